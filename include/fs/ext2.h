@@ -0,0 +1,293 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ * 
+ * @brief Second extended file system specification.
+ */
+
+#ifndef EXT2_H_
+#define EXT2_H_
+
+	#include <stdint.h>
+
+/*============================================================================*
+ *                           Superblock Information                           *
+ *============================================================================*/
+
+	/**
+	 * @brief Superblock magic number.
+	 */
+	#define EXT2_SUPER_MAGIC 0xef53
+
+	/**
+	 * @brief Offset of the superblock on the device (in bytes).
+	 */
+	#define EXT2_SUPER_OFFSET 1024
+
+	/**
+	 * @name Revision Levels
+	 */
+	/**@{*/
+	#define EXT2_GOOD_OLD_REV 0 /**< Original format.                 */
+	#define EXT2_DYNAMIC_REV  1 /**< Variable inode sizes, features.  */
+	/**@}*/
+
+	/**
+	 * @name File System States
+	 */
+	/**@{*/
+	#define EXT2_VALID_FS 0x0001 /**< Cleanly unmounted. */
+	#define EXT2_ERROR_FS 0x0002 /**< Errors detected.   */
+	/**@}*/
+
+	/**
+	 * @name Features
+	 */
+	/**@{*/
+	#define EXT2_FEATURE_INCOMPAT_FILETYPE      0x0002 /**< Type in entries. */
+	#define EXT2_FEATURE_RO_COMPAT_SPARSE_SUPER 0x0001 /**< Sparse backups.  */
+	#define EXT2_FEATURE_RO_COMPAT_LARGE_FILE   0x0002 /**< 64-bit sizes.    */
+	/**@}*/
+
+	/**
+	 * @brief Base 2 logarithm of the smallest block size.
+	 */
+	#define EXT2_MIN_BLOCK_LOG_SIZE 10
+
+	/**
+	 * @brief Base 2 logarithm of the largest block size.
+	 */
+	#define EXT2_MAX_BLOCK_LOG_SIZE 12
+
+#ifndef _ASM_FILE_
+	/**
+	 * @brief In-disk superblock.
+	 * 
+	 * @details Only the leading fields are described. The remaining ones are
+	 *          preserved as they are found on the device.
+	 */
+	struct ext2_super_block
+	{
+		uint32_t s_inodes_count;      /**< Number of inodes.               */
+		uint32_t s_blocks_count;      /**< Number of blocks.               */
+		uint32_t s_r_blocks_count;    /**< Blocks reserved to superuser.   */
+		uint32_t s_free_blocks_count; /**< Number of free blocks.          */
+		uint32_t s_free_inodes_count; /**< Number of free inodes.          */
+		uint32_t s_first_data_block;  /**< Block of the superblock.        */
+		uint32_t s_log_block_size;    /**< Block size is 1024 << this.     */
+		uint32_t s_log_frag_size;     /**< Fragment size is 1024 << this.  */
+		uint32_t s_blocks_per_group;  /**< Blocks per group.               */
+		uint32_t s_frags_per_group;   /**< Fragments per group.            */
+		uint32_t s_inodes_per_group;  /**< Inodes per group.               */
+		uint32_t s_mtime;             /**< Last mount time.                */
+		uint32_t s_wtime;             /**< Last write time.                */
+		uint16_t s_mnt_count;         /**< Mounts since last check.        */
+		uint16_t s_max_mnt_count;     /**< Mounts allowed between checks.  */
+		uint16_t s_magic;             /**< Magic number.                   */
+		uint16_t s_state;             /**< File system state.              */
+		uint16_t s_errors;            /**< Behaviour on errors.            */
+		uint16_t s_minor_rev_level;   /**< Minor revision level.           */
+		uint32_t s_lastcheck;         /**< Time of last check.             */
+		uint32_t s_checkinterval;     /**< Time allowed between checks.    */
+		uint32_t s_creator_os;        /**< Creator operating system.       */
+		uint32_t s_rev_level;         /**< Revision level.                 */
+		uint16_t s_def_resuid;        /**< User of reserved blocks.        */
+		uint16_t s_def_resgid;        /**< Group of reserved blocks.       */
+		uint32_t s_first_ino;         /**< First non-reserved inode.       */
+		uint16_t s_inode_size;        /**< Size of inode structure.        */
+		uint16_t s_block_group_nr;    /**< Group of this superblock.       */
+		uint32_t s_feature_compat;    /**< Compatible features.            */
+		uint32_t s_feature_incompat;  /**< Incompatible features.          */
+		uint32_t s_feature_ro_compat; /**< Read-only compatible features.  */
+		uint8_t s_uuid[16];           /**< Volume identifier.              */
+		char s_volume_name[16];       /**< Volume name.                    */
+	};
+
+	/**
+	 * @brief In-disk block group descriptor.
+	 */
+	struct ext2_group_desc
+	{
+		uint32_t bg_block_bitmap;      /**< Block of the block bitmap.  */
+		uint32_t bg_inode_bitmap;      /**< Block of the inode bitmap.  */
+		uint32_t bg_inode_table;       /**< First block of inode table. */
+		uint16_t bg_free_blocks_count; /**< Number of free blocks.      */
+		uint16_t bg_free_inodes_count; /**< Number of free inodes.      */
+		uint16_t bg_used_dirs_count;   /**< Number of directories.      */
+		uint16_t bg_pad;               /**< Unused.                     */
+		uint32_t bg_reserved[3];       /**< Unused.                     */
+	};
+#endif
+
+/*============================================================================*
+ *                             Inode Information                              *
+ *============================================================================*/
+
+	/**
+	 * @brief Root inode.
+	 */
+	#define EXT2_ROOT_INO 2
+
+	/**
+	 * @brief First non-reserved inode in the original format.
+	 */
+	#define EXT2_GOOD_OLD_FIRST_INO 11
+
+	/**
+	 * @brief Inode size in the original format.
+	 */
+	#define EXT2_GOOD_OLD_INODE_SIZE 128
+
+	/**
+	 * @name Block Pointers
+	 * 
+	 * @details Index of block pointers in an inode.
+	 */
+	/**@{*/
+	#define EXT2_NDIR_BLOCKS 12 /**< Number of direct blocks. */
+	#define EXT2_IND_BLOCK   12 /**< Single indirect block.   */
+	#define EXT2_DIND_BLOCK  13 /**< Double indirect block.   */
+	#define EXT2_TIND_BLOCK  14 /**< Triple indirect block.   */
+	#define EXT2_N_BLOCKS    15 /**< Number of block pointers. */
+	/**@}*/
+
+	/**
+	 * @brief Directory is indexed with a hash tree.
+	 */
+	#define EXT2_INDEX_FL 0x00001000
+
+#ifndef _ASM_FILE_
+	/**
+	 * @brief In-disk inode.
+	 * 
+	 * @details Inodes may be larger than this, in which case the extra space
+	 *          is left untouched.
+	 */
+	struct ext2_inode
+	{
+		uint16_t i_mode;                  /**< Access permissions.      */
+		uint16_t i_uid;                   /**< Owner user.              */
+		uint32_t i_size;                  /**< File size (in bytes).    */
+		uint32_t i_atime;                 /**< Last access time.        */
+		uint32_t i_ctime;                 /**< Last change time.        */
+		uint32_t i_mtime;                 /**< Last modification time.  */
+		uint32_t i_dtime;                 /**< Deletion time.           */
+		uint16_t i_gid;                   /**< Owner group.             */
+		uint16_t i_links_count;           /**< Number of links.         */
+		uint32_t i_blocks;                /**< Number of 512-byte units. */
+		uint32_t i_flags;                 /**< Flags.                   */
+		uint32_t i_osd1;                  /**< System dependent.        */
+		uint32_t i_block[EXT2_N_BLOCKS];  /**< Block pointers.          */
+		uint32_t i_generation;            /**< File version.            */
+		uint32_t i_file_acl;              /**< Extended attributes.     */
+		uint32_t i_dir_acl;               /**< High 32 bits of size.    */
+		uint32_t i_faddr;                 /**< Fragment address.        */
+		uint8_t i_osd2[12];               /**< System dependent.        */
+	};
+#endif
+
+/*============================================================================*
+ *                         Directory Entry Information                        *
+ *============================================================================*/
+
+	/**
+	 * @brief Maximum name on an ext2 file system.
+	 */
+	#define EXT2_NAME_LEN 255
+
+	/**
+	 * @name File Types
+	 * 
+	 * @details Types of files recorded in directory entries.
+	 */
+	/**@{*/
+	#define EXT2_FT_UNKNOWN  0 /**< Unknown.           */
+	#define EXT2_FT_REG_FILE 1 /**< Regular file.      */
+	#define EXT2_FT_DIR      2 /**< Directory.         */
+	#define EXT2_FT_CHRDEV   3 /**< Character device.  */
+	#define EXT2_FT_BLKDEV   4 /**< Block device.      */
+	#define EXT2_FT_FIFO     5 /**< Named pipe.        */
+	/**@}*/
+
+	/**
+	 * @brief Length of a directory entry header (in bytes).
+	 */
+	#define EXT2_DIR_HEADER_LEN 8
+
+	/**
+	 * @brief Space needed by a directory entry (in bytes).
+	 * 
+	 * @param len Length of the file name.
+	 */
+	#define EXT2_DIR_REC_LEN(len) ((EXT2_DIR_HEADER_LEN + (len) + 3) & ~3)
+
+#ifndef _ASM_FILE_
+	/**
+	 * @brief In-disk directory entry.
+	 * 
+	 * @details Entries never span blocks, and the last entry of a block
+	 *          reaches its end.
+	 */
+	struct ext2_dir_entry
+	{
+		uint32_t inode;              /**< Inode number, if in use. */
+		uint16_t rec_len;            /**< Length of this record.   */
+		uint8_t name_len;            /**< Length of the name.      */
+		uint8_t file_type;           /**< Type of the file.        */
+		char name[EXT2_NAME_LEN];    /**< File name.               */
+	};
+#endif
+
+/*============================================================================*
+ *                            In-Core Information                             *
+ *============================================================================*/
+
+#ifndef _ASM_FILE_
+	/**
+	 * @brief In-core ext2 superblock information.
+	 */
+	struct ext2_sb_info
+	{
+		uint32_t blocks_count;     /**< Number of blocks.              */
+		uint32_t first_data_block; /**< Block of the superblock.       */
+		uint32_t blocks_per_group; /**< Blocks per group.              */
+		uint32_t inodes_per_group; /**< Inodes per group.              */
+		uint32_t first_ino;        /**< First non-reserved inode.      */
+		uint32_t incompat;         /**< Incompatible features.         */
+		unsigned ngroups;          /**< Number of block groups.        */
+		unsigned block_size;       /**< Block size (in bytes).         */
+		unsigned log_ratio;        /**< Log 2 of buffers per block.    */
+		unsigned inode_size;       /**< Inode size (in bytes).         */
+	};
+
+	/**
+	 * @brief In-core ext2 inode information.
+	 */
+	struct ext2_inode_info
+	{
+		uint32_t block[EXT2_N_BLOCKS]; /**< Block pointers.           */
+		uint32_t nsectors;             /**< Number of 512-byte units. */
+		uint32_t flags;                /**< Flags.                    */
+		uint32_t dtime;                /**< Deletion time.            */
+	};
+#endif
+
+#endif /* EXT2_H_ */
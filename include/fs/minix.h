@@ -174,4 +174,241 @@
 	} __attribute__((packed));
 #endif
 
+/*============================================================================*
+ *                         Directory Index Information                        *
+ *============================================================================*/
+
+	/**
+	 * @brief Directory index magic number.
+	 */
+	#define DIRIDX_MAGIC 0x7864
+
+	/**
+	 * @brief Number of index slots in the first block of a directory.
+	 */
+	#define DIRIDX_SLOTS (BLOCK_SIZE/16 - 3)
+
+	/**
+	 * @brief Maximum number of leaf blocks in an indexed directory.
+	 */
+	#define DIRIDX_MAX (DIRIDX_SLOTS*2)
+
+#ifndef _ASM_FILE_
+	/**
+	 * @brief Directory index entry.
+	 *
+	 * @details Maps names that hash to @p hash or above, up to the hash of
+	 *          the next index entry, to a logical block of the directory.
+	 */
+	struct d_diridx_entry
+	{
+		uint32_t hash; /**< Lowest hash in the leaf block. */
+		uint16_t blk;  /**< Logical block number.          */
+	} __attribute__((packed));
+
+	/**
+	 * @brief First block of an indexed directory.
+	 *
+	 * @details An indexed directory keeps "." and ".." in the first two
+	 *          entries of its first block, as any other directory. The
+	 *          remaining entries of that block are free directory entries
+	 *          whose names hold a hash index of the leaf blocks, so that the
+	 *          file system stays readable by plain Minix implementations. Any
+	 *          entry written in that block by them voids the index, and the
+	 *          directory is then searched linearly.
+	 */
+	struct d_diridx
+	{
+		struct d_dirent dot;    /**< Current directory.       */
+		struct d_dirent dotdot; /**< Parent directory.        */
+		uint16_t h_ino;         /**< Always #INODE_NULL.      */
+		uint16_t h_magic;       /**< Magic number.            */
+		uint16_t h_count;       /**< Number of index entries. */
+		uint32_t h_checksum;    /**< Checksum of the index.   */
+		uint8_t h_unused[6];    /**< Unused.                  */
+
+		/**
+		 * @brief Index slots.
+		 */
+		struct
+		{
+			uint16_t s_ino;                 /**< Always #INODE_NULL. */
+			struct d_diridx_entry s_ent[2]; /**< Index entries.      */
+			uint16_t s_unused;              /**< Unused.             */
+		} __attribute__((packed)) slots[DIRIDX_SLOTS];
+	} __attribute__((packed));
+
+	/**
+	 * @brief Hashes a file name.
+	 *
+	 * @param name File name.
+	 *
+	 * @returns The hash value of @p name.
+	 */
+	static inline uint32_t minix_name_hash(const char *name)
+	{
+		uint32_t h = 2166136261u;
+
+		for (int i = 0; (i < MINIX_NAME_MAX) && (name[i] != '\0'); i++)
+			h = (h ^ (unsigned char) name[i])*16777619u;
+
+		return (h);
+	}
+
+	/**
+	 * @brief Gets an entry of a directory index.
+	 *
+	 * @param idx Directory index.
+	 * @param i   Entry number.
+	 *
+	 * @returns A pointer to the requested entry.
+	 */
+	static inline struct d_diridx_entry *
+	minix_diridx_entry(struct d_diridx *idx, unsigned i)
+	{
+		return (&idx->slots[i >> 1].s_ent[i & 1]);
+	}
+
+	/**
+	 * @brief Computes the checksum of a directory index.
+	 *
+	 * @param idx Directory index.
+	 *
+	 * @returns The checksum of @p idx.
+	 */
+	static inline uint32_t minix_diridx_checksum(struct d_diridx *idx)
+	{
+		uint32_t c = 2166136261u;
+
+		c = (c ^ idx->h_magic)*16777619u;
+		c = (c ^ idx->h_count)*16777619u;
+		for (unsigned i = 0; i < idx->h_count; i++)
+		{
+			c = (c ^ minix_diridx_entry(idx, i)->hash)*16777619u;
+			c = (c ^ minix_diridx_entry(idx, i)->blk)*16777619u;
+		}
+
+		return (c);
+	}
+
+	/**
+	 * @brief Asserts if a directory index is valid.
+	 *
+	 * @param idx First block of a directory.
+	 *
+	 * @returns Non-zero if the directory is indexed, and zero otherwise.
+	 */
+	static inline int minix_diridx_valid(struct d_diridx *idx)
+	{
+		if ((idx->h_ino != INODE_NULL) || (idx->h_magic != DIRIDX_MAGIC))
+			return (0);
+		if ((idx->h_count == 0) || (idx->h_count > DIRIDX_MAX))
+			return (0);
+
+		/* Some entry was written over the index. */
+		for (unsigned i = 0; i < DIRIDX_SLOTS; i++)
+		{
+			if (idx->slots[i].s_ino != INODE_NULL)
+				return (0);
+		}
+
+		return (idx->h_checksum == minix_diridx_checksum(idx));
+	}
+
+	/**
+	 * @brief Searches a directory index.
+	 *
+	 * @param idx  Directory index.
+	 * @param hash Hash of the target file name.
+	 *
+	 * @returns The number of the index entry that covers @p hash.
+	 */
+	static inline unsigned minix_diridx_search(struct d_diridx *idx, uint32_t hash)
+	{
+		unsigned lo, hi;
+
+		lo = 0;
+		hi = idx->h_count;
+		while (hi - lo > 1)
+		{
+			unsigned mid = (lo + hi) >> 1;
+
+			if (minix_diridx_entry(idx, mid)->hash <= hash)
+				lo = mid;
+			else
+				hi = mid;
+		}
+
+		return (lo);
+	}
+
+	/**
+	 * @brief Inserts an entry in a directory index.
+	 *
+	 * @param idx  Directory index.
+	 * @param i    Entry number.
+	 * @param hash Lowest hash in the leaf block.
+	 * @param blk  Logical block number of the leaf block.
+	 *
+	 * @note The directory index must not be full.
+	 */
+	static inline void
+	minix_diridx_insert(struct d_diridx *idx, unsigned i, uint32_t hash, uint16_t blk)
+	{
+		for (unsigned j = idx->h_count; j > i; j--)
+			*minix_diridx_entry(idx, j) = *minix_diridx_entry(idx, j - 1);
+
+		minix_diridx_entry(idx, i)->hash = hash;
+		minix_diridx_entry(idx, i)->blk = blk;
+		idx->h_count++;
+		idx->h_checksum = minix_diridx_checksum(idx);
+	}
+
+	/**
+	 * @brief Computes where a full leaf block shall be split.
+	 *
+	 * @param leaf  Directory entries of the leaf block.
+	 * @param split Location where the split hash shall be stored.
+	 *
+	 * @returns Zero if entries whose hash is @p split or above may be moved
+	 *          to a new leaf block, so that both blocks keep some entries,
+	 *          and non-zero if all entries have the same hash.
+	 */
+	static inline int minix_diridx_split(const struct d_dirent *leaf, uint32_t *split)
+	{
+		unsigned j, n;
+		uint32_t h[BLOCK_SIZE/sizeof(struct d_dirent)];
+
+		n = BLOCK_SIZE/sizeof(struct d_dirent);
+
+		/* Sort hashes. */
+		for (unsigned i = 0; i < n; i++)
+		{
+			uint32_t x = minix_name_hash(leaf[i].d_name);
+
+			for (j = i; (j > 0) && (h[j - 1] > x); j--)
+				h[j] = h[j - 1];
+			h[j] = x;
+		}
+
+		/* Split around the median. */
+		for (j = n/2; j < n; j++)
+		{
+			if (h[j] != h[j - 1])
+				goto found;
+		}
+		for (j = n/2 - 1; j > 0; j--)
+		{
+			if (h[j] != h[j - 1])
+				goto found;
+		}
+
+		return (-1);
+
+	found:
+		*split = h[j];
+		return (0);
+	}
+#endif
+
 #endif /* MINIX_H_ */
@@ -32,6 +32,24 @@
 	#define PTE_SIZE   4                 /* Page table entry size.     */
 	#define PDE_SIZE   4                 /* Page directory entry size. */
 
+	/*
+	 * Large pages. A page directory entry with the page size
+	 * bit set maps a whole page table (4 MB) at once.
+	 */
+	#define PAGING_LARGE   1              /* Large pages supported?    */
+	#define LPAGE_SIZE     PGTAB_SIZE     /* Large page size.          */
+	#define LPAGE_MASK     PGTAB_MASK     /* Large page mask.          */
+
+	/* Page directory entry flags used at boot time. */
+	#define PDE_PRESENT  0x001 /* Present.   */
+	#define PDE_WRITABLE 0x002 /* Writable.  */
+	#define PDE_LARGE    0x080 /* Page size. */
+	#define PDE_GLOBAL   0x100 /* Global.    */
+
+	/* Control register 4 flags. */
+	#define CR4_PSE 0x010 /* Page size extensions. */
+	#define CR4_PGE 0x080 /* Global pages.         */
+
 #ifndef _ASM_FILE_
 
 	/*
@@ -45,7 +63,8 @@
 		unsigned          :  2; /* Reserved.          */
 		unsigned accessed :  1; /* Accessed?          */
 		unsigned dirty    :  1; /* Dirty?             */
-		unsigned          :  2; /* Reserved.          */
+		unsigned large    :  1; /* Large page?        */
+		unsigned global   :  1; /* Global page?       */
 		unsigned          :  3; /* Unused.            */
 		unsigned frame    : 20; /* Frame number.      */
 	};
@@ -141,6 +160,30 @@
 		return (pde->user);
 	}
 
+	/**
+	 * @brief Sets/clears the page size bit of a page table directory entry.
+	 *
+	 * @param pde Target page table directory entry.
+	 * @param set Set bit?
+	 */
+	static inline void pde_large_set(struct pde *pde, int set)
+	{
+		pde->large = (set) ? 1 : 0;
+	}
+
+	/**
+	 * @brief Asserts if a page table directory entry maps a large page.
+	 *
+	 * @param pde Target page table directory entry.
+	 *
+	 * @returns Non zero if the target page table directory entry maps a
+	 * large page, and zero otherwise.
+	 */
+	static inline int pde_is_large(struct pde *pde)
+	{
+		return (pde->large);
+	}
+
 	/**
 	 * @brief Sets/clears the present bit of a page table entry.
 	 *
@@ -187,7 +230,7 @@
 	 */
 	static inline int pte_is_fill(struct pte *pte)
 	{
-		return (pte->fill);
+		return (pte->fill && !pte->zero);
 	}
 
 	/**
@@ -212,7 +255,60 @@
 	 */
 	static inline int pte_is_zero(struct pte *pte)
 	{
-		return (pte->zero);
+		return (pte->zero && !pte->fill);
+	}
+
+	/**
+	 * @brief Sets/clears the swap bits of a page table entry.
+	 *
+	 * @details A swapped out page is a non-present page that has both
+	 * the demand fill and the demand zero bits set. The frame field
+	 * then holds the swap slot of the page.
+	 *
+	 * @param pte Target page table entry.
+	 * @param set Set bits?
+	 */
+	static inline void pte_swap_set(struct pte *pte, int set)
+	{
+		pte->fill = (set) ? 1 : 0;
+		pte->zero = (set) ? 1 : 0;
+	}
+
+	/**
+	 * @brief Asserts if a page table entry refers to a swapped out page.
+	 *
+	 * @param pte Target page table entry.
+	 *
+	 * @returns Non zero if the target page table entry refers to a
+	 * swapped out page, and false otherwise.
+	 */
+	static inline int pte_is_swap(struct pte *pte)
+	{
+		return (pte->fill && pte->zero);
+	}
+
+	/**
+	 * @brief Sets/clears the accessed bit of a page table entry.
+	 *
+	 * @param pte Target page table entry.
+	 * @param set Set bit?
+	 */
+	static inline void pte_accessed_set(struct pte *pte, int set)
+	{
+		pte->accessed = (set) ? 1 : 0;
+	}
+
+	/**
+	 * @brief Asserts if the accessed bit of a page table entry is set.
+	 *
+	 * @param pte Target page table entry.
+	 *
+	 * @returns Non zero if the accessed bit of the target page table
+	 * entry is set, and false otherwise.
+	 */
+	static inline int pte_is_accessed(struct pte *pte)
+	{
+		return (pte->accessed);
 	}
 
 	/**
@@ -213,6 +213,11 @@
 /* Maximum number of links to a single file. */
 #define LINK_MAX 8
 
+/* Minimum size in bytes of a thread stack. */
+#ifndef PTHREAD_STACK_MIN
+#define PTHREAD_STACK_MIN 4096
+#endif
+
 /**
  * @brief Maximum number of bytes in a filename.
  */
@@ -221,6 +226,9 @@
 /* Files that one process can have open simultaneously. */
 #define OPEN_MAX 20
 
+/* Maximum value of an object of type ssize_t. */
+#define SSIZE_MAX INT_MAX
+
 /* Number of semaphores that can be opened simultaneously. */
 #define SEM_OPEN_MAX 100
 
@@ -43,15 +43,33 @@
 	#define PROC_MAX                    64 /**< Maximum number of process.         */
 	#define THRD_MAX          (PROC_MAX*4) /**< Maximum number of threads.         */
 	#define THRD_MAX_PER_PROC           16 /**< Maximum number of threads/process. */
+	#define THRD_STACK_CACHE             4 /**< Cached thread stacks/process.      */
 	#define PROC_SIZE_MAX  (MEMORY_SIZE/8) /**< Maximum process size.              */
 	#define RAMDISK_SIZE          0x400000 /**< RAM disks size.                    */
 	#define INITRD_SIZE           0x200000 /**< Init RAM disk size.                */
+	#define ZRAM_SIZE            0x1000000 /**< Compressed RAM disk size.          */
+	#define ZRAM_POOL_SIZE        0x400000 /**< Compressed RAM disk memory.        */
 	#define NR_INODES                 1024 /**< Number of in-core inodes.          */
 	#define NR_SUPERBLOCKS               4 /**< Number of in-core super blocks.    */
 	#define ROOT_DEV                0x0001 /**< Root device number.                */
+	#define SWAP_DEV                0x0201 /**< Swap device number.                */
+	#define SWAP_SIZE            0x1000000 /**< Swap area size.                    */
+	#define KSM_ENABLE                   0 /**< Merge identical pages?             */
+	#define KSM_SCAN_PAGES             256 /**< Pages scanned per merging pass.    */
+	#define KSM_SCAN_TICKS              50 /**< Ticks between merging passes.     */
+	#define PAGE_COLORING                0 /**< Color page frames?                 */
+	#define PAGE_COLORS                 16 /**< Number of page colors.             */
 	#define NR_FILES                   256 /**< Number of opened files.            */
 	#define NR_REGIONS                 128 /**< Number of memory regions.          */
 	#define NR_BUFFERS                 256 /**< Number of block buffers.           */
+	#define NR_CACHED_PAGES            512 /**< Number of page cache entries.      */
+	#define NR_DENTRIES                256 /**< Number of name cache entries.      */
+	#define NR_PREALLOC_BLOCKS           8 /**< Blocks preallocated per file.      */
+	#define NR_BMAP_CACHE               16 /**< Block translations per file.       */
+	#define NR_TMPFS_NODES             128 /**< Number of tmpfs files.             */
+	#define NR_TMPFS_DIRENTS           512 /**< Number of tmpfs directory entries. */
+	#define NR_TMPFS_PAGES            1024 /**< Pages usable by tmpfs file data.   */
+	#define NR_SHMS                     32 /**< Number of shared memory segments.  */
 	#define NR_MOUNTING_POINT           64 /**< Maximum nunber of mounting points. */
 	#define DEBUG_MAX                   64 /**< Maximum number of debug functions. */
 	/**@}*/
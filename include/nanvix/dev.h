@@ -103,6 +103,8 @@
 	/**@{*/
 	#define RAMDISK_MAJOR 0x0 /**M ramdisk device. */
 	#define ATA_MAJOR     0x1 /**< ATA device.     */
+	#define ZRAM_MAJOR    0x2 /**< Compressed RAM. */
+	#define NODEV_MAJOR   0xf /**< No device.      */
 	/**@}*/
 	
 	/**
@@ -28,12 +28,14 @@
 
 #ifndef _ASM_FILE_
 
+	#include <fs/ext2.h>
 	#include <fs/minix.h>
 	#include <nanvix/config.h>
 	#include <nanvix/const.h>
 	#include <nanvix/pm.h>
 	#include <sys/stat.h>
 	#include <sys/types.h>
+	#include <sys/uio.h>
 	#include <stdint.h>
 	#include <ustat.h>
 	#include <sys/sem.h>
@@ -47,6 +49,14 @@
 	 */
 	/**@{*/
  
+	/**
+	 * @brief Device block number.
+	 * 
+	 * @details Wider than #block_t, so that file systems with 32-bit block
+	 *          numbers can address the whole device.
+	 */
+	typedef uint32_t blkno_t;
+	
 	/**
 	 * @brief Opaque pointer to a block buffer.
 	 */
@@ -62,12 +72,13 @@
 	EXTERN void blklock(buffer_t);
 	EXTERN void blkunlock(buffer_t);
 	EXTERN void brelse(buffer_t);
-	EXTERN buffer_t bread(dev_t, block_t);
+	EXTERN buffer_t bread(dev_t, blkno_t);
+	EXTERN buffer_t bnew(dev_t, blkno_t);
 	EXTERN void bwrite(buffer_t);
 	EXTERN void buffer_dirty(buffer_t, int);
 	EXTERN void *buffer_data(const_buffer_t);
 	EXTERN dev_t buffer_dev(const_buffer_t);
-	EXTERN block_t buffer_num(const_buffer_t);
+	EXTERN blkno_t buffer_num(const_buffer_t);
 	EXTERN int buffer_is_sync(const_buffer_t);
 	
 	/**@}*/
@@ -91,6 +102,9 @@
 		ssize_t (*file_read)(struct inode *, void *, size_t , off_t );
 		ssize_t (*file_write)(struct inode *, const void *, size_t , off_t);
 		struct d_dirent *(*dirent_search) (struct inode *, const char *, struct buffer **, int);
+		int (*readpage)(struct inode *, void *, off_t);
+		ssize_t (*file_readv)(struct inode *, struct iovec *, int, off_t);
+		ssize_t (*file_writev)(struct inode *, struct iovec *, int, off_t);
 	};
 
 	/**
@@ -129,9 +143,18 @@
 		struct inode *hash_next;  /**< Next inode in the hash table.         */ 
 		struct inode *hash_prev;  /**< Previous inode in the hash table.     */ 
 		struct thread *chain;     /**< Sleeping chain.                       */ 
+		block_t pa_next;          /**< Next preallocated block.              */
+		unsigned pa_count;        /**< Number of preallocated blocks.        */
+		block_t bm_blk;           /**< Last used indirect block.             */
+		unsigned bm_first;        /**< First block mapped by it.             */
+		unsigned bm_logic;        /**< First cached block translation.       */
+		unsigned bm_count;        /**< Number of cached block translations.  */
+		block_t bm_map[NR_BMAP_CACHE]; /**< Cached block translations.      */
 		struct inode_operations * i_op;
 		union {
 			struct d_inode minix;
+			struct tmpfs_node *tmpfs;
+			struct ext2_inode_info ext2;
 		} u;
 	}; 
 
@@ -142,6 +165,7 @@
   EXTERN void inode_lock(struct inode *); 
   EXTERN void inode_unlock(struct inode *); 
   EXTERN void inode_sync(void); 
+  EXTERN void inode_prealloc_free(struct superblock *);
   EXTERN void inode_truncate(struct inode *); 
   EXTERN struct inode *inode_alloc(struct superblock *); 
   EXTERN struct inode *inode_get(dev_t dev, ino_t); 
@@ -183,7 +207,10 @@
   EXTERN void superblock_stat(superblock_t, struct ustat *); 
   EXTERN void superblock_sync(void); 
   EXTERN block_t block_map(struct inode *, off_t, int); 
-  EXTERN void block_free(struct superblock *, block_t, int); 
+  EXTERN unsigned block_map_range(struct inode *, off_t, block_t *, unsigned);
+  EXTERN void block_map_invalidate(struct inode *);
+  EXTERN void block_free(struct superblock *, block_t, int);
+  EXTERN void block_prealloc_free(struct inode *); 
    
 /*============================================================================* 
  *                              File System Manager                           * 
@@ -215,6 +242,11 @@
   EXTERN ssize_t file_read(struct inode *, void *, size_t, off_t); 
   EXTERN ssize_t dir_read(struct inode *, void *, size_t, off_t); 
   EXTERN ssize_t file_write(struct inode *, const void *, size_t, off_t); 
+  EXTERN ssize_t file_readv(struct inode *, struct iovec *, int, off_t);
+  EXTERN ssize_t file_writev(struct inode *, struct iovec *, int, off_t);
+  EXTERN void iov_copy(struct iovec *, int, void *, size_t, int);
+  EXTERN void iov_zero(struct iovec *, int, size_t);
+  EXTERN ssize_t file_splice(struct file *, off_t *, struct file *, off_t *, size_t);
   EXTERN ssize_t pipe_read(struct inode *, char *, size_t); 
   EXTERN ssize_t pipe_write(struct inode *, const char *, size_t); 
   EXTERN struct inode *do_creat(struct inode *, const char *wame, mode_t, int);
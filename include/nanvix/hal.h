@@ -96,6 +96,8 @@
 	 */
 	/**@{*/
 	EXTERN void physcpy(addr_t, addr_t, size_t);
+	EXTERN int user_copy(void *, const void *, size_t);
+	EXTERN int user_strncpy(char *, const char *, size_t);
 	/**@}*/	
 
 	/**
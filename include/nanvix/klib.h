@@ -76,6 +76,15 @@
 	#define bitmap_clear(bitmap, pos) \
 		(((uint32_t *)(bitmap))[IDX(pos)] &= ~(0x1 << OFF(pos)))
 	
+	/**
+	 * @brief Tests a bit in a bitmap.
+	 * 
+	 * @param bitmap Bitmap where the bit should be tested.
+	 * @param pos    Position of the bit that shall be tested.
+	 */
+	#define bitmap_test(bitmap, pos) \
+		(((uint32_t *)(bitmap))[IDX(pos)] & (0x1 << OFF(pos)))
+	
 	/**
 	 * @name Bitmap Functions
 	 */
@@ -193,6 +202,7 @@
 	 * @name Memory Functions
 	 */
 	/**@{*/
+	EXTERN int kmemcmp(const void *, const void *, size_t);
 	EXTERN void* kmemcpy(void *, const void *, size_t);
 	EXTERN void *kmemset(void *, int, size_t);
 	/**@}*/
@@ -34,6 +34,7 @@
 	#define INITRD_VIRT  0xc2000000 /* Initial RAM disk. */
 	#define SERIAL_VIRT  0xc4000000 /* Serial port.      */
 	#define OMPIC_VIRT   0xc5000000 /* OMPIC.            */
+	#define UMEM_VIRT    0xc8000000 /* User memory.      */
 	
 	/* Physical memory layout. */
 	#define KBASE_PHYS   0x00000000 /* Kernel base.      */
@@ -43,6 +44,10 @@
 	/* User memory layout. */
 	#define USTACK_ADDR 0xc0000000 /* User stack. */
 	#define UHEAP_ADDR  0xa0000000 /* User heap.  */
+	#define UMMAP_ADDR  0x40000000 /* Mappings.   */
+	
+	/* Memory mappings area size: 1 GB. */
+	#define UMMAP_SIZE 0x40000000
 
 	/* Kernel memory size: 16 MB. */
 	#define KMEM_SIZE 0x01000000
@@ -74,14 +79,30 @@
 	EXTERN int chkmem(const void *, size_t, mode_t);
 	EXTERN int fubyte(const void *);
 	EXTERN int fudword(const void *);
+	EXTERN int copy_from_user(void *, const void *, size_t);
+	EXTERN int copy_to_user(void *, const void *, size_t);
+	EXTERN ssize_t strncpy_from_user(char *, const char *, size_t);
+	EXTERN addr_t extable_search(addr_t);
 	EXTERN int crtpgdir(struct process *);
 	EXTERN int pfault(addr_t);
-	EXTERN int vfault(addr_t);
+	EXTERN int vfault(addr_t, int);
 	EXTERN int addr_is_clear(struct process *proc, addr_t start);
+	EXTERN int writeupg(struct process *, addr_t, const void *, size_t);
 	EXTERN void dstrypgdir(struct process *);
 	EXTERN void putkpg(void *);
 	EXTERN void mm_init(void);
+	EXTERN void kswapd(void);
+	EXTERN void ksmd(void);
+	EXTERN unsigned frame_nsaved(void);
 	EXTERN void *getkpg(int);
+	
+	/* Forward definitions. */
+	struct inode;
+	EXTERN void *pcache_get(struct inode *, off_t);
+	EXTERN void pcache_put(void *);
+	EXTERN void pcache_update(struct inode *, off_t, const void *, size_t);
+	EXTERN void pcache_invalidate(struct inode *);
+	EXTERN void pcache_flush(dev_t);
 
 #endif /* _ASM_FILE_ */
 	
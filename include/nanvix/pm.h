@@ -125,6 +125,13 @@
 		/**@{*/
 		struct pde *pgdir;                 /**< Page directory.         */
 		struct pregion pregs[NR_PREGIONS]; /**< Process memory regions. */
+		struct pregion *mmaps;             /**< Memory mappings.        */
+		unsigned nmmaps;                   /**< Used memory mappings.   */
+		struct pregion **rtab;             /**< Sorted process regions. */
+		unsigned nrtab;                    /**< Used sorted regions.    */
+		unsigned tstacks;                  /**< Used stack slots.       */
+		unsigned ntscache;                 /**< Cached thread stacks.   */
+		struct region *tscache[THRD_STACK_CACHE]; /**< Stacks cache.    */
 		size_t size;                       /**< Process size.           */
 		/**@}*/
 
@@ -169,6 +176,21 @@
 		unsigned cktime; /**< Kernel CPU time of terminated children. */
 		/**@}*/
 
+		/**
+		 * @name Memory accounting information
+		 */
+		/**@{*/
+		unsigned minflt;  /**< Minor page faults.                          */
+		unsigned majflt;  /**< Major page faults.                          */
+		unsigned cowflt;  /**< Pages copied on write.                      */
+		unsigned rss;     /**< Resident pages.                             */
+		unsigned maxrss;  /**< Peak resident pages.                        */
+		unsigned cminflt; /**< Minor page faults of terminated children.   */
+		unsigned cmajflt; /**< Major page faults of terminated children.   */
+		unsigned ccowflt; /**< Copied pages of terminated children.        */
+		unsigned cmaxrss; /**< Peak resident pages of terminated children. */
+		/**@}*/
+
 		/**
 		 * @name Scheduling information
 		 */
@@ -190,8 +212,11 @@
 	};
 	
 	/* Forward definitions. */
+	EXTERN struct process *allocproc(void);
 	EXTERN void bury(struct process *);
+	EXTERN void copyproc(struct process *);
 	EXTERN void die(int);
+	EXTERN void freeproc(struct process *);
 	EXTERN int issig(void);
 	EXTERN void pm_init(void);
 	EXTERN void sched(struct thread *);
@@ -202,6 +227,7 @@
 	EXTERN void sleep(struct thread **, int);
 #endif
 	EXTERN void sndsig(struct process *, int);
+	EXTERN void startproc(struct process *);
 	EXTERN void wakeup(struct thread **);
 	EXTERN void (*yield)(void);
 	EXTERN void yield_up(void);
@@ -35,6 +35,9 @@
 	#define REGION_STICKY    0x08 /* Stick region.           */
 	#define REGION_DOWNWARDS 0x10 /* Region grows downwards. */
 	#define REGION_UPWARDS   0x20 /* Region grows upwards.   */
+	#define REGION_NOWRITE   0x40 /* Region may not be made writable. */
+	#define REGION_SHM       0x80 /* Shared memory segment.  */
+	#define REGION_LARGE    0x100 /* Mapped with large pages. */
 	
 	/* Memory region dimensions. */
 	#define REGION_PGTABS (16) /* # Page tables.     */
@@ -58,6 +61,7 @@
 	{
 		int flags;                        /* Flags.                 */
 		struct pte *pgtab[REGION_PGTABS]; /* Underlying page table. */
+		addr_t lframe[REGION_PGTABS];     /* Underlying large page. */
 	};
 
 	/*
@@ -69,6 +73,7 @@
 		int flags;                         /* Flags (see above).          */
 		int count;                         /* Reference count.            */
 		size_t size;                       /* Region size.                */
+		size_t maxsize;                    /* Maximum region size.        */
 		struct miniregion *mtab[MREGIONS]; /* Mini region.                */
 		struct thread *chain;              /* Sleeping chain.             */
 		struct pregion *preg;              /* Process region attached to. */
@@ -134,6 +139,9 @@
 	 */
 	#define MRTAB(a) ((unsigned)(a) >> MREGION_SHIFT)
 
+	/* Memory region table. */
+	EXTERN struct region regtab[];
+
 	/* Forward definitions. */
 	EXTERN int attachreg(struct process*,struct pregion*,addr_t,struct region*);
 	EXTERN int editreg(struct region *, uid_t, gid_t, mode_t);
@@ -148,7 +156,16 @@
 	EXTERN struct region *allocreg(mode_t, size_t, int);
 	EXTERN struct region *dupreg(struct region *);
 	EXTERN struct pregion *findreg(struct process *, addr_t);
+	EXTERN unsigned procrss(struct process *, unsigned *);
+	EXTERN void regrss_add(struct process *, struct region *, int);
 	EXTERN struct region *xalloc(struct inode *, off_t, size_t);
+	EXTERN struct pregion *mapreg(struct process *, addr_t, struct region *, int);
+	EXTERN void unmapreg(struct process *, struct pregion *);
+	EXTERN void protreg(struct pregion *, mode_t);
+	EXTERN mode_t protmode(int);
+	EXTERN int syncreg(struct pregion *, addr_t, size_t);
+	EXTERN int dupmaps(struct process *);
+	EXTERN void detachmaps(struct process *);
 
 #endif /* _ASM_FILE */
 
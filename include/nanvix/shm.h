@@ -0,0 +1,62 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NANVIX_SHM_H_
+#define NANVIX_SHM_H_
+
+	#include <nanvix/const.h>
+	#include <nanvix/pm.h>
+	#include <nanvix/region.h>
+	#include <sys/types.h>
+
+	/**
+	 * @brief Shared memory segment.
+	 *
+	 * @details Shared memory segments own a reference to their underlying
+	 *          memory region, so the region outlives detaches until the
+	 *          segment is removed. Access permissions, owner and creator are
+	 *          those of the memory region.
+	 */
+	struct shm
+	{
+		key_t key;          /**< Key.                           */
+		struct region *reg; /**< Underlying memory region.      */
+		size_t size;        /**< Size in bytes.                 */
+		pid_t cpid;         /**< Process ID of creator.         */
+		pid_t lpid;         /**< Process ID of last operation.  */
+		time_t atime;       /**< Time of last attach.           */
+		time_t dtime;       /**< Time of last detach.           */
+		time_t ctime;       /**< Time of last change.           */
+	};
+
+	/**
+	 * @brief Number of processes attached to a shared memory segment.
+	 */
+	#define shm_nattch(shm) \
+		((shm)->reg->count - 1)
+
+	/* Forward definitions. */
+	EXTERN struct shm *shm_get(int);
+	EXTERN struct shm *shm_lookup(struct region *);
+	EXTERN void shm_remove(struct shm *);
+
+	/* Forward definitions. */
+	EXTERN struct shm shmtab[NR_SHMS];
+
+#endif /* NANVIX_SHM_H_ */
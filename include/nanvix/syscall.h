@@ -28,6 +28,7 @@
 	#include <sys/times.h>
 	#include <sys/types.h>
 	#include <sys/utsname.h>
+	#include <sys/shm.h>
 	#include <i386/pmc.h>
 	#include <signal.h>
 	#include <ustat.h>
@@ -35,7 +36,7 @@
 	#include <semaphore.h>
 
 	/* Number of system calls. */
-	#define NR_SYSCALLS 63
+	#define NR_SYSCALLS 79
 	
 	/* System call numbers. */
 	#define NR_alarm           0
@@ -101,12 +102,95 @@
 	#define NR_pthread_join   60
 	#define NR_pthread_self   61
 	#define NR_pthread_detach 62
-	#define NR_semget         63
-	#define NR_semctl         64
-	#define NR_semop          65
+	#define NR_mmap           63
+	#define NR_munmap         64
+	#define NR_mprotect       65
+	#define NR_msync          66
+	#define NR_shmget         67
+	#define NR_shmat          68
+	#define NR_shmdt          69
+	#define NR_shmctl         70
+	#define NR_spawn          71
+	#define NR_getrusage      72
+	#define NR_pread          73
+	#define NR_pwrite         74
+	#define NR_readv          75
+	#define NR_writev         76
+	#define NR_sendfile       77
+	#define NR_splice         78
 
 #ifndef _ASM_FILE_
 
+	#include <sys/resource.h>
+	#include <sys/uio.h>
+
+	/**
+	 * @brief Arguments of mmap().
+	 *
+	 * @details These are passed by reference, since they do not fit in the
+	 *          registers that are used to pass system call arguments.
+	 */
+	struct mmap_args
+	{
+		void *addr; /**< Mapping address.  */
+		size_t len; /**< Mapping length.   */
+		int prot;   /**< Protection.       */
+		int flags;  /**< Mapping flags.    */
+		int fd;     /**< File descriptor.  */
+		off_t off;  /**< File offset.      */
+	};
+
+	/**
+	 * @brief Arguments of splice().
+	 *
+	 * @details These are passed by reference, since they do not fit in the
+	 *          registers that are used to pass system call arguments.
+	 */
+	struct splice_args
+	{
+		int fd_in;      /**< Source file descriptor. */
+		off_t *off_in;  /**< Source file offset.     */
+		int fd_out;     /**< Target file descriptor. */
+		off_t *off_out; /**< Target file offset.     */
+		size_t len;     /**< Number of bytes.        */
+		unsigned flags; /**< Splice flags.           */
+	};
+
+	/* Spawn file actions. */
+	#define SPAWN_OPEN  0 /* Open a file.                */
+	#define SPAWN_CLOSE 1 /* Close a file descriptor.    */
+	#define SPAWN_DUP2  2 /* Duplicate file descriptor. */
+
+	/* Maximum number of spawn file actions. */
+	#define SPAWN_ACTIONS_MAX (OPEN_MAX*2)
+
+	/**
+	 * @brief File action of spawn().
+	 */
+	struct spawn_action
+	{
+		int type;         /**< Action type.                  */
+		int fd;           /**< Target file descriptor.       */
+		int newfd;        /**< New file descriptor for dup2. */
+		const char *path; /**< Path name for open.           */
+		int oflag;        /**< Open flags.                   */
+		mode_t mode;      /**< Creation mode.                */
+	};
+
+	/**
+	 * @brief Arguments of spawn().
+	 */
+	struct spawn_args
+	{
+		const char *path;                    /**< Executable.             */
+		const char **argv;                   /**< Arguments.              */
+		const char **envp;                   /**< Environment.            */
+		const struct spawn_action *actions;  /**< File actions.           */
+		int nactions;                        /**< Number of file actions. */
+		int flags;                           /**< Spawn flags.            */
+		sigset_t sigdefault;                 /**< Signals to reset.       */
+	};
+
 	/* System calls prototypes. */
 	EXTERN unsigned sys_alarm(unsigned seconds);
 	EXTERN int sys_brk(void *ptr);
@@ -340,6 +424,86 @@
 	/* Unlock a semaphore */
 	EXTERN int sys_sempost(int idx);
 
+	/*
+	 * Maps pages of memory.
+	 */
+	EXTERN void *sys_mmap(const struct mmap_args *args);
+
+	/*
+	 * Unmaps pages of memory.
+	 */
+	EXTERN int sys_munmap(void *addr, size_t len);
+
+	/*
+	 * Sets protection of memory mapping.
+	 */
+	EXTERN int sys_mprotect(void *addr, size_t len, int prot);
+
+	/*
+	 * Synchronizes memory with physical storage.
+	 */
+	EXTERN int sys_msync(void *addr, size_t len, int flags);
+
+	/*
+	 * Gets a shared memory segment.
+	 */
+	EXTERN int sys_shmget(key_t key, size_t size, int shmflg);
+
+	/*
+	 * Attaches a shared memory segment.
+	 */
+	EXTERN void *sys_shmat(int shmid, const void *shmaddr, int shmflg);
+
+	/*
+	 * Detaches a shared memory segment.
+	 */
+	EXTERN int sys_shmdt(const void *shmaddr);
+
+	/*
+	 * Shared memory control operations.
+	 */
+	EXTERN int sys_shmctl(int shmid, int cmd, struct shmid_ds *buf);
+
+	/*
+	 * Spawns a process.
+	 */
+	EXTERN pid_t sys_spawn(const struct spawn_args *args);
+
+	/*
+	 * Gets information about resource utilization.
+	 */
+	EXTERN int sys_getrusage(int who, struct rusage *r_usage);
+
+	/*
+	 * Reads from a file at a given offset.
+	 */
+	EXTERN ssize_t sys_pread(int fd, void *buf, size_t n, off_t off);
+
+	/*
+	 * Writes to a file at a given offset.
+	 */
+	EXTERN ssize_t sys_pwrite(int fd, const void *buf, size_t n, off_t off);
+
+	/*
+	 * Reads from a file into multiple buffers.
+	 */
+	EXTERN ssize_t sys_readv(int fd, const struct iovec *iov, int iovcnt);
+
+	/*
+	 * Writes to a file from multiple buffers.
+	 */
+	EXTERN ssize_t sys_writev(int fd, const struct iovec *iov, int iovcnt);
+
+	/*
+	 * Transfers data between files.
+	 */
+	EXTERN ssize_t sys_sendfile(int out_fd, int in_fd, off_t *offset, size_t count);
+
+	/*
+	 * Moves data between files.
+	 */
+	EXTERN ssize_t sys_splice(const struct splice_args *args);
+
 #endif /* _ASM_FILE_ */
 
 #endif /* NANVIX_SYSCALL_H_ */
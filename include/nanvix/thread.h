@@ -121,12 +121,36 @@
 	/**@{*/
 	#define THRD_STACK_SIZE PGTAB_SIZE /**< Thread stack size. */
 
+	/**
+	 * @brief Maximum size of a stack that is not the main one.
+	 *
+	 * @details The lowest page of a thread stack slot is left as a guard.
+	 */
+	#define THRD_STACK_MAX (THRD_STACK_SIZE - PAGE_SIZE)
+
+	/**
+	 * @brief Number of thread stack slots (main thread included).
+	 */
+	#define NR_TSTACKS (THRD_MAX_PER_PROC + 1)
+
+	/**
+	 * @brief Start address of a thread stack slot.
+	 */
+	#define TSTACK_ADDR(i) (USTACK_ADDR - 1 - (i)*THRD_STACK_SIZE)
+
+	/**
+	 * @brief Thread stack slot of a start address.
+	 */
+	#define TSTACK_SLOT(a) ((USTACK_ADDR - 1 - (a))/THRD_STACK_SIZE)
+
 	#if THRD_MAX_PER_PROC > THRD_MAX
         #error "THRD_MAX_PER_PROC should not exceed THRD_MAX"
     #elif THRD_MAX_PER_PROC > REGION_SIZE_CPP/THRD_STACK_SIZE
         #error "THRD_MAX_PER_PROC should not exceed REGION_SIZE/THRD_STACK_SIZE"
     #elif THRD_MAX > (REGION_SIZE_CPP/THRD_STACK_SIZE*PROC_MAX)
         #error "THRD_MAX should not exceed REGION_SIZE/THRD_STACK_SIZE*PROC_MAX"
+    #elif THRD_MAX_PER_PROC >= 32
+        #error "THRD_MAX_PER_PROC should be less than 32"
     #endif
 	/**@}*/
 
@@ -159,7 +183,8 @@
 		/**@{*/
 		/* TODO : keep in process memory regions,
 		 * but divide the space between threads   */
-		struct pregion pregs; /**< Thread stack memory regions. */
+		struct pregion pregs;    /**< Thread stack memory regions. */
+		struct pregion *lastreg; /**< Last region found.           */
 		/**@}*/
 
 		/**
@@ -189,6 +214,9 @@
 	EXTERN void thread_init(void);
 	EXTERN struct thread *get_free_thread();
 	EXTERN int clear_thread(struct thread *thrd);
+	EXTERN addr_t tstack_alloc(struct thread *, size_t);
+	EXTERN void tstack_free(struct process *, struct thread *);
+	EXTERN void tstack_flush(struct process *);
 
 	/* Forward definitions. */
 	EXTERN struct thread threadtab[THRD_MAX];
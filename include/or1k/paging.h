@@ -34,6 +34,11 @@
 	#define PT_SIZE    4096               /* Page table size.           */
 	#define PT_SHIFT   10                 /* Page table shift.          */
 
+	/* Large pages are not supported. */
+	#define PAGING_LARGE 0
+	#define LPAGE_SIZE   PGTAB_SIZE /* Large page size. */
+	#define LPAGE_MASK   PGTAB_MASK /* Large page mask. */
+
 	/* Page table entry constants. */
 	#define PT_CC  0x1         /* Cache Coherency.       */
 	#define PT_CI  0x2         /* Cache Inhibit.         */
@@ -202,6 +207,33 @@
 		return (pde->ppi & (PT_PPI_USR_RD >> PT_PPI_OFFSET));
 	}
 
+	/**
+	 * @brief Sets/clears the page size bit of a page table directory entry.
+	 *
+	 * @details Large pages are not supported, so this is a no-op.
+	 *
+	 * @param pde Target page table directory entry.
+	 * @param set Set bit?
+	 */
+	static inline void pde_large_set(struct pde *pde, int set)
+	{
+		((void) pde);
+		((void) set);
+	}
+
+	/**
+	 * @brief Asserts if a page table directory entry maps a large page.
+	 *
+	 * @param pde Target page table directory entry.
+	 *
+	 * @returns Always zero, since large pages are not supported.
+	 */
+	static inline int pde_is_large(struct pde *pde)
+	{
+		((void) pde);
+		return (0);
+	}
+
 	/**
 	 * @brief Sets/clears the present bit of a page table entry.
 	 *
@@ -248,7 +280,7 @@
 	 */
 	static inline int pte_is_fill(struct pte *pte)
 	{
-		return (pte->fill);
+		return (pte->fill && !pte->zero);
 	}
 
 	/**
@@ -273,7 +305,60 @@
 	 */
 	static inline int pte_is_zero(struct pte *pte)
 	{
-		return (pte->zero);
+		return (pte->zero && !pte->fill);
+	}
+
+	/**
+	 * @brief Sets/clears the swap bits of a page table entry.
+	 *
+	 * @details A swapped out page is a non-present page that has both
+	 * the demand fill and the demand zero bits set. The frame field
+	 * then holds the swap slot of the page.
+	 *
+	 * @param pte Target page table entry.
+	 * @param set Set bits?
+	 */
+	static inline void pte_swap_set(struct pte *pte, int set)
+	{
+		pte->fill = (set) ? 1 : 0;
+		pte->zero = (set) ? 1 : 0;
+	}
+
+	/**
+	 * @brief Asserts if a page table entry refers to a swapped out page.
+	 *
+	 * @param pte Target page table entry.
+	 *
+	 * @returns Non zero if the target page table entry refers to a
+	 * swapped out page, and false otherwise.
+	 */
+	static inline int pte_is_swap(struct pte *pte)
+	{
+		return (pte->fill && pte->zero);
+	}
+
+	/**
+	 * @brief Sets/clears the accessed bit of a page table entry.
+	 *
+	 * @param pte Target page table entry.
+	 * @param set Set bit?
+	 */
+	static inline void pte_accessed_set(struct pte *pte, int set)
+	{
+		pte->accessed = (set) ? 1 : 0;
+	}
+
+	/**
+	 * @brief Asserts if the accessed bit of a page table entry is set.
+	 *
+	 * @param pte Target page table entry.
+	 *
+	 * @returns Non zero if the accessed bit of the target page table
+	 * entry is set, and false otherwise.
+	 */
+	static inline int pte_is_accessed(struct pte *pte)
+	{
+		return (pte->accessed);
 	}
 
 	/**
@@ -0,0 +1,57 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SYS_MMAN_H_
+#define SYS_MMAN_H_
+
+	/* Protection options. */
+	#define PROT_NONE  0x0 /* Page cannot be accessed. */
+	#define PROT_READ  0x1 /* Page can be read.        */
+	#define PROT_WRITE 0x2 /* Page can be written.     */
+	#define PROT_EXEC  0x4 /* Page can be executed.    */
+
+	/* Mapping flags. */
+	#define MAP_SHARED    0x01 /* Share changes.          */
+	#define MAP_PRIVATE   0x02 /* Changes are private.    */
+	#define MAP_FIXED     0x10 /* Interpret addr exactly. */
+	#define MAP_ANONYMOUS 0x20 /* Not backed by a file.   */
+	#define MAP_ANON      MAP_ANONYMOUS
+	#define MAP_LARGE     0x40 /* Use large pages.        */
+
+	/* msync() flags. */
+	#define MS_ASYNC      0x1 /* Perform asynchronous writes. */
+	#define MS_INVALIDATE 0x2 /* Invalidate mappings.         */
+	#define MS_SYNC       0x4 /* Perform synchronous writes.  */
+
+	/* Failed mapping. */
+	#define MAP_FAILED ((void *) -1)
+
+#ifndef _ASM_FILE_
+
+	#include <sys/types.h>
+
+	/* Forward definitions. */
+	extern void *mmap(void *, size_t, int, int, int, off_t);
+	extern int munmap(void *, size_t);
+	extern int mprotect(void *, size_t, int);
+	extern int msync(void *, size_t, int);
+
+#endif /* _ASM_FILE_ */
+
+#endif /* SYS_MMAN_H_ */
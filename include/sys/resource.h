@@ -71,6 +71,14 @@
 struct rusage {
   	struct timeval ru_utime;	/* user time used */
 	struct timeval ru_stime;	/* system time used */
+	long ru_maxrss;			/* maximum resident set size (KB) */
+	long ru_minflt;			/* page reclaims (minor faults) */
+	long ru_majflt;			/* page faults (major faults) */
+
+	/* Nanvix extensions. */
+	long ru_rss;			/* resident set size (KB) */
+	long ru_shrss;			/* shared resident memory (KB) */
+	long ru_cowflt;			/* pages copied on write */
 };
 
 int	_EXFUN(getrusage, (int, struct rusage*));
@@ -0,0 +1,38 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SYS_SENDFILE_H_
+#define SYS_SENDFILE_H_
+
+	/* splice() flags. */
+	#define SPLICE_F_MOVE 0x1 /* Move pages instead of copying. */
+	#define SPLICE_F_MORE 0x4 /* More data will follow.         */
+
+#ifndef _ASM_FILE_
+
+	#include <sys/types.h>
+
+	/* Forward definitions. */
+	extern ssize_t sendfile(int, int, off_t *, size_t);
+	extern ssize_t splice(int, off_t *, int, off_t *, size_t, unsigned);
+
+#endif /* _ASM_FILE_ */
+
+#endif /* SYS_SENDFILE_H_ */
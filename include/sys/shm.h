@@ -0,0 +1,69 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SYS_SHM_H_
+#define SYS_SHM_H_
+
+	#include <sys/ipc.h>
+
+	/* Attach flags. */
+	#define SHM_RDONLY 0010000 /* Attach read-only.             */
+	#define SHM_RND    0020000 /* Round attach address to SHMLBA. */
+
+	/**
+	 * @brief Segment low boundary address multiple.
+	 *
+	 * @details Segments are attached at page table boundaries, which are
+	 *          at most 16 MB apart in the supported architectures.
+	 */
+	#define SHMLBA 0x1000000
+
+#ifndef _ASM_FILE_
+
+	#include <sys/types.h>
+
+	/**
+	 * @brief Number of current attaches.
+	 */
+	typedef unsigned shmatt_t;
+
+	/**
+	 * @brief Shared memory segment information.
+	 */
+	struct shmid_ds
+	{
+		struct ipc_perm shm_perm; /**< Operation permission structure. */
+		size_t shm_segsz;         /**< Size of segment in bytes.       */
+		pid_t shm_lpid;           /**< Process ID of last operation.   */
+		pid_t shm_cpid;           /**< Process ID of creator.          */
+		shmatt_t shm_nattch;      /**< Number of current attaches.     */
+		time_t shm_atime;         /**< Time of last shmat().           */
+		time_t shm_dtime;         /**< Time of last shmdt().           */
+		time_t shm_ctime;         /**< Time of last change.            */
+	};
+
+	/* Forward definitions. */
+	extern void *shmat(int, const void *, int);
+	extern int shmctl(int, int, struct shmid_ds *);
+	extern int shmdt(const void *);
+	extern int shmget(key_t, size_t, int);
+
+#endif /* _ASM_FILE_ */
+
+#endif /* SYS_SHM_H_ */
@@ -46,7 +46,7 @@
 #define	MAX_INPUT		  255	/* max bytes in terminal input */
 #define	NGROUPS_MAX		   16	/* max supplemental group id's */
 #define	PIPE_BUF		  512	/* max bytes for atomic pipe writes */
-#define	IOV_MAX			 1024	/* max elements in i/o vector */
+#define	IOV_MAX			   16	/* max elements in i/o vector */
 
 #define	BC_BASE_MAX		   99	/* max ibase/obase values in bc(1) */
 #define	BC_DIM_MAX		 2048	/* max array elements in bc(1) */
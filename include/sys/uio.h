@@ -0,0 +1,39 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SYS_UIO_H_
+#define SYS_UIO_H_
+
+	#include <sys/types.h>
+
+	/**
+	 * @brief I/O vector element.
+	 */
+	struct iovec
+	{
+		void *iov_base; /**< Base address of a memory region. */
+		size_t iov_len; /**< Size of the memory region.       */
+	};
+
+	/* Forward definitions. */
+	extern ssize_t readv(int, const struct iovec *, int);
+	extern ssize_t writev(int, const struct iovec *, int);
+
+#endif /* SYS_UIO_H_ */
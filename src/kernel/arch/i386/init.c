@@ -18,7 +18,9 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <nanvix/config.h>
 #include <nanvix/klib.h>
+#include <nanvix/mm.h>
 #include <nanvix/syscall.h>
 
 /**
@@ -91,7 +93,7 @@ PRIVATE void _exit(int status)
 }
 
 /**
- * @brief Init process.
+ * @brief Spawns init process and kernel daemons.
  */
 PUBLIC void init(void)
 {
@@ -115,4 +117,20 @@ PUBLIC void init(void)
 			_exit(-1);	
 		}
 	}
+
+	/* Spawn page-out daemon. */
+	if ((pid = fork()) < 0)
+		kpanic("failed to fork idle process");
+	else if (pid == 0)
+		kswapd();
+
+#if (KSM_ENABLE == 1)
+
+	/* Spawn same-page merging daemon. */
+	if ((pid = fork()) < 0)
+		kpanic("failed to fork idle process");
+	else if (pid == 0)
+		ksmd();
+
+#endif
 }
@@ -83,13 +83,15 @@ EXCEPTION(reserved,            SIGSEGV, "reserved exception")
  */
 PUBLIC void do_page_fault(addr_t addr, int err, int dummy0, int dummy1, struct intstack s)
 {	
+	addr_t fixup; /* Fixup code. */
+
 	((void)dummy0);
 	((void)dummy1);
 	
 	/* Validity page fault. */
 	if (!(err & 1))
 	{
-		if (!vfault(addr))
+		if (!vfault(addr, err & 2))
 			return;
 	}
 	
@@ -102,6 +104,17 @@ PUBLIC void do_page_fault(addr_t addr, int err, int dummy0, int dummy1, struct i
 	
 	if (KERNEL_WAS_RUNNING(cpus[curr_core].curr_thread))
 	{
+		/*
+		 * Bad user address accessed on behalf of the kernel. The
+		 * interrupt stack frame is written through a volatile pointer,
+		 * so that the store is not optimized away.
+		 */
+		if ((fixup = extable_search(s.epcr)) != 0)
+		{
+			((volatile struct intstack *)&s)->epcr = fixup;
+			return;
+		}
+
 		dumpregs(&s);
 		kpanic("kernel page fault %d at %x", err, addr);
 	}
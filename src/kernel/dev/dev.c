@@ -25,6 +25,7 @@
 #include <dev/cmos.h>
 #include <dev/ramdisk.h>
 #include <dev/8250.h>
+#include <dev/zram.h>
 #include <nanvix/const.h>
 #include <nanvix/dev.h>
 #include <nanvix/klib.h>
@@ -273,14 +274,15 @@ PUBLIC void cdev_test(void)
  *============================================================================*/
 
 /* Number of block devices. */
-#define NR_BLKDEV 2
+#define NR_BLKDEV 3
 
 /*
  * Block devices table.
  */
 PRIVATE const struct bdev *bdevsw[NR_BLKDEV] = {
 	NULL, /* /dev/ramdisk */
-	NULL  /* /dev/hdd     */
+	NULL, /* /dev/hdd     */
+	NULL  /* /dev/zram    */
 };
 
 /**
@@ -500,6 +502,7 @@ PUBLIC void dev_init(void)
 	clock_init(CLOCK_FREQ);
 	tty_init();
 	ramdisk_init();
+	zram_init();
 	dbg_register(cdev_test, "cdev_test");
 	dbg_register(bdev_test, "bdev_test");
 	smp_init();
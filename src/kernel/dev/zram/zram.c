@@ -0,0 +1,684 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <dev/zram.h>
+#include <nanvix/config.h>
+#include <nanvix/const.h>
+#include <nanvix/dev.h>
+#include <nanvix/fs.h>
+#include <nanvix/hal.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <sys/types.h>
+#include <stdint.h>
+#include <errno.h>
+
+/**
+ * @brief Number of pages in the compressed RAM disk.
+ */
+#define ZRAM_PAGES (ZRAM_SIZE/PAGE_SIZE)
+
+/**
+ * @brief Size of a memory chunk (in bytes).
+ */
+#define ZRAM_CHUNK_SIZE 64
+
+/**
+ * @brief Number of memory chunks.
+ */
+#define ZRAM_CHUNKS (ZRAM_POOL_SIZE/ZRAM_CHUNK_SIZE)
+
+/**
+ * @name LZ Codec Parameters
+ */
+/**@{*/
+#define LZ_HASHTAB_SIZE 1024 /**< Hash table size.             */
+#define LZ_HASH_SHIFT     22 /**< Hash shift (32 - log2 size). */
+#define LZ_MINMATCH        4 /**< Minimum match length.        */
+/**@}*/
+
+#if (ZRAM_CHUNKS & 0x1f)
+	#error "ZRAM_POOL_SIZE should be a multiple of 32 chunks"
+#endif
+
+/**
+ * @brief Memory where compressed pages are stored.
+ */
+PRIVATE unsigned char pool[ZRAM_POOL_SIZE];
+
+/**
+ * @brief Map of memory chunks in use.
+ */
+PRIVATE uint32_t chunkmap[ZRAM_CHUNKS/32];
+
+/**
+ * @brief Next memory chunk to be looked at.
+ */
+PRIVATE unsigned next_chunk = 0;
+
+/**
+ * @brief Compressed pages.
+ *
+ * @details Pages of size zero are filled with zeros, and need no memory.
+ *          Pages that do not compress are stored as they are.
+ */
+PRIVATE struct
+{
+	unsigned chunk;      /**< First memory chunk.         */
+	unsigned short size; /**< Size of compressed page.    */
+} zpages[ZRAM_PAGES];
+
+/**
+ * @brief Buffer for pages that are partially written.
+ */
+PRIVATE unsigned char zbuf[PAGE_SIZE];
+
+/**
+ * @brief Buffer for compressed pages.
+ */
+PRIVATE unsigned char cbuf[PAGE_SIZE];
+
+/**
+ * @brief Hash table of the LZ compressor.
+ *
+ * @details Positions are stored plus one, so that zero means empty.
+ */
+PRIVATE unsigned short lz_hashtab[LZ_HASHTAB_SIZE];
+
+/*============================================================================*
+ *                                 LZ Codec                                   *
+ *============================================================================*/
+
+/*
+ * The compressed format is a sequence of tokens, in the style of LZ4. Each
+ * token is a byte with the number of literals in its high nibble and the
+ * match length minus #LZ_MINMATCH in its low nibble. A nibble of 15 is
+ * followed by extra length bytes, which are added up until one of them is
+ * not 255. Then come the literals and a two byte little-endian offset back
+ * to the match. The last token has literals only.
+ */
+
+/**
+ * @brief Reads four bytes.
+ *
+ * @param p Target bytes.
+ *
+ * @returns The bytes pointed to by @p p, as a 32-bit number.
+ */
+PRIVATE inline uint32_t lz_read32(const unsigned char *p)
+{
+	return (p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24));
+}
+
+/**
+ * @brief Writes a length in extra length bytes.
+ *
+ * @param dst Output buffer.
+ * @param op  Output position.
+ * @param len Length.
+ *
+ * @returns The new output position.
+ */
+PRIVATE size_t lz_putlen(unsigned char *dst, size_t op, size_t len)
+{
+	for (/* noop */; len >= 255; len -= 255)
+		dst[op++] = 255;
+	dst[op++] = len;
+
+	return (op);
+}
+
+/**
+ * @brief Writes a token.
+ *
+ * @param dst  Output buffer.
+ * @param op   Output position.
+ * @param max  Output buffer size.
+ * @param lit  Literals.
+ * @param nlit Number of literals.
+ * @param off  Match offset.
+ * @param len  Match length (zero for the last token).
+ *
+ * @returns The new output position upon successful completion, and zero if
+ *          the output buffer is too small.
+ */
+PRIVATE size_t lz_token(unsigned char *dst, size_t op, size_t max,
+	const unsigned char *lit, size_t nlit, size_t off, size_t len)
+{
+	size_t mlen; /* Encoded match length. */
+
+	mlen = (len > 0) ? len - LZ_MINMATCH : 0;
+
+	/* Output buffer is too small. */
+	if (op + 1 + nlit/255 + 1 + nlit + 2 + mlen/255 + 1 > max)
+		return (0);
+
+	dst[op++] = (((nlit < 15) ? nlit : 15) << 4) | ((mlen < 15) ? mlen : 15);
+
+	if (nlit >= 15)
+		op = lz_putlen(dst, op, nlit - 15);
+	kmemcpy(&dst[op], lit, nlit);
+	op += nlit;
+
+	/* Last token. */
+	if (len == 0)
+		return (op);
+
+	dst[op++] = off & 0xff;
+	dst[op++] = (off >> 8) & 0xff;
+
+	if (mlen >= 15)
+		op = lz_putlen(dst, op, mlen - 15);
+
+	return (op);
+}
+
+/**
+ * @brief Compresses data.
+ *
+ * @param src Data to be compressed.
+ * @param n   Size of data (at most one page).
+ * @param dst Output buffer.
+ * @param max Output buffer size.
+ *
+ * @returns The size of compressed data upon successful completion, and zero
+ *          if it does not fit in the output buffer.
+ */
+PRIVATE size_t lz_compress(const unsigned char *src, size_t n,
+	unsigned char *dst, size_t max)
+{
+	size_t i;      /* Input position.   */
+	size_t op;     /* Output position.  */
+	size_t anchor; /* First literal.    */
+	size_t ref;    /* Match position.   */
+	size_t len;    /* Match length.     */
+	uint32_t seq;  /* Working sequence. */
+	unsigned h;    /* Hash value.       */
+
+	kmemset(lz_hashtab, 0, sizeof(lz_hashtab));
+
+	i = 0;
+	op = 0;
+	anchor = 0;
+
+	while (i + LZ_MINMATCH <= n)
+	{
+		seq = lz_read32(&src[i]);
+		h = (seq*2654435761u) >> LZ_HASH_SHIFT;
+		ref = lz_hashtab[h];
+		lz_hashtab[h] = i + 1;
+
+		/* No match. */
+		if ((ref-- == 0) || (lz_read32(&src[ref]) != seq))
+		{
+			i++;
+			continue;
+		}
+
+		/* Extend match. */
+		for (len = LZ_MINMATCH; i + len < n; len++)
+		{
+			if (src[ref + len] != src[i + len])
+				break;
+		}
+
+		op = lz_token(dst, op, max, &src[anchor], i - anchor, i - ref, len);
+		if (op == 0)
+			return (0);
+
+		i += len;
+		anchor = i;
+	}
+
+	return (lz_token(dst, op, max, &src[anchor], n - anchor, 0, 0));
+}
+
+/**
+ * @brief Reads extra length bytes.
+ *
+ * @param src Input buffer.
+ * @param ip  Input position.
+ * @param n   Input buffer size.
+ * @param len Length to be updated.
+ *
+ * @returns The new input position upon successful completion, and zero if
+ *          input is corrupted.
+ */
+PRIVATE size_t lz_getlen(const unsigned char *src, size_t ip, size_t n,
+	size_t *len)
+{
+	unsigned char b;
+
+	do
+	{
+		if (ip >= n)
+			return (0);
+		b = src[ip++];
+		*len += b;
+	} while (b == 255);
+
+	return (ip);
+}
+
+/**
+ * @brief Decompresses data.
+ *
+ * @param src Compressed data.
+ * @param n   Size of compressed data.
+ * @param dst Output buffer.
+ * @param max Size of decompressed data.
+ *
+ * @returns Zero upon successful completion, and non-zero if compressed data
+ *          is corrupted.
+ */
+PRIVATE int lz_decompress(const unsigned char *src, size_t n,
+	unsigned char *dst, size_t max)
+{
+	size_t ip;    /* Input position.  */
+	size_t op;    /* Output position. */
+	size_t len;   /* Length.          */
+	size_t off;   /* Match offset.    */
+	unsigned tok; /* Token.           */
+
+	ip = 0;
+	op = 0;
+
+	while (ip < n)
+	{
+		tok = src[ip++];
+
+		/* Copy literals. */
+		len = tok >> 4;
+		if ((len == 15) && ((ip = lz_getlen(src, ip, n, &len)) == 0))
+			return (-1);
+		if ((ip + len > n) || (op + len > max))
+			return (-1);
+		kmemcpy(&dst[op], &src[ip], len);
+		ip += len;
+		op += len;
+
+		/* Last token. */
+		if (ip == n)
+			break;
+
+		if (ip + 2 > n)
+			return (-1);
+		off = src[ip] | (src[ip + 1] << 8);
+		ip += 2;
+
+		len = tok & 0xf;
+		if ((len == 15) && ((ip = lz_getlen(src, ip, n, &len)) == 0))
+			return (-1);
+		len += LZ_MINMATCH;
+
+		if ((off == 0) || (off > op) || (op + len > max))
+			return (-1);
+
+		/* Copy match, which may overlap. */
+		for (/* noop */; len > 0; len--, op++)
+			dst[op] = dst[op - off];
+	}
+
+	return ((op == max) ? 0 : -1);
+}
+
+/*============================================================================*
+ *                             Memory Chunks                                  *
+ *============================================================================*/
+
+/**
+ * @brief Allocates contiguous memory chunks.
+ *
+ * @param n Number of memory chunks.
+ *
+ * @returns The first allocated memory chunk upon successful completion, and
+ *          a negative number upon failure.
+ */
+PRIVATE int chunk_alloc(unsigned n)
+{
+	unsigned i;     /* Working chunk.      */
+	unsigned run;   /* Free chunks in run. */
+	unsigned start; /* First chunk in run. */
+
+	run = 0;
+	start = 0;
+
+	/* Next fit. */
+	for (unsigned k = 0; k < ZRAM_CHUNKS; k++)
+	{
+		i = (next_chunk + k)%ZRAM_CHUNKS;
+
+		/* Runs do not wrap around. */
+		if (i == 0)
+			run = 0;
+
+		/* Skip full words. */
+		if ((OFF(i) == 0) && (chunkmap[IDX(i)] == BITMAP_FULL))
+		{
+			k += 31;
+			run = 0;
+			continue;
+		}
+
+		/* Chunk in use. */
+		if (chunkmap[IDX(i)] & (1 << OFF(i)))
+		{
+			run = 0;
+			continue;
+		}
+
+		if (run++ == 0)
+			start = i;
+
+		/* Found. */
+		if (run == n)
+		{
+			for (i = start; i < start + n; i++)
+				bitmap_set(chunkmap, i);
+			next_chunk = (start + n)%ZRAM_CHUNKS;
+
+			return (start);
+		}
+	}
+
+	return (-1);
+}
+
+/**
+ * @brief Frees contiguous memory chunks.
+ *
+ * @param start First memory chunk.
+ * @param n     Number of memory chunks.
+ */
+PRIVATE void chunk_free(unsigned start, unsigned n)
+{
+	for (unsigned i = start; i < start + n; i++)
+		bitmap_clear(chunkmap, i);
+}
+
+/*============================================================================*
+ *                                 Pages                                      *
+ *============================================================================*/
+
+/**
+ * @brief Number of memory chunks that hold a compressed page.
+ *
+ * @param size Size of compressed page.
+ */
+#define NCHUNKS(size) (((size) + ZRAM_CHUNK_SIZE - 1)/ZRAM_CHUNK_SIZE)
+
+/**
+ * @brief Loads a page.
+ *
+ * @param pg   Target page.
+ * @param page Where the page should be decompressed.
+ *
+ * @returns Zero upon successful completion, and non-zero otherwise.
+ */
+PRIVATE int zram_load(unsigned pg, void *page)
+{
+	unsigned char *p;
+
+	p = &pool[zpages[pg].chunk*ZRAM_CHUNK_SIZE];
+
+	/* Zero page. */
+	if (zpages[pg].size == 0)
+		kmemset(page, 0, PAGE_SIZE);
+
+	/* Uncompressed page. */
+	else if (zpages[pg].size == PAGE_SIZE)
+		kmemcpy(page, p, PAGE_SIZE);
+
+	else if (lz_decompress(p, zpages[pg].size, page, PAGE_SIZE))
+	{
+		kprintf("zram: corrupted page %d", pg);
+		return (-1);
+	}
+
+	return (0);
+}
+
+/**
+ * @brief Stores a page.
+ *
+ * @param pg   Target page.
+ * @param page Page contents.
+ *
+ * @returns Zero upon successful completion, and a negative error code
+ *          otherwise. In the later case, the old contents of the page are
+ *          kept.
+ */
+PRIVATE int zram_store(unsigned pg, const void *page)
+{
+	int chunk;              /* First memory chunk. */
+	size_t size;            /* Compressed size.    */
+	const unsigned char *p; /* Compressed page.    */
+
+	p = page;
+
+	/* Zero page. */
+	for (size = 0; size < PAGE_SIZE; size++)
+	{
+		if (p[size] != 0)
+			break;
+	}
+	if (size == PAGE_SIZE)
+	{
+		size = 0;
+		chunk = 0;
+	}
+
+	else
+	{
+		/* Store uncompressed pages that would not save a memory chunk. */
+		size = lz_compress(page, PAGE_SIZE, cbuf, PAGE_SIZE - ZRAM_CHUNK_SIZE);
+		if (size == 0)
+			size = PAGE_SIZE;
+		else
+			p = cbuf;
+
+		/* Old page is kept until the new one is stored. */
+		if ((chunk = chunk_alloc(NCHUNKS(size))) < 0)
+			return (-ENOSPC);
+
+		kmemcpy(&pool[chunk*ZRAM_CHUNK_SIZE], p, size);
+	}
+
+	/* Release old page. */
+	if (zpages[pg].size != 0)
+		chunk_free(zpages[pg].chunk, NCHUNKS(zpages[pg].size));
+
+	zpages[pg].chunk = chunk;
+	zpages[pg].size = size;
+
+	return (0);
+}
+
+/*============================================================================*
+ *                             Device Driver                                  *
+ *============================================================================*/
+
+/**
+ * @brief Writes to the compressed RAM disk.
+ *
+ * @param minor Minor device number.
+ * @param buf   Data to be written.
+ * @param n     Number of bytes to write.
+ * @param off   Device offset.
+ *
+ * @returns The number of bytes written upon successful completion, and a
+ *          negative error code otherwise. If some pages were written before
+ *          an error, the number of bytes written so far is returned.
+ */
+PRIVATE ssize_t zram_write(unsigned minor, const char *buf, size_t n, off_t off)
+{
+	int err;          /* Error code.     */
+	size_t pgoff;     /* Page offset.    */
+	size_t count;     /* Bytes to write. */
+	const void *page; /* Working page.   */
+
+	/* Invalid device. */
+	if (minor != 0)
+		return (-EINVAL);
+
+	/* Invalid offset. */
+	if ((off < 0) || (off >= ZRAM_SIZE))
+		return (-EINVAL);
+
+	/* Write as much as possible. */
+	if (off + n > ZRAM_SIZE)
+		n = ZRAM_SIZE - off;
+
+	for (size_t i = 0; i < n; i += count)
+	{
+		pgoff = (off + i) & ~PAGE_MASK;
+		count = ((n - i) < PAGE_SIZE - pgoff) ? (n - i) : PAGE_SIZE - pgoff;
+
+		page = &buf[i];
+
+		/* Partial write. */
+		if (count < PAGE_SIZE)
+		{
+			if (zram_load((off + i) >> PAGE_SHIFT, zbuf))
+				return ((i > 0) ? (ssize_t)i : -EIO);
+			kmemcpy(&zbuf[pgoff], &buf[i], count);
+			page = zbuf;
+		}
+
+		if ((err = zram_store((off + i) >> PAGE_SHIFT, page)) < 0)
+			return ((i > 0) ? (ssize_t)i : err);
+	}
+
+	return ((ssize_t)n);
+}
+
+/**
+ * @brief Reads from the compressed RAM disk.
+ *
+ * @param minor Minor device number.
+ * @param buf   Buffer where data should be placed.
+ * @param n     Number of bytes to read.
+ * @param off   Device offset.
+ *
+ * @returns The number of bytes read upon successful completion, and a
+ *          negative error code otherwise.
+ */
+PRIVATE ssize_t zram_read(unsigned minor, char *buf, size_t n, off_t off)
+{
+	size_t pgoff; /* Page offset.   */
+	size_t count; /* Bytes to read. */
+
+	/* Invalid device. */
+	if (minor != 0)
+		return (-EINVAL);
+
+	/* Invalid offset. */
+	if ((off < 0) || (off >= ZRAM_SIZE))
+		return (-EINVAL);
+
+	/* Read as much as possible. */
+	if (off + n > ZRAM_SIZE)
+		n = ZRAM_SIZE - off;
+
+	for (size_t i = 0; i < n; i += count)
+	{
+		pgoff = (off + i) & ~PAGE_MASK;
+		count = ((n - i) < PAGE_SIZE - pgoff) ? (n - i) : PAGE_SIZE - pgoff;
+
+		/* Whole page. */
+		if (count == PAGE_SIZE)
+		{
+			if (zram_load((off + i) >> PAGE_SHIFT, &buf[i]))
+				return (-EIO);
+			continue;
+		}
+
+		if (zram_load((off + i) >> PAGE_SHIFT, zbuf))
+			return (-EIO);
+		kmemcpy(&buf[i], &zbuf[pgoff], count);
+	}
+
+	return ((ssize_t)n);
+}
+
+/**
+ * @brief Reads a block from the compressed RAM disk.
+ *
+ * @param minor Minor device number.
+ * @param buf   Target block buffer.
+ *
+ * @returns Zero upon successful completion, and non-zero otherwise.
+ */
+PRIVATE int zram_readblk(unsigned minor, buffer_t buf)
+{
+	off_t off;
+
+	off = buffer_num(buf) << BLOCK_SIZE_LOG2;
+
+	if (zram_read(minor, buffer_data(buf), BLOCK_SIZE, off) != BLOCK_SIZE)
+		return (-EIO);
+
+	return (0);
+}
+
+/**
+ * @brief Writes a block to the compressed RAM disk.
+ *
+ * @param minor Minor device number.
+ * @param buf   Target block buffer.
+ *
+ * @returns Zero upon successful completion, and non-zero otherwise.
+ */
+PRIVATE int zram_writeblk(unsigned minor, buffer_t buf)
+{
+	off_t off;
+	ssize_t n;
+
+	off = buffer_num(buf) << BLOCK_SIZE_LOG2;
+	n = zram_write(minor, buffer_data(buf), BLOCK_SIZE, off);
+
+	buffer_dirty(buf, 0);
+	brelse(buf);
+
+	return ((n == BLOCK_SIZE) ? 0 : -EIO);
+}
+
+/**
+ * @brief Compressed RAM disk device driver interface.
+ */
+PRIVATE const struct bdev zram_driver = {
+	&zram_read,     /* read()     */
+	&zram_write,    /* write()    */
+	&zram_readblk,  /* readblk()  */
+	&zram_writeblk  /* writeblk() */
+};
+
+/**
+ * @brief Initializes the compressed RAM disk device driver.
+ */
+PUBLIC void zram_init(void)
+{
+	kprintf("dev: initializing zram device driver");
+
+	if (bdev_register(ZRAM_MAJOR, &zram_driver))
+		kpanic("failed to register zram device driver");
+
+	kprintf("zram: %d KB disk in %d KB of memory",
+		ZRAM_SIZE/1024, ZRAM_POOL_SIZE/1024);
+}
@@ -78,7 +78,7 @@ struct buffer
 	 */
 	/**@{*/
 	dev_t dev;      /**< Device.          */
-	block_t num;    /**< Block number.    */
+	blkno_t num;    /**< Block number.    */
 	void *data;     /**< Underlying data. */
 	unsigned count; /**< Reference count. */
 	/**@}*/
@@ -187,7 +187,7 @@ PUBLIC inline dev_t buffer_dev(const struct buffer *buf)
  * 
  * @note The buffer must be locked.
  */
-PUBLIC inline block_t buffer_num(const struct buffer *buf)
+PUBLIC inline blkno_t buffer_num(const struct buffer *buf)
 {
 	return (buf->num);
 }
@@ -246,7 +246,7 @@ PUBLIC void buffer_share(struct buffer *buf)
  * ensured to be locked, and may be, or may be not, valid.  Upon
  * failure, a null pointer NULL is returned instead.
  */
-PRIVATE struct buffer *getblk(dev_t dev, block_t num)
+PRIVATE struct buffer *getblk(dev_t dev, blkno_t num)
 {
 	unsigned i;          /* Hash table index. */
 	struct buffer *buf;  /* Buffer.           */
@@ -454,7 +454,7 @@ PUBLIC void brelse(struct buffer *buf)
  * @note The device number should be valid.
  * @note The block number should be valid.
  */
-PUBLIC struct buffer *bread(dev_t dev, block_t num)
+PUBLIC struct buffer *bread(dev_t dev, blkno_t num)
 {
 	struct buffer *buf;
 	
@@ -473,6 +473,38 @@ PUBLIC struct buffer *bread(dev_t dev, block_t num)
 	return (buf);
 }
 
+/**
+ * @brief Gets a cleared block buffer.
+ * 
+ * @details Gets a block buffer for the block numbered num of the device
+ *          numbered dev and fills it with zeros, without reading the block
+ *          from the device. This is intended for blocks that are about to be
+ *          entirely overwritten, such as freshly allocated ones.
+ * 
+ * @param dev Device number.
+ * @param num Block number.
+ * 
+ * @returns A pointer to a buffer holding the cleared block is returned. In
+ *          this case, the block buffer is ensured to be locked, valid and
+ *          dirty.
+ * 
+ * @note The device number should be valid.
+ * @note The block number should be valid.
+ */
+PUBLIC struct buffer *bnew(dev_t dev, blkno_t num)
+{
+	struct buffer *buf;
+	
+	buf = getblk(dev, num);
+	
+	kmemset(buf->data, 0, BLOCK_SIZE);
+	
+	/* Update buffer flags. */
+	buf->flags |= BUFFER_VALID | BUFFER_DIRTY;
+	
+	return (buf);
+}
+
 /**
  * @brief Writes a block buffer to the underlying device.
  * 
@@ -0,0 +1,320 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ *
+ * @brief Directory entry cache.
+ *
+ * @details The directory entry cache maps a (directory, file name) pair
+ *          to an inode number, so that resolving a path name does not scan
+ *          the blocks of every directory along the way. Negative entries
+ *          record names that are known not to exist in a directory.
+ */
+
+#include <nanvix/config.h>
+#include <nanvix/const.h>
+#include <nanvix/fs.h>
+#include <nanvix/klib.h>
+#include <limits.h>
+#include "fs.h"
+
+/**
+ * @brief Hash table size of the directory entry cache.
+ */
+#define DCACHE_HASHTAB_SIZE 127
+
+/**
+ * @brief Cached directory entry.
+ */
+struct dentry
+{
+	/**
+	 * @name General information
+	 */
+	/**@{*/
+	dev_t dev;               /**< Device.                  */
+	ino_t dir;               /**< Directory inode number.  */
+	ino_t num;               /**< Inode number, if any.    */
+	char name[NAME_MAX + 1]; /**< File name.               */
+	/**@}*/
+
+	/**
+	 * @name Cache information.
+	 */
+	/**@{*/
+	struct dentry *lru_next;  /**< Next entry in the LRU list.       */
+	struct dentry *lru_prev;  /**< Previous entry in the LRU list.   */
+	struct dentry *hash_next; /**< Next entry in the hash table.     */
+	struct dentry *hash_prev; /**< Previous entry in the hash table. */
+	/**@}*/
+};
+
+/**
+ * @brief Cached directory entries.
+ */
+PRIVATE struct dentry dentries[NR_DENTRIES];
+
+/**
+ * @brief List of free cache entries.
+ */
+PRIVATE struct dentry *free_dentries = NULL;
+
+/**
+ * @brief LRU list of cached directory entries.
+ *
+ * @details Most recently used entries are kept at the head of the list.
+ */
+PRIVATE struct dentry lru;
+
+/**
+ * @brief Directory entry cache hash table.
+ */
+PRIVATE struct dentry hashtab[DCACHE_HASHTAB_SIZE];
+
+/**
+ * @brief Hashes a directory entry.
+ *
+ * @param dev  Device number.
+ * @param dir  Directory inode number.
+ * @param name File name.
+ *
+ * @returns The hash table slot of the directory entry.
+ */
+PRIVATE unsigned dcache_hash(dev_t dev, ino_t dir, const char *name)
+{
+	unsigned h;
+
+	h = dev ^ dir;
+	for (int i = 0; (i < NAME_MAX) && (name[i] != '\0'); i++)
+		h = (h << 5) + h + (unsigned char) name[i];
+
+	return (h%DCACHE_HASHTAB_SIZE);
+}
+
+/**
+ * @brief Initializes the directory entry cache.
+ */
+PUBLIC void dcache_init(void)
+{
+	kprintf("fs: initializing directory entry cache");
+
+	lru.lru_next = &lru;
+	lru.lru_prev = &lru;
+
+	for (unsigned i = 0; i < DCACHE_HASHTAB_SIZE; i++)
+	{
+		hashtab[i].hash_next = &hashtab[i];
+		hashtab[i].hash_prev = &hashtab[i];
+	}
+
+	for (unsigned i = 0; i < NR_DENTRIES; i++)
+		dentries[i].lru_next = (i + 1 < NR_DENTRIES) ? &dentries[i + 1] : NULL;
+	free_dentries = &dentries[0];
+}
+
+/**
+ * @brief Removes an entry from the directory entry cache.
+ *
+ * @param d Target entry.
+ */
+PRIVATE void dcache_drop(struct dentry *d)
+{
+	/* Remove entry from the hash table. */
+	d->hash_prev->hash_next = d->hash_next;
+	d->hash_next->hash_prev = d->hash_prev;
+
+	/* Remove entry from the LRU list. */
+	d->lru_prev->lru_next = d->lru_next;
+	d->lru_next->lru_prev = d->lru_prev;
+
+	d->lru_next = free_dentries;
+	free_dentries = d;
+}
+
+/**
+ * @brief Searches for an entry in the directory entry cache.
+ *
+ * @param dip  Directory inode.
+ * @param name File name.
+ *
+ * @returns If the entry is cached, a pointer to it is returned. Otherwise, a
+ *          #NULL pointer is returned instead.
+ */
+PRIVATE struct dentry *dcache_search(struct inode *dip, const char *name)
+{
+	struct dentry *d;
+	struct dentry *head;
+
+	head = &hashtab[dcache_hash(dip->dev, dip->num, name)];
+
+	for (d = head->hash_next; d != head; d = d->hash_next)
+	{
+		if ((d->dev == dip->dev) && (d->dir == dip->num) &&
+			(!kstrncmp(d->name, name, NAME_MAX)))
+			return (d);
+	}
+
+	return (NULL);
+}
+
+/**
+ * @brief Looks up a directory entry.
+ *
+ * @details Searches the directory entry cache for the file named @p name in
+ *          the directory pointed to by @p dip.
+ *
+ * @param dip  Directory inode.
+ * @param name File name.
+ * @param num  Location where the inode number shall be stored.
+ *
+ * @returns Zero if the entry is cached, and non-zero otherwise. In the former
+ *          case, the inode number of the file, or #INODE_NULL if the file is
+ *          known not to exist, is stored in the location pointed to by
+ *          @p num.
+ *
+ * @note The directory inode must be locked.
+ */
+PUBLIC int dcache_lookup(struct inode *dip, const char *name, ino_t *num)
+{
+	struct dentry *d;
+
+	/* Cache miss. */
+	if ((d = dcache_search(dip, name)) == NULL)
+		return (-1);
+
+	/* Move entry to the head of the LRU list. */
+	d->lru_prev->lru_next = d->lru_next;
+	d->lru_next->lru_prev = d->lru_prev;
+	d->lru_next = lru.lru_next;
+	d->lru_prev = &lru;
+	lru.lru_next->lru_prev = d;
+	lru.lru_next = d;
+
+	*num = d->num;
+
+	return (0);
+}
+
+/**
+ * @brief Inserts a directory entry in the directory entry cache.
+ *
+ * @details Records that the file named @p name in the directory pointed to
+ *          by @p dip has inode number @p num. If @p num is #INODE_NULL, a
+ *          negative entry is recorded instead. The least recently used
+ *          entry is evicted if the cache is full.
+ *
+ * @param dip  Directory inode.
+ * @param name File name.
+ * @param num  Inode number.
+ *
+ * @note The directory inode must be locked.
+ */
+PUBLIC void dcache_enter(struct inode *dip, const char *name, ino_t num)
+{
+	unsigned i;       /* Hash table index. */
+	struct dentry *d; /* Working entry.    */
+
+	/* Update entry. */
+	if ((d = dcache_search(dip, name)) != NULL)
+	{
+		d->num = num;
+		return;
+	}
+
+	/* Evict least recently used entry. */
+	if (free_dentries == NULL)
+		dcache_drop(lru.lru_prev);
+
+	d = free_dentries;
+	free_dentries = d->lru_next;
+
+	d->dev = dip->dev;
+	d->dir = dip->num;
+	d->num = num;
+	kstrncpy(d->name, name, NAME_MAX);
+	d->name[NAME_MAX] = '\0';
+
+	/* Insert entry in the hash table. */
+	i = dcache_hash(d->dev, d->dir, d->name);
+	d->hash_next = hashtab[i].hash_next;
+	d->hash_prev = &hashtab[i];
+	hashtab[i].hash_next->hash_prev = d;
+	hashtab[i].hash_next = d;
+
+	/* Insert entry in the LRU list. */
+	d->lru_next = lru.lru_next;
+	d->lru_prev = &lru;
+	lru.lru_next->lru_prev = d;
+	lru.lru_next = d;
+}
+
+/**
+ * @brief Removes a directory entry from the directory entry cache.
+ *
+ * @param dip  Directory inode.
+ * @param name File name.
+ *
+ * @note The directory inode must be locked.
+ */
+PUBLIC void dcache_remove(struct inode *dip, const char *name)
+{
+	struct dentry *d;
+
+	if ((d = dcache_search(dip, name)) != NULL)
+		dcache_drop(d);
+}
+
+/**
+ * @brief Invalidates cached entries of a directory.
+ *
+ * @param dip Directory inode.
+ *
+ * @note The directory inode must be locked.
+ */
+PUBLIC void dcache_invalidate(struct inode *dip)
+{
+	for (struct dentry *d = lru.lru_next; d != &lru; /* noop */)
+	{
+		struct dentry *next = d->lru_next;
+
+		if ((d->dev == dip->dev) && (d->dir == dip->num))
+			dcache_drop(d);
+
+		d = next;
+	}
+}
+
+/**
+ * @brief Invalidates cached entries of a device.
+ *
+ * @param dev Target device.
+ */
+PUBLIC void dcache_flush(dev_t dev)
+{
+	for (struct dentry *d = lru.lru_next; d != &lru; /* noop */)
+	{
+		struct dentry *next = d->lru_next;
+
+		if (d->dev == dev)
+			dcache_drop(d);
+
+		d = next;
+	}
+}
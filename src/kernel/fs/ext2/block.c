@@ -0,0 +1,392 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file
+ * 
+ * @brief ext2 block module implementation.
+ * 
+ * @details An ext2 block is made of one or more consecutive buffers of the
+ *          block buffer cache, and metadata is always accessed one buffer at
+ *          a time. Blocks are preferably allocated in the group of the inode
+ *          that owns them.
+ */
+
+#include <nanvix/config.h>
+#include <nanvix/const.h>
+#include <nanvix/fs.h>
+#include <nanvix/klib.h>
+#include <nanvix/pm.h>
+#include <errno.h>
+#include "../fs.h"
+#include "ext2.h"
+
+/**
+ * @brief Number of bits in a buffer.
+ */
+#define BITS_PER_BUFFER (BLOCK_SIZE << 3)
+
+/**
+ * @brief Reads part of a block.
+ * 
+ * @details Reads the buffer that holds the byte at offset @p off from the
+ *          beginning of the block numbered @p blk. The offset may go past the
+ *          end of the block, in which case the following blocks are read.
+ * 
+ * @param sb  Superblock of the file system.
+ * @param blk Block number.
+ * @param off Byte offset.
+ * 
+ * @returns The (locked) buffer. Use EXT2_BDATA() to get the data at @p off.
+ */
+PUBLIC struct buffer *ext2_bread(struct superblock *sb, uint32_t blk, unsigned off)
+{
+	return (bread(sb->dev, (blk << sb->u.ext2.log_ratio) + (off >> BLOCK_SIZE_LOG2)));
+}
+
+/**
+ * @brief Gets a block group descriptor.
+ * 
+ * @param sb    Superblock of the file system.
+ * @param group Block group number.
+ * @param gd    Location where a pointer to the descriptor shall be stored.
+ * 
+ * @returns The (locked) buffer that holds the descriptor.
+ */
+PUBLIC struct buffer *
+ext2_group_get(struct superblock *sb, unsigned group, struct ext2_group_desc **gd)
+{
+	unsigned off;       /* Descriptor offset. */
+	struct buffer *buf; /* Working buffer.    */
+	
+	off = group*sizeof(struct ext2_group_desc);
+	buf = ext2_bread(sb, sb->u.ext2.first_data_block + 1, off);
+	*gd = (struct ext2_group_desc *)EXT2_BDATA(buf, off);
+	
+	return (buf);
+}
+
+/**
+ * @brief Allocates a bit in a bitmap.
+ * 
+ * @param sb    Superblock of the file system.
+ * @param blk   Block of the bitmap.
+ * @param nbits Number of valid bits in the bitmap.
+ * 
+ * @returns The number of the allocated bit, or #BITMAP_FULL if all bits are
+ *          set.
+ */
+PUBLIC bit_t ext2_bitmap_alloc(struct superblock *sb, uint32_t blk, uint32_t nbits)
+{
+	bit_t bit;          /* Working bit.    */
+	struct buffer *buf; /* Working buffer. */
+	
+	for (uint32_t first = 0; first < nbits; first += BITS_PER_BUFFER)
+	{
+		buf = ext2_bread(sb, blk, first >> 3);
+		bit = bitmap_first_free(buffer_data(buf), BLOCK_SIZE);
+		
+		/* Found. */
+		if ((bit != BITMAP_FULL) && (first + bit < nbits))
+		{
+			bitmap_set(buffer_data(buf), bit);
+			buffer_dirty(buf, 1);
+			brelse(buf);
+			return (first + bit);
+		}
+		
+		brelse(buf);
+	}
+	
+	return (BITMAP_FULL);
+}
+
+/**
+ * @brief Clears a bit in a bitmap.
+ * 
+ * @param sb  Superblock of the file system.
+ * @param blk Block of the bitmap.
+ * @param bit Bit to be cleared.
+ */
+PUBLIC void ext2_bitmap_free(struct superblock *sb, uint32_t blk, uint32_t bit)
+{
+	struct buffer *buf; /* Working buffer. */
+	
+	buf = ext2_bread(sb, blk, bit >> 3);
+	bitmap_clear(buffer_data(buf), bit%BITS_PER_BUFFER);
+	buffer_dirty(buf, 1);
+	brelse(buf);
+}
+
+/**
+ * @brief Allocates a block.
+ * 
+ * @details Allocates a zeroed block for the inode pointed to by @p ip,
+ *          starting the search in the group of the inode. Blocks reserved to
+ *          the superuser are only handed to the superuser.
+ * 
+ * @param ip Inode that shall own the block.
+ * 
+ * @returns Upon successful completion, the number of the allocated block is
+ *          returned. Upon failure, zero is returned instead.
+ */
+PUBLIC uint32_t ext2_block_alloc(struct inode *ip)
+{
+	bit_t bit;                  /* Bit in the bitmap.  */
+	uint32_t blk;               /* Block number.       */
+	uint32_t nbits;             /* Blocks in group.    */
+	unsigned group;             /* Working group.      */
+	struct buffer *buf;         /* Descriptor buffer.  */
+	struct ext2_group_desc *gd; /* Group descriptor.   */
+	struct ext2_sb_info *info;  /* File system info.   */
+	struct ext2_super_block *d_sb;
+	struct superblock *sb;
+	
+	superblock_lock(sb = ip->sb);
+	
+	info = &sb->u.ext2;
+	d_sb = EXT2_DSB(sb);
+	
+	/* Reserved blocks. */
+	if ((d_sb->s_free_blocks_count <= d_sb->s_r_blocks_count) && (!IS_SUPERUSER(curr_proc)))
+		goto error0;
+	
+	for (unsigned i = 0; i < info->ngroups; i++)
+	{
+		group = ((ip->num - 1)/info->inodes_per_group + i)%info->ngroups;
+		
+		buf = ext2_group_get(sb, group, &gd);
+		
+		/* Skip full groups. */
+		if (gd->bg_free_blocks_count == 0)
+		{
+			brelse(buf);
+			continue;
+		}
+		
+		nbits = info->blocks_count - info->first_data_block - group*info->blocks_per_group;
+		if (nbits > info->blocks_per_group)
+			nbits = info->blocks_per_group;
+		
+		bit = ext2_bitmap_alloc(sb, gd->bg_block_bitmap, nbits);
+		
+		/* Found. */
+		if (bit != BITMAP_FULL)
+		{
+			gd->bg_free_blocks_count--;
+			buffer_dirty(buf, 1);
+			brelse(buf);
+			goto found;
+		}
+		
+		brelse(buf);
+	}
+	
+error0:
+	superblock_unlock(sb);
+	curr_proc->errno = -ENOSPC;
+	return (0);
+
+found:
+	
+	d_sb->s_free_blocks_count--;
+	buffer_dirty(sb->buf, 1);
+	sb->flags |= SUPERBLOCK_DIRTY;
+	superblock_unlock(sb);
+	
+	blk = info->first_data_block + group*info->blocks_per_group + bit;
+	
+	/* Zero block. */
+	for (unsigned j = 0; j < (1u << info->log_ratio); j++)
+	{
+		buf = bnew(sb->dev, (blk << info->log_ratio) + j);
+		buffer_dirty(buf, 1);
+		brelse(buf);
+	}
+	
+	ip->u.ext2.nsectors += info->block_size >> 9;
+	ip->flags |= INODE_DIRTY;
+	
+	return (blk);
+}
+
+/**
+ * @brief Frees a block.
+ * 
+ * @details Frees the block numbered @p blk. If @p lvl is not zero, the block
+ *          is an indirect block of that level, and the blocks that it points
+ *          to are freed as well.
+ * 
+ * @param sb  Superblock of the file system.
+ * @param blk Block number.
+ * @param lvl Level of indirection.
+ */
+PUBLIC void ext2_block_free(struct superblock *sb, uint32_t blk, int lvl)
+{
+	uint32_t *p;                /* Block pointers.    */
+	unsigned group;             /* Block group.       */
+	struct buffer *buf;         /* Working buffer.    */
+	struct ext2_group_desc *gd; /* Group descriptor.  */
+	struct ext2_sb_info *info;  /* File system info.  */
+	
+	/* Nothing to be done. */
+	if (blk == 0)
+		return;
+	
+	info = &sb->u.ext2;
+	
+	/* Free blocks pointed to. */
+	if (lvl > 0)
+	{
+		for (unsigned off = 0; off < info->block_size; off += BLOCK_SIZE)
+		{
+			buf = ext2_bread(sb, blk, off);
+			p = buffer_data(buf);
+			for (unsigned i = 0; i < BLOCK_SIZE/sizeof(uint32_t); i++)
+				ext2_block_free(sb, p[i], lvl - 1);
+			brelse(buf);
+		}
+	}
+	
+	superblock_lock(sb);
+	
+	blk -= info->first_data_block;
+	group = blk/info->blocks_per_group;
+	
+	buf = ext2_group_get(sb, group, &gd);
+	ext2_bitmap_free(sb, gd->bg_block_bitmap, blk%info->blocks_per_group);
+	gd->bg_free_blocks_count++;
+	buffer_dirty(buf, 1);
+	brelse(buf);
+	
+	EXT2_DSB(sb)->s_free_blocks_count++;
+	buffer_dirty(sb->buf, 1);
+	sb->flags |= SUPERBLOCK_DIRTY;
+	
+	superblock_unlock(sb);
+}
+
+/**
+ * @brief Follows a block pointer in an indirect block.
+ * 
+ * @param ip     Target inode.
+ * @param blk    Indirect block.
+ * @param i      Index of the pointer.
+ * @param create Allocate the block pointed to if it is missing?
+ * 
+ * @returns The block pointed to, or zero if there is none.
+ */
+PRIVATE uint32_t ext2_indirect(struct inode *ip, uint32_t blk, unsigned i, int create)
+{
+	uint32_t next;      /* Block pointed to. */
+	struct buffer *buf; /* Working buffer.   */
+	unsigned off;       /* Pointer offset.   */
+	
+	off = i*sizeof(uint32_t);
+	
+	buf = ext2_bread(ip->sb, blk, off);
+	next = *(uint32_t *)EXT2_BDATA(buf, off);
+	brelse(buf);
+	
+	/* Create block. */
+	if ((next == 0) && (create))
+	{
+		if ((next = ext2_block_alloc(ip)) == 0)
+			return (0);
+		
+		buf = ext2_bread(ip->sb, blk, off);
+		*(uint32_t *)EXT2_BDATA(buf, off) = next;
+		buffer_dirty(buf, 1);
+		brelse(buf);
+	}
+	
+	return (next);
+}
+
+/**
+ * @brief Maps a file byte offset in a block number.
+ * 
+ * @param ip     File to use.
+ * @param off    File byte offset.
+ * @param create Create the block if it does not exist?
+ * 
+ * @returns The block number that is associated with the file byte offset, or
+ *          zero if there is none.
+ * 
+ * @note The inode must be locked.
+ */
+PUBLIC uint32_t ext2_block_map(struct inode *ip, off_t off, int create)
+{
+	int lvl;                   /* Level of indirection. */
+	uint32_t *slot;            /* Pointer in the inode. */
+	uint32_t blk;              /* Working block.        */
+	unsigned logic;            /* Logical block number. */
+	unsigned shift;            /* Log 2 of pointers.    */
+	struct ext2_sb_info *info; /* File system info.     */
+	
+	info = &ip->sb->u.ext2;
+	shift = info->log_ratio + BLOCK_SIZE_LOG2 - 2;
+	logic = off >> (info->log_ratio + BLOCK_SIZE_LOG2);
+	
+	/* Direct block. */
+	if (logic < EXT2_NDIR_BLOCKS)
+	{
+		slot = &ip->u.ext2.block[logic];
+		lvl = 0;
+	}
+	
+	/* Single indirect block. */
+	else if ((logic -= EXT2_NDIR_BLOCKS) < (1u << shift))
+	{
+		slot = &ip->u.ext2.block[EXT2_IND_BLOCK];
+		lvl = 1;
+	}
+	
+	/* Double indirect block. */
+	else if ((logic -= (1u << shift)) < (1u << 2*shift))
+	{
+		slot = &ip->u.ext2.block[EXT2_DIND_BLOCK];
+		lvl = 2;
+	}
+	
+	/* Triple indirect block. */
+	else
+	{
+		logic -= (1u << 2*shift);
+		slot = &ip->u.ext2.block[EXT2_TIND_BLOCK];
+		lvl = 3;
+	}
+	
+	/* Create block. */
+	if ((*slot == 0) && (create))
+	{
+		if ((blk = ext2_block_alloc(ip)) == 0)
+			return (0);
+		*slot = blk;
+		ip->flags |= INODE_DIRTY;
+	}
+	
+	/* Walk down indirect blocks. */
+	for (blk = *slot; (lvl > 0) && (blk != 0); lvl--)
+	{
+		blk = ext2_indirect(ip, blk,
+			(logic >> (lvl - 1)*shift) & ((1u << shift) - 1), create);
+	}
+	
+	return (blk);
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file
+ * 
+ * @brief Second extended file system.
+ */
+
+#ifndef _EXT2_H_
+#define _EXT2_H_
+
+	#include <nanvix/const.h>
+	#include <nanvix/dev.h>
+	#include <nanvix/fs.h>
+	#include <fs/ext2.h>
+
+	#if (BLOCK_SIZE_LOG2 != EXT2_MIN_BLOCK_LOG_SIZE)
+		#error "ext2 blocks must be made of whole buffers"
+	#endif
+
+	/**
+	 * @brief Gets the in-disk superblock of a file system.
+	 * 
+	 * @param sb In-core superblock.
+	 */
+	#define EXT2_DSB(sb) \
+		((struct ext2_super_block *)buffer_data((sb)->buf))
+
+	/**
+	 * @brief Gets the data at an offset in a buffer.
+	 * 
+	 * @param buf Buffer returned by ext2_bread().
+	 * @param off Byte offset that was passed to ext2_bread().
+	 */
+	#define EXT2_BDATA(buf, off) \
+		((char *)buffer_data(buf) + ((off) & (BLOCK_SIZE - 1)))
+
+	/* Forward definitions. */
+	EXTERN struct buffer *ext2_bread(struct superblock *, uint32_t, unsigned);
+	EXTERN struct buffer *ext2_group_get(struct superblock *, unsigned, struct ext2_group_desc **);
+	EXTERN bit_t ext2_bitmap_alloc(struct superblock *, uint32_t, uint32_t);
+	EXTERN void ext2_bitmap_free(struct superblock *, uint32_t, uint32_t);
+	EXTERN uint32_t ext2_block_alloc(struct inode *);
+	EXTERN void ext2_block_free(struct superblock *, uint32_t, int);
+	EXTERN uint32_t ext2_block_map(struct inode *, off_t, int);
+
+	EXTERN int inode_read_ext2(dev_t, ino_t, struct inode *);
+	EXTERN void inode_write_ext2(struct inode *);
+	EXTERN void inode_free_ext2(struct inode *);
+	EXTERN void inode_truncate_ext2(struct inode *);
+	EXTERN int inode_alloc_ext2(struct superblock *, struct inode *);
+
+	EXTERN struct superblock *superblock_read_ext2(dev_t, struct superblock *);
+	EXTERN void superblock_put_ext2(struct superblock *);
+	EXTERN void superblock_write_ext2(struct superblock *);
+	EXTERN void superblock_stat_ext2(struct superblock *, struct ustat *);
+
+	EXTERN ssize_t dir_read_ext2(struct inode *, void *, size_t, off_t);
+	EXTERN int dir_add_ext2(struct inode *, struct inode *, const char *);
+	EXTERN int dir_remove_ext2(struct inode *, const char *);
+	EXTERN struct d_dirent *dirent_search_ext2(struct inode *, const char *, struct buffer **, int);
+	EXTERN ssize_t file_read_ext2(struct inode *, void *, size_t, off_t);
+	EXTERN ssize_t file_write_ext2(struct inode *, const void *, size_t, off_t);
+	EXTERN ssize_t file_readv_ext2(struct inode *, struct iovec *, int, off_t);
+	EXTERN ssize_t file_writev_ext2(struct inode *, struct iovec *, int, off_t);
+	EXTERN int readpage_ext2(struct inode *, void *, off_t);
+
+	EXTERN void init_ext2(void);
+	EXTERN struct super_operations *so_ext2(void);
+
+	EXTERN struct inode_operations inode_o_ext2;
+
+#endif /* _EXT2_H_ */
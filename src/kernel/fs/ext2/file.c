@@ -0,0 +1,655 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file
+ * 
+ * @brief ext2 file module implementation.
+ * 
+ * @details Directory entries of ext2 have variable length, so they are not
+ *          handed out as they are found on the disk. Instead, directories are
+ *          read as arrays of #d_dirent, and names that do not fit in one are
+ *          left out.
+ */
+
+#include <nanvix/clock.h>
+#include <nanvix/config.h>
+#include <nanvix/const.h>
+#include <nanvix/fs.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <limits.h>
+#include "../fs.h"
+#include "ext2.h"
+
+/*
+ * Reads from a regular file into an I/O vector, bypassing the page cache.
+ */
+PRIVATE ssize_t file_readv_blocks
+(struct inode *i, struct iovec *iov, int iovcnt, size_t n, off_t off)
+{
+	size_t blkoff;       /* Buffer offset.        */
+	size_t chunk;        /* Data chunk size.      */
+	ssize_t count;       /* Bytes read.           */
+	uint32_t blk;        /* Working block number. */
+	unsigned bmask;      /* Block offset mask.    */
+	struct buffer *bbuf; /* Working block buffer. */
+	
+	bmask = i->sb->u.ext2.block_size - 1;
+	count = 0;
+	
+	/* Read data. */
+	while ((n > 0) && (off < i->size))
+	{
+		blk = ext2_block_map(i, off, 0);
+		
+		blkoff = off % BLOCK_SIZE;
+		
+		/* Calculate read chunk size. */
+		chunk = (n < BLOCK_SIZE - blkoff) ? n : BLOCK_SIZE - blkoff;
+		if ((off_t)chunk > i->size - off)
+			chunk = i->size - off;
+		
+		/* Holes read as zeros. */
+		if (blk == 0)
+			iov_zero(iov, iovcnt, chunk);
+		else
+		{
+			bbuf = ext2_bread(i->sb, blk, off & bmask);
+			iov_copy(iov, iovcnt, EXT2_BDATA(bbuf, off), chunk, 1);
+			brelse(bbuf);
+		}
+		
+		n -= chunk;
+		off += chunk;
+		count += chunk;
+	}
+	
+	return (count);
+}
+
+/*
+ * Reads a page of a regular file.
+ */
+PUBLIC int readpage_ext2(struct inode *i, void *page, off_t off)
+{
+	struct iovec iov; /* I/O vector.  */
+	ssize_t count;    /* Bytes read.  */
+	
+	iov.iov_base = page;
+	iov.iov_len = PAGE_SIZE;
+	
+	count = file_readv_blocks(i, &iov, 1, PAGE_SIZE, off);
+	kmemset((char *)page + count, 0, PAGE_SIZE - count);
+	
+	return (0);
+}
+
+/*
+ * Reads from a regular file into an I/O vector.
+ */
+PUBLIC ssize_t file_readv_ext2(struct inode *i, struct iovec *iov, int iovcnt, off_t off)
+{
+	char *pg;      /* Cached page.     */
+	size_t n;      /* Bytes to read.   */
+	size_t pgoff;  /* Page offset.     */
+	size_t chunk;  /* Data chunk size. */
+	ssize_t count; /* Bytes read.      */
+	
+	n = 0;
+	for (int j = 0; j < iovcnt; j++)
+		n += iov[j].iov_len;
+	
+	count = 0;
+	
+	/* Read data. */
+	while ((n > 0) && (off < i->size))
+	{
+		pgoff = off & ~PAGE_MASK;
+		
+		/* Page cache is full, so read blocks straight. */
+		if ((pg = pcache_get(i, off - pgoff)) == NULL)
+			return (count + file_readv_blocks(i, iov, iovcnt, n, off));
+		
+		/* Calculate read chunk size. */
+		chunk = (n < PAGE_SIZE - pgoff) ? n : PAGE_SIZE - pgoff;
+		if ((off_t)chunk > i->size - off)
+			chunk = i->size - off;
+		
+		iov_copy(iov, iovcnt, pg + pgoff, chunk, 1);
+		pcache_put(pg);
+		
+		n -= chunk;
+		off += chunk;
+		count += chunk;
+	}
+	
+	return (count);
+}
+
+/*
+ * Reads from a regular file.
+ */
+PUBLIC ssize_t file_read_ext2(struct inode *i, void *buf, size_t n, off_t off)
+{
+	struct iovec iov; /* I/O vector. */
+	
+	iov.iov_base = buf;
+	iov.iov_len = n;
+	
+	return (file_readv_ext2(i, &iov, 1, off));
+}
+
+/*
+ * Writes to a regular file from an I/O vector.
+ */
+PUBLIC ssize_t file_writev_ext2(struct inode *i, struct iovec *iov, int iovcnt, off_t off)
+{
+	char *data;          /* Block data.           */
+	size_t n;            /* Bytes to write.       */
+	size_t blkoff;       /* Buffer offset.        */
+	size_t chunk;        /* Data chunk size.      */
+	ssize_t count;       /* Bytes written.        */
+	uint32_t blk;        /* Working block number. */
+	unsigned bmask;      /* Block offset mask.    */
+	struct buffer *bbuf; /* Working block buffer. */
+	
+	bmask = i->sb->u.ext2.block_size - 1;
+	
+	n = 0;
+	for (int j = 0; j < iovcnt; j++)
+		n += iov[j].iov_len;
+	
+	count = 0;
+	
+	/* Write data. */
+	while (n > 0)
+	{
+		blk = ext2_block_map(i, off, 1);
+		
+		/* No space left. */
+		if (blk == 0)
+			break;
+		
+		blkoff = off % BLOCK_SIZE;
+		
+		chunk = (n < BLOCK_SIZE - blkoff) ? n : BLOCK_SIZE - blkoff;
+		
+		/*
+		 * The whole buffer is about to be overwritten,
+		 * so there is no need to read it in before.
+		 */
+		if (chunk == BLOCK_SIZE)
+			bbuf = bnew(i->dev, (blk << i->sb->u.ext2.log_ratio) + ((off & bmask) >> BLOCK_SIZE_LOG2));
+		else
+			bbuf = ext2_bread(i->sb, blk, off & bmask);
+		
+		data = EXT2_BDATA(bbuf, off);
+		iov_copy(iov, iovcnt, data, chunk, 0);
+		pcache_update(i, off, data, chunk);
+		buffer_dirty(bbuf, 1);
+		brelse(bbuf);
+		
+		n -= chunk;
+		off += chunk;
+		count += chunk;
+		
+		/* Update file size. */
+		if (off > i->size)
+		{
+			i->size = off;
+			i->flags |= INODE_DIRTY;
+		}
+	}
+	
+	return (count);
+}
+
+/*
+ * Writes to a regular file.
+ */
+PUBLIC ssize_t file_write_ext2(struct inode *i, const void *buf, size_t n, off_t off)
+{
+	struct iovec iov; /* I/O vector. */
+	
+	iov.iov_base = (void *)buf;
+	iov.iov_len = n;
+	
+	return (file_writev_ext2(i, &iov, 1, off));
+}
+
+/**
+ * @brief Reads from a directory.
+ * 
+ * @param dip Target directory.
+ * @param buf Target buffer.
+ * @param n   Number of bytes.
+ * @param off Directory offset.
+ * 
+ * @returns Zero if all bytes were read, and non-zero otherwise.
+ */
+PRIVATE int ext2_dir_peek(struct inode *dip, void *buf, size_t n, off_t off)
+{
+	struct iovec iov; /* I/O vector. */
+	
+	iov.iov_base = buf;
+	iov.iov_len = n;
+	
+	return (file_readv_blocks(dip, &iov, 1, n, off) != (ssize_t)n);
+}
+
+/**
+ * @brief Writes to a directory.
+ * 
+ * @param dip Target directory.
+ * @param buf Source buffer.
+ * @param n   Number of bytes.
+ * @param off Directory offset.
+ * 
+ * @returns Zero if all bytes were written, and non-zero otherwise.
+ */
+PRIVATE int ext2_dir_poke(struct inode *dip, const void *buf, size_t n, off_t off)
+{
+	return (file_write_ext2(dip, buf, n, off) != (ssize_t)n);
+}
+
+/**
+ * @brief Reads a directory entry.
+ * 
+ * @details Reads the directory entry at offset @p off of the directory
+ *          pointed to by @p dip. The name is only read if the entry is in use
+ *          and the name is at most #NAME_MAX characters long.
+ * 
+ * @param dip Target directory.
+ * @param off Offset of the entry.
+ * @param d   Location where the entry shall be stored.
+ * 
+ * @returns Zero upon successful completion, and non-zero if the entry is
+ *          corrupted.
+ */
+PRIVATE int ext2_dirent_read(struct inode *dip, off_t off, struct ext2_dir_entry *d)
+{
+	unsigned bsize; /* Block size. */
+	
+	bsize = dip->sb->u.ext2.block_size;
+	
+	if (ext2_dir_peek(dip, d, EXT2_DIR_HEADER_LEN, off))
+		return (-1);
+	
+	/* Corrupted entry. */
+	if ((d->rec_len < EXT2_DIR_REC_LEN(1)) || (d->rec_len & 3) ||
+		((off & (bsize - 1)) + d->rec_len > bsize) ||
+		(EXT2_DIR_REC_LEN(d->name_len) > d->rec_len))
+	{
+		kprintf("fs: corrupted ext2 directory %d", dip->num);
+		return (-1);
+	}
+	
+	/* Read name. */
+	if ((d->inode != 0) && (d->name_len <= NAME_MAX))
+		return (ext2_dir_peek(dip, d->name, d->name_len, off + EXT2_DIR_HEADER_LEN));
+	
+	return (0);
+}
+
+/**
+ * @brief Searches for a directory entry.
+ * 
+ * @param dip  Target directory.
+ * @param name File name.
+ * @param d    Location where the entry shall be stored.
+ * @param prev Location where the offset of the previous entry in the same
+ *             block shall be stored.
+ * 
+ * @returns The offset of the entry, or a negative number if there is no such
+ *          entry. If the entry is the first one of its block, @p prev is set
+ *          to a negative number.
+ */
+PRIVATE off_t ext2_dirent_find
+(struct inode *dip, const char *name, struct ext2_dir_entry *d, off_t *prev)
+{
+	size_t len;     /* Name length.  */
+	off_t off;      /* Entry offset. */
+	unsigned bmask; /* Block mask.   */
+	
+	bmask = dip->sb->u.ext2.block_size - 1;
+	len = kstrlen(name);
+	
+	*prev = -1;
+	for (off = 0; off < dip->size; off += d->rec_len)
+	{
+		if ((off & bmask) == 0)
+			*prev = -1;
+		
+		/* Corrupted directory. */
+		if (ext2_dirent_read(dip, off, d))
+			break;
+		
+		/* Found. */
+		if ((d->inode != 0) && (d->name_len == len) && (!kmemcmp(d->name, name, len)))
+			return (off);
+		
+		*prev = off;
+	}
+	
+	return (-1);
+}
+
+/**
+ * @brief Gets the type of a file for a directory entry.
+ * 
+ * @param mode Access permissions of the file.
+ * 
+ * @returns The type of the file.
+ */
+PRIVATE uint8_t ext2_file_type(mode_t mode)
+{
+	if (S_ISREG(mode))
+		return (EXT2_FT_REG_FILE);
+	if (S_ISDIR(mode))
+		return (EXT2_FT_DIR);
+	if (S_ISCHR(mode))
+		return (EXT2_FT_CHRDEV);
+	if (S_ISBLK(mode))
+		return (EXT2_FT_BLKDEV);
+	if (S_ISFIFO(mode))
+		return (EXT2_FT_FIFO);
+	
+	return (EXT2_FT_UNKNOWN);
+}
+
+/**
+ * @brief Asserts if a directory is empty.
+ * 
+ * @param dip Target directory.
+ * 
+ * @returns Non-zero if the directory holds nothing but '.' and '..', and
+ *          zero otherwise.
+ */
+PRIVATE int ext2_dir_empty(struct inode *dip)
+{
+	off_t off;               /* Entry offset. */
+	struct ext2_dir_entry d; /* Working entry. */
+	
+	for (off = 0; off < dip->size; off += d.rec_len)
+	{
+		/* Corrupted directory. */
+		if (ext2_dirent_read(dip, off, &d))
+			return (0);
+		
+		/* Free entry. */
+		if (d.inode == 0)
+			continue;
+		
+		/* Dot entries. */
+		if ((d.name_len == 1) && (d.name[0] == '.'))
+			continue;
+		if ((d.name_len == 2) && (d.name[0] == '.') && (d.name[1] == '.'))
+			continue;
+		
+		return (0);
+	}
+	
+	return (1);
+}
+
+/*
+ * Searches for a directory entry.
+ * 
+ * Entries are only created by dir_add_ext2(), so create is not honored.
+ */
+PUBLIC struct d_dirent *dirent_search_ext2
+(struct inode *dip, const char *filename, struct buffer **buf, int create)
+{
+	off_t prev;                 /* Previous entry. */
+	struct ext2_dir_entry d;    /* Disk entry.     */
+	PRIVATE struct d_dirent de; /* Found entry.    */
+	
+	UNUSED(create);
+	
+	/* Entries are not handed in buffers. */
+	*buf = NULL;
+	
+	/* Not found. */
+	if (ext2_dirent_find(dip, filename, &d, &prev) < 0)
+		return (NULL);
+	
+	de.d_ino = d.inode;
+	kstrncpy(de.d_name, filename, NAME_MAX);
+	
+	return (&de);
+}
+
+/*
+ * Adds an entry to a directory.
+ */
+PUBLIC int dir_add_ext2(struct inode *dinode, struct inode *inode, const char *name)
+{
+	off_t off;               /* Entry offset.      */
+	off_t prev;              /* Previous entry.    */
+	size_t len;              /* Name length.       */
+	uint16_t need;           /* Space needed.      */
+	uint16_t used;           /* Space in use.      */
+	unsigned bsize;          /* Block size.        */
+	struct ext2_dir_entry d; /* Working entry.     */
+	
+	bsize = dinode->sb->u.ext2.block_size;
+	len = kstrlen(name);
+	need = EXT2_DIR_REC_LEN(len);
+	
+	/* Reuse entry. */
+	if ((off = ext2_dirent_find(dinode, name, &d, &prev)) >= 0)
+	{
+		d.inode = inode->num;
+		if (ext2_dir_poke(dinode, &d.inode, sizeof(d.inode), off))
+			return (-1);
+		goto out;
+	}
+	
+	/* Search for free space. */
+	for (off = 0; off < dinode->size; off += d.rec_len)
+	{
+		/* Corrupted directory. */
+		if (ext2_dirent_read(dinode, off, &d))
+			return (-1);
+		
+		used = (d.inode != 0) ? EXT2_DIR_REC_LEN(d.name_len) : 0;
+		
+		/* Not enough space. */
+		if (d.rec_len - used < need)
+			continue;
+		
+		/* Split entry. */
+		if (used != 0)
+		{
+			d.rec_len -= used;
+			if (ext2_dir_poke(dinode, &used, sizeof(used), off + 4))
+				return (-1);
+			off += used;
+		}
+		
+		goto found;
+	}
+	
+	/* Append block. */
+	off = dinode->size;
+	if (ext2_block_map(dinode, off, 1) == 0)
+		return (-1);
+	d.rec_len = bsize;
+	
+found:
+	
+	d.inode = inode->num;
+	d.name_len = len;
+	d.file_type = 0;
+	if (dinode->sb->u.ext2.incompat & EXT2_FEATURE_INCOMPAT_FILETYPE)
+		d.file_type = ext2_file_type(inode->mode);
+	kmemcpy(d.name, name, len);
+	
+	if (ext2_dir_poke(dinode, &d, EXT2_DIR_HEADER_LEN + len, off))
+		return (-1);
+	
+	/* Directory grew by a block. */
+	if (dinode->size < off + (off_t)d.rec_len)
+		dinode->size = off + d.rec_len;
+	
+out:
+	
+	/* Hash tree index is now stale. */
+	dinode->u.ext2.flags &= ~EXT2_INDEX_FL;
+	inode_touch(dinode);
+	
+	return (0);
+}
+
+/*
+ * Removes an entry from a directory.
+ */
+PUBLIC int dir_remove_ext2(struct inode *dinode, const char *filename)
+{
+	off_t off;                  /* Entry offset.    */
+	off_t prev;                 /* Previous entry.  */
+	uint16_t rec_len;           /* Merged length.   */
+	struct ext2_dir_entry d;    /* Directory entry. */
+	struct ext2_dir_entry p;    /* Previous entry.  */
+	struct inode *file;         /* File inode.      */
+	
+	/* Not found. */
+	if ((off = ext2_dirent_find(dinode, filename, &d, &prev)) < 0)
+		return (-ENOENT);
+	
+	/* Cannot remove '.' */
+	if (d.inode == dinode->num)
+		return (-EBUSY);
+	
+	/* Failed to get file's inode. */
+	if ((file = inode_get(dinode->dev, d.inode)) == NULL)
+		return (-ENOENT);
+	
+	/* Unlinking directory. */
+	if (S_ISDIR(file->mode))
+	{
+		/* Not allowed. */
+		if (!IS_SUPERUSER(curr_proc))
+		{
+			inode_put(file);
+			return (-EPERM);
+		}
+		
+		/* Directory not empty. */
+		if (!ext2_dir_empty(file))
+		{
+			inode_put(file);
+			return (-EBUSY);
+		}
+	}
+	
+	/* Merge entry into the previous one. */
+	if (prev >= 0)
+	{
+		if (ext2_dirent_read(dinode, prev, &p))
+		{
+			inode_put(file);
+			return (-EIO);
+		}
+		rec_len = p.rec_len + d.rec_len;
+		ext2_dir_poke(dinode, &rec_len, sizeof(rec_len), prev + 4);
+	}
+	
+	/* Free entry. */
+	else
+	{
+		d.inode = 0;
+		ext2_dir_poke(dinode, &d.inode, sizeof(d.inode), off);
+	}
+	
+	dinode->u.ext2.flags &= ~EXT2_INDEX_FL;
+	inode_touch(dinode);
+	
+	/*
+	 * A directory also loses its own '.' entry,
+	 * and its '..' entry no longer links the parent.
+	 */
+	if (S_ISDIR(file->mode))
+	{
+		file->nlinks = 0;
+		dinode->nlinks--;
+	}
+	else
+		file->nlinks--;
+	
+	inode_touch(file);
+	inode_put(file);
+	
+	return (0);
+}
+
+/*
+ * Reads from a directory.
+ */
+PUBLIC ssize_t dir_read_ext2(struct inode *i, void *buf, size_t n, off_t off)
+{
+	char *p;                 /* Writing pointer.   */
+	off_t pos;               /* Entry offset.      */
+	size_t skip;             /* Entries to skip.   */
+	size_t entoff;           /* Offset in entry.   */
+	size_t chunk;            /* Data chunk size.   */
+	struct d_dirent de;      /* Returned entry.    */
+	struct ext2_dir_entry d; /* Working entry.     */
+	
+	p = buf;
+	skip = off/sizeof(struct d_dirent);
+	entoff = off%sizeof(struct d_dirent);
+	
+	for (pos = 0; (pos < i->size) && (n > 0); pos += d.rec_len)
+	{
+		/* Corrupted directory. */
+		if (ext2_dirent_read(i, pos, &d))
+			break;
+		
+		/* Skip free entries and names that do not fit. */
+		if ((d.inode == 0) || (d.name_len > NAME_MAX))
+			continue;
+		
+		/* Entry before the offset. */
+		if (skip > 0)
+		{
+			skip--;
+			continue;
+		}
+		
+		de.d_ino = d.inode;
+		kmemset(de.d_name, 0, sizeof(de.d_name));
+		kmemcpy(de.d_name, d.name, d.name_len);
+		
+		chunk = sizeof(struct d_dirent) - entoff;
+		if (chunk > n)
+			chunk = n;
+		
+		kmemcpy(p, (char *)&de + entoff, chunk);
+		
+		n -= chunk;
+		p += chunk;
+		entoff = 0;
+	}
+	
+	return ((ssize_t)(p - (char *)buf));
+}
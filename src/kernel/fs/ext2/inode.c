@@ -0,0 +1,404 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file
+ * 
+ * @brief ext2 inode module implementation.
+ */
+
+#include <nanvix/clock.h>
+#include <nanvix/config.h>
+#include <nanvix/const.h>
+#include <nanvix/fs.h>
+#include <nanvix/klib.h>
+#include <nanvix/pm.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include "../fs.h"
+#include "ext2.h"
+
+/**
+ * @brief Gets a disk inode.
+ * 
+ * @param sb  Superblock of the file system.
+ * @param num Inode number.
+ * @param d_i Location where a pointer to the disk inode shall be stored.
+ * 
+ * @returns The (locked) buffer that holds the disk inode.
+ */
+PRIVATE struct buffer *
+ext2_inode_get(struct superblock *sb, ino_t num, struct ext2_inode **d_i)
+{
+	unsigned off;               /* Inode offset.     */
+	uint32_t table;             /* Inode table.      */
+	struct buffer *buf;         /* Working buffer.   */
+	struct ext2_group_desc *gd; /* Group descriptor. */
+	struct ext2_sb_info *info;  /* File system info. */
+	
+	info = &sb->u.ext2;
+	
+	buf = ext2_group_get(sb, (num - 1)/info->inodes_per_group, &gd);
+	table = gd->bg_inode_table;
+	brelse(buf);
+	
+	off = ((num - 1)%info->inodes_per_group)*info->inode_size;
+	buf = ext2_bread(sb, table, off);
+	*d_i = (struct ext2_inode *)EXT2_BDATA(buf, off);
+	
+	return (buf);
+}
+
+/**
+ * @brief Writes an inode to disk.
+ * 
+ * @details Writes the inode pointed to by @p ip to disk.
+ * 
+ * @param ip Inode to be written to disk.
+ * 
+ * @note The inode must be locked.
+ */
+PUBLIC void inode_write_ext2(struct inode *ip)
+{
+	struct buffer *buf;     /* Buffer.     */
+	struct ext2_inode *d_i; /* Disk inode. */
+	
+	/* Nothing to be done. */
+	if (!(ip->flags & INODE_DIRTY))
+		return;
+	
+	buf = ext2_inode_get(ip->sb, ip->num, &d_i);
+	
+	/* Write inode to buffer. */
+	d_i->i_mode = ip->mode;
+	d_i->i_links_count = ip->nlinks;
+	d_i->i_uid = ip->uid;
+	d_i->i_gid = ip->gid;
+	d_i->i_size = ip->size;
+	d_i->i_atime = ip->time;
+	d_i->i_ctime = ip->time;
+	d_i->i_mtime = ip->time;
+	d_i->i_dtime = ip->u.ext2.dtime;
+	d_i->i_blocks = ip->u.ext2.nsectors;
+	d_i->i_flags = ip->u.ext2.flags;
+	for (unsigned i = 0; i < EXT2_N_BLOCKS; i++)
+		d_i->i_block[i] = ip->u.ext2.block[i];
+	ip->flags &= ~INODE_DIRTY;
+	buffer_dirty(buf, 1);
+	
+	brelse(buf);
+}
+
+/**
+ * @brief Reads an inode from the disk.
+ * 
+ * @details Reads the inode with number @p num from the device @p dev.
+ * 
+ * @param dev Device where the inode is located.
+ * @param num Number of the inode that shall be read.
+ * @param ip  Inode of the cache where the result of the reading is written.
+ * 
+ * @returns Upon successful completion zero is returned. Upon failure, non-zero
+ *          is returned instead.
+ */
+PUBLIC int inode_read_ext2(dev_t dev, ino_t num, struct inode *ip)
+{
+	struct buffer *buf;     /* Buffer.      */
+	struct ext2_inode *d_i; /* Disk inode.  */
+	struct superblock *sb;  /* Super block. */
+	
+	/* Get superblock. */
+	if ((sb = superblock_get(dev)) == NULL)
+		goto error0;
+	
+	/* Invalid inode number. */
+	if ((num == INODE_NULL) || (num > sb->ninodes))
+		goto error1;
+	
+	buf = ext2_inode_get(sb, num, &d_i);
+	
+	/* Invalid disk inode. */
+	if (d_i->i_links_count == 0)
+		goto error2;
+	
+	/* File too big. */
+	if ((S_ISREG(d_i->i_mode)) && ((d_i->i_dir_acl != 0) || ((off_t)d_i->i_size < 0)))
+	{
+		kprintf("fs: ext2 file %d is too big", num);
+		goto error2;
+	}
+	
+	/* Initialize in-core inode. */
+	ip->mode = d_i->i_mode;
+	ip->nlinks = d_i->i_links_count;
+	ip->uid = d_i->i_uid;
+	ip->gid = d_i->i_gid;
+	ip->size = d_i->i_size;
+	ip->time = d_i->i_mtime;
+	for (unsigned i = 0; i < NR_ZONES; i++)
+		ip->blocks[i] = BLOCK_NULL;
+	for (unsigned i = 0; i < EXT2_N_BLOCKS; i++)
+		ip->u.ext2.block[i] = d_i->i_block[i];
+	ip->u.ext2.nsectors = d_i->i_blocks;
+	ip->u.ext2.flags = d_i->i_flags;
+	ip->u.ext2.dtime = 0;
+	
+	/* Device number. */
+	if (S_ISCHR(ip->mode) || S_ISBLK(ip->mode))
+		ip->blocks[0] = d_i->i_block[0];
+	
+	ip->dev = dev;
+	ip->num = num;
+	ip->sb = sb;
+	ip->i_op = &inode_o_ext2;
+	ip->flags &= ~(INODE_DIRTY | INODE_MOUNT | INODE_PIPE);
+	ip->flags |= INODE_VALID;
+	
+	brelse(buf);
+	superblock_put(sb);
+	
+	return (0);
+
+error2:
+	brelse(buf);
+error1:
+	superblock_put(sb);
+error0:
+	return (1);
+}
+
+/**
+ * @brief Frees an inode.
+ * 
+ * @details Frees the inode pointed to by @p ip.
+ * 
+ * @param ip Target inode.
+ * 
+ * @note The inode must be locked.
+ */
+PUBLIC void inode_free_ext2(struct inode *ip)
+{
+	struct buffer *buf;         /* Descriptor buffer. */
+	struct ext2_group_desc *gd; /* Group descriptor.  */
+	struct ext2_sb_info *info;  /* File system info.  */
+	struct superblock *sb;      /* Super block.       */
+	
+	superblock_lock(sb = ip->sb);
+	
+	info = &sb->u.ext2;
+	
+	buf = ext2_group_get(sb, (ip->num - 1)/info->inodes_per_group, &gd);
+	ext2_bitmap_free(sb, gd->bg_inode_bitmap, (ip->num - 1)%info->inodes_per_group);
+	gd->bg_free_inodes_count++;
+	if (S_ISDIR(ip->mode))
+		gd->bg_used_dirs_count--;
+	buffer_dirty(buf, 1);
+	brelse(buf);
+	
+	EXT2_DSB(sb)->s_free_inodes_count++;
+	buffer_dirty(sb->buf, 1);
+	sb->flags |= SUPERBLOCK_DIRTY;
+	
+	superblock_unlock(sb);
+	
+	ip->u.ext2.dtime = CURRENT_TIME;
+	ip->flags |= INODE_DIRTY;
+}
+
+/**
+ * @brief Truncates an inode.
+ * 
+ * @details Truncates the inode pointed to by @p ip by freeing all underlying
+ *          blocks.
+ * 
+ * @param ip Inode that shall be truncated.
+ * 
+ * @note The inode must be locked.
+ */
+PUBLIC void inode_truncate_ext2(struct inode *ip)
+{
+	/*
+	 * Device numbers and short symbolic
+	 * links are kept in block pointers.
+	 */
+	if (ip->u.ext2.nsectors != 0)
+	{
+		for (unsigned j = 0; j < EXT2_NDIR_BLOCKS; j++)
+			ext2_block_free(ip->sb, ip->u.ext2.block[j], 0);
+		ext2_block_free(ip->sb, ip->u.ext2.block[EXT2_IND_BLOCK], 1);
+		ext2_block_free(ip->sb, ip->u.ext2.block[EXT2_DIND_BLOCK], 2);
+		ext2_block_free(ip->sb, ip->u.ext2.block[EXT2_TIND_BLOCK], 3);
+		
+		for (unsigned j = 0; j < EXT2_N_BLOCKS; j++)
+			ip->u.ext2.block[j] = 0;
+		ip->u.ext2.nsectors = 0;
+	}
+	
+	ip->size = 0;
+	inode_touch(ip);
+}
+
+/**
+ * @brief Allocates an inode.
+ * 
+ * @details Allocates an inode in the file system that is associated to the 
+ *          superblock pointed to by @p sb.
+ * 
+ * @param sb Superblock where the inode shall be allocated.
+ * @param ip Inode of the cache which is allocated.
+ * 
+ * @returns Upon successful completion zero is returned. Upon failure, non-zero
+ *          is returned instead.
+ * 
+ * @note The superblock must not be locked.
+ */
+PUBLIC int inode_alloc_ext2(struct superblock *sb, struct inode *ip)
+{
+	ino_t num;                  /* Inode number.      */
+	bit_t bit;                  /* Bit in the bitmap. */
+	struct buffer *buf;         /* Working buffer.    */
+	struct ext2_inode *d_i;     /* Disk inode.        */
+	struct ext2_group_desc *gd; /* Group descriptor.  */
+	struct ext2_sb_info *info;  /* File system info.  */
+	
+	superblock_lock(sb);
+	
+	info = &sb->u.ext2;
+	
+	/* Search for free inode. */
+	for (unsigned group = 0; group < info->ngroups; group++)
+	{
+		buf = ext2_group_get(sb, group, &gd);
+		
+		/* Skip full groups. */
+		if (gd->bg_free_inodes_count == 0)
+		{
+			brelse(buf);
+			continue;
+		}
+		
+		bit = ext2_bitmap_alloc(sb, gd->bg_inode_bitmap, info->inodes_per_group);
+		
+		/* Found. */
+		if (bit != BITMAP_FULL)
+		{
+			gd->bg_free_inodes_count--;
+			buffer_dirty(buf, 1);
+			brelse(buf);
+			
+			num = group*info->inodes_per_group + bit + 1;
+			goto found;
+		}
+		
+		brelse(buf);
+	}
+	
+	superblock_unlock(sb);
+	curr_proc->errno = -ENOSPC;
+	return (1);
+	
+found:
+	
+	EXT2_DSB(sb)->s_free_inodes_count--;
+	buffer_dirty(sb->buf, 1);
+	sb->flags |= SUPERBLOCK_DIRTY;
+	
+	/* Clear disk inode. */
+	buf = ext2_inode_get(sb, num, &d_i);
+	kmemset(d_i, 0, info->inode_size);
+	buffer_dirty(buf, 1);
+	brelse(buf);
+	
+	/* 
+	 * Initialize inode. 
+	 * mode will be initialized later.
+	 */
+	ip->nlinks = 1;
+	ip->uid = curr_proc->euid;
+	ip->gid = curr_proc->egid;
+	ip->size = 0;
+	for (unsigned j = 0; j < NR_ZONES; j++)
+		ip->blocks[j] = BLOCK_NULL;
+	for (unsigned j = 0; j < EXT2_N_BLOCKS; j++)
+		ip->u.ext2.block[j] = 0;
+	ip->u.ext2.nsectors = 0;
+	ip->u.ext2.flags = 0;
+	ip->u.ext2.dtime = 0;
+	ip->dev = sb->dev;
+	ip->num = num;
+	ip->sb = sb;
+	ip->flags &= ~(INODE_MOUNT | INODE_PIPE);
+	ip->flags |= INODE_VALID;
+	ip->i_op = &inode_o_ext2;
+	
+	superblock_unlock(sb);
+	
+	return (0);
+}
+
+/**
+ * @brief ext2 file system operations.
+ */
+PRIVATE struct super_operations super_o_ext2 = 
+{
+		&inode_read_ext2,			/* inode_read 		*/ 
+		&inode_write_ext2,			/* inode_write 		*/
+		&inode_free_ext2,			/* inode_free 		*/
+		&inode_truncate_ext2,		/* inode_truncate 	*/
+		&inode_alloc_ext2,			/* inode_alloc 		*/
+		NULL,						/* notify_change 	*/
+		NULL,						/* put inode 		*/
+		&superblock_put_ext2,		/* put_super 		*/
+		&superblock_write_ext2,		/* write_super 		*/
+		&superblock_stat_ext2,		/* superblock_stat 	*/
+		NULL 						/* remount_fs 		*/
+};
+
+PUBLIC struct inode_operations inode_o_ext2 =
+{
+	&dir_read_ext2,
+	&dir_add_ext2,
+	&dir_remove_ext2,
+	&file_read_ext2,
+	&file_write_ext2,
+	&dirent_search_ext2,
+	&readpage_ext2,
+	&file_readv_ext2,
+	&file_writev_ext2
+};
+
+PRIVATE struct file_system_type fs_ext2 = {
+	superblock_read_ext2,
+	&super_o_ext2,
+	"ext2",
+	0
+};
+
+PUBLIC struct super_operations *so_ext2(void)
+{
+	return (&super_o_ext2);
+}
+
+/**
+ * @brief Initialise the file system in the virtual file system.
+ */
+PUBLIC void init_ext2(void)
+{
+	if (fs_register(EXT2, &fs_ext2))
+		kpanic("Failed to register ext2 file system");
+}
@@ -0,0 +1,255 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file
+ * 
+ * @brief ext2 superblock module implementation.
+ * 
+ * @details Revision 0 and 1 file systems with 1 KB, 2 KB or 4 KB blocks are
+ *          supported, as long as they only use features that do not change
+ *          the layout of blocks, inodes and directories. Such images can be
+ *          built on a Linux host with mke2fs -t ext2, and checked back with
+ *          e2fsck.
+ */
+
+#include <nanvix/clock.h>
+#include <nanvix/config.h>
+#include <nanvix/const.h>
+#include <nanvix/fs.h>
+#include <nanvix/klib.h>
+#include <limits.h>
+#include <ustat.h>
+#include "../fs.h"
+#include "ext2.h"
+
+/**
+ * @brief Supported incompatible features.
+ */
+#define EXT2_FEATURE_INCOMPAT_SUPP \
+	EXT2_FEATURE_INCOMPAT_FILETYPE
+
+/**
+ * @brief Supported read-only compatible features.
+ */
+#define EXT2_FEATURE_RO_COMPAT_SUPP \
+	(EXT2_FEATURE_RO_COMPAT_SPARSE_SUPER | EXT2_FEATURE_RO_COMPAT_LARGE_FILE)
+
+/**
+ * @brief Writes superblock to underlying device.
+ * 
+ * @details Writes the superblock pointed to by @p sb back. Group descriptors
+ *          and bitmaps live in ordinary buffers, and are written back along
+ *          with them.
+ * 
+ * @param sb Superblock to be written back to disk.
+ * 
+ * @note The superblock must be valid.
+ * @note The superblock must be locked.
+ */
+PUBLIC void superblock_write_ext2(struct superblock *sb)
+{
+	EXT2_DSB(sb)->s_wtime = CURRENT_TIME;
+	
+	buffer_share(sb->buf);
+	bwrite(sb->buf);
+}
+
+/**
+ * @brief Releases a superblock.
+ * 
+ * @details Releases a superblock. If its reference count drops to zero, the
+ *          file system is marked as cleanly unmounted, the superblock buffer
+ *          is released and then the superblock is marked as invalid.
+ * 
+ * @param sb Superblock to be released.
+ * 
+ * @note The superblock must be valid.
+ * @note The superblock must be locked.
+ */
+PUBLIC void superblock_put_ext2(struct superblock *sb)
+{
+	/* Double free. */
+	if (sb->count == 0)
+		kpanic("freeing superblock twice");
+	
+	/* Release underlying resources. */
+	if (--sb->count == 0)
+	{
+		EXT2_DSB(sb)->s_state |= EXT2_VALID_FS;
+		superblock_write_ext2(sb);
+		
+		brelse(sb->buf);
+		
+		sb->flags &= ~SUPERBLOCK_VALID;
+	}
+}
+
+/**
+ * @brief Reads a superblock from a device.
+ * 
+ * @details Reads the superblock of an ext2 file system from a device. Once
+ *          the read has completed, the magic number and the features of the
+ *          file system are asserted and in-core fields are filled.
+ * 
+ * @param dev Device number.
+ * @param sb  In-core superblock.
+ * 
+ * @returns Upon successful completion, @p sb is returned. Upon failure, a
+ *          #NULL pointer is returned instead.
+ */
+PUBLIC struct superblock *superblock_read_ext2(dev_t dev, struct superblock *sb)
+{
+	struct buffer *buf;             /* Buffer disk superblock. */
+	struct ext2_super_block *d_sb;  /* Disk superblock.        */
+	struct ext2_sb_info *info;      /* File system info.       */
+	
+	/* Read superblock from device. */
+	buf = bread(dev, EXT2_SUPER_OFFSET >> BLOCK_SIZE_LOG2);
+	d_sb = (struct ext2_super_block *)buffer_data(buf);
+	
+	/* Bad magic number. */
+	if (d_sb->s_magic != EXT2_SUPER_MAGIC)
+		goto error0;
+	
+	/* Unsupported features. */
+	if ((d_sb->s_rev_level > EXT2_DYNAMIC_REV) ||
+		(d_sb->s_feature_incompat & ~EXT2_FEATURE_INCOMPAT_SUPP) ||
+		(d_sb->s_feature_ro_compat & ~EXT2_FEATURE_RO_COMPAT_SUPP))
+	{
+		kprintf("fs: unsupported ext2 features");
+		goto error0;
+	}
+	
+	/* Unsupported block size. */
+	if (d_sb->s_log_block_size > EXT2_MAX_BLOCK_LOG_SIZE - EXT2_MIN_BLOCK_LOG_SIZE)
+	{
+		kprintf("fs: unsupported ext2 block size");
+		goto error0;
+	}
+	
+	info = &sb->u.ext2;
+	info->log_ratio = d_sb->s_log_block_size;
+	info->block_size = BLOCK_SIZE << info->log_ratio;
+	info->blocks_count = d_sb->s_blocks_count;
+	info->first_data_block = d_sb->s_first_data_block;
+	info->blocks_per_group = d_sb->s_blocks_per_group;
+	info->inodes_per_group = d_sb->s_inodes_per_group;
+	info->incompat = d_sb->s_feature_incompat;
+	if (d_sb->s_rev_level == EXT2_GOOD_OLD_REV)
+	{
+		info->inode_size = EXT2_GOOD_OLD_INODE_SIZE;
+		info->first_ino = EXT2_GOOD_OLD_FIRST_INO;
+	}
+	else
+	{
+		info->inode_size = d_sb->s_inode_size;
+		info->first_ino = d_sb->s_first_ino;
+	}
+	
+	/* Inodes must not span buffers. */
+	if ((info->inode_size < EXT2_GOOD_OLD_INODE_SIZE) ||
+		(info->inode_size > BLOCK_SIZE) ||
+		(info->inode_size & (info->inode_size - 1)))
+	{
+		kprintf("fs: unsupported ext2 inode size");
+		goto error0;
+	}
+	
+	/* Bad geometry. */
+	if ((info->blocks_per_group == 0) || (info->inodes_per_group == 0) ||
+		(info->blocks_per_group > (info->block_size << 3)) ||
+		(info->inodes_per_group > (info->block_size << 3)) ||
+		(info->blocks_count <= info->first_data_block))
+	{
+		kprintf("fs: bad ext2 geometry");
+		goto error0;
+	}
+	
+	/* Too many inodes or blocks. */
+	if (((ino_t)d_sb->s_inodes_count != d_sb->s_inodes_count) ||
+		(((info->blocks_count << info->log_ratio) >> info->log_ratio) != info->blocks_count))
+	{
+		kprintf("fs: ext2 file system is too large");
+		goto error0;
+	}
+	
+	info->ngroups = (info->blocks_count - info->first_data_block + 
+		info->blocks_per_group - 1)/info->blocks_per_group;
+	
+	/* Not cleanly unmounted. */
+	if (!(d_sb->s_state & EXT2_VALID_FS) || (d_sb->s_state & EXT2_ERROR_FS))
+		kprintf("fs: ext2 file system was not cleanly unmounted");
+	
+	/* Mark file system as in use. */
+	d_sb->s_state &= ~EXT2_VALID_FS;
+	d_sb->s_mnt_count++;
+	d_sb->s_mtime = CURRENT_TIME;
+	buffer_dirty(buf, 1);
+	
+	/* Initialize superblock. */
+	sb->buf = buf;
+	sb->ninodes = d_sb->s_inodes_count;
+	sb->imap_blocks = 0;
+	sb->zmap_blocks = 0;
+	sb->first_data_block = info->first_data_block;
+	sb->max_size = LONG_MAX;
+	sb->zones = 0;
+	sb->root = NULL;
+	sb->root_ino = EXT2_ROOT_INO;
+	sb->mp = NULL;
+	sb->dev = dev;
+	sb->flags &= ~(SUPERBLOCK_DIRTY | SUPERBLOCK_RDONLY);
+	sb->flags |= SUPERBLOCK_VALID;
+	sb->isearch = 0;
+	sb->zsearch = 0;
+	sb->chain = NULL;
+	sb->count++;
+	sb->s_op = so_ext2();
+	
+	blkunlock(buf);
+	
+	return (sb);
+	
+error0:
+	brelse(buf);
+	return (NULL);
+}
+
+/**
+ * @brief Gets file system statistics.
+ * 
+ * @param sb   Superblock of the file system to be inspected.
+ * @param ubuf Place where statics should be stored.
+ * 
+ * @note The superblock must be valid.
+ * @note The superblock must be locked.
+ * @note The buffer must be valid.
+ */
+PUBLIC void superblock_stat_ext2(struct superblock *sb, struct ustat *ubuf)
+{
+	struct ext2_super_block *d_sb; /* Disk superblock. */
+	
+	d_sb = EXT2_DSB(sb);
+	
+	ubuf->f_tfree = d_sb->s_free_blocks_count;
+	ubuf->f_tinode = d_sb->s_free_inodes_count;
+	kstrcpy(ubuf->f_fname, "ext2");
+	kstrncpy(ubuf->f_fpack, d_sb->s_volume_name, sizeof(ubuf->f_fpack) - 1);
+	ubuf->f_fpack[sizeof(ubuf->f_fpack) - 1] = '\0';
+}
@@ -34,10 +34,20 @@
  */
 PUBLIC int dir_remove(struct inode *dinode, const char *filename)
 {
+	int ret;
+
 	/* Check if the operation is valid */
 	if (!dinode || !dinode->i_op || !dinode->i_op->dir_remove)
 		return 0;
-	return dinode->i_op->dir_remove(dinode, filename);
+
+	dcache_remove(dinode, filename);
+	ret = dinode->i_op->dir_remove(dinode, filename);
+
+	/* The name is known to be gone now. */
+	if (ret == 0)
+		dcache_enter(dinode, filename, INODE_NULL);
+
+	return (ret);
 }
 
 /*
@@ -45,10 +55,19 @@ PUBLIC int dir_remove(struct inode *dinode, const char *filename)
  */
 PUBLIC int dir_add(struct inode *dinode, struct inode *inode, const char *name)
 {
+	int ret;
+
 	/* Check if the operation is valid */
 	if (!dinode || !dinode->i_op || !dinode->i_op->dir_add)
 		return 0;
-	return dinode->i_op->dir_add(dinode, inode, name);
+
+	dcache_remove(dinode, name);
+	ret = dinode->i_op->dir_add(dinode, inode, name);
+
+	if (ret == 0)
+		dcache_enter(dinode, name, inode->num);
+
+	return (ret);
 }
 
 /*
@@ -103,12 +122,158 @@ PUBLIC ssize_t file_write(struct inode *i, const void *buf, size_t n, off_t off)
 	return retour;
 }
 
+/*
+ * Copies data between a buffer and an I/O vector.
+ */
+PUBLIC void iov_copy(struct iovec *iov, int iovcnt, void *buf, size_t n, int out)
+{
+	size_t chunk; /* Data chunk size. */
+	char *p;      /* Buffer pointer.  */
+	
+	p = buf;
+	
+	/* Elements are consumed in place. */
+	for (int j = 0; (j < iovcnt) && (n > 0); j++)
+	{
+		chunk = (n < iov[j].iov_len) ? n : iov[j].iov_len;
+		
+		if (out)
+			kmemcpy(iov[j].iov_base, p, chunk);
+		else
+			kmemcpy(p, iov[j].iov_base, chunk);
+		
+		iov[j].iov_base = (char *)iov[j].iov_base + chunk;
+		iov[j].iov_len -= chunk;
+		
+		n -= chunk;
+		p += chunk;
+	}
+}
+
+/*
+ * Zeroes part of an I/O vector.
+ */
+PUBLIC void iov_zero(struct iovec *iov, int iovcnt, size_t n)
+{
+	size_t chunk; /* Data chunk size. */
+	
+	/* Elements are consumed in place. */
+	for (int j = 0; (j < iovcnt) && (n > 0); j++)
+	{
+		chunk = (n < iov[j].iov_len) ? n : iov[j].iov_len;
+		
+		kmemset(iov[j].iov_base, 0, chunk);
+		
+		iov[j].iov_base = (char *)iov[j].iov_base + chunk;
+		iov[j].iov_len -= chunk;
+		
+		n -= chunk;
+	}
+}
+
+/*
+ * Reads from a regular file into an I/O vector.
+ */
+PUBLIC ssize_t file_readv(struct inode *i, struct iovec *iov, int iovcnt, off_t off)
+{
+	ssize_t count; /* Bytes read.  */
+	ssize_t ret;   /* Return value. */
+	
+	/* Check if the operation is valid */
+	if (!i || !i->i_op || !i->i_op->file_read)
+		return 0;
+	
+	inode_lock(i);
+	
+	/* Read all buffers at once. */
+	if (i->i_op->file_readv != NULL)
+		count = i->i_op->file_readv(i, iov, iovcnt, off);
+	
+	/* Read one buffer at a time. */
+	else
+	{
+		count = 0;
+		for (int j = 0; j < iovcnt; j++)
+		{
+			ret = i->i_op->file_read(i, iov[j].iov_base, iov[j].iov_len, off);
+			
+			if (ret < 0)
+			{
+				count = (count > 0) ? count : ret;
+				break;
+			}
+			
+			count += ret;
+			off += ret;
+			
+			/* End of file reached. */
+			if ((size_t)ret < iov[j].iov_len)
+				break;
+		}
+	}
+	
+	inode_touch(i);
+	inode_unlock(i);
+	
+	return (count);
+}
+
+/*
+ * Writes to a regular file from an I/O vector.
+ */
+PUBLIC ssize_t file_writev(struct inode *i, struct iovec *iov, int iovcnt, off_t off)
+{
+	ssize_t count; /* Bytes written. */
+	ssize_t ret;   /* Return value.  */
+	
+	/* Check if the operation is valid */
+	if (!i || !i->i_op || !i->i_op->file_write)
+		return 0;
+	
+	inode_lock(i);
+	
+	/* Write all buffers at once. */
+	if (i->i_op->file_writev != NULL)
+		count = i->i_op->file_writev(i, iov, iovcnt, off);
+	
+	/* Write one buffer at a time. */
+	else
+	{
+		count = 0;
+		for (int j = 0; j < iovcnt; j++)
+		{
+			ret = i->i_op->file_write(i, iov[j].iov_base, iov[j].iov_len, off);
+			
+			if (ret < 0)
+			{
+				count = (count > 0) ? count : ret;
+				break;
+			}
+			
+			count += ret;
+			off += ret;
+			
+			/* No room left. */
+			if ((size_t)ret < iov[j].iov_len)
+				break;
+		}
+	}
+	
+	inode_touch(i);
+	inode_unlock(i);
+	
+	return (count);
+}
+
 PUBLIC ino_t dir_search(struct inode *ip, const char *filename)
 {
 	struct buffer *buf; /* Block buffer.    */
 	struct d_dirent *d; /* Directory entry. */
+	ino_t num;          /* Inode number.    */
 	int i;
 
+	i = 0;
+
 	/* Cross mount point*/
 	if ((ip->flags & INODE_MOUNT) && (kstrcmp (filename,"..")) )
 	{
@@ -122,15 +287,26 @@ PUBLIC ino_t dir_search(struct inode *ip, const char *filename)
 		i = 1;
 	}
 	
+	/* Search directory entry cache. */
+	if (!dcache_lookup(ip, filename, &num))
+		goto out;
+
 	/* Search directory entry. */
 	d = ip->i_op->dirent_search(ip,filename, &buf, 0);
 
-	if (d == NULL)
-		return (INODE_NULL);
+	num = INODE_NULL;
+	if (d != NULL)
+	{
+		num = d->d_ino;
+		if (buf != NULL)
+			brelse(buf);
+	}
 	
-	brelse(buf);
+	dcache_enter(ip, filename, num);
+
+out:
 	if (i == 1)
 		inode_unlock(ip);
 	
-	return (d->d_ino);
-}
\ No newline at end of file
+	return (num);
+}
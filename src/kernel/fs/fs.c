@@ -138,10 +138,8 @@ PUBLIC mode_t permission(mode_t mode, uid_t uid, gid_t gid, struct process *proc
  */
 PUBLIC char *getname(const char *name)
 {
-	int ch;        /* Temporary character. */
-	char *kname;   /* Kernel user name.    */
-	const char *r; /* Read pointer.        */
-	char *w;       /* Write pointer.       */
+	ssize_t len; /* File name length. */
+	char *kname; /* Kernel user name. */
 	
 	/* Grab a kernel page. */
 	if ((kname = getkpg(0)) == NULL)
@@ -151,29 +149,20 @@ PUBLIC char *getname(const char *name)
 	}
 
 	/* Copy user file name. */
-	for (r = name, w = kname; (ch = fubyte(r)) != '\0'; r++, w++)
-	{	
-		/* Bad user file name. */
-		if (ch < 0)
-		{
-			putkpg(kname);
-			curr_proc->errno = -EFAULT;
-			return (NULL);
-			
-		}
-		
-		/* File name too long. */
-		if ((w - kname) > PAGE_SIZE - 1)
-		{
-			putkpg(kname);
-			curr_proc->errno = -ENAMETOOLONG;
-			return (NULL);
-		}
-		
-		*w = ch;
+	if ((len = strncpy_from_user(kname, name, PAGE_SIZE)) < 0)
+	{
+		putkpg(kname);
+		curr_proc->errno = len;
+		return (NULL);
 	}
 
-	*w = '\0';
+	/* File name too long. */
+	if (len == PAGE_SIZE)
+	{
+		putkpg(kname);
+		curr_proc->errno = -ENAMETOOLONG;
+		return (NULL);
+	}
 	
 	return (kname);
 }
@@ -193,6 +182,7 @@ PUBLIC void fs_init(void)
 {
 	binit();
 	inode_init();
+	dcache_init();
 	superblock_init();
 	
 	/* Sanity check. */
@@ -47,6 +47,18 @@
   /* Forward definitions. */
   EXTERN void inode_init(void);
 
+/*============================================================================*
+ *                        Directory Entry Cache Library                       *
+ *============================================================================*/
+
+  /* Forward definitions. */
+  EXTERN void dcache_init(void);
+  EXTERN int dcache_lookup(struct inode *, const char *, ino_t *);
+  EXTERN void dcache_enter(struct inode *, const char *, ino_t);
+  EXTERN void dcache_remove(struct inode *, const char *);
+  EXTERN void dcache_invalidate(struct inode *);
+  EXTERN void dcache_flush(dev_t);
+
 /*============================================================================*
  *                            Super Block Library                             *
  *============================================================================*/
@@ -112,15 +124,19 @@
     off_t max_size;                 /**< Maximum file size.            */
     block_t zones;                  /**< Number of zones.              */
     struct inode *root;             /**< Inode for root directory.     */
+    ino_t root_ino;                 /**< Root directory inode number.  */
     struct inode *mp;               /**< Inode mounted on.             */
     dev_t dev;                      /**< Underlying device.            */
     enum superblock_flags flags;    /**< Flags.                        */
     ino_t isearch;                  /**< Inodes below this are in use. */
     block_t zsearch;                /**< Zones below this are in use.  */
+    unsigned ifree[IMAP_SIZE];      /**< Free inodes per map block.    */
+    unsigned zfree[ZMAP_SIZE];      /**< Free zones per map block.     */
     struct thread *chain;           /**< Waiting chain.                */
     struct super_operations *s_op;  /**< Super operation of filesystem */
     union {
     	struct d_superblock minix;
+    	struct ext2_sb_info ext2;
     } u;
   };
 
@@ -135,8 +151,14 @@
     struct superblock *(*superblock_read) (dev_t, struct superblock *);  /**< Function to read the superblock        */
     struct super_operations *so;                                         /**< Stucture of file system's functio      */
     char *name;                                                          /**< Name of the file system                */
+    int flags;                                                           /**< File system flags                      */
   };
 
+  /**
+   * @brief File system that is not backed by a device.
+   */
+  #define FS_NODEV (1 << 0)
+
   /**
    * @brief Mounting point.
    */
@@ -153,11 +175,13 @@
    * @brief Number of the file system.
    */
   #define MINIX 0
+  #define TMPFS 1
+  #define EXT2  2
   
   /**
    * @brief Maximum nunber of file system.
    */
-  #define NR_FILE_SYSTEM 1
+  #define NR_FILE_SYSTEM 3
 
   /**
    * @brief Function too register file system in the virtual file system .
@@ -170,6 +194,7 @@
   //PUBLIC struct inode * mountRoot ();
   PUBLIC void mountRoot();
   PUBLIC struct file_system_type *fs_from_device (dev_t);
+  EXTERN struct superblock *superblock_read_fs(dev_t, struct file_system_type *);
   /**@}*/
 
 #endif /* _FS_H_ */
@@ -35,6 +35,8 @@
 #include <nanvix/syscall.h>
 #include "fs.h"
 #include "minix/minix.h"
+#include "tmpfs/tmpfs.h"
+#include "ext2/ext2.h"
 
 #include <sys/fcntl.h>
 
@@ -222,6 +224,64 @@ PUBLIC struct inode * cross_mount_point_down (struct  inode * ip)
 		
 }
 
+/**
+ * @brief Searches for a file system that is not backed by a device.
+ *
+ * @param name Name of the file system.
+ *
+ * @returns A pointer to the file system, or NULL if there is no such file
+ * system.
+ */
+PRIVATE struct file_system_type *fs_nodev(const char *name)
+{
+	for (int i = 0; i < NR_FILE_SYSTEM; i++)
+	{
+		if ((file_system_table[i] != NULL) 
+			&& (file_system_table[i]->flags & FS_NODEV)
+			&& !kstrcmp(file_system_table[i]->name, name))
+			return (file_system_table[i]);
+	}
+	return (NULL);
+}
+
+/**
+ * @brief Gets a device number for a file system that has no device.
+ *
+ * @returns A device number that is not in the mount table, or NULL_DEV if 
+ * there is none left.
+ */
+PRIVATE dev_t nodev_alloc(void)
+{
+	dev_t dev;
+
+	for (unsigned minor = 0; minor < 16; minor++)
+	{
+		dev = DEVID(NODEV_MAJOR, minor, BLKDEV);
+		if (fs_from_device(dev) == NULL)
+			return (dev);
+	}
+	return (NULL_DEV);
+}
+
+/**
+ * @brief Asserts if files of a device are in use.
+ *
+ * @param dev Target device.
+ *
+ * @returns Non-zero if some in-core inode of the device is in use, and zero
+ * otherwise.
+ */
+PRIVATE int dev_busy(dev_t dev)
+{
+	for (struct inode *ip = &inodes[0]; ip < &inodes[NR_INODES]; ip++)
+	{
+		if ((ip->count > 0) && (ip->flags & INODE_VALID) 
+			&& !(ip->flags & INODE_PIPE) && (ip->dev == dev))
+			return (1);
+	}
+	return (0);
+}
+
 /*
  * Converts a path name to inode but do not transverse mount point.
  */
@@ -266,7 +326,8 @@ PRIVATE struct inode *inode_nameb(const char *pathname)
  * 
  * @details insert a new mouting point in the mouting table.
  * 
- * @returns return 0 in sucess, and 1 if something went wrong.
+ * @returns return 0 in sucess, and a negative error code if something went
+ * wrong.
  *
  * @todo there is a probleme in the function mount try to access to the two same inodes. 
  */
@@ -281,6 +342,7 @@ PUBLIC int mount (char *device, char *mountPoint)
 	int dev;						/* The number of the device to be mounted				*/	 
 	int num_root;					/* Number of the root inode 							*/
 	int num_mount;					/* Number of the mount inode 							*/
+	int err;						/* Error code 											*/
 
 	inode_root_fs = NULL;
 	inode_mount = NULL;
@@ -291,26 +353,41 @@ PUBLIC int mount (char *device, char *mountPoint)
 
 	/* No space available on the mounting point table */
 	if ((ind_mp < 0) || (ind_mp > NR_MOUNTING_POINT))
-		return 1;
-
-	/* Get the inode of the device */
-	inode_device = inode_nameb (device); 
+		return (-EBUSY);
 
-	/* Problem with device inode */
-	if (inode_device == NULL)
+	/* File system without a device */
+	if ((fs = fs_nodev (device)) != NULL)
 	{
-		kprintf ("Device inode not found.");
-		return 1;
+		dev = nodev_alloc ();
+		if (dev == NULL_DEV)
+		{
+			kprintf ("No more devices for %s.", device);
+			return (-ENODEV);
+		}
 	}
 
-	/* Check if it's a device */
-	if (!S_ISCHR (inode_device->mode) && !S_ISBLK (inode_device->mode) && inode_device->num != 1)
+	else
 	{
-		kprintf ("What you provided is not a device.");
-		goto error0;
+		/* Get the inode of the device */
+		inode_device = inode_nameb (device); 
+
+		/* Problem with device inode */
+		if (inode_device == NULL)
+		{
+			kprintf ("Device inode not found.");
+			return (curr_proc->errno);
+		}
+
+		/* Check if it's a device */
+		if (!S_ISCHR (inode_device->mode) && !S_ISBLK (inode_device->mode) && inode_device->num != 1)
+		{
+			kprintf ("What you provided is not a device.");
+			inode_put (inode_device);
+			return (-ENODEV);
+		}
+		dev = inode_device->blocks[0];
+		inode_put (inode_device);
 	}
-	dev = inode_device->blocks[0];
-	inode_put (inode_device);
 	
 	/* Get the inode of the mount point */
 	inode_mount = inode_nameb (mountPoint);
@@ -319,13 +396,14 @@ PUBLIC int mount (char *device, char *mountPoint)
 	if (inode_mount == NULL)
 	{
 		kprintf("Mount inode not found.");
-		goto error1;
+		return (curr_proc->errno);
 	}
 	
 	/* Check if the mount inode is a directory */
 	if (!S_ISDIR (inode_mount->mode))
 	{
 		kprintf ("Mount inode is not a directory.");
+		err = -ENOTDIR;
 		goto error1;
 	}
 
@@ -333,14 +411,27 @@ PUBLIC int mount (char *device, char *mountPoint)
 	if (is_mounting_point (inode_mount) != NULL)
 	{
 		kprintf("An other device is already mounted on this directory.");
+		err = -EBUSY;
+		goto error1;
+	}
+
+	/* Create the file system */
+	if (fs != NULL)
+	{
+		sb = superblock_read_fs (dev, fs);
+		if (sb != NULL)
+			goto found;
+
+		kprintf ("Failed to create the file system.");
+		err = -EINVAL;
 		goto error1;
 	}
 
 	/* Search which file system is on the device */
 	for (int i = 0; i < NR_FILE_SYSTEM; i++){
-		if (file_system_table[i] != NULL)
+		if ((file_system_table[i] != NULL) && !(file_system_table[i]->flags & FS_NODEV))
 		{
-			sb = superblock_read (dev); 
+			sb = superblock_read_fs (dev, file_system_table[i]); 
 			if (sb != NULL)
 			{
 				fs = file_system_table[i];
@@ -349,10 +440,14 @@ PUBLIC int mount (char *device, char *mountPoint)
 		}
 	}
 	kprintf ("The file system of the device is not recognized.");
+	err = -EINVAL;
 	goto error1;
 
 found:
 
+	/* Forget names cached from a previous file system on the device. */
+	dcache_flush(dev);
+
 	/* Insert the mouting point in the mount table */
 	mount_table[ind_mp].dev = dev;
 	mount_table[ind_mp].fs = fs;
@@ -362,14 +457,15 @@ found:
 	inode_mount->flags |=INODE_MOUNT;
 	
 	inode_put (inode_mount);
+	num_root = sb->root_ino;
 	superblock_unlock (sb);
 
 	/* Get the root inode of the file system */
-	inode_root_fs = inode_get(dev,1);
+	inode_root_fs = inode_get(dev,num_root);
 	
 	if(inode_root_fs == NULL){
 		mount_table[ind_mp].free = 1;
-		return 1;
+		return (-EIO);
 	}
 
 	num_root = inode_root_fs->num;
@@ -379,14 +475,9 @@ found:
 	mount_table[ind_mp].no_inode_mount = num_mount;
 	
 	return 0;
-error0:
-	if (inode_root_fs != NULL ){
-		inode_put (inode_root_fs);
-	}
 error1:
-	if (inode_mount != NULL)
-		inode_put (inode_mount);
-	return 1;
+	inode_put (inode_mount);
+	return (err);
 }
 
 /**
@@ -394,14 +485,18 @@ error1:
  * 
  * @details remove a mouting point of the mouting table.
  * 
- * @returns return 0 in sucess, and 1 if something went wrong.
+ * @returns return 0 in sucess, and a negative error code if something went
+ * wrong.
  *
  */
 
 PUBLIC int unmount (char *mountPoint)
 {
 	struct inode *inode_mount;
+	struct superblock *sb;
+	dev_t dev;
 	int ind;
+	int err;
 			
 	inode_mount = NULL;
 
@@ -412,13 +507,14 @@ PUBLIC int unmount (char *mountPoint)
 	if (inode_mount == NULL)
 	{
 		kprintf("Mount inode not found.");
-		goto error;
+		return (curr_proc->errno);
 	}
 	
 	/* Check if the mount inode is a directory */
 	if (!S_ISDIR (inode_mount->mode))
 	{
 		kprintf("Mount inode is not a directory.");
+		err = -ENOTDIR;
 		goto error;
 	}
 
@@ -433,16 +529,36 @@ PUBLIC int unmount (char *mountPoint)
 		}
 	}
 	kprintf("This mounting point does not exist in the mount table.");
+	err = -EINVAL;
 	goto error;
 found: 
+	dev = mount_table[ind].dev;
+
+	/* Files of the device are still in use */
+	if (dev_busy(dev))
+	{
+		kprintf("The device is busy.");
+		err = -EBUSY;
+		goto error;
+	}
+
+	pcache_flush(dev);
+	dcache_flush(dev);
+
+	/* Release the superblock read at mount time */
+	if ((sb = superblock_get(dev)) != NULL)
+	{
+		sb->count--;
+		superblock_put(sb);
+	}
+
 	mount_table[ind].free = 1;
 	inode_mount->flags &= ~INODE_MOUNT;
 	inode_put (inode_mount);
 	return 0;
 error:	
-	if (inode_mount != NULL)
-		inode_put (inode_mount);
-	return 1;
+	inode_put (inode_mount);
+	return (err);
 
 }
 
@@ -650,6 +766,27 @@ PUBLIC void inode_unlock(struct inode *ip)
 	ip->flags &= ~INODE_LOCKED;
 }
 
+/**
+ * @brief Frees preallocated disk blocks of a file system.
+ * 
+ * @details Gives back the disk blocks that are preallocated to in-core
+ *          inodes of the file system pointed to by @p sb. Inodes are not
+ *          locked, since preallocated blocks are only handed out and freed
+ *          with the superblock locked.
+ * 
+ * @param sb Target superblock.
+ * 
+ * @note The superblock must be locked.
+ */
+PUBLIC void inode_prealloc_free(struct superblock *sb)
+{
+	for (struct inode *ip = &inodes[0]; ip < &inodes[NR_INODES]; ip++)
+	{
+		if ((ip->sb == sb) && (ip->pa_count > 0))
+			block_prealloc_free(ip);
+	}
+}
+
 /**
  * @brief Synchronizes the in-core inode table.
  * 
@@ -708,6 +845,7 @@ PUBLIC void inode_truncate(struct inode *ip)
 	if (fs->so->inode_truncate == NULL)
 		kpanic("Operation not supported by the file system.");
 
+	pcache_invalidate(ip);
 	fs->so->inode_truncate(ip);
 }
 
@@ -745,10 +883,6 @@ PUBLIC struct inode *inode_alloc(struct superblock *sb)
 		kpanic("No super operation in the superblock.");
 	}
 
-	/* Allocate inode. */
-	if (inode_alloc_minix(sb,ip))
-		return (NULL);
-	
 	/* Operation not supported. */
 	if (sb->s_op->inode_alloc == NULL)
 		kpanic("Operation not supported by the file system.");
@@ -831,6 +965,8 @@ PUBLIC int inode_rename(const char* pathname, const char* newname)
 	const char *filename;
 
 	semdirectory = inode_dname(pathname, &filename);
+	dcache_remove(semdirectory, filename);
+	dcache_remove(semdirectory, newname);
 	inode_unlock(semdirectory);
 	nentries = semdirectory->size/sizeof(struct d_dirent);
 	i = 0;
@@ -975,8 +1111,14 @@ PUBLIC void inode_put(struct inode *ip)
 			if (fs == NULL)
 				kpanic ("File system not recognized.");
 
+			if (fs->so->put_inode != NULL)
+				fs->so->put_inode(ip);
+
 			if (ip->nlinks == 0)
 			{
+				/* Inode number may be reused. */
+				if (S_ISDIR(ip->mode))
+					dcache_invalidate(ip);
 				inode_free(ip,fs);
 				inode_truncate(ip);
 			}
@@ -1311,6 +1453,8 @@ PUBLIC void inode_init(void)
 
 	/*Initialize FileSystemTable*/
 	init_minix();
+	init_tmpfs();
+	init_ext2();
 
 	/*Initialize MountTable*/
 	init_mount_table();
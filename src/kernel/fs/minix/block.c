@@ -31,36 +31,57 @@
  */
 
 /**
- * @brief Allocates a disk block.
+ * @brief Reserves a run of disk blocks.
  * 
- * @details Allocates a disk block by searching in the bitmap of blocks for a
- *          free block.
+ * @details Searches in the bitmap of blocks for a free block, preferring the
+ *          block numbered @p goal, and reserves it along with the free blocks
+ *          that immediately follow it, up to #NR_PREALLOC_BLOCKS blocks.
  * 
- * @param sb Superblock in which the disk block should be allocated.
+ * @param sb      Superblock in which the disk blocks should be reserved.
+ * @param goal    Preferred disk block.
+ * @param nblocks Location where the number of reserved blocks shall be stored.
  * 
- * @return Upon successful completion, the block number of the allocated block
- *         is returned. Upon failed, #BLOCK_NULL is returned instead.
+ * @return Upon successful completion, the block number of the first reserved
+ *         block is returned. Upon failed, #BLOCK_NULL is returned instead.
  * 
  * @note The superblock must be locked.
  */
-PRIVATE block_t block_alloc(struct superblock *sb)
+PRIVATE block_t block_reserve(struct superblock *sb, block_t goal, unsigned *nblocks)
 {
-	bit_t bit;          /* Bit number in the bitmap. */
-	block_t num;        /* Block number.             */
-	block_t blk;        /* Working block.            */
-	block_t firstblk;   /* First block to check.     */
-	struct buffer *buf; /* Working buffer.           */
+	bit_t bit;        /* Bit number in the bitmap. */
+	unsigned n;       /* Number of blocks.         */
+	block_t num;      /* Block number.             */
+	block_t blk;      /* Working block.            */
+	block_t firstblk; /* First block to check.     */
+	uint32_t *map;    /* Working bitmap.           */
+
+	/* Try to continue previous run. */
+	if ((goal >= sb->first_data_block) && (goal < sb->zones))
+	{
+		bit = goal - sb->first_data_block;
+		blk = bit/(BLOCK_SIZE << 3);
+		bit = bit%(BLOCK_SIZE << 3);
+		
+		if (!bitmap_test(buffer_data(sb->zmap[blk]), bit))
+			goto found;
+	}
 
 	/* Search for a free block. */
 	firstblk = (sb->zsearch - sb->first_data_block)/(BLOCK_SIZE << 3);
+	if (firstblk >= sb->zmap_blocks)
+		firstblk = 0;
 	blk = firstblk;
 	do
 	{
-		bit = bitmap_first_free(buffer_data(sb->zmap[blk]), BLOCK_SIZE);
-		
-		/* Found. */
-		if (bit != BITMAP_FULL)
-			goto found;
+		/* Skip full blocks. */
+		if (sb->zfree[blk] != 0)
+		{
+			bit = bitmap_first_free(buffer_data(sb->zmap[blk]), BLOCK_SIZE);
+			
+			/* Found. */
+			if (bit != BITMAP_FULL)
+				goto found;
+		}
 		
 		/* Wrap around. */
 		blk = (blk + 1 < sb->zmap_blocks) ? blk + 1 : 0;
@@ -71,22 +92,74 @@ PRIVATE block_t block_alloc(struct superblock *sb)
 found:
 
 	num =  sb->first_data_block + bit + blk*(BLOCK_SIZE << 3);
+	map = buffer_data(sb->zmap[blk]);
+	
+	/* Reserve free blocks that follow. */
+	n = 0;
+	do
+	{
+		bitmap_set(map, bit + n);
+		n++;
+	} while ((n < NR_PREALLOC_BLOCKS) && (bit + n < (BLOCK_SIZE << 3)) &&
+		(num + n < sb->zones) && (!bitmap_test(map, bit + n)));
+	
+	sb->zfree[blk] -= n;
+	buffer_dirty(sb->zmap[blk], 1);
+	sb->flags |= SUPERBLOCK_DIRTY;
 	
 	/* 
 	 * Remember disk block number to 
 	 * speedup next block allocation.
 	 */
-	sb->zsearch = num;
+	if ((num != goal) || (num == sb->zsearch))
+		sb->zsearch = num + n;
 	
-	/* Allocate block. */
-	bitmap_set(buffer_data(sb->zmap[blk]), bit);
-	buffer_dirty(sb->zmap[blk], 1);
-	sb->flags |= SUPERBLOCK_DIRTY;
+	*nblocks = n;
+	
+	return (num);
+}
+
+/**
+ * @brief Allocates a disk block.
+ * 
+ * @details Allocates a disk block to the file pointed to by @p ip. Blocks are
+ *          handed out from a run that is preallocated to the file, so that
+ *          files that grow in parallel still come out physically contiguous.
+ *          When the run is exhausted, a new one is reserved, right after the
+ *          previous one if possible.
+ * 
+ * @param ip File to which the disk block should be allocated.
+ * 
+ * @return Upon successful completion, the block number of the allocated block
+ *         is returned. Upon failed, #BLOCK_NULL is returned instead.
+ * 
+ * @note The file must be locked.
+ * @note The superblock must be locked.
+ */
+PRIVATE block_t block_alloc(struct inode *ip)
+{
+	block_t num;        /* Block number.   */
+	struct buffer *buf; /* Working buffer. */
+
+	/* Preallocate a new run. */
+	if (ip->pa_count == 0)
+	{
+		num = block_reserve(ip->sb, ip->pa_next, &ip->pa_count);
+		
+		if (num == BLOCK_NULL)
+			return (BLOCK_NULL);
+		
+		ip->pa_next = num;
+	}
+	
+	num = ip->pa_next++;
+	ip->pa_count--;
 	
-	/* Clean block to avoid security issues. */
-	buf = bread(sb->dev, blk);	
-	kmemset(buffer_data(buf), 0, BLOCK_SIZE);
-	buffer_dirty(buf, 1);
+	/*
+	 * Clean block to avoid security issues.
+	 * There is no need to read it in before.
+	 */
+	buf = bnew(ip->sb->dev, num);
 	brelse(buf);
 	
 	return (num);
@@ -130,6 +203,7 @@ PRIVATE void block_free_direct(struct superblock *sb, block_t num)
 	
 	/* Free disk block. */
 	bitmap_clear(buffer_data(sb->zmap[idx]), off);
+	sb->zfree[idx]++;
 	buffer_dirty(sb->zmap[idx], 1);
 	sb->flags |= SUPERBLOCK_DIRTY;
 }
@@ -232,6 +306,27 @@ PUBLIC void block_free(struct superblock *sb, block_t num, int lvl)
 	}
 }
 
+/**
+ * @brief Frees preallocated disk blocks.
+ * 
+ * @details Gives back to the file system the disk blocks that were
+ *          preallocated to the file pointed to by @p ip but not used. The
+ *          next run is still sought right after the last allocated block.
+ * 
+ * @param ip Target file.
+ * 
+ * @note The file must be locked.
+ * @note The superblock must be locked.
+ */
+PUBLIC void block_prealloc_free(struct inode *ip)
+{
+	/* Free unused blocks. */
+	for (unsigned i = 0; i < ip->pa_count; i++)
+		block_free_direct(ip->sb, ip->pa_next + i);
+	
+	ip->pa_count = 0;
+}
+
 /**
  * @brief Create an indirect block.
  *
@@ -256,7 +351,7 @@ PUBLIC block_t create_indirect_block
 	{
 		/* Allocate an block. */
 		superblock_lock(ip->sb);
-		phys = block_alloc(ip->sb);
+		phys = block_alloc(ip);
 		superblock_unlock(ip->sb);
 
 		if (phys != BLOCK_NULL)
@@ -302,7 +397,7 @@ PUBLIC block_t create_direct_block(struct inode *ip, off_t offset, int create)
 	{
 		/* Allocate an block. */
 		superblock_lock(ip->sb);
-		phys = block_alloc(ip->sb);
+		phys = block_alloc(ip);
 		superblock_unlock(ip->sb);
 
 		if (phys != BLOCK_NULL)
@@ -318,6 +413,134 @@ PUBLIC block_t create_direct_block(struct inode *ip, off_t offset, int create)
 		return (ip->blocks[offset]);
 }
 
+/**
+ * @brief Invalidates the block map cache of a file.
+ * 
+ * @details Drops the cached indirect block and block translations of the
+ *          file pointed to by @p ip. This should be called whenever blocks
+ *          are taken away from the file.
+ * 
+ * @param ip Target file.
+ * 
+ * @note @p ip must be locked.
+ */
+PUBLIC void block_map_invalidate(struct inode *ip)
+{
+	ip->bm_blk = BLOCK_NULL;
+	ip->bm_count = 0;
+}
+
+/**
+ * @brief Caches block translations of a file.
+ * 
+ * @details Copies the translations that start at entry @p idx of the
+ *          indirect block @p map, which is the last used indirect block of
+ *          the file pointed to by @p ip, to the block map cache of the file.
+ * 
+ * @param ip  Target file.
+ * @param map Contents of the indirect block.
+ * @param idx First entry to cache.
+ * 
+ * @note @p ip must be locked.
+ */
+PRIVATE void block_map_fill(struct inode *ip, const block_t *map, unsigned idx)
+{
+	ip->bm_count = 0;
+	ip->bm_logic = ip->bm_first + idx;
+	
+	while ((idx < NR_SINGLE) && (ip->bm_count < NR_BMAP_CACHE))
+		ip->bm_map[ip->bm_count++] = map[idx++];
+}
+
+/**
+ * @brief Looks up a block translation in the block map cache.
+ * 
+ * @param ip    Target file.
+ * @param logic Logical block number.
+ * 
+ * @returns A pointer to the cached translation of the logical block @p logic
+ *          of the file pointed to by @p ip, or a #NULL pointer if there is
+ *          none.
+ * 
+ * @note @p ip must be locked.
+ */
+PRIVATE inline block_t *block_map_cached(struct inode *ip, unsigned logic)
+{
+	if ((logic < ip->bm_logic) || (logic - ip->bm_logic >= ip->bm_count))
+		return (NULL);
+	
+	return (&ip->bm_map[logic - ip->bm_logic]);
+}
+
+/**
+ * @brief Gets the indirect block that maps a logical block.
+ * 
+ * @details Looks up the indirect block that holds the translation of the
+ *          logical block @p logic of the file pointed to by @p ip. If
+ *          @p create is not zero, missing indirect blocks are allocated
+ *          along the way. The indirect block that is found is remembered, so
+ *          that later lookups in the same indirect block do not walk the
+ *          double indirect zone again.
+ * 
+ * @param ip     Target file.
+ * @param logic  Logical block number, past the direct zone.
+ * @param create Create missing indirect blocks?
+ * 
+ * @returns Upon successful completion, the disk block number of the indirect
+ *          block is returned, and ip->bm_first holds the logical block
+ *          number that is mapped by its first entry. Otherwise, #BLOCK_NULL
+ *          is returned instead.
+ * 
+ * @note @p ip must be locked.
+ */
+PRIVATE block_t block_map_indirect(struct inode *ip, unsigned logic, int create)
+{
+	block_t phys;       /* Physical block number. */
+	unsigned first;     /* First mapped block.    */
+	struct buffer *buf; /* Double indirect block. */
+	
+	/* Last used indirect block. */
+	if ((ip->bm_blk != BLOCK_NULL) &&
+		(logic >= ip->bm_first) && (logic - ip->bm_first < NR_SINGLE))
+		return (ip->bm_blk);
+	
+	logic -= NR_ZONES_DIRECT;
+	
+	/* Single indirect zone. */
+	if (logic < NR_SINGLE)
+	{
+		phys = create_direct_block(ip, ZONE_SINGLE, create);
+		first = NR_ZONES_DIRECT;
+	}
+	
+	/* Double indirect zone. */
+	else if ((logic -= NR_SINGLE) < NR_DOUBLE)
+	{
+		/* We cannot go any further. */
+		if ((phys = create_direct_block(ip, ZONE_DOUBLE, create)) == BLOCK_NULL)
+			return (BLOCK_NULL);
+		
+		buf = bread(ip->dev, phys);
+		phys = create_indirect_block(buf, ip, logic/NR_SINGLE, create);
+		first = NR_ZONES_DIRECT + NR_SINGLE + (logic/NR_SINGLE)*NR_SINGLE;
+	}
+	
+	/* Triple indirect zone. */
+	else
+	{
+		kpanic("triple indirect zones not supported");
+		return (BLOCK_NULL);
+	}
+	
+	if (phys != BLOCK_NULL)
+	{
+		ip->bm_blk = phys;
+		ip->bm_first = first;
+	}
+	
+	return (phys);
+}
+
 /**
  * @brief Maps a file byte offset in a disk block number.
  * 
@@ -337,10 +560,12 @@ PUBLIC block_t create_direct_block(struct inode *ip, off_t offset, int create)
  */
 PUBLIC block_t block_map(struct inode *ip, off_t off, int create)
 {
-	block_t phys;       /* Physical block number.    */
-	block_t logic;      /* Logical block number.     */
-	struct buffer *buf; /* Underlying buffer.        */
-	unsigned tmp;       /* Logical block number tmp. */
+	block_t phys;       /* Physical block number. */
+	unsigned logic;     /* Logical block number.  */
+	block_t *map;       /* Indirect block.        */
+	block_t *cached;    /* Cached translation.    */
+	unsigned idx;       /* Indirect block entry.  */
+	struct buffer *buf; /* Underlying buffer.     */
 	
 	logic = off/BLOCK_SIZE;
 	
@@ -360,103 +585,119 @@ PUBLIC block_t block_map(struct inode *ip, off_t off, int create)
 	
 	/* Direct block. */
 	if (logic < NR_ZONES_DIRECT)
+		return (create_direct_block(ip, logic, create));
+	
+	/* Cached translation. */
+	if ((cached = block_map_cached(ip, logic)) != NULL)
 	{
-		/* Create direct block. */
-		if (ip->blocks[logic] == BLOCK_NULL && create)
+		if ((*cached != BLOCK_NULL) || (!create))
+			return (*cached);
+	}
+	
+	/* We cannot go any further. */
+	if ((phys = block_map_indirect(ip, logic, create)) == BLOCK_NULL)
+		return (BLOCK_NULL);
+	
+	buf = bread(ip->dev, phys);
+	map = buffer_data(buf);
+	idx = logic - ip->bm_first;
+	
+	/* Create direct block. */
+	if ((map[idx] == BLOCK_NULL) && (create))
+	{
+		superblock_lock(ip->sb);
+		phys = block_alloc(ip);
+		superblock_unlock(ip->sb);
+		
+		if (phys != BLOCK_NULL)
 		{
-			superblock_lock(ip->sb);
-			phys = block_alloc(ip->sb);
-			superblock_unlock(ip->sb);
-			
-			if (phys != BLOCK_NULL)
-			{
-				ip->blocks[logic] = phys;
-				inode_touch(ip);
-			}
+			map[idx] = phys;
+			buffer_dirty(buf, 1);
+			inode_touch(ip);
 		}
-		
-		return (ip->blocks[logic]);
 	}
 	
-	logic -= NR_ZONES_DIRECT;
+	phys = map[idx];
+	block_map_fill(ip, map, idx);
+	brelse(buf);
 	
-	/* Single indirect block. */
-	if (logic < NR_SINGLE)
+	return (phys);
+}
+
+/**
+ * @brief Maps a run of file blocks in disk block numbers.
+ * 
+ * @details Maps up to @p n consecutive blocks of the file pointed to by
+ *          @p ip, starting at the one that holds the offset @p off, in disk
+ *          block numbers. Each indirect block is read at most once, so a run
+ *          costs about as much as a single call to block_map(). Holes are
+ *          mapped to #BLOCK_NULL and are not filled in.
+ * 
+ * @param ip   File to use.
+ * @param off  File byte offset.
+ * @param blks Location where the disk block numbers shall be stored.
+ * @param n    Number of blocks to map.
+ * 
+ * @returns The number of blocks that were mapped, which is less than @p n
+ *          only if the run goes past the maximum file size.
+ * 
+ * @note @p ip must be locked.
+ */
+PUBLIC unsigned block_map_range(struct inode *ip, off_t off, block_t *blks, unsigned n)
+{
+	block_t phys;       /* Physical block number. */
+	unsigned logic;     /* Logical block number.  */
+	block_t *map;       /* Indirect block.        */
+	block_t *cached;    /* Cached translation.    */
+	unsigned idx;       /* Indirect block entry.  */
+	unsigned count;     /* Blocks mapped.         */
+	struct buffer *buf; /* Underlying buffer.     */
+	
+	count = 0;
+	logic = off/BLOCK_SIZE;
+	
+	while ((count < n) && ((off_t)logic <= (ip->sb->max_size - 1)/BLOCK_SIZE))
 	{
-		/* Create single indirect block. */
-		if (ip->blocks[ZONE_SINGLE] == BLOCK_NULL && create)
+		/* Direct block. */
+		if (logic < NR_ZONES_DIRECT)
 		{
-			superblock_lock(ip->sb);
-			phys = block_alloc(ip->sb);
-			superblock_unlock(ip->sb);
-			
-			if (phys != BLOCK_NULL)
-			{
-				ip->blocks[ZONE_SINGLE] = phys;
-				inode_touch(ip);
-			}
+			blks[count++] = ip->blocks[logic++];
+			continue;
 		}
 		
-		/* We cannot go any further. */
-		if ((phys = ip->blocks[ZONE_SINGLE]) == BLOCK_NULL)
-			return (BLOCK_NULL);
-	
-		buf = bread(ip->dev, phys);
-		
-		/* Create direct block. */
-		if (((block_t *)buffer_data(buf))[logic] == BLOCK_NULL && create)
+		/* Cached translation. */
+		if ((cached = block_map_cached(ip, logic)) != NULL)
 		{
-			superblock_lock(ip->sb);
-			phys = block_alloc(ip->sb);
-			superblock_unlock(ip->sb);
-			
-			if (phys != BLOCK_NULL)
-			{
-				((block_t *)buffer_data(buf))[logic] = phys;
-				buffer_dirty(buf, 1);
-				inode_touch(ip);
-			}
+			blks[count++] = *cached;
+			logic++;
+			continue;
 		}
 		
-		brelse(buf);
+		/* Hole. */
+		if ((phys = block_map_indirect(ip, logic, 0)) == BLOCK_NULL)
+		{
+			blks[count++] = BLOCK_NULL;
+			logic++;
+			continue;
+		}
 		
-		return (((block_t *)buffer_data(buf))[logic]);
-	}
-	
-	logic = off - REMAINING_OFFSET;
-	
-	/* Double indirect block. */
-	tmp = logic / BLOCK_SIZE;
-	if (tmp < NR_DOUBLE)
-	{
-		size_t logicSingle = logic / (NR_SINGLE * BLOCK_SIZE);
-		size_t logicDouble = logic / BLOCK_SIZE;
+		buf = bread(ip->dev, phys);
+		map = buffer_data(buf);
 		
-		/* Create single, double and/or direct block. */
-		if ( (phys = create_direct_block(ip,ZONE_DOUBLE,create)) != BLOCK_NULL)
+		for (idx = logic - ip->bm_first; (idx < NR_SINGLE) && (count < n); idx++)
 		{
-			buf = bread(ip->dev, phys);
-			if ( (phys = create_indirect_block(buf,ip,logicSingle,create)) 
-				!= BLOCK_NULL)
-			{
-				buf = bread(ip->dev, phys);
-				if ( (phys = create_indirect_block(buf,ip,logicDouble,create)) 
-					!= BLOCK_NULL)
-					return (phys);
-				else
-					return (BLOCK_NULL);
-			}
-			else
-				return (BLOCK_NULL);
+			blks[count++] = map[idx];
+			logic++;
 		}
-		else
-			return (BLOCK_NULL);
+		
+		/* Cache translations of the blocks that follow. */
+		if (idx < NR_SINGLE)
+			block_map_fill(ip, map, idx);
+		
+		brelse(buf);
 	}
-
-	/* Triple indirect zone. */
-	kpanic("triple indirect zones not supported");
 	
-	return (BLOCK_NULL);
+	return (count);
 }
 
 /**@}*/
@@ -23,6 +23,7 @@
 #include <nanvix/const.h>
 #include <nanvix/fs.h>
 #include <nanvix/klib.h>
+#include <nanvix/mm.h>
 #include <sys/types.h>
 #include <dirent.h>
 #include <errno.h>
@@ -118,26 +119,40 @@ PUBLIC int dir_add_minix(struct inode *dinode, struct inode *inode, const char *
 }
 
 /*
- * Reads from a regular file.
+ * Reads from a regular file into an I/O vector, bypassing the page cache.
  */
-PUBLIC ssize_t file_read_minix(struct inode *i, void *buf, size_t n, off_t off)
+PRIVATE ssize_t file_readv_blocks
+(struct inode *i, struct iovec *iov, int iovcnt, size_t n, off_t off)
 {
-	char *p;             /* Writing pointer.      */
-	size_t blkoff;       /* Block offset.         */
-	size_t chunk;        /* Data chunk size.      */
-	block_t blk;         /* Working block number. */
-	struct buffer *bbuf; /* Working block buffer. */
-		
-	p = buf;
+	size_t blkoff;               /* Block offset.         */
+	size_t chunk;                /* Data chunk size.      */
+	ssize_t count;               /* Bytes read.           */
+	block_t blk;                 /* Working block number. */
+	block_t blks[NR_BMAP_CACHE]; /* Mapped blocks.        */
+	unsigned nblks, j;           /* Mapped blocks count.  */
+	struct buffer *bbuf;         /* Working block buffer. */
+	
+	count = 0;
+	nblks = j = 0;
 	
 	/* Read data. */
-	do
+	while ((n > 0) && (off < i->size))
 	{
-		blk = block_map(i, off, 0);
+		/* Map a run of blocks. */
+		if (j == nblks)
+		{
+			if ((nblks = block_map_range(i, off, blks, NR_BMAP_CACHE)) == 0)
+				break;
+			j = 0;
+		}
+		
+		/* Holes are filled in. */
+		if ((blk = blks[j++]) == BLOCK_NULL)
+			blk = block_map(i, off, 0);
 		
 		/* End of file reached. */
 		if (blk == BLOCK_NULL)
-			goto out;
+			break;
 		
 		bbuf = bread(i->dev, blk);
 			
@@ -146,25 +161,111 @@ PUBLIC ssize_t file_read_minix(struct inode *i, void *buf, size_t n, off_t off)
 		/* Calculate read chunk size. */
 		chunk = (n < BLOCK_SIZE - blkoff) ? n : BLOCK_SIZE - blkoff;
 		if ((off_t)chunk > i->size - off)
-		{
 			chunk = i->size - off;
-			if (chunk == 0)
-			{
-				brelse(bbuf);
-				goto out;
-			}
+		
+		iov_copy(iov, iovcnt, (char *)buffer_data(bbuf) + blkoff, chunk, 1);
+		brelse(bbuf);
+		
+		n -= chunk;
+		off += chunk;
+		count += chunk;
+	}
+	
+	return (count);
+}
+
+/*
+ * Reads a page of a regular file.
+ */
+PUBLIC int readpage_minix(struct inode *i, void *page, off_t off)
+{
+	char *p;                            /* Writing pointer.      */
+	size_t chunk;                       /* Data chunk size.      */
+	block_t blk;                        /* Working block number. */
+	block_t blks[PAGE_SIZE/BLOCK_SIZE]; /* Mapped blocks.        */
+	unsigned nblks, j;                  /* Mapped blocks count.  */
+	struct buffer *bbuf;                /* Working block buffer. */
+	
+	nblks = block_map_range(i, off, blks, PAGE_SIZE/BLOCK_SIZE);
+	
+	for (p = page, j = 0; p < (char *)page + PAGE_SIZE; p += BLOCK_SIZE, j++)
+	{
+		blk = ((off < i->size) && (j < nblks)) ? blks[j] : BLOCK_NULL;
+		
+		/* Hole or end of file. */
+		if (blk == BLOCK_NULL)
+		{
+			kmemset(p, 0, BLOCK_SIZE);
+			off += BLOCK_SIZE;
+			continue;
 		}
 		
-		kmemcpy(p, (char *)buffer_data(bbuf) + blkoff, chunk);
+		bbuf = bread(i->dev, blk);
+		
+		chunk = (i->size - off < BLOCK_SIZE) ? i->size - off : BLOCK_SIZE;
+		kmemcpy(p, buffer_data(bbuf), chunk);
+		kmemset(p + chunk, 0, BLOCK_SIZE - chunk);
 		brelse(bbuf);
 		
+		off += BLOCK_SIZE;
+	}
+	
+	return (0);
+}
+
+/*
+ * Reads from a regular file into an I/O vector.
+ */
+PUBLIC ssize_t file_readv_minix(struct inode *i, struct iovec *iov, int iovcnt, off_t off)
+{
+	char *pg;      /* Cached page.     */
+	size_t n;      /* Bytes to read.   */
+	size_t pgoff;  /* Page offset.     */
+	size_t chunk;  /* Data chunk size. */
+	ssize_t count; /* Bytes read.      */
+	
+	n = 0;
+	for (int j = 0; j < iovcnt; j++)
+		n += iov[j].iov_len;
+	
+	count = 0;
+	
+	/* Read data. */
+	while ((n > 0) && (off < i->size))
+	{
+		pgoff = off & ~PAGE_MASK;
+		
+		/* Page cache is full, so read blocks straight. */
+		if ((pg = pcache_get(i, off - pgoff)) == NULL)
+			return (count + file_readv_blocks(i, iov, iovcnt, n, off));
+		
+		/* Calculate read chunk size. */
+		chunk = (n < PAGE_SIZE - pgoff) ? n : PAGE_SIZE - pgoff;
+		if ((off_t)chunk > i->size - off)
+			chunk = i->size - off;
+		
+		iov_copy(iov, iovcnt, pg + pgoff, chunk, 1);
+		pcache_put(pg);
+		
 		n -= chunk;
 		off += chunk;
-		p += chunk;
-	} while (n > 0);
+		count += chunk;
+	}
+	
+	return (count);
+}
 
-out:
-	return ((ssize_t)(p - (char *)buf));
+/*
+ * Reads from a regular file.
+ */
+PUBLIC ssize_t file_read_minix(struct inode *i, void *buf, size_t n, off_t off)
+{
+	struct iovec iov; /* I/O vector. */
+	
+	iov.iov_base = buf;
+	iov.iov_len = n;
+	
+	return (file_readv_minix(i, &iov, 1, off));
 }
 
 /*
@@ -219,39 +320,55 @@ out:
 }
 
 /*
- * Writes to a regular file.
+ * Writes to a regular file from an I/O vector.
  */
-PUBLIC ssize_t file_write_minix(struct inode *i, const void *buf, size_t n, off_t off)
+PUBLIC ssize_t file_writev_minix(struct inode *i, struct iovec *iov, int iovcnt, off_t off)
 {
-	const char *p;       /* Reading pointer.      */
+	char *data;          /* Block data.           */
+	size_t n;            /* Bytes to write.       */
 	size_t blkoff;       /* Block offset.         */
 	size_t chunk;        /* Data chunk size.      */
+	ssize_t count;       /* Bytes written.        */
 	block_t blk;         /* Working block number. */
 	struct buffer *bbuf; /* Working block buffer. */
-		
-	p = buf;
+	
+	n = 0;
+	for (int j = 0; j < iovcnt; j++)
+		n += iov[j].iov_len;
+	
+	count = 0;
 	
 	/* Write data. */
-	do
+	while (n > 0)
 	{
 		blk = block_map(i, off, 1);
 		
 		/* End of file reached. */
 		if (blk == BLOCK_NULL)
-			goto out;
-		
-		bbuf = bread(i->dev, blk);
+			break;
 		
 		blkoff = off % BLOCK_SIZE;
 		
 		chunk = (n < BLOCK_SIZE - blkoff) ? n : BLOCK_SIZE - blkoff;
-		kmemcpy((char *)buffer_data(bbuf) + blkoff, buf, chunk);
+		
+		/*
+		 * The whole block is about to be overwritten,
+		 * so there is no need to read it in before.
+		 */
+		if (chunk == BLOCK_SIZE)
+			bbuf = bnew(i->dev, blk);
+		else
+			bbuf = bread(i->dev, blk);
+		
+		data = (char *)buffer_data(bbuf) + blkoff;
+		iov_copy(iov, iovcnt, data, chunk, 0);
+		pcache_update(i, off, data, chunk);
 		buffer_dirty(bbuf, 1);
 		brelse(bbuf);
 		
 		n -= chunk;
 		off += chunk;
-		p += chunk;
+		count += chunk;
 		
 		/* Update file size. */
 		if (off > i->size)
@@ -259,11 +376,270 @@ PUBLIC ssize_t file_write_minix(struct inode *i, const void *buf, size_t n, off_
 			i->size = off;
 			i->flags |= INODE_DIRTY;
 		}
-		
-	} while (n > 0);
+	}
+	
+	return (count);
+}
 
-out:
-	return ((ssize_t)(p - (char *)buf));
+/*
+ * Writes to a regular file.
+ */
+PUBLIC ssize_t file_write_minix(struct inode *i, const void *buf, size_t n, off_t off)
+{
+	struct iovec iov; /* I/O vector. */
+	
+	iov.iov_base = (void *)buf;
+	iov.iov_len = n;
+	
+	return (file_writev_minix(i, &iov, 1, off));
+}
+
+/**
+ * @brief Number of directory entries in a block.
+ */
+#define DIRENTS_PER_BLOCK (BLOCK_SIZE/sizeof(struct d_dirent))
+
+/**
+ * @brief Gets the index of a directory.
+ * 
+ * @param dip Target directory.
+ * 
+ * @returns If the directory is indexed, the (locked) buffer of its first
+ *          block is returned. Otherwise, a #NULL pointer is returned instead.
+ * 
+ * @note @p dip must be locked.
+ */
+PRIVATE struct buffer *diridx_get(struct inode *dip)
+{
+	struct buffer *buf;
+
+	/* Too small to be indexed. */
+	if ((dip->size < 2*BLOCK_SIZE) || (dip->blocks[0] == BLOCK_NULL))
+		return (NULL);
+
+	buf = bread(dip->dev, dip->blocks[0]);
+
+	if (!minix_diridx_valid(buffer_data(buf)))
+	{
+		brelse(buf);
+		return (NULL);
+	}
+
+	return (buf);
+}
+
+/**
+ * @brief Drops the index of a directory.
+ * 
+ * @details Clears the index slots of the first block of the directory, so
+ *          that it is searched linearly from now on. Leaf blocks are plain
+ *          directory blocks, so nothing else needs to be done.
+ * 
+ * @param ibuf Buffer of the first block of the directory.
+ */
+PRIVATE void diridx_drop(struct buffer *ibuf)
+{
+	struct d_diridx *idx = buffer_data(ibuf);
+
+	kmemset((char *)idx + 2*sizeof(struct d_dirent), 0,
+		BLOCK_SIZE - 2*sizeof(struct d_dirent));
+	buffer_dirty(ibuf, 1);
+}
+
+/**
+ * @brief Splits a full leaf block of an indexed directory.
+ * 
+ * @details Moves the upper half of the entries of the leaf block, as ordered
+ *          by the hash of their names, to a new block appended to the
+ *          directory, and indexes it right after the split block.
+ * 
+ * @param dip  Target directory.
+ * @param idx  Directory index.
+ * @param i    Index entry of the leaf block.
+ * @param lbuf Buffer of the leaf block.
+ * 
+ * @returns Zero upon successful completion, and non-zero otherwise.
+ */
+PRIVATE int diridx_split
+(struct inode *dip, struct d_diridx *idx, unsigned i, struct buffer *lbuf)
+{
+	uint32_t split;           /* Split hash.           */
+	block_t blk;              /* New leaf block.       */
+	uint16_t logic;           /* Logical block number. */
+	struct buffer *nbuf;      /* Buffer of new leaf.   */
+	struct d_dirent *d1, *d2; /* Leaf blocks.          */
+
+	/* Index is full. */
+	if (idx->h_count == DIRIDX_MAX)
+		return (-1);
+
+	d1 = buffer_data(lbuf);
+
+	/* All names have the same hash. */
+	if (minix_diridx_split(d1, &split))
+		return (-1);
+
+	logic = dip->size/BLOCK_SIZE;
+	if ((blk = block_map(dip, dip->size, 1)) == BLOCK_NULL)
+		return (-1);
+
+	nbuf = bread(dip->dev, blk);
+	d2 = buffer_data(nbuf);
+	kmemset(d2, 0, BLOCK_SIZE);
+
+	/* Move entries. */
+	for (unsigned j = 0; j < DIRENTS_PER_BLOCK; j++)
+	{
+		if (minix_name_hash(d1[j].d_name) >= split)
+		{
+			*d2++ = d1[j];
+			kmemset(&d1[j], 0, sizeof(struct d_dirent));
+		}
+	}
+
+	buffer_dirty(nbuf, 1);
+	brelse(nbuf);
+	buffer_dirty(lbuf, 1);
+
+	dip->size += BLOCK_SIZE;
+	inode_touch(dip);
+
+	minix_diridx_insert(idx, i + 1, split, logic);
+
+	return (0);
+}
+
+/**
+ * @brief Searches for a directory entry in an indexed directory.
+ * 
+ * @details Hashes @p filename and looks it up in the single leaf block that
+ *          the index points to. When a new entry does not fit in its leaf
+ *          block, the leaf block is split. If that is not possible, the
+ *          index is dropped.
+ * 
+ * @param dip      Directory where the directory entry shall be searched.
+ * @param ibuf     Buffer of the first block of the directory.
+ * @param filename Name of the directory entry that shall be searched.
+ * @param buf      Buffer where the directory entry is loaded.
+ * @param create   Create directory entry?
+ * @param d        Location where the directory entry shall be stored.
+ * 
+ * @returns Zero if the search was carried out, and non-zero if the directory
+ *          shall be searched linearly instead. In the former case, the
+ *          directory entry, or #NULL, is stored in the location pointed to by
+ *          @p d, as in dirent_search_minix().
+ * 
+ * @note @p ibuf is released.
+ */
+PRIVATE int dirent_search_indexed(struct inode *dip, struct buffer *ibuf,
+	const char *filename, struct buffer **buf, int create, struct d_dirent **d)
+{
+	unsigned i;           /* Index entry.       */
+	block_t blk;          /* Leaf block.        */
+	uint32_t hash;        /* Hash of file name. */
+	struct d_dirent *ent; /* Working entry.     */
+	struct d_dirent *fre; /* First free entry.  */
+	struct d_diridx *idx; /* Directory index.   */
+
+	idx = buffer_data(ibuf);
+	(*buf) = NULL;
+	(*d) = NULL;
+
+	/* "." and ".." live in the first block. */
+	if (!kstrcmp(filename, ".") || !kstrcmp(filename, ".."))
+	{
+		if (create)
+		{
+			brelse(ibuf);
+			curr_proc->errno = EEXIST;
+			return (0);
+		}
+
+		(*buf) = ibuf;
+		(*d) = (filename[1] == '\0') ? &idx->dot : &idx->dotdot;
+		return (0);
+	}
+
+	hash = minix_name_hash(filename);
+
+again:
+
+	i = minix_diridx_search(idx, hash);
+
+	/* Broken index. */
+	if ((minix_diridx_entry(idx, i)->blk == 0) ||
+		(minix_diridx_entry(idx, i)->blk*BLOCK_SIZE >= dip->size) ||
+		((blk = block_map(dip, minix_diridx_entry(idx, i)->blk*BLOCK_SIZE, 0))
+			== BLOCK_NULL))
+		goto linear;
+
+	(*buf) = bread(dip->dev, blk);
+	ent = buffer_data(*buf);
+
+	fre = NULL;
+	for (unsigned j = 0; j < DIRENTS_PER_BLOCK; j++, ent++)
+	{
+		/* Remember free entry. */
+		if (ent->d_ino == INODE_NULL)
+		{
+			if (fre == NULL)
+				fre = ent;
+			continue;
+		}
+
+		/* Found. */
+		if (!kstrncmp(ent->d_name, filename, NAME_MAX))
+		{
+			brelse(ibuf);
+
+			/* Duplicated entry. */
+			if (create)
+			{
+				brelse(*buf);
+				(*buf) = NULL;
+				curr_proc->errno = EEXIST;
+				return (0);
+			}
+
+			(*d) = ent;
+			return (0);
+		}
+	}
+
+	/* Not found. */
+	if (!create)
+	{
+		brelse(*buf);
+		(*buf) = NULL;
+		brelse(ibuf);
+		return (0);
+	}
+
+	/* Free entry found. */
+	if (fre != NULL)
+	{
+		brelse(ibuf);
+		(*d) = fre;
+		return (0);
+	}
+
+	/* Split leaf block. */
+	if (diridx_split(dip, idx, i, *buf))
+	{
+		brelse(*buf);
+		(*buf) = NULL;
+		goto linear;
+	}
+
+	buffer_dirty(ibuf, 1);
+	brelse(*buf);
+	(*buf) = NULL;
+	goto again;
+
+linear:
+	diridx_drop(ibuf);
+	brelse(ibuf);
+	return (-1);
 }
 
 /**
@@ -290,11 +666,19 @@ out:
 PUBLIC struct d_dirent *dirent_search_minix
 (struct inode *dip, const char *filename, struct buffer **buf, int create)
 {
-	int i;              /* Working directory entry index.       */
-	int entry;          /* Index of first free directory entry. */
-	block_t blk;        /* Working block number.                */
-	int nentries;       /* Number of directory entries.         */
-	struct d_dirent *d; /* Directory entry.                     */
+	int i;               /* Working directory entry index.       */
+	int entry;           /* Index of first free directory entry. */
+	block_t blk;         /* Working block number.                */
+	int nentries;        /* Number of directory entries.         */
+	struct d_dirent *d;  /* Directory entry.                     */
+	struct buffer *ibuf; /* First block of indexed directory.    */
+
+	/* Indexed directory. */
+	if ((ibuf = diridx_get(dip)) != NULL)
+	{
+		if (!dirent_search_indexed(dip, ibuf, filename, buf, create, &d))
+			return (d);
+	}
 
 	nentries = dip->size/sizeof(struct d_dirent);
 	
@@ -153,6 +153,9 @@ PUBLIC int inode_read_minix(dev_t dev, ino_t num, struct inode *ip)
 	ip->num = num;
 	ip->sb = sb;
 	ip->i_op = &inode_o_minix;
+	ip->pa_next = BLOCK_NULL;
+	ip->pa_count = 0;
+	block_map_invalidate(ip);
 	ip->flags &= ~(INODE_DIRTY | INODE_MOUNT | INODE_PIPE);
 	ip->flags |= INODE_VALID;
 	
@@ -184,6 +187,7 @@ PUBLIC void inode_free_minix(struct inode *ip)
 	superblock_lock(sb = ip->sb);
 	
 	bitmap_clear(buffer_data(sb->imap[blk]), (ip->num - 1)%(BLOCK_SIZE << 3));
+	sb->ifree[blk]++;
 	
 	buffer_dirty(sb->imap[blk], 1);
 	if (ip->num < sb->isearch)
@@ -209,6 +213,11 @@ PUBLIC void inode_truncate_minix(struct inode *ip)
 	
 	superblock_lock(sb = ip->sb);
 	
+	/* Free preallocated blocks. */
+	block_prealloc_free(ip);
+	ip->pa_next = BLOCK_NULL;
+	block_map_invalidate(ip);
+	
 	/* Free direct zone. */
 	for (unsigned j = 0; j < NR_ZONES_DIRECT; j++)
 	{
@@ -236,6 +245,23 @@ PUBLIC void inode_truncate_minix(struct inode *ip)
 	inode_touch(ip);
 }
 
+/**
+ * @brief Releases an inode.
+ * 
+ * @details Frees the disk blocks that were preallocated to the inode pointed
+ *          to by @p ip, once it is no longer in use.
+ * 
+ * @param ip Inode that shall be released.
+ * 
+ * @note The inode must be locked.
+ */
+PUBLIC void inode_put_minix(struct inode *ip)
+{
+	superblock_lock(ip->sb);
+	block_prealloc_free(ip);
+	superblock_unlock(ip->sb);
+}
+
 /**
  * @brief Allocates an inode.
  * 
@@ -264,6 +290,10 @@ PUBLIC int inode_alloc_minix(struct superblock *sb,struct inode *ip)
 	/* Search for free inode. */
 	for (i = 0; i < sb->imap_blocks; i++)
 	{
+		/* Skip full blocks. */
+		if (sb->ifree[i] == 0)
+			continue;
+		
 		bit = bitmap_first_free(buffer_data(sb->imap[i]), BLOCK_SIZE);
 		
 		/* Found. */
@@ -285,6 +315,7 @@ found:
 	
 	/* Allocate inode. */
 	bitmap_set(buffer_data(sb->imap[i]), bit);
+	sb->ifree[i]--;
 	buffer_dirty(sb->imap[i], 1);
 	sb->flags |= SUPERBLOCK_DIRTY;
 	
@@ -304,6 +335,9 @@ found:
 	ip->flags &= ~(INODE_MOUNT | INODE_PIPE);
 	ip->flags |= INODE_VALID;
 	ip->i_op = &inode_o_minix;
+	ip->pa_next = BLOCK_NULL;
+	ip->pa_count = 0;
+	block_map_invalidate(ip);
 	superblock_unlock(sb);
 
 	return (0);
@@ -569,7 +603,7 @@ PRIVATE struct super_operations super_o_minix =
 		&inode_truncate_minix,		/* inode_truncate 	*/
 		&inode_alloc_minix,			/* inode_alloc 		*/
 		NULL,						/* notify_change 	*/
-		NULL,						/* put inode 		*/
+		&inode_put_minix,			/* put inode 		*/
 		&superblock_put_minix,		/* put_super 		*/
 		&superblock_write_minix,	/* write_super 		*/
 		&superblock_stat_minix,		/* superblock_stat 	*/
@@ -583,13 +617,17 @@ PUBLIC struct inode_operations inode_o_minix =
 	&dir_remove_minix,
 	&file_read_minix,
 	&file_write_minix,
-	&dirent_search_minix
+	&dirent_search_minix,
+	&readpage_minix,
+	&file_readv_minix,
+	&file_writev_minix
 };
 
 PRIVATE struct file_system_type fs_minix = {
 	superblock_read_minix,
 	&super_o_minix,
-	"minix"
+	"minix",
+	0
 };
 
 PUBLIC struct super_operations * so_minix(void){
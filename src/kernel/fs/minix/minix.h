@@ -36,6 +36,7 @@
 	EXTERN int inode_alloc_minix(struct superblock *, struct inode *);
 	EXTERN void inode_free_minix(struct inode *);
 	EXTERN void inode_truncate_minix(struct inode *);
+	EXTERN void inode_put_minix(struct inode *);
 	
 	EXTERN void init_minix (void);
 	EXTERN int minix_mkfs(const char *, uint16_t, uint16_t, uint16_t, uint16_t);
@@ -52,6 +53,9 @@
 	PUBLIC int dir_remove_minix(struct inode *, const char *);
 	PUBLIC ssize_t file_read_minix(struct inode *, void *, size_t , off_t );
 	PUBLIC ssize_t file_write_minix(struct inode *, const void *, size_t , off_t);
+	PUBLIC ssize_t file_readv_minix(struct inode *, struct iovec *, int, off_t);
+	PUBLIC ssize_t file_writev_minix(struct inode *, struct iovec *, int, off_t);
+	PUBLIC int readpage_minix(struct inode *, void *, off_t);
 	EXTERN struct d_dirent *dirent_search_minix (struct inode *, const char *, struct buffer **, int);
 
 
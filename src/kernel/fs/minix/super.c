@@ -42,7 +42,9 @@
  * @brief Writes superblock to underlying device.
  * 
  * @details If the superblock is dirty, writes it to the underlying device.
- *          The inode and block maps are also written back.
+ *          The inode and block maps are also written back. Blocks that are
+ *          preallocated to open files are freed first, so that they are not
+ *          lost if the system stops before the files are closed.
  * 
  * @param sb Superblock to be written back to disk.
  * 
@@ -51,6 +53,8 @@
  */
 PUBLIC void superblock_write_minix(struct superblock *sb)
 {	
+	inode_prealloc_free(sb);
+
 	/* Write inode map buffers. */
 	for (unsigned i = 0; i < sb->imap_blocks; i++)
 	{
@@ -109,6 +113,23 @@ PUBLIC void superblock_put_minix(struct superblock *sb)
 	}
 }
 
+/**
+ * @brief Sets the padding bits of a map.
+ * 
+ * @details The last block of the inode and zone maps is seldom full. Bits
+ *          past the end of the file system are set, so that they are neither
+ *          handed out nor counted as free.
+ * 
+ * @param map     Blocks of the map.
+ * @param nblocks Number of blocks in the map.
+ * @param nbits   Number of valid bits in the map.
+ */
+PRIVATE void map_pad(struct buffer **map, unsigned nblocks, unsigned nbits)
+{
+	for (unsigned bit = nbits; bit < nblocks*(BLOCK_SIZE << 3); bit++)
+		bitmap_set(buffer_data(map[bit/(BLOCK_SIZE << 3)]), bit%(BLOCK_SIZE << 3));
+}
+
 /**
  * @brief Reads a superblock from a device.
  * 
@@ -155,13 +176,21 @@ PUBLIC struct superblock *superblock_read_minix(dev_t dev, superblock * sb)
 	sb->imap_blocks = d_sb->s_imap_nblocks;
 	for (unsigned i = 0; i < sb->imap_blocks; i++)
 		blkunlock(sb->imap[i] = bread(dev, 2 + i));
+	map_pad(sb->imap, sb->imap_blocks, d_sb->s_ninodes);
+	for (unsigned i = 0; i < sb->imap_blocks; i++)
+		sb->ifree[i] = bitmap_nclear(buffer_data(sb->imap[i]), BLOCK_SIZE);
 	sb->zmap_blocks = d_sb->s_bmap_nblocks;
 	for (unsigned i = 0; i < sb->zmap_blocks; i++)
 		blkunlock(sb->zmap[i] = bread(dev, 2 + sb->imap_blocks + i));
+	map_pad(sb->zmap, sb->zmap_blocks,
+		d_sb->s_nblocks - d_sb->s_first_data_block);
+	for (unsigned i = 0; i < sb->zmap_blocks; i++)
+		sb->zfree[i] = bitmap_nclear(buffer_data(sb->zmap[i]), BLOCK_SIZE);
 	sb->first_data_block = d_sb->s_first_data_block;
 	sb->max_size = d_sb->s_max_size;
 	sb->zones = d_sb->s_nblocks;
 	sb->root = NULL;
+	sb->root_ino = INODE_ROOT;
 	sb->mp = NULL;
 	sb->dev = dev;
 	sb->flags &= ~(SUPERBLOCK_DIRTY | SUPERBLOCK_RDONLY);
@@ -197,28 +226,18 @@ error1:
  */
 PUBLIC void superblock_stat_minix(struct superblock *sb, struct ustat *ubuf)
 {
-	int tfree;     /* Total free blocks. */
-	int tinode;    /* Total free inodes. */
-	int bmap_size; /* Size of block map. */
-	int imap_size; /* Size of inode map. */
+	int tfree;  /* Total free blocks. */
+	int tinode; /* Total free inodes. */
 	
 	/* Count number of free blocks. */
 	tfree = 0;
-	bmap_size = sb->zmap_blocks;
-	for (int i = 0; i < bmap_size; i++)
-	{
-		for (int j = 0; j < (BLOCK_SIZE >> 2); j++)
-			tfree += bitmap_nclear(buffer_data(sb->zmap[i]), BLOCK_SIZE);
-	}
+	for (unsigned i = 0; i < sb->zmap_blocks; i++)
+		tfree += sb->zfree[i];
 	
 	/* Count number of free inodes. */
 	tinode = 0;
-	imap_size = sb->zmap_blocks;
-	for (int i = 0; i < imap_size; i++)
-	{
-		for (int j = 0; j < (BLOCK_SIZE >> 2); j++)
-			tinode += bitmap_nclear(buffer_data(sb->imap[i]), BLOCK_SIZE);
-	}
+	for (unsigned i = 0; i < sb->imap_blocks; i++)
+		tinode += sb->ifree[i];
 	
 	ubuf->f_tfree = tfree;
 	ubuf->f_tinode = tinode;
@@ -19,6 +19,7 @@
 
 #include <nanvix/const.h>
 #include <nanvix/fs.h>
+#include <nanvix/klib.h>
 #include <nanvix/pm.h>
 #include <errno.h>
 
@@ -28,6 +29,7 @@
 PUBLIC ssize_t pipe_read(struct inode *inode, char *buf, size_t n)
 {
 	char *r;
+	size_t chunk;
 	
 	r = buf;
 	
@@ -37,7 +39,7 @@ PUBLIC ssize_t pipe_read(struct inode *inode, char *buf, size_t n)
 		return (0);
 	
 	/* Read from pipe. */
-	while (n-- > 0)
+	while (n > 0)
 	{	
 		/* Sleep while pipe is empty. */
 		while (inode->head == inode->tail)
@@ -58,9 +60,17 @@ PUBLIC ssize_t pipe_read(struct inode *inode, char *buf, size_t n)
 			
 		}
 		
-		*r++ = inode->pipe[inode->tail];
-		inode->tail = (inode->tail + 1)%inode->size;
+		/* Read contiguous bytes at once. */
+		chunk = (inode->head > inode->tail) ? inode->head - inode->tail :
+			inode->size - inode->tail;
+		chunk = (n < chunk) ? n : chunk;
+		
+		kmemcpy(r, &inode->pipe[inode->tail], chunk);
+		inode->tail = (inode->tail + chunk)%inode->size;
 		wakeup(&inode->chain);
+		
+		r += chunk;
+		n -= chunk;
 	}
 	
 	return (r - buf);
@@ -73,6 +83,7 @@ PUBLIC ssize_t pipe_read(struct inode *inode, char *buf, size_t n)
 PUBLIC ssize_t pipe_write(struct inode *inode, const char *buf, size_t n)
 {
 	const char *w;
+	size_t chunk;
 	
 	w = buf;
 	
@@ -86,7 +97,7 @@ PUBLIC ssize_t pipe_write(struct inode *inode, const char *buf, size_t n)
 	}
 	
 	/* Write to pipe. */
-	while (n-- > 0)
+	while (n > 0)
 	{
 		/* Sleep while pipe is full. */
 		while ((inode->head + 1)%inode->size == inode->tail)
@@ -110,9 +121,17 @@ PUBLIC ssize_t pipe_write(struct inode *inode, const char *buf, size_t n)
 			}
 		}
 		
-		inode->pipe[inode->head] = *w++;
-		inode->head = (inode->head + 1)%inode->size;
+		/* Write contiguous bytes at once, leaving one slot free. */
+		chunk = (inode->tail > inode->head) ? inode->tail - inode->head - 1 :
+			inode->size - inode->head - ((inode->tail == 0) ? 1 : 0);
+		chunk = (n < chunk) ? n : chunk;
+		
+		kmemcpy(&inode->pipe[inode->head], w, chunk);
+		inode->head = (inode->head + chunk)%inode->size;
 		wakeup(&inode->chain);
+		
+		w += chunk;
+		n -= chunk;
 	}
 	
 	return (w - buf);
@@ -0,0 +1,259 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file
+ *
+ * @brief File splicing.
+ *
+ * @details Moves data between two open files inside the kernel, so that it
+ *          does not cross user space. Data of regular files is taken straight
+ *          from the page cache, and other files go through a kernel page.
+ */
+
+#include <nanvix/const.h>
+#include <nanvix/dev.h>
+#include <nanvix/fs.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <errno.h>
+
+/**
+ * @brief Reads data from a file that is not regular.
+ *
+ * @param f   Source file.
+ * @param buf Target buffer.
+ * @param n   Maximum number of bytes to read.
+ * @param pos File offset.
+ *
+ * @returns The number of bytes read is returned. Upon failure, a negative
+ *          error code is returned instead.
+ */
+PRIVATE ssize_t splice_read(struct file *f, char *buf, size_t n, off_t pos)
+{
+	size_t avail;    /* Bytes in the pipe. */
+	ssize_t count;   /* Bytes read.        */
+	struct inode *i; /* Source inode.      */
+
+	i = f->inode;
+
+	/* Character special file. */
+	if (S_ISCHR(i->mode))
+		return (cdev_read(i->blocks[0], buf, n));
+
+	/* Block special file. */
+	else if (S_ISBLK(i->mode))
+		count = bdev_read(i->blocks[0], buf, n, pos);
+
+	/*
+	 * Pipe file. Do not wait for more
+	 * data than there is in the pipe.
+	 */
+	else if (S_ISFIFO(i->mode))
+	{
+		avail = (i->head + i->size - i->tail)%i->size;
+		if ((avail > 0) && (avail < n))
+			n = avail;
+		count = pipe_read(i, buf, n);
+	}
+
+	/* Regular file. */
+	else if (S_ISREG(i->mode))
+		count = file_read(i, buf, n, pos);
+
+	/* Unknown file type. */
+	else
+		return (-EINVAL);
+
+	return ((count < 0) ? curr_proc->errno : count);
+}
+
+/**
+ * @brief Writes data to a file.
+ *
+ * @param f   Target file.
+ * @param buf Source buffer.
+ * @param n   Number of bytes to write.
+ * @param pos File offset.
+ *
+ * @returns The number of bytes written is returned. Upon failure, a negative
+ *          error code is returned instead.
+ */
+PRIVATE ssize_t splice_write(struct file *f, const char *buf, size_t n, off_t *pos)
+{
+	ssize_t count;   /* Bytes written. */
+	struct inode *i; /* Target inode.  */
+
+	i = f->inode;
+
+	/* Character special file. */
+	if (S_ISCHR(i->mode))
+		return (cdev_write(i->blocks[0], buf, n));
+
+	/* Block special file. */
+	else if (S_ISBLK(i->mode))
+		count = bdev_write(i->blocks[0], buf, n, *pos);
+
+	/* Pipe file. */
+	else if (S_ISFIFO(i->mode))
+		count = pipe_write(i, buf, n);
+
+	/* Regular file. */
+	else if (S_ISREG(i->mode))
+	{
+		/* Append mode. */
+		if (f->oflag & O_APPEND)
+			*pos = i->size;
+
+		count = file_write(i, buf, n, *pos);
+	}
+
+	/* Unknown file type. */
+	else
+		return (-EINVAL);
+
+	/* Failed to write. */
+	if (count < 0)
+		return (curr_proc->errno);
+
+	*pos += count;
+
+	return (count);
+}
+
+/**
+ * @brief Splices two files.
+ *
+ * @details Moves up to @p n bytes from the file pointed to by @p in, starting
+ *          at offset @p inpos, to the file pointed to by @p out, starting at
+ *          offset @p outpos. Offsets of pipes and character devices are not
+ *          used. Reading from a pipe or a terminal stops once it has no more
+ *          data at hand.
+ *
+ * @param in     Source file.
+ * @param inpos  Source file offset.
+ * @param out    Target file.
+ * @param outpos Target file offset.
+ * @param n      Number of bytes to move.
+ *
+ * @returns The number of bytes moved is returned, and the offsets are
+ *          advanced accordingly. Upon failure, a negative error code is
+ *          returned instead.
+ */
+PUBLIC ssize_t file_splice
+(struct file *in, off_t *inpos, struct file *out, off_t *outpos, size_t n)
+{
+	char *pg;        /* Cached page.        */
+	char *buf;       /* Bounce page.        */
+	char *data;      /* Data to be written. */
+	size_t pgoff;    /* Page offset.        */
+	size_t chunk;    /* Data chunk size.    */
+	ssize_t ret;     /* Return value.       */
+	ssize_t count;   /* Bytes moved.        */
+	struct inode *i; /* Source inode.       */
+
+	i = in->inode;
+	buf = NULL;
+	count = 0;
+
+	while (n > 0)
+	{
+		pg = NULL;
+		pgoff = 0;
+
+		/* Regular file. */
+		if (S_ISREG(i->mode))
+		{
+			inode_lock(i);
+
+			/* End of file reached. */
+			if (*inpos >= i->size)
+			{
+				inode_unlock(i);
+				break;
+			}
+
+			pgoff = *inpos & ~PAGE_MASK;
+			chunk = (n < PAGE_SIZE - pgoff) ? n : PAGE_SIZE - pgoff;
+			if ((off_t)chunk > i->size - *inpos)
+				chunk = i->size - *inpos;
+
+			/*
+			 * The page is held while it is written, so
+			 * the source inode may be unlocked meanwhile.
+			 */
+			pg = pcache_get(i, *inpos - pgoff);
+			inode_unlock(i);
+		}
+		else
+			chunk = (n < PAGE_SIZE) ? n : PAGE_SIZE;
+
+		/* Read data in a kernel page. */
+		if (pg == NULL)
+		{
+			if ((buf == NULL) && ((buf = getkpg(0)) == NULL))
+			{
+				ret = -ENOMEM;
+				goto error;
+			}
+
+			if ((ret = splice_read(in, buf, chunk, *inpos)) <= 0)
+				goto error;
+
+			chunk = ret;
+			data = buf;
+		}
+		else
+			data = pg + pgoff;
+
+		ret = splice_write(out, data, chunk, outpos);
+
+		if (pg != NULL)
+			pcache_put(pg);
+
+		/* Failed to write. */
+		if (ret < 0)
+			goto error;
+
+		*inpos += ret;
+		count += ret;
+		n -= ret;
+
+		/* Short write, or no data at hand. */
+		if (((size_t)ret < chunk) || S_ISCHR(i->mode))
+			break;
+		if (S_ISFIFO(i->mode) && (i->head == i->tail))
+			break;
+	}
+
+	if (buf != NULL)
+		putkpg(buf);
+
+	return (count);
+
+error:
+	if (buf != NULL)
+		putkpg(buf);
+
+	return ((count > 0) ? count : ret);
+}
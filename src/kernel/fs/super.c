@@ -218,6 +218,40 @@ PUBLIC void superblock_put(struct superblock *sb)
 	superblock_unlock(sb);
 }
 
+/**
+ * @brief Reads a superblock of a given file system from a device.
+ * 
+ * @details Reads the superblock of the file system pointed to by @p fs that
+ *          lies on the device @p dev, and fills in-core fields.
+ * 
+ * @param dev Device number.
+ * @param fs  File system.
+ * 
+ * @returns Upon successful completion, a pointer to the in-core superblock
+ *          is returned. The superblock is ensured to be locked in this case.
+ *          Upon failure, a NULL pointer is returned instead.
+ * 
+ * @note The device number should be valid.
+ */
+PUBLIC struct superblock *superblock_read_fs(dev_t dev, struct file_system_type *fs)
+{
+	struct superblock *sb; /* In-core superblock. */
+	
+	/* Get empty superblock. */
+	sb = superblock_empty();
+	if (sb == NULL)
+		return (NULL);
+	
+	/* Not this file system. */
+	if (fs->superblock_read(dev, sb) == NULL)
+	{
+		superblock_unlock(sb);
+		return (NULL);
+	}
+	
+	return (sb);
+}
+
 /**
  * @brief Reads a superblock from a device.
  * 
@@ -240,21 +274,18 @@ PUBLIC struct superblock *superblock_read(dev_t dev)
 
 	struct superblock *sb;     /* In-core superblock.     */
 	struct file_system_type *fs;
+	
+	/*Get the file_system of the device*/
+	fs = fs_from_device(dev);
+	if (fs != NULL)
+		return (superblock_read_fs(dev, fs));
 		
 	/* Get empty superblock. */	
 	sb = superblock_empty();
 	if (sb == NULL)
 		return NULL;
 
-	/*Get the file_system of the device*/
-	fs = fs_from_device(dev);
-	if (fs != NULL)
-	{
-		fs->superblock_read(dev,sb);	
-		return (sb);
-	}
-	else 
-		superblock_read_minix(dev,sb);
+	superblock_read_minix(dev,sb);
 
 	return (sb);
 }
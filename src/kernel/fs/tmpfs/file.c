@@ -0,0 +1,568 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file
+ * 
+ * @brief tmpfs file module implementation.
+ * 
+ * @details Directory entries of all instances come from a single pool, and
+ *          file data is kept in kernel pages. Both are bounded, so that a
+ *          tmpfs cannot starve the rest of the kernel.
+ */
+
+#include <nanvix/config.h>
+#include <nanvix/const.h>
+#include <nanvix/fs.h>
+#include <nanvix/hal.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <limits.h>
+#include "../fs.h"
+#include "tmpfs.h"
+
+/**
+ * @brief Pool of directory entries.
+ */
+PRIVATE struct tmpfs_dirent dirents[NR_TMPFS_DIRENTS];
+
+/**
+ * @brief List of free directory entries.
+ */
+PRIVATE struct tmpfs_dirent *free_dirents = NULL;
+
+/**
+ * @brief Number of data pages in use.
+ */
+PRIVATE unsigned npages = 0;
+
+/**
+ * @brief Initializes the pool of directory entries.
+ */
+PUBLIC void tmpfs_dirent_init(void)
+{
+	for (unsigned i = 0; i < NR_TMPFS_DIRENTS; i++)
+		dirents[i].next = ((i + 1) < NR_TMPFS_DIRENTS) ? &dirents[i + 1] : NULL;
+	free_dirents = &dirents[0];
+	npages = 0;
+}
+
+/**
+ * @brief Gets the number of free data pages.
+ * 
+ * @returns The number of free data pages.
+ */
+PUBLIC unsigned tmpfs_free_pages(void)
+{
+	return (NR_TMPFS_PAGES - npages);
+}
+
+/**
+ * @brief Hashes a file name.
+ * 
+ * @param name File name.
+ * 
+ * @returns The hash chain of the file name.
+ */
+PRIVATE unsigned tmpfs_hash(const char *name)
+{
+	unsigned h = 0;
+	
+	for (int i = 0; (i < NAME_MAX) && (name[i] != '\0'); i++)
+		h = (h << 5) + h + (unsigned char) name[i];
+	
+	return (h%TMPFS_HASHTAB_SIZE);
+}
+
+/**
+ * @brief Searches for a directory entry.
+ * 
+ * @param node Target directory.
+ * @param name File name.
+ * 
+ * @returns If the entry is found, a pointer to it is returned. Otherwise, a
+ *          #NULL pointer is returned instead.
+ */
+PRIVATE struct tmpfs_dirent *tmpfs_lookup(struct tmpfs_node *node, const char *name)
+{
+	struct tmpfs_dirent *e;
+	
+	/* Empty directory. */
+	if (node->hashtab == NULL)
+		return (NULL);
+	
+	for (e = node->hashtab[tmpfs_hash(name)]; e != NULL; e = e->hash_next)
+	{
+		if (!kstrncmp(e->d.d_name, name, NAME_MAX))
+			return (e);
+	}
+	
+	return (NULL);
+}
+
+/**
+ * @brief Links a file to a directory.
+ * 
+ * @details Appends an entry named @p name for the file numbered @p num to
+ *          the directory pointed to by @p node.
+ * 
+ * @param node Target directory.
+ * @param name File name.
+ * @param num  Inode number of the file.
+ * 
+ * @returns Zero upon successful completion, and non-zero otherwise.
+ */
+PUBLIC int tmpfs_link(struct tmpfs_node *node, const char *name, ino_t num)
+{
+	unsigned h;             /* Hash chain.    */
+	struct tmpfs_dirent *e; /* Working entry. */
+	
+	/* Allocate hash table. */
+	if (node->hashtab == NULL)
+	{
+		if ((node->hashtab = getkpg(1)) == NULL)
+			return (-1);
+	}
+	
+	/* No free entries. */
+	if ((e = free_dirents) == NULL)
+		return (-1);
+	free_dirents = e->next;
+	
+	kstrncpy(e->d.d_name, name, NAME_MAX);
+	e->d.d_ino = num;
+	
+	/* Insert entry in the hash table. */
+	h = tmpfs_hash(name);
+	e->hash_next = node->hashtab[h];
+	node->hashtab[h] = e;
+	
+	/* Append entry to the directory. */
+	e->next = NULL;
+	e->prev = node->tail;
+	if (node->tail != NULL)
+		node->tail->next = e;
+	else
+		node->head = e;
+	node->tail = e;
+	
+	node->size += sizeof(struct d_dirent);
+	
+	return (0);
+}
+
+/**
+ * @brief Unlinks a directory entry.
+ * 
+ * @param node Target directory.
+ * @param e    Entry to be removed.
+ */
+PRIVATE void tmpfs_unlink(struct tmpfs_node *node, struct tmpfs_dirent *e)
+{
+	struct tmpfs_dirent **pp;
+	
+	/* Remove entry from the hash table. */
+	for (pp = &node->hashtab[tmpfs_hash(e->d.d_name)]; *pp != e; pp = &(*pp)->hash_next)
+		/* noop */;
+	*pp = e->hash_next;
+	
+	/* Remove entry from the directory. */
+	if (e->prev != NULL)
+		e->prev->next = e->next;
+	else
+		node->head = e->next;
+	if (e->next != NULL)
+		e->next->prev = e->prev;
+	else
+		node->tail = e->prev;
+	
+	node->size -= sizeof(struct d_dirent);
+	
+	e->next = free_dirents;
+	free_dirents = e;
+}
+
+/**
+ * @brief Truncates a node.
+ * 
+ * @details Releases the data pages of a regular file, or the entries of a
+ *          directory.
+ * 
+ * @param node Target node.
+ */
+PUBLIC void tmpfs_truncate(struct tmpfs_node *node)
+{
+	/* Release data pages. */
+	if (node->pages != NULL)
+	{
+		for (unsigned i = 0; i < TMPFS_NR_PAGES; i++)
+		{
+			if (node->pages[i] != NULL)
+			{
+				putkpg(node->pages[i]);
+				npages--;
+			}
+		}
+		
+		putkpg(node->pages);
+		node->pages = NULL;
+	}
+	
+	/* Release directory entries. */
+	if (node->hashtab != NULL)
+	{
+		while (node->head != NULL)
+			tmpfs_unlink(node, node->head);
+		
+		putkpg(node->hashtab);
+		node->hashtab = NULL;
+	}
+	
+	node->size = 0;
+}
+
+/*
+ * Searches for a directory entry.
+ */
+PUBLIC struct d_dirent *dirent_search_tmpfs
+(struct inode *dip, const char *filename, struct buffer **buf, int create)
+{
+	struct tmpfs_node *node; /* Directory node. */
+	struct tmpfs_dirent *e;  /* Working entry.  */
+	
+	/* Entries are not backed by buffers. */
+	*buf = NULL;
+	
+	node = dip->u.tmpfs;
+	
+	/* Found. */
+	if ((e = tmpfs_lookup(node, filename)) != NULL)
+		return (&e->d);
+	
+	/* Not found. */
+	if (!create)
+		return (NULL);
+	
+	/* Create entry. */
+	if (tmpfs_link(node, filename, INODE_NULL))
+	{
+		curr_proc->errno = -ENOSPC;
+		return (NULL);
+	}
+	dip->size = node->size;
+	inode_touch(dip);
+	
+	return (&node->tail->d);
+}
+
+/*
+ * Removes an entry from a directory.
+ */
+PUBLIC int dir_remove_tmpfs(struct inode *dinode, const char *filename)
+{
+	struct tmpfs_node *node; /* Directory node.  */
+	struct tmpfs_dirent *e;  /* Directory entry. */
+	struct inode *file;      /* File inode.      */
+	
+	node = dinode->u.tmpfs;
+	
+	/* Not found. */
+	if ((e = tmpfs_lookup(node, filename)) == NULL)
+		return (-ENOENT);
+	
+	/* Cannot remove '.' */
+	if (e->d.d_ino == dinode->num)
+		return (-EBUSY);
+	
+	/* Failed to get file's inode. */
+	if ((file = inode_get(dinode->dev, e->d.d_ino)) == NULL)
+		return (-ENOENT);
+	
+	/* Unlinking directory. */
+	if (S_ISDIR(file->mode))
+	{
+		/* Not allowed. */
+		if (!IS_SUPERUSER(curr_proc))
+		{
+			inode_put(file);
+			return (-EPERM);
+		}
+		
+		/* Directory not empty. */
+		if (file->size > (off_t)(2*sizeof(struct d_dirent)))
+		{
+			inode_put(file);
+			return (-EBUSY);
+		}
+	}
+	
+	/* Remove directory entry. */
+	tmpfs_unlink(node, e);
+	dinode->size = node->size;
+	
+	inode_touch(dinode);
+	file->nlinks--;
+	inode_touch(file);
+	inode_put(file);
+	
+	return (0);
+}
+
+/*
+ * Adds an entry to a directory.
+ */
+PUBLIC int dir_add_tmpfs(struct inode *dinode, struct inode *inode, const char *name)
+{
+	struct tmpfs_node *node; /* Directory node.  */
+	struct tmpfs_dirent *e;  /* Directory entry. */
+	
+	node = dinode->u.tmpfs;
+	
+	/* Reuse entry. */
+	if ((e = tmpfs_lookup(node, name)) != NULL)
+		e->d.d_ino = inode->num;
+	
+	/* Failed to create directory entry. */
+	else if (tmpfs_link(node, name, inode->num))
+		return (-1);
+	
+	dinode->size = node->size;
+	inode_touch(dinode);
+	
+	return (0);
+}
+
+/*
+ * Reads from a directory.
+ */
+PUBLIC ssize_t dir_read_tmpfs(struct inode *i, void *buf, size_t n, off_t off)
+{
+	char *p;                /* Writing pointer.  */
+	size_t entoff;          /* Entry offset.     */
+	size_t chunk;           /* Data chunk size.  */
+	struct tmpfs_dirent *e; /* Working entry.    */
+	
+	p = buf;
+	
+	/* Skip entries before the offset. */
+	for (e = i->u.tmpfs->head; (e != NULL) && (off >= (off_t)sizeof(struct d_dirent)); e = e->next)
+		off -= sizeof(struct d_dirent);
+	entoff = off;
+	
+	/* Read data. */
+	for (/* noop */; (e != NULL) && (n > 0); e = e->next)
+	{
+		chunk = sizeof(struct d_dirent) - entoff;
+		if (chunk > n)
+			chunk = n;
+		
+		kmemcpy(p, (char *)&e->d + entoff, chunk);
+		
+		n -= chunk;
+		p += chunk;
+		entoff = 0;
+	}
+	
+	return ((ssize_t)(p - (char *)buf));
+}
+
+/**
+ * @brief Gets a data page of a file.
+ * 
+ * @param node   Target node.
+ * @param off    File offset.
+ * @param create Allocate the page if it is missing?
+ * 
+ * @returns The data page at offset @p off, or a #NULL pointer if there is
+ *          no such page and it could not be allocated.
+ */
+PRIVATE char *tmpfs_page(struct tmpfs_node *node, off_t off, int create)
+{
+	unsigned i; /* Page slot. */
+	
+	i = off >> PAGE_SHIFT;
+	
+	/* Allocate table of pages. */
+	if (node->pages == NULL)
+	{
+		if ((!create) || ((node->pages = getkpg(1)) == NULL))
+			return (NULL);
+	}
+	
+	/* Allocate page. */
+	if ((node->pages[i] == NULL) && (create))
+	{
+		/* Too many pages. */
+		if (npages >= NR_TMPFS_PAGES)
+			return (NULL);
+		
+		if ((node->pages[i] = getkpg(1)) == NULL)
+			return (NULL);
+		npages++;
+	}
+	
+	return (node->pages[i]);
+}
+
+/*
+ * Reads a page of a regular file.
+ */
+PUBLIC int readpage_tmpfs(struct inode *i, void *page, off_t off)
+{
+	char *data;   /* Data page.       */
+	size_t chunk; /* Data chunk size. */
+	
+	chunk = (off < i->size) ? i->size - off : 0;
+	if (chunk > PAGE_SIZE)
+		chunk = PAGE_SIZE;
+	
+	/* Holes read as zeros. */
+	if ((chunk == 0) || ((data = tmpfs_page(i->u.tmpfs, off, 0)) == NULL))
+		chunk = 0;
+	else
+		kmemcpy(page, data, chunk);
+	kmemset((char *)page + chunk, 0, PAGE_SIZE - chunk);
+	
+	return (0);
+}
+
+/*
+ * Reads from a regular file into an I/O vector.
+ */
+PUBLIC ssize_t file_readv_tmpfs(struct inode *i, struct iovec *iov, int iovcnt, off_t off)
+{
+	char *data;    /* Data page.       */
+	size_t n;      /* Bytes to read.   */
+	size_t pgoff;  /* Page offset.     */
+	size_t chunk;  /* Data chunk size. */
+	ssize_t count; /* Bytes read.      */
+	
+	n = 0;
+	for (int j = 0; j < iovcnt; j++)
+		n += iov[j].iov_len;
+	
+	count = 0;
+	
+	/* Read data. */
+	while ((n > 0) && (off < i->size))
+	{
+		pgoff = off & ~PAGE_MASK;
+		
+		/* Calculate read chunk size. */
+		chunk = (n < PAGE_SIZE - pgoff) ? n : PAGE_SIZE - pgoff;
+		if ((off_t)chunk > i->size - off)
+			chunk = i->size - off;
+		
+		/* Holes read as zeros. */
+		if ((data = tmpfs_page(i->u.tmpfs, off, 0)) == NULL)
+			iov_zero(iov, iovcnt, chunk);
+		else
+			iov_copy(iov, iovcnt, data + pgoff, chunk, 1);
+		
+		n -= chunk;
+		off += chunk;
+		count += chunk;
+	}
+	
+	return (count);
+}
+
+/*
+ * Reads from a regular file.
+ */
+PUBLIC ssize_t file_read_tmpfs(struct inode *i, void *buf, size_t n, off_t off)
+{
+	struct iovec iov; /* I/O vector. */
+	
+	iov.iov_base = buf;
+	iov.iov_len = n;
+	
+	return (file_readv_tmpfs(i, &iov, 1, off));
+}
+
+/*
+ * Writes to a regular file from an I/O vector.
+ */
+PUBLIC ssize_t file_writev_tmpfs(struct inode *i, struct iovec *iov, int iovcnt, off_t off)
+{
+	char *data;    /* Data page.       */
+	size_t n;      /* Bytes to write.  */
+	size_t pgoff;  /* Page offset.     */
+	size_t chunk;  /* Data chunk size. */
+	ssize_t count; /* Bytes written.   */
+	
+	n = 0;
+	for (int j = 0; j < iovcnt; j++)
+		n += iov[j].iov_len;
+	
+	count = 0;
+	
+	/* Write data. */
+	while (n > 0)
+	{
+		/* File too big. */
+		if (off >= TMPFS_MAX_SIZE)
+		{
+			curr_proc->errno = -EFBIG;
+			break;
+		}
+		
+		/* No space left. */
+		if ((data = tmpfs_page(i->u.tmpfs, off, 1)) == NULL)
+		{
+			curr_proc->errno = -ENOSPC;
+			break;
+		}
+		
+		pgoff = off & ~PAGE_MASK;
+		
+		chunk = (n < PAGE_SIZE - pgoff) ? n : PAGE_SIZE - pgoff;
+		
+		iov_copy(iov, iovcnt, data + pgoff, chunk, 0);
+		pcache_update(i, off, data + pgoff, chunk);
+		
+		n -= chunk;
+		off += chunk;
+		count += chunk;
+		
+		/* Update file size. */
+		if (off > i->size)
+		{
+			i->size = off;
+			i->flags |= INODE_DIRTY;
+		}
+	}
+	
+	return (count);
+}
+
+/*
+ * Writes to a regular file.
+ */
+PUBLIC ssize_t file_write_tmpfs(struct inode *i, const void *buf, size_t n, off_t off)
+{
+	struct iovec iov; /* I/O vector. */
+	
+	iov.iov_base = (void *)buf;
+	iov.iov_len = n;
+	
+	return (file_writev_tmpfs(i, &iov, 1, off));
+}
@@ -0,0 +1,254 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ * 
+ * @brief tmpfs inode module implementation.
+ */
+
+#include <nanvix/clock.h>
+#include <nanvix/config.h>
+#include <nanvix/const.h>
+#include <nanvix/fs.h>
+#include <nanvix/klib.h>
+#include <nanvix/pm.h>
+#include <errno.h>
+#include "../fs.h"
+#include "tmpfs.h"
+
+/**
+ * @brief Reads an inode.
+ * 
+ * @details Fills the in-core inode pointed to by @p ip with the file numbered
+ *          @p num in the file system instance on the device @p dev.
+ * 
+ * @param dev Device of the file system instance.
+ * @param num Number of the inode that shall be read.
+ * @param ip  Inode of the cache where the result of the reading is written.
+ * 
+ * @returns Upon successful completion zero is returned. Upon failure, non-zero
+ *          is returned instead.
+ */
+PUBLIC int inode_read_tmpfs(dev_t dev, ino_t num, struct inode *ip)
+{
+	struct tmpfs_node *node; /* Underlying node. */
+	struct superblock *sb;   /* Super block.     */
+	
+	/* No such file. */
+	if ((node = tmpfs_node_get(dev, num)) == NULL)
+		return (1);
+	
+	/* Get superblock. */
+	if ((sb = superblock_get(dev)) == NULL)
+		return (1);
+	
+	/* Initialize in-core inode. */
+	ip->mode = node->mode;
+	ip->nlinks = node->nlinks;
+	ip->uid = node->uid;
+	ip->gid = node->gid;
+	ip->size = node->size;
+	ip->time = node->time;
+	for (unsigned i = 0; i < NR_ZONES; i++)
+		ip->blocks[i] = BLOCK_NULL;
+	ip->dev = dev;
+	ip->num = num;
+	ip->sb = sb;
+	ip->i_op = &inode_o_tmpfs;
+	ip->u.tmpfs = node;
+	ip->flags &= ~(INODE_DIRTY | INODE_MOUNT | INODE_PIPE);
+	ip->flags |= INODE_VALID;
+	
+	superblock_put(sb);
+	
+	return (0);
+}
+
+/**
+ * @brief Writes an inode back.
+ * 
+ * @details Copies the attributes of the in-core inode pointed to by @p ip
+ *          back to its node.
+ * 
+ * @param ip Target inode.
+ * 
+ * @note The inode must be locked.
+ */
+PUBLIC void inode_write_tmpfs(struct inode *ip)
+{
+	struct tmpfs_node *node; /* Underlying node. */
+	
+	/* Nothing to be done. */
+	if (!(ip->flags & INODE_DIRTY) || ((node = ip->u.tmpfs) == NULL))
+		return;
+	
+	node->mode = ip->mode;
+	node->nlinks = ip->nlinks;
+	node->uid = ip->uid;
+	node->gid = ip->gid;
+	node->size = ip->size;
+	node->time = ip->time;
+	
+	ip->flags &= ~INODE_DIRTY;
+}
+
+/**
+ * @brief Frees an inode.
+ * 
+ * @details Frees the node that underlies the inode pointed to by @p ip,
+ *          along with its contents.
+ * 
+ * @param ip Target inode.
+ * 
+ * @note The inode must be locked.
+ */
+PUBLIC void inode_free_tmpfs(struct inode *ip)
+{
+	/* Nothing to be done. */
+	if (ip->u.tmpfs == NULL)
+		return;
+	
+	tmpfs_node_free(ip->u.tmpfs);
+	ip->u.tmpfs = NULL;
+	ip->flags &= ~INODE_DIRTY;
+}
+
+/**
+ * @brief Truncates an inode.
+ * 
+ * @details Truncates the inode pointed to by @p ip by freeing all underlying
+ *          pages.
+ * 
+ * @param ip Inode that shall be truncated.
+ * 
+ * @note The inode must be locked.
+ */
+PUBLIC void inode_truncate_tmpfs(struct inode *ip)
+{
+	/* Inode was freed. */
+	if (ip->u.tmpfs == NULL)
+	{
+		ip->size = 0;
+		return;
+	}
+	
+	tmpfs_truncate(ip->u.tmpfs);
+	
+	ip->size = 0;
+	inode_touch(ip);
+}
+
+/**
+ * @brief Allocates an inode.
+ * 
+ * @param sb Superblock of the file system instance.
+ * @param ip Inode of the cache which is allocated.
+ * 
+ * @returns Upon successful completion zero is returned. Upon failure, non-zero
+ *          is returned instead.
+ * 
+ * @note The superblock must not be locked.
+ */
+PUBLIC int inode_alloc_tmpfs(struct superblock *sb, struct inode *ip)
+{
+	struct tmpfs_node *node; /* Underlying node. */
+	
+	/* No free nodes. */
+	if ((node = tmpfs_node_alloc(sb->dev, INODE_NULL)) == NULL)
+	{
+		curr_proc->errno = -ENOSPC;
+		return (1);
+	}
+	
+	/* 
+	 * Initialize inode. 
+	 * mode will be initialized later.
+	 */
+	ip->nlinks = 1;
+	ip->uid = curr_proc->euid;
+	ip->gid = curr_proc->egid;
+	ip->size = 0;
+	for (unsigned j = 0; j < NR_ZONES; j++)
+		ip->blocks[j] = BLOCK_NULL;
+	ip->dev = sb->dev;
+	ip->num = node->num;
+	ip->sb = sb;
+	ip->flags &= ~(INODE_MOUNT | INODE_PIPE);
+	ip->flags |= INODE_VALID;
+	ip->i_op = &inode_o_tmpfs;
+	ip->u.tmpfs = node;
+	
+	return (0);
+}
+
+/**
+ * @brief tmpfs file system operations.
+ */
+PRIVATE struct super_operations super_o_tmpfs = 
+{
+		&inode_read_tmpfs,			/* inode_read 		*/ 
+		&inode_write_tmpfs,			/* inode_write 		*/
+		&inode_free_tmpfs,			/* inode_free 		*/
+		&inode_truncate_tmpfs,		/* inode_truncate 	*/
+		&inode_alloc_tmpfs,			/* inode_alloc 		*/
+		NULL,						/* notify_change 	*/
+		NULL,						/* put inode 		*/
+		&superblock_put_tmpfs,		/* put_super 		*/
+		&superblock_write_tmpfs,	/* write_super 		*/
+		&superblock_stat_tmpfs,		/* superblock_stat 	*/
+		NULL 						/* remount_fs 		*/
+};
+
+PUBLIC struct inode_operations inode_o_tmpfs =
+{
+	&dir_read_tmpfs,
+	&dir_add_tmpfs,
+	&dir_remove_tmpfs,
+	&file_read_tmpfs,
+	&file_write_tmpfs,
+	&dirent_search_tmpfs,
+	&readpage_tmpfs,
+	&file_readv_tmpfs,
+	&file_writev_tmpfs
+};
+
+PRIVATE struct file_system_type fs_tmpfs = {
+	superblock_read_tmpfs,
+	&super_o_tmpfs,
+	"tmpfs",
+	FS_NODEV
+};
+
+PUBLIC struct super_operations *so_tmpfs(void)
+{
+	return (&super_o_tmpfs);
+}
+
+/**
+ * @brief Initialise the file system in the virtual file system.
+ */
+PUBLIC void init_tmpfs(void)
+{
+	tmpfs_node_init();
+	tmpfs_dirent_init();
+	
+	if (fs_register(TMPFS, &fs_tmpfs))
+		kpanic("Failed to register tmpfs file system");
+}
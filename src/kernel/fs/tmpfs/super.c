@@ -0,0 +1,289 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ * 
+ * @brief tmpfs superblock module implementation.
+ * 
+ * @details A tmpfs is not backed by any device. Each mounted instance gets a
+ *          device number of its own, and its files are kept in a table of
+ *          nodes that is shared by all instances. The root directory of an
+ *          instance is numbered #INODE_ROOT, and other files are numbered
+ *          after the slot of their node in the table.
+ */
+
+#include <nanvix/clock.h>
+#include <nanvix/config.h>
+#include <nanvix/const.h>
+#include <nanvix/fs.h>
+#include <nanvix/klib.h>
+#include <sys/stat.h>
+#include <ustat.h>
+#include "../fs.h"
+#include "tmpfs.h"
+
+/**
+ * @brief Number of the first file that is not a root directory.
+ */
+#define TMPFS_FIRST_INO (INODE_ROOT + 1)
+
+/**
+ * @brief Table of nodes.
+ */
+PRIVATE struct tmpfs_node nodes[NR_TMPFS_NODES];
+
+/**
+ * @brief List of free nodes.
+ */
+PRIVATE struct tmpfs_node *free_nodes = NULL;
+
+/**
+ * @brief Number of free nodes.
+ */
+PRIVATE unsigned nfree_nodes = 0;
+
+/**
+ * @brief Initializes the table of nodes.
+ */
+PUBLIC void tmpfs_node_init(void)
+{
+	for (unsigned i = 0; i < NR_TMPFS_NODES; i++)
+	{
+		nodes[i].dev = NULL_DEV;
+		nodes[i].num = INODE_NULL;
+		nodes[i].free_next = ((i + 1) < NR_TMPFS_NODES) ? &nodes[i + 1] : NULL;
+	}
+	free_nodes = &nodes[0];
+	nfree_nodes = NR_TMPFS_NODES;
+}
+
+/**
+ * @brief Gets a node.
+ * 
+ * @param dev Device of the file system instance.
+ * @param num Inode number.
+ * 
+ * @returns A pointer to the requested node, or a #NULL pointer if there is
+ *          no such file.
+ */
+PUBLIC struct tmpfs_node *tmpfs_node_get(dev_t dev, ino_t num)
+{
+	unsigned i;
+	
+	/* Root directory. */
+	if (num == INODE_ROOT)
+	{
+		for (i = 0; i < NR_TMPFS_NODES; i++)
+		{
+			if ((nodes[i].dev == dev) && (nodes[i].num == INODE_ROOT))
+				return (&nodes[i]);
+		}
+		
+		return (NULL);
+	}
+	
+	/* Invalid inode number. */
+	if ((num < TMPFS_FIRST_INO) || ((i = num - TMPFS_FIRST_INO) >= NR_TMPFS_NODES))
+		return (NULL);
+	
+	/* Not a file of this instance. */
+	if ((nodes[i].dev != dev) || (nodes[i].num != num))
+		return (NULL);
+	
+	return (&nodes[i]);
+}
+
+/**
+ * @brief Allocates a node.
+ * 
+ * @param dev Device of the file system instance.
+ * @param num Inode number, or #INODE_NULL to pick one.
+ * 
+ * @returns Upon successful completion, a pointer to a blank node is returned.
+ *          Upon failure, a #NULL pointer is returned instead.
+ */
+PUBLIC struct tmpfs_node *tmpfs_node_alloc(dev_t dev, ino_t num)
+{
+	struct tmpfs_node *node;
+	
+	/* No free nodes. */
+	if ((node = free_nodes) == NULL)
+		return (NULL);
+	
+	free_nodes = node->free_next;
+	nfree_nodes--;
+	
+	node->dev = dev;
+	node->num = (num != INODE_NULL) ? num : (node - nodes) + TMPFS_FIRST_INO;
+	node->mode = 0;
+	node->nlinks = 1;
+	node->uid = curr_proc->euid;
+	node->gid = curr_proc->egid;
+	node->size = 0;
+	node->time = CURRENT_TIME;
+	node->pages = NULL;
+	node->hashtab = NULL;
+	node->head = NULL;
+	node->tail = NULL;
+	
+	return (node);
+}
+
+/**
+ * @brief Frees a node.
+ * 
+ * @details Releases the data or directory entries of the node pointed to by
+ *          @p node, and then puts it back in the list of free nodes.
+ * 
+ * @param node Target node.
+ */
+PUBLIC void tmpfs_node_free(struct tmpfs_node *node)
+{
+	tmpfs_truncate(node);
+	
+	node->dev = NULL_DEV;
+	node->num = INODE_NULL;
+	node->free_next = free_nodes;
+	free_nodes = node;
+	nfree_nodes++;
+}
+
+/**
+ * @brief Gets the number of free nodes.
+ * 
+ * @returns The number of free nodes.
+ */
+PUBLIC unsigned tmpfs_free_nodes(void)
+{
+	return (nfree_nodes);
+}
+
+/**
+ * @brief Writes a superblock back.
+ * 
+ * @details There is nothing to be written back, since there is no device.
+ * 
+ * @param sb Target superblock.
+ */
+PUBLIC void superblock_write_tmpfs(struct superblock *sb)
+{
+	UNUSED(sb);
+}
+
+/**
+ * @brief Releases a superblock.
+ * 
+ * @details Releases a superblock. If its reference count drops to zero, all
+ *          files of the file system instance are freed and then the
+ *          superblock is marked as invalid.
+ * 
+ * @param sb Superblock to be released.
+ * 
+ * @note The superblock must be valid.
+ * @note The superblock must be locked.
+ */
+PUBLIC void superblock_put_tmpfs(struct superblock *sb)
+{
+	/* Double free. */
+	if (sb->count == 0)
+		kpanic("freeing superblock twice");
+	
+	/* Release underlying resources. */
+	if (--sb->count == 0)
+	{
+		for (unsigned i = 0; i < NR_TMPFS_NODES; i++)
+		{
+			if (nodes[i].dev == sb->dev)
+				tmpfs_node_free(&nodes[i]);
+		}
+		
+		sb->flags &= ~SUPERBLOCK_VALID;
+	}
+}
+
+/**
+ * @brief Creates a file system instance.
+ * 
+ * @details Creates an empty file system on the device @p dev, and fills the
+ *          in-core superblock pointed to by @p sb.
+ * 
+ * @param dev Device number.
+ * @param sb  In-core superblock.
+ * 
+ * @returns Upon successful completion, @p sb is returned. Upon failure, a
+ *          #NULL pointer is returned instead.
+ */
+PUBLIC struct superblock *superblock_read_tmpfs(dev_t dev, struct superblock *sb)
+{
+	struct tmpfs_node *root; /* Root directory. */
+	
+	/* Create root directory. */
+	if ((root = tmpfs_node_alloc(dev, INODE_ROOT)) == NULL)
+		return (NULL);
+	root->mode = S_IFDIR | S_IRWXU | S_IRWXG | S_IRWXO;
+	root->nlinks = 2;
+	if (tmpfs_link(root, ".", INODE_ROOT) || tmpfs_link(root, "..", INODE_ROOT))
+	{
+		tmpfs_node_free(root);
+		return (NULL);
+	}
+	
+	/* Initialize superblock. */
+	sb->buf = NULL;
+	sb->ninodes = NR_TMPFS_NODES;
+	sb->imap_blocks = 0;
+	sb->zmap_blocks = 0;
+	sb->first_data_block = 0;
+	sb->max_size = TMPFS_MAX_SIZE;
+	sb->zones = NR_TMPFS_PAGES;
+	sb->root = NULL;
+	sb->root_ino = INODE_ROOT;
+	sb->mp = NULL;
+	sb->dev = dev;
+	sb->flags &= ~(SUPERBLOCK_DIRTY | SUPERBLOCK_RDONLY);
+	sb->flags |= SUPERBLOCK_VALID;
+	sb->isearch = 0;
+	sb->zsearch = 0;
+	sb->chain = NULL;
+	sb->count++;
+	sb->s_op = so_tmpfs();
+	
+	return (sb);
+}
+
+/**
+ * @brief Gets file system statistics.
+ * 
+ * @param sb   Superblock of the file system to be inspected.
+ * @param ubuf Place where statics should be stored.
+ * 
+ * @note The superblock must be valid.
+ * @note The superblock must be locked.
+ * @note The buffer must be valid.
+ */
+PUBLIC void superblock_stat_tmpfs(struct superblock *sb, struct ustat *ubuf)
+{
+	UNUSED(sb);
+	
+	ubuf->f_tfree = tmpfs_free_pages();
+	ubuf->f_tinode = tmpfs_free_nodes();
+	kstrcpy(ubuf->f_fname, "tmpfs");
+	ubuf->f_fpack[0] = '\0';
+}
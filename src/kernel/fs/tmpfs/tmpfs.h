@@ -0,0 +1,122 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ * 
+ * @brief Temporary file system.
+ */
+
+#ifndef _TMPFS_H_
+#define _TMPFS_H_
+
+	#include <nanvix/const.h>
+	#include <nanvix/dev.h>
+	#include <nanvix/fs.h>
+	#include <nanvix/hal.h>
+
+	/**
+	 * @brief Number of page slots in a file.
+	 */
+	#define TMPFS_NR_PAGES (PAGE_SIZE/sizeof(void *))
+
+	/**
+	 * @brief Maximum file size.
+	 */
+	#define TMPFS_MAX_SIZE ((off_t)(TMPFS_NR_PAGES*PAGE_SIZE))
+
+	/**
+	 * @brief Number of hash chains in a directory.
+	 */
+	#define TMPFS_HASHTAB_SIZE (PAGE_SIZE/sizeof(struct tmpfs_dirent *))
+
+	/**
+	 * @brief tmpfs directory entry.
+	 */
+	struct tmpfs_dirent
+	{
+		struct d_dirent d;              /**< Directory entry.          */
+		struct tmpfs_dirent *next;      /**< Next entry in directory.  */
+		struct tmpfs_dirent *prev;      /**< Previous entry.           */
+		struct tmpfs_dirent *hash_next; /**< Next entry in hash chain. */
+	};
+
+	/**
+	 * @brief tmpfs file.
+	 * 
+	 * @details Files live only in memory. Data of a regular file is kept in
+	 *          kernel pages, which are found through a table of pages. A
+	 *          directory keeps its entries in a hash table, and also in a
+	 *          list, so that they are read in creation order.
+	 */
+	struct tmpfs_node
+	{
+		dev_t dev;                     /**< Device, if in use.       */
+		ino_t num;                     /**< Inode number.            */
+		mode_t mode;                   /**< Access permissions.      */
+		nlink_t nlinks;                /**< Number of links.         */
+		uid_t uid;                     /**< Owner user.              */
+		gid_t gid;                     /**< Owner group.             */
+		off_t size;                    /**< File size (in bytes).    */
+		time_t time;                   /**< Last access time.        */
+		void **pages;                  /**< Table of file pages.     */
+		struct tmpfs_dirent **hashtab; /**< Directory hash table.    */
+		struct tmpfs_dirent *head;     /**< First directory entry.   */
+		struct tmpfs_dirent *tail;     /**< Last directory entry.    */
+		struct tmpfs_node *free_next;  /**< Next free node.          */
+	};
+
+	/* Forward definitions. */
+	EXTERN void tmpfs_node_init(void);
+	EXTERN void tmpfs_dirent_init(void);
+	EXTERN struct tmpfs_node *tmpfs_node_get(dev_t, ino_t);
+	EXTERN struct tmpfs_node *tmpfs_node_alloc(dev_t, ino_t);
+	EXTERN void tmpfs_node_free(struct tmpfs_node *);
+	EXTERN void tmpfs_truncate(struct tmpfs_node *);
+	EXTERN int tmpfs_link(struct tmpfs_node *, const char *, ino_t);
+	EXTERN unsigned tmpfs_free_pages(void);
+	EXTERN unsigned tmpfs_free_nodes(void);
+
+	EXTERN int inode_read_tmpfs(dev_t, ino_t, struct inode *);
+	EXTERN void inode_write_tmpfs(struct inode *);
+	EXTERN void inode_free_tmpfs(struct inode *);
+	EXTERN void inode_truncate_tmpfs(struct inode *);
+	EXTERN int inode_alloc_tmpfs(struct superblock *, struct inode *);
+
+	EXTERN struct superblock *superblock_read_tmpfs(dev_t, struct superblock *);
+	EXTERN void superblock_put_tmpfs(struct superblock *);
+	EXTERN void superblock_write_tmpfs(struct superblock *);
+	EXTERN void superblock_stat_tmpfs(struct superblock *, struct ustat *);
+
+	EXTERN ssize_t dir_read_tmpfs(struct inode *, void *, size_t, off_t);
+	EXTERN int dir_add_tmpfs(struct inode *, struct inode *, const char *);
+	EXTERN int dir_remove_tmpfs(struct inode *, const char *);
+	EXTERN struct d_dirent *dirent_search_tmpfs(struct inode *, const char *, struct buffer **, int);
+	EXTERN ssize_t file_read_tmpfs(struct inode *, void *, size_t, off_t);
+	EXTERN ssize_t file_write_tmpfs(struct inode *, const void *, size_t, off_t);
+	EXTERN ssize_t file_readv_tmpfs(struct inode *, struct iovec *, int, off_t);
+	EXTERN ssize_t file_writev_tmpfs(struct inode *, struct iovec *, int, off_t);
+	EXTERN int readpage_tmpfs(struct inode *, void *, off_t);
+
+	EXTERN void init_tmpfs(void);
+	EXTERN struct super_operations *so_tmpfs(void);
+
+	EXTERN struct inode_operations inode_o_tmpfs;
+
+#endif /* _TMPFS_H_ */
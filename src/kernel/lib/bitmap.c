@@ -74,11 +74,49 @@ PUBLIC unsigned bitmap_nclear(uint32_t *bitmap, size_t size)
 	return ((size << 3) - bitmap_nset(bitmap, size));
 }
 
+/**
+ * @brief Searches for the first cleared bit in a word.
+ * 
+ * @details Searches for the first cleared bit in a word using the find first
+ *          set instruction of the underlying processor on its complement.
+ * 
+ * @param word Word to be searched. It should not have all bits set.
+ * 
+ * @returns The number of the first cleared bit in the word.
+ */
+PRIVATE inline uint32_t word_first_free(uint32_t word)
+{
+	uint32_t off; /* Bit offset. */
+	
+#ifdef i386
+	__asm__ (
+		"bsfl %1, %0"
+		: "=r" (off)
+		: "rm" (~word)
+	);
+#elif or1k
+	/* l.ff1 counts bits from one. */
+	__asm__ (
+		"l.ff1 %0, %1"
+		: "=r" (off)
+		: "r" (~word)
+	);
+	off--;
+#else
+	off = 0;
+	while (word & (0x1 << off))
+		off++;
+#endif
+	
+	return (off);
+}
+
 /**
  * @brief Searches for the first free bit in a bitmap.
  * 
  * @details Searches for the first free bit in a bitmap. In order to speedup
- *          computation, bits are checked in chunks of 4 bytes.
+ *          computation, bits are checked in chunks of 4 bytes, and the free
+ *          bit is then located with a single instruction.
  * 
  * @param bitmap Bitmap to be searched.
  * @param size   Size (in bytes) of the bitmap.
@@ -89,7 +127,6 @@ PUBLIC unsigned bitmap_nclear(uint32_t *bitmap, size_t size)
 PUBLIC bit_t bitmap_first_free(uint32_t *bitmap, size_t size)
 {
     uint32_t *max;          /* Bitmap bondary. */
-    register uint32_t off;  /* Bit offset.     */
     register uint32_t *idx; /* Bit index.      */
     
     idx = bitmap;
@@ -100,15 +137,7 @@ PUBLIC bit_t bitmap_first_free(uint32_t *bitmap, size_t size)
     {
 		/* Index found. */
 		if (*idx != 0xffffffff)
-		{
-			off = 0;
-			
-			/* Find offset. */
-			while (*idx & (0x1 << off))
-				off++;
-				
-			return (((idx - bitmap) << 5) + off);
-		}
+			return (((idx - bitmap) << 5) + word_first_free(*idx));
 	
 		idx++;
 	}
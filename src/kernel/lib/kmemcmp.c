@@ -0,0 +1,48 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ * 
+ * This file is part of Nanvix.
+ * 
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <nanvix/const.h>
+#include <sys/types.h>
+
+/**
+ * @brief Compares bytes in memory.
+ * 
+ * @param s1 First memory area.
+ * @param s2 Second memory area.
+ * @param n  Number of bytes to be compared.
+ * 
+ * @returns Zero if the memory areas are equal, a negative number if the
+ *          first differing byte in @p s1 is less than the one in @p s2, and
+ *          a positive number otherwise.
+ */
+PUBLIC int kmemcmp(const void *s1, const void *s2, size_t n)
+{
+	const unsigned char *p1; /* Read pointer. */
+	const unsigned char *p2; /* Read pointer. */
+	
+	p1 = s1;
+	p2 = s2;
+	
+	for (/* noop */; n > 0; n--, p1++, p2++)
+	{
+		if (*p1 != *p2)
+			return (*p1 - *p2);
+	}
+	
+	return (0);
+}
@@ -0,0 +1,335 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <nanvix/clock.h>
+#include <nanvix/config.h>
+#include <nanvix/const.h>
+#include <nanvix/hal.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <nanvix/region.h>
+#include "mm.h"
+
+/**
+ * @brief Hash table size of the same-page merging daemon.
+ */
+#define KSM_HASHTAB_SIZE 509
+
+/**
+ * @brief Number of page table entries in a page table.
+ */
+#define NR_PTES (PAGE_SIZE/PTE_SIZE)
+
+/**
+ * @brief Number of pages in a memory region.
+ */
+#define REGION_PAGES (MREGIONS*REGION_PGTABS*NR_PTES)
+
+/**
+ * @brief Pages that may be merged.
+ *
+ * @details Entries either refer to a merged page frame, which is write
+ *          protected everywhere, or to a page that was not merged yet, in
+ *          which case the memory region and the page where it was found are
+ *          recorded as well. Entries are never trusted: they are revalidated
+ *          and the page contents are compared before any merge.
+ */
+PRIVATE struct
+{
+	unsigned sum;       /**< Checksum of page contents.           */
+	addr_t frame;       /**< Page frame.                          */
+	struct region *reg; /**< Memory region (NULL if merged).      */
+	unsigned pg;        /**< Page in the memory region.           */
+} hashtab[KSM_HASHTAB_SIZE];
+
+/**
+ * @brief Checksum of the zero page.
+ */
+PRIVATE unsigned zero_sum;
+
+/**
+ * @brief Scanning position.
+ */
+PRIVATE struct
+{
+	unsigned reg; /**< Index of the memory region. */
+	unsigned pg;  /**< Page in the memory region.  */
+} hand = { 0, 0 };
+
+/**
+ * @brief Sleeping chain of the same-page merging daemon.
+ */
+PRIVATE struct thread *ksmd_chain = NULL;
+
+/**
+ * @brief Computes the checksum of a page.
+ *
+ * @param page Kernel virtual address of target page.
+ *
+ * @returns The checksum of the page.
+ */
+PRIVATE unsigned ksm_sum(const void *page)
+{
+	unsigned sum = 0;
+	const unsigned *p = page;
+
+	for (unsigned i = 0; i < PAGE_SIZE/sizeof(unsigned); i++)
+		sum = ((sum << 5) | (sum >> 27)) ^ p[i];
+
+	return (sum);
+}
+
+/**
+ * @brief Asserts if the pages of a memory region may be merged.
+ *
+ * @details Shared regions are written in place, and large pages are never
+ *          copied on write, so neither is merged. Locked regions are skipped,
+ *          so that the daemon never gets in the way of page faults.
+ *
+ * @param reg Target memory region.
+ *
+ * @returns Non-zero if the pages of the region may be merged, and zero
+ *          otherwise.
+ */
+PRIVATE int mergeable(struct region *reg)
+{
+	return (!(reg->flags & (REGION_FREE | REGION_LOCKED | REGION_SHARED |
+		REGION_LARGE)));
+}
+
+/**
+ * @brief Gets a page of a memory region.
+ *
+ * @param reg Target memory region.
+ * @param pg  Page in the memory region.
+ *
+ * @returns The requested page table entry, or a #NULL pointer if its page
+ *          table is not allocated.
+ */
+PRIVATE struct pte *ksm_pte(struct region *reg, unsigned pg)
+{
+	struct miniregion *mreg;
+
+	if ((mreg = reg->mtab[pg/(REGION_PGTABS*NR_PTES)]) == NULL)
+		return (NULL);
+	if (mreg->pgtab[(pg/NR_PTES)%REGION_PGTABS] == NULL)
+		return (NULL);
+
+	return (&mreg->pgtab[(pg/NR_PTES)%REGION_PGTABS][pg%NR_PTES]);
+}
+
+/**
+ * @brief Merges a page with a page that was not merged yet.
+ *
+ * @param i   Hash table entry of the page that was not merged yet.
+ * @param reg Memory region of the target page.
+ * @param pg  Target page.
+ *
+ * @returns Non-zero if the pages were merged, and zero otherwise.
+ *
+ * @note The memory region of the target page must be locked.
+ */
+PRIVATE int ksm_merge2(unsigned i, struct region *reg, struct pte *pg)
+{
+	int ret = 0;          /* Return value.        */
+	struct pte *pg2;      /* Other page.          */
+	struct region *reg2;  /* Other memory region. */
+
+	reg2 = hashtab[i].reg;
+
+	if (reg2 != reg)
+	{
+		if (!mergeable(reg2))
+			return (0);
+		lockreg(reg2);
+	}
+
+	pg2 = ksm_pte(reg2, hashtab[i].pg);
+
+	/* Page changed since it was found. */
+	if ((pg2 == NULL) || (pg2 == pg) || (!pte_is_present(pg2)))
+		goto out;
+	if ((pg2->frame != hashtab[i].frame) || frame_is_shared(pg2->frame))
+		goto out;
+	if (kmemcmp(UMEM_PAGE(pg->frame), UMEM_PAGE(pg2->frame), PAGE_SIZE))
+		goto out;
+
+	mergeupg(pg2, pg2->frame);
+	mergeupg(pg, pg2->frame);
+	hashtab[i].reg = NULL;
+	ret = 1;
+
+out:
+	if (reg2 != reg)
+		unlockreg(reg2);
+
+	return (ret);
+}
+
+/**
+ * @brief Merges a page.
+ *
+ * @details Pages that are shared are skipped, since they are either copied
+ *          on write already or belong to the page cache.
+ *
+ * @param reg Memory region of the target page.
+ * @param n   Page in the memory region.
+ * @param pg  Target page.
+ *
+ * @note The memory region must be locked.
+ */
+PRIVATE void ksm_merge(struct region *reg, unsigned n, struct pte *pg)
+{
+	unsigned i;   /* Hash table index. */
+	unsigned sum; /* Page checksum.    */
+	void *page;   /* Page contents.    */
+
+	/* Page may not be merged. */
+	if (frame_is_shared(pg->frame) || frame_is_merged(pg->frame))
+		return;
+
+	page = UMEM_PAGE(pg->frame);
+	sum = ksm_sum(page);
+
+	/* Zero page. */
+	if (sum == zero_sum)
+	{
+		if (!kmemcmp(page, UMEM_PAGE(zero_frame), PAGE_SIZE))
+		{
+			mergeupg(pg, zero_frame);
+			return;
+		}
+	}
+
+	i = sum%KSM_HASHTAB_SIZE;
+
+	if ((hashtab[i].frame != 0) && (hashtab[i].sum == sum))
+	{
+		/* Merged page. */
+		if (hashtab[i].reg == NULL)
+		{
+			if (frame_is_merged(hashtab[i].frame) &&
+				!kmemcmp(page, UMEM_PAGE(hashtab[i].frame), PAGE_SIZE))
+			{
+				mergeupg(pg, hashtab[i].frame);
+				return;
+			}
+		}
+
+		/* Page that was not merged yet. */
+		else if (ksm_merge2(i, reg, pg))
+			return;
+	}
+
+	/* Remember page. */
+	hashtab[i].sum = sum;
+	hashtab[i].frame = pg->frame;
+	hashtab[i].reg = reg;
+	hashtab[i].pg = n;
+}
+
+/**
+ * @brief Scans the pages of a memory region.
+ *
+ * @param reg Target memory region.
+ * @param max Maximum number of pages to scan.
+ *
+ * @returns The number of pages that were scanned.
+ *
+ * @note The memory region must be locked.
+ */
+PRIVATE unsigned ksm_scanreg(struct region *reg, unsigned max)
+{
+	unsigned n;     /* Scanned pages. */
+	struct pte *pg; /* Working page.  */
+
+	for (n = 0; (hand.pg < REGION_PAGES) && (n < max); hand.pg++)
+	{
+		/* Skip invalid page tables. */
+		if ((pg = ksm_pte(reg, hand.pg)) == NULL)
+		{
+			hand.pg = (hand.pg/NR_PTES + 1)*NR_PTES - 1;
+			continue;
+		}
+
+		/* Page not in memory. */
+		if (!pte_is_present(pg))
+			continue;
+
+		ksm_merge(reg, hand.pg, pg);
+		n++;
+	}
+
+	return (n);
+}
+
+/**
+ * @brief Scans up to #KSM_SCAN_PAGES pages for merging.
+ */
+PRIVATE void ksm_scan(void)
+{
+	unsigned n;         /* Scanned pages.  */
+	struct region *reg; /* Working region. */
+
+	n = 0;
+	for (unsigned i = 0; (i < NR_REGIONS) && (n < KSM_SCAN_PAGES); i++)
+	{
+		reg = &regtab[hand.reg];
+
+		if (mergeable(reg))
+		{
+			lockreg(reg);
+			n += ksm_scanreg(reg, KSM_SCAN_PAGES - n);
+			unlockreg(reg);
+
+			/* Resume here on the next pass. */
+			if (hand.pg < REGION_PAGES)
+				break;
+		}
+
+		hand.reg = (hand.reg + 1)%NR_REGIONS;
+		hand.pg = 0;
+	}
+}
+
+/**
+ * @brief Same-page merging daemon.
+ *
+ * @details Periodically scans pages of private memory regions and merges
+ *          the ones that are identical into a single page frame, which is
+ *          then copied on write. At most #KSM_SCAN_PAGES pages are scanned
+ *          every #KSM_SCAN_TICKS clock ticks.
+ */
+PUBLIC void ksmd(void)
+{
+	kstrncpy(curr_proc->name, "ksmd", NAME_MAX);
+
+	zero_sum = ksm_sum(UMEM_PAGE(zero_frame));
+
+	while (!shutting_down)
+	{
+		ksm_scan();
+
+		curr_proc->alarm = ticks + KSM_SCAN_TICKS;
+		sleep(&ksmd_chain, PRIO_USER);
+		curr_proc->received = 0;
+	}
+
+	die(0);
+}
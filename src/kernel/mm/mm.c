@@ -25,6 +25,8 @@
 #include <nanvix/mm.h>
 #include <nanvix/debug.h>
 #include <nanvix/smp.h>
+#include <errno.h>
+#include "mm.h"
 
 /*
  * Bad KPOOL_PHYS ?
@@ -68,6 +70,13 @@
 	#error "bad identity mapping"
 #endif
 
+/*
+ * Bad UMEM_VIRT ?
+ */
+#if ((UMEM_VIRT & ~PGTAB_MASK) || (UMEM_VIRT < OMPIC_VIRT + PGTAB_SIZE))
+	#error "bad UMEM_VIRT"
+#endif
+
 /**
  * Too large INITRD?
  */
@@ -83,6 +92,8 @@ PUBLIC unsigned const BUFFERS_VIRT = 0;
  */
 PUBLIC void mm_init(void)
 {
+	paging_init();
+	pcache_init();
 	initreg();
 	dbg_register(test_mm, "test_mm");
 }
@@ -122,6 +133,163 @@ PUBLIC int chkmem(const void *addr, size_t size, mode_t mask)
 	return (ret);
 }
 
+/**
+ * @brief Exception fixup table entry.
+ */
+struct extable
+{
+	addr_t insn;  /**< Instruction that may fault. */
+	addr_t fixup; /**< Where to resume execution.  */
+};
+
+/**
+ * @name Exception fixup table
+ *
+ * @details Defined by the linker.
+ */
+/**@{*/
+EXTERN struct extable EXTABLE_START[];
+EXTERN struct extable EXTABLE_END[];
+/**@}*/
+
+/**
+ * @brief Searches the exception fixup table.
+ *
+ * @param insn Address of the faulting instruction.
+ *
+ * @returns If the faulting instruction accesses user memory on behalf of the
+ *          kernel, the address where execution should resume is returned.
+ *          Otherwise, zero is returned instead.
+ */
+PUBLIC addr_t extable_search(addr_t insn)
+{
+	for (struct extable *e = EXTABLE_START; e < EXTABLE_END; e++)
+	{
+		if (e->insn == insn)
+			return (e->fixup);
+	}
+
+	return (0);
+}
+
+/**
+ * @brief Checks access permissions to a range of user address space.
+ *
+ * @details The process region is looked up only once for the whole range.
+ *          Pages that are not in memory are not checked, since faults are
+ *          handled by the exception fixup table.
+ *
+ * @param addr Start address.
+ * @param n    Number of bytes.
+ * @param mask Access permissions mask.
+ *
+ * @returns The number of bytes, up to @p n, that may be accessed starting at
+ *          @p addr.
+ */
+PRIVATE size_t uaccess(const void *addr, size_t n, mode_t mask)
+{
+	addr_t end;           /* End of memory region.   */
+	struct region *reg;   /* Working memory region.  */
+	struct pregion *preg; /* Working process region. */
+
+	/* Kernel address space. */
+	if (IN_KERNEL(addr))
+	{
+		if (KERNEL_WAS_RUNNING(cpus[curr_core].curr_thread) || ((curr_proc) == INIT))
+			return (n);
+
+		return (0);
+	}
+
+	/* Get associated process region. */
+	if ((preg = findreg(curr_proc, ADDR(addr))) == NULL)
+		return (0);
+
+	lockreg(reg = preg->reg);
+
+	/* Not allowed. */
+	if (!(accessreg(curr_proc, reg) & mask))
+	{
+		unlockreg(reg);
+		return (0);
+	}
+
+	end = (reg->flags & REGION_DOWNWARDS) ?
+		preg->start : preg->start + reg->size;
+
+	unlockreg(reg);
+
+	return ((n < end - ADDR(addr)) ? n : end - ADDR(addr));
+}
+
+/**
+ * @brief Copies a block of memory from user address space.
+ *
+ * @param to   Target kernel buffer.
+ * @param from Source user buffer.
+ * @param n    Number of bytes.
+ *
+ * @returns Zero upon successful completion, and -EFAULT otherwise.
+ */
+PUBLIC int copy_from_user(void *to, const void *from, size_t n)
+{
+	if (uaccess(from, n, MAY_READ) != n)
+		return (-EFAULT);
+
+	return ((user_copy(to, from, n)) ? -EFAULT : 0);
+}
+
+/**
+ * @brief Copies a block of memory to user address space.
+ *
+ * @param to   Target user buffer.
+ * @param from Source kernel buffer.
+ * @param n    Number of bytes.
+ *
+ * @returns Zero upon successful completion, and -EFAULT otherwise.
+ */
+PUBLIC int copy_to_user(void *to, const void *from, size_t n)
+{
+	if (uaccess(to, n, MAY_WRITE) != n)
+		return (-EFAULT);
+
+	return ((user_copy(to, from, n)) ? -EFAULT : 0);
+}
+
+/**
+ * @brief Copies a string from user address space.
+ *
+ * @param to   Target kernel buffer.
+ * @param from Source user string.
+ * @param n    Maximum number of bytes to copy.
+ *
+ * @returns Upon successful completion, the length of the string is returned.
+ *          If the string is @p n bytes long or longer, @p n is returned and
+ *          the target buffer is not null terminated. Upon failure, -EFAULT
+ *          is returned instead.
+ */
+PUBLIC ssize_t strncpy_from_user(char *to, const char *from, size_t n)
+{
+	int len;    /* String length.    */
+	size_t max; /* Accessible bytes. */
+
+	/* Nothing to be done. */
+	if (n == 0)
+		return (0);
+
+	if ((max = uaccess(from, n, MAY_READ)) == 0)
+		return (-EFAULT);
+
+	if ((len = user_strncpy(to, from, max)) < 0)
+		return (-EFAULT);
+
+	/* String crosses the end of the memory region. */
+	if (((size_t)len == max) && (max < n))
+		return (-EFAULT);
+
+	return (len);
+}
+
 /**
  * @brief Fetches a byte from user address space.
  * 
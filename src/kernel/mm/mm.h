@@ -23,12 +23,54 @@
 	/* Page marks. */
 	#define PAGE_FILL 0 /* Demand fill. */
 	#define PAGE_ZERO 1 /* Demand zero. */
+
+	/* Free page frames watermarks. */
+	#define SWAP_LOWAT  64 /* Wake up the page-out daemon. */
+	#define SWAP_HIWAT 128 /* Page-out daemon may rest.    */
+	
+	/**
+	 * @brief Converts a page frame number into a kernel virtual address.
+	 *
+	 * @param frame Frame number of target page frame.
+	 */
+	#define UMEM_PAGE(frame) \
+		((void *)(UMEM_VIRT + (((frame) << PAGE_SHIFT) - UBASE_PHYS)))
+	
+	/**
+	 * @brief Converts a kernel virtual address into a page frame number.
+	 *
+	 * @param page Kernel virtual address of target page frame.
+	 */
+	#define UMEM_FRAME(page) \
+		(((ADDR(page) - UMEM_VIRT) + UBASE_PHYS) >> PAGE_SHIFT)
+	
+	/* Shared zero page frame. */
+	EXTERN addr_t zero_frame;
 	
 	/* Forward definitions. */
+	EXTERN addr_t frame_alloc(void);
+	EXTERN addr_t frame_alloc_color(unsigned);
+	EXTERN void frame_free(addr_t);
+	EXTERN void frame_share(addr_t);
+	EXTERN int frame_is_shared(addr_t);
+	EXTERN addr_t lframe_alloc(void);
+	EXTERN void lframe_free(addr_t);
+	EXTERN void pcache_init(void);
+	EXTERN int pcache_reclaim(void);
+	EXTERN void paging_init(void);
 	EXTERN void freeupg(struct pte *);
 	EXTERN void linkupg(struct pte *, struct pte *);
 	EXTERN void mappgtab(struct process *, addr_t, void *);
+	EXTERN void maplpg(struct process *, addr_t, addr_t, int);
 	EXTERN void markpg(struct pte *, int);
 	EXTERN void umappgtab(struct process *, addr_t);
+	EXTERN unsigned frame_nfree(void);
+	EXTERN int swap_read(addr_t, void *);
+	EXTERN void swap_dup(addr_t);
+	EXTERN void swap_free(addr_t);
+	EXTERN int swap_reclaim(void);
+	EXTERN void kswapd_wakeup(void);
+	EXTERN int frame_is_merged(addr_t);
+	EXTERN void mergeupg(struct pte *, addr_t);
 
 #endif /* _MM_H_ */
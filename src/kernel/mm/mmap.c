@@ -0,0 +1,418 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/config.h>
+#include <nanvix/const.h>
+#include <nanvix/fs.h>
+#include <nanvix/hal.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <nanvix/region.h>
+#include <nanvix/smp.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include "mm.h"
+
+/**
+ * @brief Maximum number of memory mappings per process.
+ *
+ * @details Mappings are placed at page table boundaries, so the mappings
+ *          area has room for at most UMMAP_SIZE/PGTAB_SIZE of them, and the
+ *          table of process regions fits in a single kernel page.
+ */
+#define NR_MMAPS (PAGE_SIZE/sizeof(struct pregion))
+
+/**
+ * @brief End of the mappings area.
+ */
+#define UMMAP_END ((addr_t)UMMAP_ADDR + (addr_t)UMMAP_SIZE)
+
+/**
+ * @brief Asserts that the table of process regions has room for as many
+ *        mappings as fit in the mappings area.
+ *
+ * @details The preprocessor cannot evaluate sizeof, so the array size turns
+ *          negative, and compilation fails, if #NR_MMAPS is too small.
+ */
+typedef char nr_mmaps_check[((UMMAP_SIZE/PGTAB_SIZE) <= NR_MMAPS) ? 1 : -1];
+
+/**
+ * @brief Gets the page table entry of a region.
+ *
+ * @param reg Target region.
+ * @param off Offset in the region.
+ *
+ * @returns The requested page table entry.
+ */
+PRIVATE inline struct pte *regpte(struct region *reg, addr_t off)
+{
+	return (&reg->mtab[off >> MREGION_SHIFT]->
+		pgtab[(off >> PGTAB_SHIFT)%REGION_PGTABS][PG(off)]);
+}
+
+/**
+ * @brief Gets the large page of a region.
+ *
+ * @param reg Target region.
+ * @param off Offset in the region.
+ *
+ * @returns The number of the first page frame of the requested large page.
+ */
+PRIVATE inline addr_t reglframe(struct region *reg, addr_t off)
+{
+	return (reg->mtab[off >> MREGION_SHIFT]->
+		lframe[(off >> PGTAB_SHIFT)%REGION_PGTABS]);
+}
+
+/**
+ * @brief Converts memory protection options into access permissions.
+ *
+ * @param prot Protection options.
+ *
+ * @returns Access permissions of a memory region with the requested
+ *          protection. Pages cannot be write-only, so writable mappings
+ *          are readable as well.
+ */
+PUBLIC mode_t protmode(int prot)
+{
+	mode_t mode = 0;
+
+	if (prot & (PROT_READ | PROT_EXEC))
+		mode |= S_IRUSR;
+	if (prot & PROT_WRITE)
+		mode |= S_IRUSR | S_IWUSR;
+
+	return (mode);
+}
+
+/**
+ * @brief Asserts if a range of the mappings area is free.
+ *
+ * @param proc  Target process.
+ * @param start Start address.
+ * @param size  Size in bytes.
+ *
+ * @returns Non-zero if the range is free, and zero otherwise.
+ */
+PRIVATE int mapfree(struct process *proc, addr_t start, size_t size)
+{
+	/* Out of mappings area. */
+	if ((start & ~PGTAB_MASK) || (start < UMMAP_ADDR))
+		return (0);
+	if (start + size > UMMAP_END)
+		return (0);
+
+	for (addr_t addr = start; addr < start + size; addr += PGTAB_SIZE)
+	{
+		if (!addr_is_clear(proc, addr) || (findreg(proc, addr) != NULL))
+			return (0);
+	}
+
+	return (1);
+}
+
+/**
+ * @brief Maps a memory region into a process.
+ *
+ * @details Attaches the memory region pointed to by @p reg in the mappings
+ *          area of the process pointed to by @p proc. If @p addr is a free
+ *          page table aligned address, the region is attached there.
+ *          Otherwise, the first free range that is large enough is used,
+ *          unless @p fixed is set.
+ *
+ * @param proc  Target process.
+ * @param addr  Requested address.
+ * @param reg   Memory region to be mapped.
+ * @param fixed Map exactly at @p addr?
+ *
+ * @returns Upon successful completion, the process region where the memory
+ *          region was attached is returned. Upon failure, a #NULL pointer is
+ *          returned instead.
+ *
+ * @note The memory region must be locked.
+ */
+PUBLIC struct pregion *
+mapreg(struct process *proc, addr_t addr, struct region *reg, int fixed)
+{
+	size_t size;          /* Mapping size.           */
+	struct pregion *preg; /* Working process region. */
+
+	size = ALIGN(reg->size, PGTAB_SIZE);
+
+	/* Look for an address. */
+	if (!mapfree(proc, addr, size))
+	{
+		if (fixed)
+			return (NULL);
+
+		for (addr = UMMAP_ADDR; addr < UMMAP_END; addr += PGTAB_SIZE)
+		{
+			if (mapfree(proc, addr, size))
+				goto found;
+		}
+
+		return (NULL);
+	}
+
+found:
+
+	/* Allocate table of process regions. */
+	if (proc->mmaps == NULL)
+	{
+		if ((proc->mmaps = getkpg(1)) == NULL)
+			return (NULL);
+		proc->nmmaps = 0;
+	}
+
+	/* Search for a free process region. */
+	for (preg = &proc->mmaps[0]; preg < &proc->mmaps[proc->nmmaps]; preg++)
+	{
+		if (preg->reg == NULL)
+			break;
+	}
+
+	/* Too many mappings. */
+	if (preg == &proc->mmaps[NR_MMAPS])
+		return (NULL);
+
+	if (attachreg(proc, preg, addr, reg))
+		return (NULL);
+
+	if (preg == &proc->mmaps[proc->nmmaps])
+		proc->nmmaps++;
+
+	return (preg);
+}
+
+/**
+ * @brief Unmaps a memory region from a process.
+ *
+ * @details Shared file mappings are written back before being detached.
+ *
+ * @param proc Target process.
+ * @param preg Process region to be unmapped.
+ */
+PUBLIC void unmapreg(struct process *proc, struct pregion *preg)
+{
+	struct region *reg;
+
+	/* Nothing to be done. */
+	if ((reg = preg->reg) == NULL)
+		return;
+
+	lockreg(reg);
+	syncreg(preg, preg->start, reg->size);
+	unlockreg(reg);
+
+	detachreg(proc, preg);
+
+	/* Shrink table of process regions. */
+	while ((proc->nmmaps > 0) && (proc->mmaps[proc->nmmaps - 1].reg == NULL))
+		proc->nmmaps--;
+}
+
+/**
+ * @brief Changes access permissions of a mapped memory region.
+ *
+ * @details Updates the access permissions of the memory region that is
+ *          attached to @p preg and the pages that are already in memory.
+ *          Private pages that become writable are marked copy-on-write, so
+ *          that pages shared with the page cache are not overwritten.
+ *
+ * @param preg Target process region.
+ * @param mode New access permissions.
+ *
+ * @note The memory region must be locked.
+ */
+PUBLIC void protreg(struct pregion *preg, mode_t mode)
+{
+	struct pte *pg;     /* Working page.   */
+	struct region *reg; /* Working region. */
+
+	reg = preg->reg;
+	reg->mode = mode;
+
+	/*
+	 * Large pages are remapped as a whole. Inaccessible ones are
+	 * unmapped, so that a validity fault is raised on access.
+	 */
+	if (reg->flags & REGION_LARGE)
+	{
+		for (addr_t off = 0; off < reg->size; off += LPAGE_SIZE)
+		{
+			if (mode & MAY_READ)
+			{
+				maplpg(curr_proc, preg->start + off, reglframe(reg, off),
+					(mode & MAY_WRITE) ? 1 : 0);
+			}
+			else if (!addr_is_clear(curr_proc, preg->start + off))
+				umappgtab(curr_proc, preg->start + off);
+		}
+		return;
+	}
+
+	for (addr_t off = 0; off < reg->size; off += PAGE_SIZE)
+	{
+		pg = regpte(reg, off);
+
+		/* Page not in memory. */
+		if (!pte_is_present(pg))
+			continue;
+
+		pte_user_set(pg, (mode & MAY_READ) ? 1 : 0);
+
+		/* Read-only page. */
+		if (!(mode & MAY_WRITE))
+			pte_write_set(pg, 0);
+
+		/* Shared page. */
+		else if (reg->flags & REGION_SHARED)
+			pte_write_set(pg, 1);
+
+		/* Private page. */
+		else if (!pte_is_write(pg))
+			pte_cow_set(pg, 1);
+	}
+
+	tlb_flush();
+	cpus[curr_core].curr_thread->tlb_flush = 1;
+}
+
+/**
+ * @brief Writes back a shared file mapping.
+ *
+ * @param preg Target process region.
+ * @param addr Start address.
+ * @param size Number of bytes.
+ *
+ * @returns Zero upon successful completion, and a negative error code
+ *          otherwise.
+ *
+ * @note The memory region must be locked.
+ */
+PUBLIC int syncreg(struct pregion *preg, addr_t addr, size_t size)
+{
+	size_t n;           /* Bytes to write. */
+	addr_t end;         /* End address.    */
+	addr_t off;         /* Region offset.  */
+	struct pte *pg;     /* Working page.   */
+	struct region *reg; /* Working region. */
+
+	reg = preg->reg;
+
+	/* Nothing to be done. */
+	if (!(reg->flags & REGION_SHARED) || (reg->file.inode == NULL))
+		return (0);
+
+	end = addr + size;
+	if (end > preg->start + reg->file.size)
+		end = preg->start + reg->file.size;
+
+	for (addr &= PAGE_MASK; addr < end; addr += PAGE_SIZE)
+	{
+		off = addr - preg->start;
+		pg = regpte(reg, off);
+
+		/* Page not in memory. */
+		if (!pte_is_present(pg))
+			continue;
+
+		n = reg->file.size - off;
+		n = (n < PAGE_SIZE) ? n : PAGE_SIZE;
+
+		if (file_write(reg->file.inode, UMEM_PAGE(pg->frame), n,
+			reg->file.off + off) < 0)
+			return (-EIO);
+	}
+
+	return (0);
+}
+
+/**
+ * @brief Duplicates the memory mappings of the current process.
+ *
+ * @param proc Process where the mappings shall be duplicated.
+ *
+ * @returns Zero upon successful completion, and non-zero otherwise.
+ */
+PUBLIC int dupmaps(struct process *proc)
+{
+	struct region *reg;   /* Memory region.  */
+	struct pregion *preg; /* Process region. */
+
+	proc->mmaps = NULL;
+	proc->nmmaps = 0;
+
+	/* Nothing to be done. */
+	if (curr_proc->mmaps == NULL)
+		return (0);
+
+	if ((proc->mmaps = getkpg(1)) == NULL)
+		return (-1);
+
+	for (unsigned i = 0; i < curr_proc->nmmaps; i++)
+	{
+		preg = &curr_proc->mmaps[i];
+
+		/* Process region not in use. */
+		if (preg->reg == NULL)
+			continue;
+
+		lockreg(preg->reg);
+		reg = dupreg(preg->reg);
+		unlockreg(preg->reg);
+
+		/* Failed to duplicate region. */
+		if (reg == NULL)
+			return (-1);
+
+		if (attachreg(proc, &proc->mmaps[i], preg->start, reg))
+		{
+			unlockreg(reg);
+			if (reg->count == 0)
+				freereg(reg);
+			return (-1);
+		}
+
+		unlockreg(reg);
+		proc->nmmaps = i + 1;
+	}
+
+	return (0);
+}
+
+/**
+ * @brief Detaches all memory mappings of a process.
+ *
+ * @param proc Target process.
+ */
+PUBLIC void detachmaps(struct process *proc)
+{
+	/* Nothing to be done. */
+	if (proc->mmaps == NULL)
+		return;
+
+	while (proc->nmmaps > 0)
+		unmapreg(proc, &proc->mmaps[proc->nmmaps - 1]);
+
+	putkpg(proc->mmaps);
+	proc->mmaps = NULL;
+}
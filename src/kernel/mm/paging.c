@@ -28,6 +28,11 @@
 #include <nanvix/smp.h>
 #include "mm.h"
 
+/**
+ * @brief Page directory of the idle process.
+ */
+EXTERN struct pde idle_pgdir[];
+
 /*============================================================================*
  *                             Page Frames Subsystem                          *
  *============================================================================*/
@@ -42,6 +47,29 @@
  */
 PRIVATE unsigned frames[NR_FRAMES] = {0, };
 
+/**
+ * @brief Number of free page frames.
+ */
+PRIVATE unsigned nfree = NR_FRAMES;
+
+/**
+ * @brief Shared zero page frame.
+ *
+ * @details Demand zero pages that are only read map this page frame, so
+ *          that a private page frame is assigned on the first write only.
+ *          The kernel holds a reference to it, so that it is never freed
+ *          nor stolen on copy-on-write.
+ */
+PUBLIC addr_t zero_frame = 0;
+
+/**
+ * @brief Page frames that hold merged pages.
+ *
+ * @details All pages that map a merged page frame are write protected, so
+ *          that its contents do not change while it is flagged.
+ */
+PRIVATE unsigned char merged[NR_FRAMES] = {0, };
+
 /**
  * @brief Converts a frame ID to a frame number.
  *
@@ -66,20 +94,138 @@ PRIVATE inline int frame_addr_to_id(addr_t addr)
 	return (addr - (UBASE_PHYS >> PAGE_SHIFT));
 }
 
+/**
+ * @brief Takes a free page frame.
+ * 
+ * @param id ID of target page frame.
+ * 
+ * @returns The page frame number of the target page frame.
+ */
+PRIVATE addr_t frame_take(unsigned id)
+{
+	frames[id] = 1;
+	
+	if (--nfree < SWAP_LOWAT)
+		kswapd_wakeup();
+	
+	return (frame_id_to_addr(id));
+}
+
 /**
  * @brief Allocates a page frame.
  * 
+ * @details When no page frame is free, unused pages of the page cache
+ *          are reclaimed first, and then pages of processes are swapped
+ *          out. The page-out daemon is woken up whenever free page frames
+ *          run low, so that this seldom happens.
+ * 
  * @returns The page frame number upon success, and zero upon failure.
  */
-PRIVATE addr_t frame_alloc(void)
+PUBLIC addr_t frame_alloc(void)
 {
+	do
+	{
+		/* Search for a free frame. */
+		for (unsigned i = 0; i < NR_FRAMES; i++)
+		{
+			/* Found it. */
+			if (frames[i] == 0)
+				return (frame_take(i));
+		}
+	} while (!pcache_reclaim() || !swap_reclaim());
+	
+	return (0);
+}
+
+/**
+ * @brief Allocates a page frame of a given color.
+ * 
+ * @details Page frames whose numbers are congruent modulo #PAGE_COLORS map
+ *          to the same sets of a physically indexed cache. Handing out
+ *          frames of distinct colors to consecutive virtual pages spreads
+ *          them across the cache, so that walking through a buffer does not
+ *          evict lines of the buffer itself. When no page frame of the
+ *          requested color is free, any page frame is allocated instead.
+ * 
+ * @param color Requested color.
+ * 
+ * @returns The page frame number upon success, and zero upon failure.
+ */
+PUBLIC addr_t frame_alloc_color(unsigned color)
+{
+#if (PAGE_COLORING == 1)
+	unsigned i;
+	
+	/* First page frame of the requested color. */
+	i = (color + PAGE_COLORS - frame_id_to_addr(0)%PAGE_COLORS)%PAGE_COLORS;
+	
 	/* Search for a free frame. */
-	for (unsigned i = 0; i < NR_FRAMES; i++)
+	for (/* noop */; i < NR_FRAMES; i += PAGE_COLORS)
 	{
 		/* Found it. */
 		if (frames[i] == 0)
+			return (frame_take(i));
+	}
+#else
+	UNUSED(color);
+#endif
+	
+	return (frame_alloc());
+}
+
+/**
+ * @brief Returns the number of free page frames.
+ *
+ * @returns The number of free page frames.
+ */
+PUBLIC unsigned frame_nfree(void)
+{
+	return (nfree);
+}
+
+/**
+ * @brief Number of page frames in a large page.
+ */
+#define LPAGE_FRAMES (LPAGE_SIZE/PAGE_SIZE)
+
+/**
+ * @brief Allocates a large page frame.
+ *
+ * @details Searches for #LPAGE_FRAMES free page frames that are contiguous
+ *          and aligned to a large page boundary, so that they may be mapped
+ *          by a single page directory entry. The frames are cleaned.
+ *
+ * @returns The number of the first page frame upon success, and zero upon
+ *          failure.
+ */
+PUBLIC addr_t lframe_alloc(void)
+{
+	unsigned i, j;
+	
+	/* Not supported. */
+	if (!PAGING_LARGE)
+		return (0);
+	
+	for (i = 0; i + LPAGE_FRAMES <= NR_FRAMES; i += LPAGE_FRAMES)
+	{
+		/* Frame is not aligned. */
+		if (frame_id_to_addr(i) & (LPAGE_FRAMES - 1))
+			continue;
+	
+		for (j = 0; j < LPAGE_FRAMES; j++)
+		{
+			if (frames[i + j] != 0)
+				break;
+		}
+		
+		/* Found. */
+		if (j == LPAGE_FRAMES)
 		{
-			frames[i] = 1;
+			for (j = 0; j < LPAGE_FRAMES; j++)
+				frames[i + j] = 1;
+			nfree -= LPAGE_FRAMES;
+			
+			kmemset(UMEM_PAGE(frame_id_to_addr(i)), 0, LPAGE_SIZE);
 			
 			return (frame_id_to_addr(i));
 		}
@@ -88,15 +234,32 @@ PRIVATE addr_t frame_alloc(void)
 	return (0);
 }
 
+/**
+ * @brief Frees a large page frame.
+ *
+ * @param addr Number of the first page frame of target large page frame.
+ */
+PUBLIC void lframe_free(addr_t addr)
+{
+	for (unsigned i = 0; i < LPAGE_FRAMES; i++)
+		frame_free(addr + i);
+}
+
 /**
  * @brief Frees a page frame.
  *
  * @param addr Frame number of target page frame.
  */
-PRIVATE inline void frame_free(addr_t addr)
+PUBLIC inline void frame_free(addr_t addr)
 {
 	if (frames[frame_addr_to_id(addr)]-- == 0)
 		kpanic("mm: double free on page frame");
+	
+	if (frames[frame_addr_to_id(addr)] == 0)
+	{
+		merged[frame_addr_to_id(addr)] = 0;
+		nfree++;
+	}
 }
 
 /**
@@ -104,7 +267,7 @@ PRIVATE inline void frame_free(addr_t addr)
  *
  * @param i ID of target page frame.
  */
-PRIVATE inline void frame_share(addr_t addr)
+PUBLIC inline void frame_share(addr_t addr)
 {
 	frames[frame_addr_to_id(addr)]++;
 }
@@ -117,11 +280,43 @@ PRIVATE inline void frame_share(addr_t addr)
  * @returns Non zero if the page frame is being shared, and zero
  * otherwise.
  */
-PRIVATE inline int frame_is_shared(addr_t addr)
+PUBLIC inline int frame_is_shared(addr_t addr)
 {
 	return (frames[frame_addr_to_id(addr)] > 1);
 }
 
+/**
+ * @brief Asserts if a page frame holds a merged page.
+ *
+ * @param addr Frame number of target page frame.
+ *
+ * @returns Non zero if the page frame holds a merged page, and zero
+ * otherwise.
+ */
+PUBLIC int frame_is_merged(addr_t addr)
+{
+	return (merged[frame_addr_to_id(addr)]);
+}
+
+/**
+ * @brief Returns the number of page frames saved by merging pages.
+ *
+ * @returns The number of page frames saved by merging pages.
+ */
+PUBLIC unsigned frame_nsaved(void)
+{
+	unsigned n = 0;
+	
+	for (unsigned i = 0; i < NR_FRAMES; i++)
+	{
+		if (merged[i])
+			n += frames[i] - 1;
+	}
+	
+	/* The kernel holds a reference to the zero page. */
+	return (n - 1);
+}
+
 /*============================================================================*
  *                              Paging System                                 *
  *============================================================================*/
@@ -178,6 +373,7 @@ PRIVATE inline void pde_clear(struct pde *pde)
 	pde_present_set(pde, 0);
 	pde_user_set(pde, 0);
 	pde_write_set(pde, 0);
+	pde_large_set(pde, 0);
 }
 
 /**
@@ -228,7 +424,8 @@ PRIVATE inline void pte_clear(struct pte *pte)
  */
 PRIVATE inline int pte_is_clear(struct pte *pte)
 {
-	return (!(pte_is_present(pte) | pte_is_fill(pte) | pte_is_zero(pte)));
+	return (!(pte_is_present(pte) | pte_is_fill(pte) | pte_is_zero(pte) |
+		pte_is_swap(pte)));
 }
 
 /**
@@ -275,6 +472,41 @@ PUBLIC void mappgtab(struct process *proc, addr_t addr, void *pgtab)
 	}
 }
 
+/**
+ * @brief Maps a large page into user address space.
+ * 
+ * @param proc     Process in which the large page should be mapped.
+ * @param addr     Address where the large page should be mapped.
+ * @param frame    Number of the first page frame of the large page.
+ * @param writable Is the large page writable?
+ * 
+ * @note The large page is unmapped with umappgtab().
+ */
+PUBLIC void maplpg(struct process *proc, addr_t addr, addr_t frame, int writable)
+{
+	struct pde *pde;
+	
+	pde = &proc->pgdir[PGTAB(addr)];
+	
+	/* Bad page table. */
+	if (pde_is_clear(pde) && !pde_is_large(pde))
+		kpanic("mm: busy page table directory entry");
+	
+	/* Map large page. */
+	pde_present_set(pde, 1);
+	pde_user_set(pde, 1);
+	pde_write_set(pde, writable);
+	pde_large_set(pde, 1);
+	pde->frame = frame;
+	
+	/* Flush changes. */
+	if (proc == curr_proc)
+	{
+		tlb_flush();
+		cpus[curr_core].curr_thread->tlb_flush = 1;
+	}
+}
+
 /**
  * @brief Unmaps a page table from user address space.
  * 
@@ -304,6 +536,72 @@ PUBLIC void umappgtab(struct process *proc, addr_t addr)
 	}
 }
 
+/**
+ * @brief Maps user memory into kernel space.
+ *
+ * @details Builds the page tables that map all user page frames at
+ *          #UMEM_VIRT, so that the kernel may access a page frame without
+ *          having it mapped in the address space of the current process.
+ *          The mapping is set up in the page directory of the idle process,
+ *          and it is inherited by all other processes.
+ */
+PUBLIC void paging_init(void)
+{
+	struct pde *pde;    /* Working page directory entry. */
+	struct pte *pgtab;  /* Working page table.           */
+	struct pte *pte;    /* Working page table entry.     */
+	
+	/* Map user memory with large pages. */
+	if (PAGING_LARGE && !((UMEM_SIZE | UBASE_PHYS) & ~LPAGE_MASK))
+	{
+		for (addr_t addr = 0; addr < UMEM_SIZE; addr += LPAGE_SIZE)
+		{
+			pde = &idle_pgdir[PGTAB(UMEM_VIRT + addr)];
+			pde_present_set(pde, 1);
+			pde_write_set(pde, 1);
+			pde_user_set(pde, 0);
+			pde_large_set(pde, 1);
+			pde->frame = (UBASE_PHYS + addr) >> PAGE_SHIFT;
+		}
+		
+		tlb_flush();
+		goto done;
+	}
+	
+	pgtab = NULL;
+	for (addr_t addr = 0; addr < UMEM_SIZE; addr += PAGE_SIZE)
+	{
+		/* Map a new page table. */
+		if (!(addr & ~PGTAB_MASK))
+		{
+			if ((pgtab = getkpg(1)) == NULL)
+				kpanic("mm: cannot map user memory");
+			
+			pde = &idle_pgdir[PGTAB(UMEM_VIRT + addr)];
+			pde_present_set(pde, 1);
+			pde_write_set(pde, 1);
+			pde_user_set(pde, 0);
+			pde->frame = (ADDR(pgtab) - KBASE_VIRT) >> PAGE_SHIFT;
+		}
+		
+		pte = &pgtab[PG(UMEM_VIRT + addr)];
+		pte_present_set(pte, 1);
+		pte_write_set(pte, 1);
+		pte_user_set(pte, 0);
+		pte->frame = (UBASE_PHYS + addr) >> PAGE_SHIFT;
+	}
+	
+	tlb_flush();
+
+done:
+	
+	/* Grab shared zero page frame. */
+	if (!(zero_frame = frame_alloc()))
+		kpanic("mm: cannot allocate zero page");
+	kmemset(UMEM_PAGE(zero_frame), 0, PAGE_SIZE);
+	merged[frame_addr_to_id(zero_frame)] = 1;
+}
+
 /**
  * @brief Creates a page directory for a process.
  * 
@@ -330,34 +628,40 @@ PUBLIC int crtpgdir(struct process *proc)
 		goto err1;
 
 	/* Get kernel page for IPI kernel stack. */
-	ipikstack = getkpg(1);
-	if (ipikstack == NULL)
-		goto err2;
+	ipikstack = NULL;
+	if (smp_enabled)
+	{
+		if ((ipikstack = getkpg(1)) == NULL)
+			goto err2;
+	}
 
 	/* Build page directory. */
 	pgdir[0] = curr_proc->pgdir[0];
-	pgdir[PGTAB(KBASE_VIRT)] = curr_proc->pgdir[PGTAB(KBASE_VIRT)];
-	pgdir[PGTAB(KPOOL_VIRT)] = curr_proc->pgdir[PGTAB(KPOOL_VIRT)];
+	for (addr_t addr = KBASE_VIRT; addr < KPOOL_VIRT + KPOOL_SIZE; addr += PGTAB_SIZE)
+		pgdir[PGTAB(addr)] = curr_proc->pgdir[PGTAB(addr)];
 	pgdir[PGTAB(INITRD_VIRT)] = curr_proc->pgdir[PGTAB(INITRD_VIRT)];
 	pgdir[PGTAB(SERIAL_VIRT)] = curr_proc->pgdir[PGTAB(SERIAL_VIRT)];
 #ifdef or1k
 	pgdir[PGTAB(OMPIC_VIRT)] = curr_proc->pgdir[PGTAB(OMPIC_VIRT)];
 #endif
+	for (addr_t addr = UMEM_VIRT; addr < UMEM_VIRT + UMEM_SIZE; addr += PGTAB_SIZE)
+		pgdir[PGTAB(addr)] = curr_proc->pgdir[PGTAB(addr)];
 	
-	/* Clone kernel stack. */
-	kmemcpy(kstack, cpus[curr_core].curr_thread->kstack, KSTACK_SIZE);
-	
-	/* Adjust stack pointers. */
-	proc->threads->kesp = (cpus[curr_core].curr_thread->kesp -
-		(dword_t)cpus[curr_core].curr_thread->kstack)+(dword_t)kstack;
-	
-	s1 = (struct intstack *) proc->threads->kesp;
-	s1->old_kesp = proc->threads->kesp;
-	
+	/*
+	 * The idle process forks from within the kernel, and the child
+	 * carries on with the whole call chain, so the kernel stack is cloned.
+	 */
 	if (curr_proc == IDLE)
 	{
+		kmemcpy(kstack, cpus[curr_core].curr_thread->kstack, KSTACK_SIZE);
+		
+		/* Adjust stack pointers. */
+		proc->threads->kesp = (cpus[curr_core].curr_thread->kesp -
+			(dword_t)cpus[curr_core].curr_thread->kstack)+(dword_t)kstack;
+		
 		s1 = (struct intstack *) cpus[curr_core].curr_thread->kesp;
 		s2 = (struct intstack *) proc->threads->kesp;
+		s2->old_kesp = proc->threads->kesp;
 #ifdef i386
 		s2->ebp = (s1->ebp - (dword_t)cpus[curr_core].curr_thread->kstack)
 			+ (dword_t)kstack;
@@ -377,6 +681,22 @@ PUBLIC int crtpgdir(struct process *proc)
 #endif
 	}
 
+	/*
+	 * User processes fork through a system call, so the child only needs
+	 * the interrupt stack that takes it back to user mode. Forge it at the
+	 * top of the new kernel stack, as forge_stack() does for new threads.
+	 */
+	else
+	{
+		s1 = (struct intstack *) cpus[curr_core].curr_thread->kesp;
+		s2 = (struct intstack *)((addr_t)kstack + KSTACK_SIZE - DWORD_SIZE
+			- INT_FRAME_SIZE);
+		kmemcpy(s2, s1, sizeof(struct intstack));
+		
+		proc->threads->kesp = (addr_t)s2;
+		s2->old_kesp = proc->threads->kesp;
+	}
+
 	/* Assign page directory. */
 	proc->cr3 = ADDR(pgdir) - KBASE_VIRT;
 	proc->pgdir = pgdir;
@@ -393,6 +713,14 @@ err0:
 	return (-1);
 }
 
+/**
+ * @brief Gets the color of a user page.
+ *
+ * @details Pages are colored after their virtual page number, which is the
+ *          index of their entry in the page table.
+ */
+#define PTE_COLOR(pg) ((((addr_t)(pg)) & ~PAGE_MASK)/PTE_SIZE)
+
 /**
  * @brief Clones a page.
  * 
@@ -406,7 +734,7 @@ PRIVATE int clonepg(struct pte *pg)
 	addr_t oldframe; /* Old page frame. */
 	
 	/* Grab a page frame. */
-	if (!(newframe = frame_alloc()))
+	if (!(newframe = frame_alloc_color(PTE_COLOR(pg))))
 		return (-1);
 	
 	/* Unlink old frame. */
@@ -422,65 +750,279 @@ PRIVATE int clonepg(struct pte *pg)
 /**
  * @brief Allocates a user page.
  * 
+ * @param proc     Process where the page resides.
  * @param addr     Address where the page resides.
  * @param writable Is the page writable?
  * 
  * @returns Zero upon successful completion, and non-zero otherwise.
  */
-PRIVATE int allocupg(addr_t vaddr, int writable)
+PRIVATE int allocupg(struct process *proc, addr_t vaddr, int writable)
 {
 	addr_t paddr;   /* Page address.             */
 	struct pte *pg; /* Working page table entry. */
 	
 	/* Failed to allocate page frame. */
-	if (!(paddr = frame_alloc()))
+	if (!(paddr = frame_alloc_color(PG(vaddr))))
 		return (-1);
 
 	vaddr &= PAGE_MASK;
 	
 	/* Allocate page. */
-	pg = getpte(curr_proc, vaddr);
+	pg = getpte(proc, vaddr);
 	pte_init(pg, writable);
 	pg->frame = paddr;
 	
 	tlb_flush();
 	cpus[curr_core].curr_thread->tlb_flush = 1;
 	
-	kmemset((void *)(vaddr), 0, PAGE_SIZE);
+	kmemset(UMEM_PAGE(paddr), 0, PAGE_SIZE);
 	
 	return (0);
 }
 
+/**
+ * @brief Enables copy-on-write on a page.
+ *
+ * @param pg Target page.
+ */
+PRIVATE void cow_enable(struct pte *pg)
+{
+	pte_cow_set(pg, 1);
+	pte_write_set(pg, 0);
+}
+
+/**
+ * @brief Maps the shared zero page.
+ * 
+ * @details Writable pages are mapped copy-on-write, so that a private page
+ *          frame is assigned on the first write.
+ * 
+ * @param pg       Demand zero page.
+ * @param writable Is the page writable?
+ */
+PRIVATE void zeroupg(struct pte *pg, int writable)
+{
+	pte_init(pg, 0);
+	if (writable)
+		cow_enable(pg);
+	pg->frame = zero_frame;
+	frame_share(zero_frame);
+	
+	tlb_flush();
+	cpus[curr_core].curr_thread->tlb_flush = 1;
+}
+
+/**
+ * @brief Swaps in a user page.
+ * 
+ * @param pg       Swapped out page.
+ * @param writable Is the page writable?
+ * 
+ * @returns Zero upon successful completion, and non-zero otherwise.
+ */
+PRIVATE int swapinpg(struct pte *pg, int writable)
+{
+	addr_t slot;  /* Swap slot.  */
+	addr_t frame; /* Page frame. */
+	
+	slot = pg->frame;
+	
+	/* Failed to allocate page frame. */
+	if (!(frame = frame_alloc_color(PTE_COLOR(pg))))
+		return (-1);
+	
+	/* Failed to read page. */
+	if (swap_read(slot, UMEM_PAGE(frame)))
+	{
+		frame_free(frame);
+		return (-1);
+	}
+	
+	pte_init(pg, writable);
+	pg->frame = frame;
+	swap_free(slot);
+	
+	tlb_flush();
+	cpus[curr_core].curr_thread->tlb_flush = 1;
+	
+	return (0);
+}
+
+/**
+ * @brief Disables copy-on-write on a page.
+ *
+ * @param pg Target page.
+ *
+ * @returns Zero on success, and non zero otherwise.
+ */
+PRIVATE int cow_disable(struct pte *pg)
+{
+	/* Steal page. */
+	if (frame_is_shared(pg->frame))
+	{
+		/* Clone page. */
+		if (clonepg(pg))
+			return (-1);
+	}
+	
+	/* Page is not merged anymore. */
+	else
+		merged[frame_addr_to_id(pg->frame)] = 0;
+
+	pte_cow_set(pg, 0);
+	pte_write_set(pg, 1);
+	
+	tlb_flush();
+	cpus[curr_core].curr_thread->tlb_flush = 1;
+
+	return (0);
+}
+
+/**
+ * @brief Asserts if copy-on-write is enabled on a page.
+ *
+ * @param pg Target page.
+ *
+ * @returns Non zero if copy-on-write is enabled, and zero otherwise.
+ */
+PRIVATE int cow_is_enabled(struct pte *pg)
+{
+	return ((pte_is_cow(pg)) && (!pte_is_write(pg)));
+}
+
+/**
+ * @brief Writes to user pages of a process.
+ *
+ * @details Copies @p n bytes from @p buf to the address @p addr in the
+ *          address space of the process pointed to by @p proc, which need not
+ *          be the current one. Demand zero pages are assigned and copy-on-write
+ *          pages are copied on the way.
+ *
+ * @param proc Target process.
+ * @param addr Target address.
+ * @param buf  Data to be written.
+ * @param n    Number of bytes.
+ *
+ * @returns Zero upon successful completion, and non-zero otherwise.
+ *
+ * @note The target pages must belong to private writable regions that are
+ *       attached to the process.
+ */
+PUBLIC int writeupg(struct process *proc, addr_t addr, const void *buf, size_t n)
+{
+	size_t chunk;   /* Bytes to copy.            */
+	struct pte *pg; /* Working page table entry. */
+	const char *p;  /* Read pointer.             */
+
+	p = buf;
+	while (n > 0)
+	{
+		chunk = PAGE_SIZE - (addr & ~PAGE_MASK);
+		chunk = (n < chunk) ? n : chunk;
+
+		pg = getpte(proc, addr);
+
+		/* Swap in page. */
+		if (pte_is_swap(pg))
+		{
+			if (swapinpg(pg, 1))
+				return (-1);
+			regrss_add(proc, findreg(proc, addr)->reg, 1);
+		}
+
+		/* Assign demand zero page. */
+		else if (!pte_is_present(pg))
+		{
+			if (!pte_is_zero(pg) || allocupg(proc, addr, 1))
+				return (-1);
+			regrss_add(proc, findreg(proc, addr)->reg, 1);
+		}
+
+		/* Break copy on write. */
+		else if (cow_is_enabled(pg))
+		{
+			if (cow_disable(pg))
+				return (-1);
+		}
+
+		kmemcpy((char *)UMEM_PAGE(pg->frame) + (addr & ~PAGE_MASK), p, chunk);
+
+		n -= chunk;
+		addr += chunk;
+		p += chunk;
+	}
+
+	return (0);
+}
+
 /**
  * @brief Reads a page from a file.
  * 
- * @param reg  Region where the page resides.
+ * @details Pages that lie entirely within the file are taken from the page
+ *          cache and mapped straight into the process. Writable pages of
+ *          private regions are mapped copy-on-write, so that the cached copy
+ *          stays intact. Shared regions map cached pages even at the end of
+ *          the file. Remaining pages are read into a private page frame.
+ * 
+ * @param preg Process region where the page resides.
  * @param addr Address where the page should be loaded. 
  * 
  * @returns Zero upon successful completion, and non-zero upon failure.
  */
-PRIVATE int readpg(struct region *reg, addr_t addr)
+PRIVATE int readpg(struct pregion *preg, addr_t addr)
 {
 	char *p;             /* Read pointer.             */
-	off_t off;           /* Block offset.             */
+	off_t off;           /* File offset.              */
+	size_t n;            /* Bytes to read.            */
 	ssize_t count;       /* Bytes read.               */
 	struct inode *inode; /* File inode.               */
+	struct region *reg;  /* Working region.           */
 	struct pte *pg;      /* Working page table entry. */
 	
 	addr &= PAGE_MASK;
-	
-	/* Assign a user page. */
-	if (allocupg(addr, reg->mode & MAY_WRITE))
-		return (-1);
+	reg = preg->reg;
 	
 	/* Find page table entry. */
 	pg = getpte(curr_proc, addr);
 	
-	/* Read page. */
-	off = reg->file.off + (PG(addr) << PAGE_SHIFT);
+	off = reg->file.off + (addr - preg->start);
 	inode = reg->file.inode;
-	p = (char *)(addr);
-	count = file_read(inode, p, PAGE_SIZE, off);
+	n = reg->file.size - (addr - preg->start);
+	
+	/* Map cached page. */
+	if (((n >= PAGE_SIZE) || (reg->flags & REGION_SHARED)) && !(off & ~PAGE_MASK))
+	{
+		inode_lock(inode);
+		p = pcache_get(inode, off);
+		inode_unlock(inode);
+		
+		if (p != NULL)
+		{
+			/* Shared mappings write straight to the page cache. */
+			if (reg->flags & REGION_SHARED)
+				pte_init(pg, reg->mode & MAY_WRITE);
+			else
+			{
+				pte_init(pg, 0);
+				if (reg->mode & MAY_WRITE)
+					cow_enable(pg);
+			}
+			pg->frame = UMEM_FRAME(p);
+			
+			tlb_flush();
+			cpus[curr_core].curr_thread->tlb_flush = 1;
+			
+			return (0);
+		}
+	}
+	
+	/* Assign a user page. */
+	if (allocupg(curr_proc, addr, reg->mode & MAY_WRITE))
+		return (-1);
+	
+	/* Read page. */
+	p = UMEM_PAGE(pg->frame);
+	count = file_read(inode, p, (n < PAGE_SIZE) ? n : PAGE_SIZE, off);
 	
 	/* Failed to read page. */
 	if (count < 0)
@@ -492,6 +1034,39 @@ PRIVATE int readpg(struct region *reg, addr_t addr)
 	return (0);
 }
 
+/**
+ * @brief Merges a user page.
+ * 
+ * @details Maps the page frame @p frame, which should have the very same
+ *          contents, at the page pointed to by @p pg, and releases the
+ *          page frame that was there. Writable pages are mapped
+ *          copy-on-write. If @p frame is already mapped at @p pg, the page
+ *          is just write protected, so that other pages may be merged into
+ *          it later on.
+ * 
+ * @param pg    Target page.
+ * @param frame Merged page frame.
+ * 
+ * @note The memory region of the target page must be locked.
+ */
+PUBLIC void mergeupg(struct pte *pg, addr_t frame)
+{
+	if (pte_is_write(pg))
+		cow_enable(pg);
+	
+	if (pg->frame != frame)
+	{
+		frame_share(frame);
+		frame_free(pg->frame);
+		pg->frame = frame;
+	}
+	
+	merged[frame_addr_to_id(frame)] = 1;
+	
+	tlb_flush();
+	cpus[curr_core].curr_thread->tlb_flush = 1;
+}
+
 /**
  * @brief Frees a user page.
  * 
@@ -510,6 +1085,13 @@ PUBLIC void freeupg(struct pte *pg)
 		if (pte_is_fill(pg) || pte_is_zero(pg))
 			goto done;
 
+		/* Swapped out page. */
+		if (pte_is_swap(pg))
+		{
+			swap_free(pg->frame);
+			goto done;
+		}
+
 		kpanic("mm: freeing invalid user page");
 	}
 		
@@ -551,55 +1133,6 @@ PUBLIC void markpg(struct pte *pg, int mark)
 	}
 }
 
-/**
- * @brief Enables copy-on-write on a page.
- *
- * @param pg Target page.
- */
-PRIVATE void cow_enable(struct pte *pg)
-{
-	pte_cow_set(pg, 1);
-	pte_write_set(pg, 0);
-}
-
-/**
- * @brief Disables copy-on-write on a page.
- *
- * @param pg Target page.
- *
- * @returns Zero on success, and non zero otherwise.
- */
-PRIVATE int cow_disable(struct pte *pg)
-{
-	/* Steal page. */
-	if (frame_is_shared(pg->frame))
-	{
-		/* Clone page. */
-		if (clonepg(pg))
-			return (-1);
-	}
-
-	pte_cow_set(pg, 0);
-	pte_write_set(pg, 1);
-	
-	tlb_flush();
-	cpus[curr_core].curr_thread->tlb_flush = 1;
-
-	return (0);
-}
-
-/**
- * @brief Asserts if copy-on-write is enabled on a page.
- *
- * @param pg Target page.
- *
- * @returns Non zero if copy-on-write is enabled, and zero otherwise.
- */
-PRIVATE int cow_is_enabled(struct pte *pg)
-{
-	return ((pte_is_cow(pg)) && (!pte_is_write(pg)));
-}
-
 /**
  * @brief Links two pages.
  * 
@@ -622,6 +1155,14 @@ PUBLIC void linkupg(struct pte *upg1, struct pte *upg2)
 			return;
 		}
 
+		/* Swapped out page. */
+		if (pte_is_swap(upg1))
+		{
+			swap_dup(upg1->frame);
+			kmemcpy(upg2, upg1, sizeof(struct pte));
+			return;
+		}
+
 		kpanic("linking invalid user page");
 	}
 
@@ -653,7 +1194,8 @@ PUBLIC void dstrypgdir(struct process *proc)
 	while (t != NULL)
 	{
 		putkpg(t->kstack);
-		putkpg(t->ipikstack);
+		if (t->ipikstack != NULL)
+			putkpg(t->ipikstack);
 		t = t->next;
 	}
 	putkpg(proc->pgdir);
@@ -662,12 +1204,17 @@ PUBLIC void dstrypgdir(struct process *proc)
 /**
  * @brief Handles a validity page fault.
  * 
- * @brief addr Faulting address.
+ * @details Demand zero pages of private regions that are read map the
+ *          shared zero page, so that no page frame is assigned until they
+ *          are written.
+ * 
+ * @brief addr  Faulting address.
+ * @brief write Was it a write access?
  * 
  * @returns Upon successful completion, zero is returned. Upon
  * failure, non-zero is returned instead.
  */
-PUBLIC int vfault(addr_t addr)
+PUBLIC int vfault(addr_t addr, int write)
 {
 	struct pte *pg;       /* Working page.           */
 	struct region *reg;   /* Working region.         */
@@ -705,25 +1252,52 @@ stack_reg:
 			goto error1;
 	}
 	
+	/* Region may not be accessed. */
+	if (!(reg->mode & MAY_READ))
+		goto error1;
+	
+	/* Large pages are always present. */
+	if (reg->flags & REGION_LARGE)
+		goto error1;
+	
 	pg = getpte(curr_proc, addr);
 	
+	/* Swapped out. */
+	if (pte_is_swap(pg))
+	{
+		if (swapinpg(pg, reg->mode & MAY_WRITE))
+			goto error1;
+		curr_proc->majflt++;
+	}
+	
 	/* Should be demand fill or demand zero. */
-	if (!(pte_is_fill(pg) || pte_is_zero(pg)))
+	else if (!(pte_is_fill(pg) || pte_is_zero(pg)))
 		goto error1;
 	
 	/* Demand fill. */
 	else if (pte_is_fill(pg))
 	{
-		if (readpg(reg, addr))
+		if (readpg(preg, addr))
 			goto error1;
+		curr_proc->majflt++;
+	}
+
+	/* Demand zero read. */
+	else if (!write && !(reg->flags & REGION_SHARED))
+	{
+		zeroupg(pg, reg->mode & MAY_WRITE);
+		curr_proc->minflt++;
 	}
 
 	/* Demand zero. */
 	else
 	{
-		if (allocupg(addr, reg->mode & MAY_WRITE))
+		if (allocupg(curr_proc, addr, reg->mode & MAY_WRITE))
 			goto error1;
+		curr_proc->minflt++;
 	}
+	
+	regrss_add(curr_proc, reg, 1);
 
 	unlockreg(reg);
 	return (0);
@@ -753,15 +1327,21 @@ PUBLIC int pfault(addr_t addr)
 	
 	lockreg(preg->reg);
 
+	/* Large pages are never copied on write. */
+	if (preg->reg->flags & REGION_LARGE)
+		goto error1;
+
 	pg = getpte(curr_proc, addr);
 
 	/* Copy on write not enabled. */
-	if (!cow_is_enabled(pg))
+	if (!cow_is_enabled(pg) || !(preg->reg->mode & MAY_WRITE))
 		goto error1;
 		
 	/* Copy page. */
 	if (cow_disable(pg))
 		goto error1;
+	curr_proc->minflt++;
+	curr_proc->cowflt++;
 
 	unlockreg(preg->reg);
 	return(0);
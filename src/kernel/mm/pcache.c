@@ -0,0 +1,379 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/config.h>
+#include <nanvix/const.h>
+#include <nanvix/fs.h>
+#include <nanvix/hal.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include "mm.h"
+
+/**
+ * @brief Hash table size of the page cache.
+ */
+#define PCACHE_HASHTAB_SIZE 127
+
+/**
+ * @brief Cached page.
+ */
+struct cpage
+{
+	/**
+	 * @name General information
+	 */
+	/**@{*/
+	dev_t dev;    /**< Device.                    */
+	ino_t num;    /**< Inode number.              */
+	off_t off;    /**< Page offset in the file.   */
+	addr_t frame; /**< Underlying page frame.     */
+	/**@}*/
+
+	/**
+	 * @name Cache information.
+	 */
+	/**@{*/
+	struct cpage *lru_next;  /**< Next page in the LRU list.         */
+	struct cpage *lru_prev;  /**< Previous page in the LRU list.     */
+	struct cpage *hash_next; /**< Next page in the hash table.       */
+	struct cpage *hash_prev; /**< Previous page in the hash table.   */
+	/**@}*/
+};
+
+/**
+ * @brief Cached pages.
+ */
+PRIVATE struct cpage cpages[NR_CACHED_PAGES];
+
+/**
+ * @brief List of free cache entries.
+ */
+PRIVATE struct cpage *free_cpages = NULL;
+
+/**
+ * @brief LRU list of cached pages.
+ *
+ * @details Most recently used pages are kept at the head of the list.
+ */
+PRIVATE struct cpage lru;
+
+/**
+ * @brief Page cache hash table.
+ */
+PRIVATE struct cpage hashtab[PCACHE_HASHTAB_SIZE];
+
+/**
+ * @brief Hash function for the page cache hash table.
+ *
+ * @details Hashes a device number, an inode number and a page offset to a
+ *          page cache hash table slot.
+ */
+#define HASH(dev, num, off) \
+	(((dev)^(num)^((off) >> PAGE_SHIFT))%PCACHE_HASHTAB_SIZE)
+
+/**
+ * @brief Initializes the page cache.
+ */
+PUBLIC void pcache_init(void)
+{
+	lru.lru_next = &lru;
+	lru.lru_prev = &lru;
+
+	for (unsigned i = 0; i < PCACHE_HASHTAB_SIZE; i++)
+	{
+		hashtab[i].hash_next = &hashtab[i];
+		hashtab[i].hash_prev = &hashtab[i];
+	}
+
+	for (unsigned i = 0; i < NR_CACHED_PAGES; i++)
+		cpages[i].lru_next = (i + 1 < NR_CACHED_PAGES) ? &cpages[i + 1] : NULL;
+	free_cpages = &cpages[0];
+}
+
+/**
+ * @brief Removes a page from the page cache.
+ *
+ * @param pg Target page.
+ */
+PRIVATE void pcache_remove(struct cpage *pg)
+{
+	/* Remove page from the hash table. */
+	pg->hash_prev->hash_next = pg->hash_next;
+	pg->hash_next->hash_prev = pg->hash_prev;
+
+	/* Remove page from the LRU list. */
+	pg->lru_prev->lru_next = pg->lru_next;
+	pg->lru_next->lru_prev = pg->lru_prev;
+
+	frame_free(pg->frame);
+
+	pg->lru_next = free_cpages;
+	free_cpages = pg;
+}
+
+/**
+ * @brief Searches for a page in the page cache.
+ *
+ * @param dev Device number.
+ * @param num Inode number.
+ * @param off Page offset.
+ *
+ * @returns If the page is cached, a pointer to it is returned. Otherwise, a
+ *          #NULL pointer is returned instead.
+ */
+PRIVATE struct cpage *pcache_search(dev_t dev, ino_t num, off_t off)
+{
+	struct cpage *pg;
+	struct cpage *head;
+
+	head = &hashtab[HASH(dev, num, off)];
+
+	for (pg = head->hash_next; pg != head; pg = pg->hash_next)
+	{
+		if ((pg->dev == dev) && (pg->num == num) && (pg->off == off))
+			return (pg);
+	}
+
+	return (NULL);
+}
+
+/**
+ * @brief Reclaims a page from the page cache.
+ *
+ * @details Evicts the least recently used page that is not mapped by any
+ *          process nor being used by the kernel.
+ *
+ * @returns Zero if a page frame was released, and non-zero otherwise.
+ */
+PUBLIC int pcache_reclaim(void)
+{
+	struct cpage *pg;
+
+	for (pg = lru.lru_prev; pg != &lru; pg = pg->lru_prev)
+	{
+		/* Page is in use. */
+		if (frame_is_shared(pg->frame))
+			continue;
+
+		pcache_remove(pg);
+
+		return (0);
+	}
+
+	return (-1);
+}
+
+/**
+ * @brief Takes a reference to a cached page.
+ *
+ * @param pg Target page.
+ *
+ * @returns The kernel virtual address of the page.
+ */
+PRIVATE void *pcache_hit(struct cpage *pg)
+{
+	/* Move page to the head of the LRU list. */
+	pg->lru_prev->lru_next = pg->lru_next;
+	pg->lru_next->lru_prev = pg->lru_prev;
+	pg->lru_next = lru.lru_next;
+	pg->lru_prev = &lru;
+	lru.lru_next->lru_prev = pg;
+	lru.lru_next = pg;
+
+	frame_share(pg->frame);
+
+	return (UMEM_PAGE(pg->frame));
+}
+
+/**
+ * @brief Gets a page from the page cache.
+ *
+ * @details Gets the page at offset @p off in the file pointed to by @p ip.
+ *          If the page is not in the page cache, it is read in.
+ *
+ * @param ip  File inode.
+ * @param off Page-aligned offset in the file.
+ *
+ * @returns Upon successful completion, the kernel virtual address of the
+ *          page is returned. In this case, the page is ensured not to be
+ *          evicted until it is released with pcache_put(). Upon failure, a
+ *          #NULL pointer is returned instead.
+ *
+ * @note The inode must be locked.
+ */
+PUBLIC void *pcache_get(struct inode *ip, off_t off)
+{
+	addr_t frame;     /* Page frame.       */
+	struct cpage *pg; /* Working page.     */
+	unsigned i;       /* Hash table index. */
+
+	/* Operation not supported. */
+	if ((ip->i_op == NULL) || (ip->i_op->readpage == NULL))
+		return (NULL);
+
+	/* Cache hit. */
+	if ((pg = pcache_search(ip->dev, ip->num, off)) != NULL)
+		return (pcache_hit(pg));
+
+	/* Get a free cache entry. */
+	if (free_cpages == NULL)
+	{
+		if (pcache_reclaim())
+			return (NULL);
+	}
+
+	/* Color the page after its file offset. */
+	if (!(frame = frame_alloc_color(off >> PAGE_SHIFT)))
+		return (NULL);
+
+	/* Read page. */
+	if (ip->i_op->readpage(ip, UMEM_PAGE(frame), off))
+	{
+		frame_free(frame);
+		return (NULL);
+	}
+
+	/*
+	 * Reading may sleep. Another reader may have
+	 * cached the same page in the meantime, and
+	 * that copy is the one kept up to date.
+	 */
+	if ((pg = pcache_search(ip->dev, ip->num, off)) != NULL)
+	{
+		frame_free(frame);
+		return (pcache_hit(pg));
+	}
+
+	/* Entry stolen while reading. */
+	if ((free_cpages == NULL) && (pcache_reclaim()))
+	{
+		frame_free(frame);
+		return (NULL);
+	}
+
+	pg = free_cpages;
+	free_cpages = pg->lru_next;
+
+	pg->dev = ip->dev;
+	pg->num = ip->num;
+	pg->off = off;
+	pg->frame = frame;
+
+	/* Insert page in the hash table. */
+	i = HASH(pg->dev, pg->num, pg->off);
+	pg->hash_next = hashtab[i].hash_next;
+	pg->hash_prev = &hashtab[i];
+	hashtab[i].hash_next->hash_prev = pg;
+	hashtab[i].hash_next = pg;
+
+	/* Insert page in the LRU list. */
+	pg->lru_next = lru.lru_next;
+	pg->lru_prev = &lru;
+	lru.lru_next->lru_prev = pg;
+	lru.lru_next = pg;
+
+	frame_share(frame);
+
+	return (UMEM_PAGE(frame));
+}
+
+/**
+ * @brief Releases a page of the page cache.
+ *
+ * @param page Kernel virtual address of the page.
+ */
+PUBLIC void pcache_put(void *page)
+{
+	frame_free(UMEM_FRAME(page));
+}
+
+/**
+ * @brief Updates cached pages of a file.
+ *
+ * @details Copies @p n bytes from @p buf into the cached pages of the file
+ *          pointed to by @p ip, starting at offset @p off. Pages that are not
+ *          cached are left untouched.
+ *
+ * @param ip  File inode.
+ * @param off File offset.
+ * @param buf Data.
+ * @param n   Number of bytes.
+ *
+ * @note The inode must be locked.
+ */
+PUBLIC void pcache_update(struct inode *ip, off_t off, const void *buf, size_t n)
+{
+	size_t pgoff;     /* Page offset.     */
+	size_t chunk;     /* Data chunk size. */
+	struct cpage *pg; /* Working page.    */
+	const char *p;    /* Reading pointer. */
+
+	p = buf;
+	while (n > 0)
+	{
+		pgoff = off & ~PAGE_MASK;
+		chunk = (n < PAGE_SIZE - pgoff) ? n : PAGE_SIZE - pgoff;
+
+		pg = pcache_search(ip->dev, ip->num, off - pgoff);
+		if (pg != NULL)
+			kmemcpy((char *)UMEM_PAGE(pg->frame) + pgoff, p, chunk);
+
+		n -= chunk;
+		off += chunk;
+		p += chunk;
+	}
+}
+
+/**
+ * @brief Invalidates cached pages of a file.
+ *
+ * @param ip File inode.
+ *
+ * @note The inode must be locked.
+ */
+PUBLIC void pcache_invalidate(struct inode *ip)
+{
+	for (struct cpage *pg = lru.lru_next; pg != &lru; /* noop */)
+	{
+		struct cpage *next = pg->lru_next;
+
+		if ((pg->dev == ip->dev) && (pg->num == ip->num))
+			pcache_remove(pg);
+
+		pg = next;
+	}
+}
+
+/**
+ * @brief Invalidates cached pages of a device.
+ *
+ * @param dev Target device.
+ */
+PUBLIC void pcache_flush(dev_t dev)
+{
+	for (struct cpage *pg = lru.lru_next; pg != &lru; /* noop */)
+	{
+		struct cpage *next = pg->lru_next;
+
+		if (pg->dev == dev)
+			pcache_remove(pg);
+
+		pg = next;
+	}
+}
@@ -35,7 +35,7 @@
 /**
  * @brief Memory region table.
  */
-PRIVATE struct region regtab[NR_REGIONS];
+PUBLIC struct region regtab[NR_REGIONS];
 
 /*
  * @brief Mini region table.
@@ -80,6 +80,49 @@ PRIVATE inline void freemreg(struct miniregion *mreg)
 	mreg->flags = MREGION_FREE;
 }
 
+/**
+ * @brief Expands a memory region that is mapped with large pages.
+ * 
+ * @details Large pages are allocated up front, since a fault on a large
+ *          page cannot be served with a single page frame.
+ * 
+ * @param reg  Memory region that shall be expanded.
+ * @param size Size in bytes to be added to the memory region.
+ * 
+ * @returns Zero upon success, and non-zero otherwise.
+ */
+PRIVATE int expandlarge(struct region *reg, size_t size)
+{
+	unsigned i, j; /* Loop indexes. */
+	
+	size = ALIGN(size, LPAGE_SIZE);
+	
+	/* Region too big. */
+	if (reg->size + size > REGION_SIZE)
+		return (-1);
+	
+	while (size > 0)
+	{
+		i = reg->size >> MREGION_SHIFT;
+		j = (reg->size >> PGTAB_SHIFT) - (REGION_PGTABS*i);
+		
+		/* Create mini region. */
+		if (reg->mtab[i] == NULL)
+		{
+			if ((reg->mtab[i] = allocmreg()) == NULL)
+				return (-1);
+		}
+		
+		if (!(reg->mtab[i]->lframe[j] = lframe_alloc()))
+			return (-1);
+		
+		size -= LPAGE_SIZE;
+		reg->size += LPAGE_SIZE;
+	}
+	
+	return (0);
+}
+
 /**
  * @brief Expands a memory region.
  * 
@@ -97,6 +140,10 @@ PRIVATE int expand(struct process *proc, struct region *reg, size_t size)
 	size_t newmaxsize;    /* New maximum size of the region.*/
 	struct pte *pgtab;    /* Working page table entry.      */
 	
+	/* Large pages. */
+	if (reg->flags & REGION_LARGE)
+		return ((proc == NULL) ? expandlarge(reg, size) : -1);
+	
 	size = ALIGN(size, PAGE_SIZE);
 	preg = reg->preg;
 
@@ -135,7 +182,7 @@ PRIVATE int expand(struct process *proc, struct region *reg, size_t size)
 			return (-1);
 
 		/* Check for stack overflow. */
-		if (newmaxsize > THRD_STACK_SIZE)
+		if (newmaxsize > reg->maxsize)
 		{
 			kprintf("expand region stack overflow");
 			return (-1);
@@ -431,6 +478,7 @@ found:
 	reg->flags = flags & ~(REGION_FREE | REGION_LOCKED);
 	reg->count = 0;
 	reg->size = 0;
+	reg->maxsize = (flags & REGION_DOWNWARDS) ? THRD_STACK_SIZE : REGION_SIZE;
 	reg->chain = NULL;
 	reg->file.inode = NULL;
 	reg->file.off = 0;
@@ -485,6 +533,13 @@ PUBLIC void freereg(struct region *reg)
 
 		for (j = 0; j < REGION_PGTABS; j++)
 		{
+			/* Free underlying large page. */
+			if (reg->mtab[i]->lframe[j])
+			{
+				lframe_free(reg->mtab[i]->lframe[j]);
+				reg->mtab[i]->lframe[j] = 0;
+			}
+			
 			/* Skip invalid page tables. */
 			if (reg->mtab[i]->pgtab[j] == NULL)
 				continue;
@@ -523,6 +578,177 @@ PUBLIC int editreg(struct region *reg, uid_t uid, gid_t gid, mode_t mode)
 	return (0);
 }
 
+/**
+ * @brief Maximum number of entries in the table of sorted process regions.
+ */
+#define NR_RTAB (PAGE_SIZE/sizeof(struct pregion *))
+
+/**
+ * @brief Compares an address against a process region.
+ * 
+ * @param preg Target process region.
+ * @param addr Address to be compared.
+ * 
+ * @returns A negative number if the process region lies below @p addr, a
+ *          positive number if it lies above @p addr, and zero if it
+ *          contains @p addr.
+ */
+PRIVATE int regcmp(struct pregion *preg, addr_t addr)
+{
+	struct region *reg = preg->reg;
+	
+	/* Region grows downwards. */
+	if (reg->flags & REGION_DOWNWARDS)
+	{
+		if (addr > preg->start)
+			return (-1);
+		return ((addr >= preg->start - reg->size) ? 0 : 1);
+	}
+	
+	/* Region grows upwards. */
+	if (addr < preg->start)
+		return (1);
+	return ((addr < preg->start + reg->size) ? 0 : -1);
+}
+
+/**
+ * @brief Inserts a process region in the table of sorted process regions.
+ * 
+ * @details Process regions do not overlap, so they are kept sorted by their
+ *          start address.
+ * 
+ * @param proc Target process.
+ * @param preg Process region to be inserted.
+ * 
+ * @note The table must have room for the process region.
+ */
+PRIVATE void rtab_insert(struct process *proc, struct pregion *preg)
+{
+	unsigned i;
+	
+	for (i = proc->nrtab; i > 0; i--)
+	{
+		if (proc->rtab[i - 1]->start < preg->start)
+			break;
+		proc->rtab[i] = proc->rtab[i - 1];
+	}
+	
+	proc->rtab[i] = preg;
+	proc->nrtab++;
+}
+
+/**
+ * @brief Removes a process region from the table of sorted process regions.
+ * 
+ * @details The table is released once it becomes empty. Threads that
+ *          have @p preg as their last hit in findreg() forget about it.
+ * 
+ * @param proc Target process.
+ * @param preg Process region to be removed.
+ */
+PRIVATE void rtab_remove(struct process *proc, struct pregion *preg)
+{
+	unsigned i;
+	
+	for (struct thread *t = proc->threads; t != NULL; t = t->next)
+	{
+		if (t->lastreg == preg)
+			t->lastreg = NULL;
+	}
+	
+	for (i = 0; i < proc->nrtab; i++)
+	{
+		if (proc->rtab[i] == preg)
+			break;
+	}
+	
+	/* Not found. */
+	if (i == proc->nrtab)
+		kpanic("mm: process region not indexed");
+	
+	for (proc->nrtab--; i < proc->nrtab; i++)
+		proc->rtab[i] = proc->rtab[i + 1];
+	
+	/* Release table. */
+	if (proc->nrtab == 0)
+	{
+		putkpg(proc->rtab);
+		proc->rtab = NULL;
+	}
+}
+
+/**
+ * @brief Counts the resident pages of a memory region.
+ * 
+ * @param reg    Target memory region.
+ * @param shared Store for the number of shared pages (may be #NULL).
+ * 
+ * @returns The number of resident pages of the memory region.
+ */
+PRIVATE unsigned regrss(struct region *reg, unsigned *shared)
+{
+	unsigned rss;      /* Resident pages. */
+	unsigned nshared;  /* Shared pages.   */
+	struct pte *pgtab; /* Page table.     */
+	
+	rss = 0;
+	nshared = 0;
+	for (unsigned i = 0; i < MREGIONS; i++)
+	{
+		/* Skip invalid mini regions. */
+		if (reg->mtab[i] == NULL)
+			continue;
+		
+		for (unsigned j = 0; j < REGION_PGTABS; j++)
+		{
+			/* Large page. */
+			if (reg->mtab[i]->lframe[j])
+			{
+				rss += LPAGE_SIZE/PAGE_SIZE;
+				if (reg->count > 1)
+					nshared += LPAGE_SIZE/PAGE_SIZE;
+				continue;
+			}
+			
+			/* Skip invalid page tables. */
+			if ((pgtab = reg->mtab[i]->pgtab[j]) == NULL)
+				continue;
+			
+			for (unsigned k = 0; k < PAGE_SIZE/PTE_SIZE; k++)
+			{
+				/* Page not in memory. */
+				if (!pte_is_present(&pgtab[k]))
+					continue;
+				
+				rss++;
+				if ((reg->count > 1) || frame_is_shared(pgtab[k].frame))
+					nshared++;
+			}
+		}
+	}
+	
+	if (shared != NULL)
+		*shared = nshared;
+	
+	return (rss);
+}
+
+/**
+ * @brief Adds to the resident pages of a process.
+ * 
+ * @details The peak resident set size of the process is raised as well, so
+ *          that it is exact whenever pages are brought into memory.
+ * 
+ * @param proc Target process.
+ * @param n    Number of pages (may be negative).
+ */
+PRIVATE void procrss_add(struct process *proc, int n)
+{
+	proc->rss += n;
+	if (proc->rss > proc->maxrss)
+		proc->maxrss = proc->rss;
+}
+
 /**
  * @brief Attaches a memory region to a process.
  * 
@@ -569,6 +795,10 @@ PUBLIC int attachreg
 	/* Process cannot grow more. */
 	if (proc->size + reg->size > PROC_SIZE_MAX)
 		return (-1);
+	
+	/* Too many process regions. */
+	if (proc->nrtab == NR_RTAB)
+		return (-1);
 
 	/* Attaching shared region. */
 	if (reg->flags & REGION_SHARED)
@@ -585,6 +815,13 @@ PUBLIC int attachreg
 		if (reg->count > 0)
 			return (-1);
 	}
+	
+	/* Allocate table of sorted process regions. */
+	if (proc->rtab == NULL)
+	{
+		if ((proc->rtab = getkpg(0)) == NULL)
+			return (-1);
+	}
 
 	/* Map page tables. */
 	addr = start;
@@ -619,6 +856,13 @@ PUBLIC int attachreg
 					/* Map only valid page tables. */
 					if (reg->mtab[i]->pgtab[j] != NULL)
 						mappgtab(proc, addr, reg->mtab[i]->pgtab[j]);
+					
+					/* Map accessible large pages. */
+					else if ((reg->mtab[i]->lframe[j]) && (reg->mode & MAY_READ))
+					{
+						maplpg(proc, addr, reg->mtab[i]->lframe[j],
+							(reg->mode & MAY_WRITE) ? 1 : 0);
+					}
 					addr += PGTAB_SIZE;
 				}
 			}
@@ -633,6 +877,8 @@ PUBLIC int attachreg
 	reg->count++;
 	reg->preg = preg;
 	proc->size += reg->size;
+	rtab_insert(proc, preg);
+	procrss_add(proc, regrss(reg, NULL));
 
 	return (0);
 }
@@ -692,6 +938,10 @@ PUBLIC void detachreg(struct process *proc, struct pregion *preg)
 					/* Unmap only valid page tables. */
 					if (reg->mtab[i]->pgtab[j] != NULL)
 						umappgtab(proc, addr);
+					
+					/* Unmap mapped large pages. */
+					else if ((reg->mtab[i]->lframe[j]) && !addr_is_clear(proc, addr))
+						umappgtab(proc, addr);
 					addr += PGTAB_SIZE;
 				}
 			}
@@ -700,6 +950,8 @@ PUBLIC void detachreg(struct process *proc, struct pregion *preg)
 		}
 	}
 	
+	procrss_add(proc, -(int)regrss(reg, NULL));
+	rtab_remove(proc, preg);
 	preg->reg = NULL;
 	proc->size -= reg->size;
 	
@@ -730,6 +982,7 @@ PUBLIC struct region *dupreg(struct region *reg)
 	/* Failed to allocate new region. */
 	if ((new_reg = allocreg(reg->mode, reg->size, reg->flags)) == NULL)
 		return (NULL);
+	new_reg->maxsize = reg->maxsize;
 	
 	/* Link underlying page tables. */
 	for (i = 0; i < MREGIONS; i++)
@@ -739,6 +992,14 @@ PUBLIC struct region *dupreg(struct region *reg)
 
 		for (j = 0; j < REGION_PGTABS; j++)
 		{
+			/* Copy large page. */
+			if (reg->mtab[i]->lframe[j])
+			{
+				kmemcpy(UMEM_PAGE(new_reg->mtab[i]->lframe[j]),
+					UMEM_PAGE(reg->mtab[i]->lframe[j]), LPAGE_SIZE);
+				continue;
+			}
+			
 			/* Skip invalid page tables. */
 			if (reg->mtab[i]->pgtab[j] == NULL)
 				continue;
@@ -772,7 +1033,8 @@ PUBLIC struct region *dupreg(struct region *reg)
  */
 PUBLIC int growreg(struct process *proc, struct pregion *preg, ssize_t size)
 {
-	struct region *reg;
+	unsigned rss;       /* Resident pages. */
+	struct region *reg; /* Working region. */
 	
 	/* Attached shared regions may not grow. */
 	if ((reg = preg->reg)->flags & REGION_SHARED)
@@ -784,7 +1046,11 @@ PUBLIC int growreg(struct process *proc, struct pregion *preg, ssize_t size)
 	
 	/* Contract region */
 	if (size < 0)
+	{
+		rss = regrss(reg, NULL);
 		contract(proc, reg, -size);
+		procrss_add(proc, (int)regrss(reg, NULL) - (int)rss);
+	}
 	
 	/* Expand region. */
 	else
@@ -807,6 +1073,10 @@ PUBLIC int growreg(struct process *proc, struct pregion *preg, ssize_t size)
 /**
  * @brief Finds a memory region.
  * 
+ * @details The last process region found by the calling thread is checked
+ *          first. Otherwise, the table of sorted process regions is
+ *          binary searched.
+ * 
  * @param proc Process where the memory region shall be searched.
  * @param addr Address to be queried.
  * 
@@ -814,70 +1084,119 @@ PUBLIC int growreg(struct process *proc, struct pregion *preg, ssize_t size)
  *          returned. Upon failure, a NULL pointer is returned instead.
  */
 PUBLIC struct pregion *findreg(struct process *proc, addr_t addr)
-{        
-	struct region *reg;   /* Working memory region.  */
+{
+	int cmp;              /* Comparison result.      */
+	unsigned lo, hi;      /* Search bounds.          */
 	struct pregion *preg; /* Working process region. */
-	struct thread *t;     /* Working thread. */
+	struct thread *t;     /* Calling thread.         */
+	
+	t = (proc == curr_proc) ? cpus[curr_core].curr_thread : NULL;
 	
-	/* Find associated region. */
-	for (preg = &proc->pregs[0]; preg < &proc->pregs[NR_PREGIONS]; preg++)
+	/* Last hit. */
+	if ((t != NULL) && ((preg = t->lastreg) != NULL))
 	{
-		/* Skip invalid regions. */
-		if ((reg = preg->reg) == NULL)
-			continue;
+		if (regcmp(preg, addr) == 0)
+			return (preg);
+	}
+	
+	lo = 0;
+	hi = proc->nrtab;
+	while (lo < hi)
+	{
+		preg = proc->rtab[(lo + hi)/2];
 		
-		/* Region grows downwards. */
-		if (reg->flags & REGION_DOWNWARDS)
+		/* Found. */
+		if ((cmp = regcmp(preg, addr)) == 0)
 		{
-			if (addr <= preg->start)
-			{
-				if (addr >= preg->start - reg->size)
-					return (preg);
-			}
+			if (t != NULL)
+				t->lastreg = preg;
+			return (preg);
 		}
 		
-		/* Region grows upwards. */
+		if (cmp < 0)
+			lo = (lo + hi)/2 + 1;
 		else
-		{
-			if (addr >= preg->start)
-			{
-				if (addr < preg->start + reg->size)
-					return (preg);
-			}
-		}
+			hi = (lo + hi)/2;
 	}
+	
+	return (NULL);
+}
 
-	/* Find associated region in thread. */
-	t = proc->threads;
-	while (t != NULL)
+/**
+ * @brief Counts the resident pages of a process.
+ * 
+ * @details Walks the page tables of the regions attached to the process
+ *          pointed to by @p proc and counts pages that are in memory. Pages
+ *          whose frame is referenced elsewhere, or that belong to a region
+ *          attached more than once, are shared. The running count of
+ *          resident pages of the process is resynchronized as well.
+ * 
+ * @param proc   Target process.
+ * @param shared Store for the number of shared pages (may be #NULL).
+ * 
+ * @returns The number of resident pages of the process.
+ */
+PUBLIC unsigned procrss(struct process *proc, unsigned *shared)
+{
+	unsigned rss;     /* Resident pages.           */
+	unsigned nshared; /* Shared pages.             */
+	unsigned n;       /* Shared pages of a region. */
+	
+	rss = 0;
+	nshared = 0;
+	for (unsigned i = 0; i < proc->nrtab; i++)
 	{
-		preg = &t->pregs;
+		rss += regrss(proc->rtab[i]->reg, &n);
+		nshared += n;
+	}
+	
+	proc->rss = rss;
+	if (rss > proc->maxrss)
+		proc->maxrss = rss;
+	if (shared != NULL)
+		*shared = nshared;
+	
+	return (rss);
+}
 
-		/* Skip invalid regions. */
-		if ((reg = preg->reg) == NULL)
-		{
-			t = t->next;
+/**
+ * @brief Adds to the resident pages of a memory region.
+ * 
+ * @details Every process to which the memory region pointed to by @p reg is
+ *          attached is charged. The process table is only searched when
+ *          the region is attached more than once, or when its owner @p proc
+ *          is not known.
+ * 
+ * @param proc Process that owns the memory region (may be #NULL).
+ * @param reg  Target memory region.
+ * @param n    Number of pages (may be negative).
+ */
+PUBLIC void regrss_add(struct process *proc, struct region *reg, int n)
+{
+	struct process *p;
+	
+	/* Private region. */
+	if ((proc != NULL) && (reg->count <= 1))
+	{
+		procrss_add(proc, n);
+		return;
+	}
+	
+	for (p = FIRST_PROC; p <= LAST_PROC; p++)
+	{
+		/* Skip invalid processes. */
+		if (!IS_VALID(p))
 			continue;
-		}
-
-		/* Region grows downwards. */
-		if (reg->flags & REGION_DOWNWARDS)
+		
+		for (unsigned i = 0; i < p->nrtab; i++)
 		{
-			if (addr <= preg->start)
+			if (p->rtab[i]->reg == reg)
 			{
-				if (addr >= preg->start - reg->size)
-					return (preg);
+				procrss_add(p, n);
+				break;
 			}
 		}
-
-		/* Region grows upwards. */
-		else
-			kpanic("threads stack region grows upwards");
-
-		t = t->next;
 	}
-
-	return (NULL);
 }
 
 /**
@@ -0,0 +1,476 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/config.h>
+#include <nanvix/const.h>
+#include <nanvix/dev.h>
+#include <nanvix/hal.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <nanvix/region.h>
+#include <nanvix/smp.h>
+#include <errno.h>
+#include "mm.h"
+
+/**
+ * @brief Number of swap slots.
+ */
+#define NR_SWAP_SLOTS (SWAP_SIZE/PAGE_SIZE)
+
+/**
+ * @brief Maximum number of pages that are written at once.
+ */
+#define SWAP_BATCH 8
+
+/**
+ * @brief Number of page table entries in a page table.
+ */
+#define NR_PTES (PAGE_SIZE/PTE_SIZE)
+
+/**
+ * @brief Number of pages in a memory region.
+ */
+#define REGION_PAGES (MREGIONS*REGION_PGTABS*NR_PTES)
+
+/**
+ * @brief Offset of a swap slot in the swap device.
+ *
+ * @param slot Target swap slot.
+ */
+#define SWAP_OFF(slot) ((off_t)(slot) << PAGE_SHIFT)
+
+/**
+ * @brief Reference count for swap slots.
+ */
+PRIVATE unsigned char swap_map[NR_SWAP_SLOTS];
+
+/**
+ * @brief Next swap slot to be allocated.
+ */
+PRIVATE unsigned swap_next = 0;
+
+/**
+ * @brief Is swapping enabled?
+ */
+PRIVATE int swap_enabled = 0;
+
+/**
+ * @brief Is a page out on the way?
+ */
+PRIVATE int swap_busy = 0;
+
+/**
+ * @brief Threads waiting for a page out to complete.
+ */
+PRIVATE struct thread *swap_chain = NULL;
+
+/**
+ * @brief Sleeping chain of the page-out daemon.
+ */
+PRIVATE struct thread *kswapd_chain = NULL;
+
+/**
+ * @brief Buffer where batches of pages are gathered before being written.
+ */
+PRIVATE char swapbuf[SWAP_BATCH*PAGE_SIZE];
+
+/**
+ * @brief Hand of the CLOCK page replacement algorithm.
+ */
+PRIVATE struct
+{
+	unsigned reg; /**< Index of the memory region. */
+	unsigned pg;  /**< Page in the memory region.  */
+} hand = { 0, 0 };
+
+/**
+ * @brief Pages being swapped out.
+ */
+PRIVATE struct
+{
+	struct pte *pg;  /**< Page table entry.            */
+	struct pte old;  /**< Page table entry before.     */
+	addr_t slot;     /**< Swap slot.                   */
+} batch[SWAP_BATCH];
+
+/**
+ * @brief Enables swapping.
+ *
+ * @details Swapping is only enabled if the whole swap area can be read.
+ */
+PRIVATE void swap_on(void)
+{
+	ssize_t n;
+
+	n = bdev_read(SWAP_DEV, swapbuf, PAGE_SIZE, SWAP_OFF(NR_SWAP_SLOTS - 1));
+
+	/* No swap area. */
+	if (n != PAGE_SIZE)
+	{
+		kprintf("mm: no swap area");
+		return;
+	}
+
+	swap_enabled = 1;
+	kprintf("mm: %d KB swap area", SWAP_SIZE/1024);
+}
+
+/**
+ * @brief Allocates a swap slot.
+ *
+ * @returns Upon successful completion, the allocated swap slot is returned.
+ *          Upon failure, a negative number is returned instead.
+ */
+PRIVATE int swap_alloc(void)
+{
+	unsigned slot;
+
+	/* Slots are handed out in order, so that batches are contiguous. */
+	for (unsigned i = 0; i < NR_SWAP_SLOTS; i++)
+	{
+		slot = (swap_next + i)%NR_SWAP_SLOTS;
+
+		/* Found. */
+		if (swap_map[slot] == 0)
+		{
+			swap_map[slot] = 1;
+			swap_next = slot + 1;
+
+			return (slot);
+		}
+	}
+
+	return (-1);
+}
+
+/**
+ * @brief Increments the reference count of a swap slot.
+ *
+ * @param slot Target swap slot.
+ */
+PUBLIC void swap_dup(addr_t slot)
+{
+	swap_map[slot]++;
+}
+
+/**
+ * @brief Frees a swap slot.
+ *
+ * @param slot Target swap slot.
+ */
+PUBLIC void swap_free(addr_t slot)
+{
+	if (swap_map[slot]-- == 0)
+		kpanic("mm: double free on swap slot");
+}
+
+/**
+ * @brief Reads a page from the swap area.
+ *
+ * @param slot Swap slot where the page is stored.
+ * @param page Kernel virtual address where the page should be read into.
+ *
+ * @returns Zero upon successful completion, and non-zero otherwise.
+ */
+PUBLIC int swap_read(addr_t slot, void *page)
+{
+	if (bdev_read(SWAP_DEV, page, PAGE_SIZE, SWAP_OFF(slot)) != PAGE_SIZE)
+		return (-1);
+
+	return (0);
+}
+
+/**
+ * @brief Asserts if the pages of a memory region may be swapped out.
+ *
+ * @details Shared regions are not swapped, since their pages may belong to
+ *          the page cache. Large pages are never swapped out.
+ *
+ * @param reg Target memory region.
+ *
+ * @returns Non-zero if the pages of the region may be swapped out, and zero
+ *          otherwise.
+ */
+PRIVATE int swappable(struct region *reg)
+{
+	return (!(reg->flags & (REGION_FREE | REGION_LOCKED | REGION_SHARED |
+		REGION_LARGE)));
+}
+
+/**
+ * @brief Selects pages to be swapped out.
+ *
+ * @details Advances the hand of the CLOCK over the pages of the memory region
+ *          pointed to by @p reg. Pages that were recently accessed have their
+ *          accessed bit cleared and are given a second chance. Pages that are
+ *          shared with other regions or with the page cache are skipped.
+ *
+ * @param reg Target memory region.
+ *
+ * @returns The number of pages that were selected.
+ *
+ * @note The memory region must be locked.
+ */
+PRIVATE unsigned swap_select(struct region *reg)
+{
+	unsigned i, j, k;         /* Loop indexes.      */
+	unsigned n;               /* Selected pages.    */
+	struct miniregion *mreg;  /* Working mini region. */
+	struct pte *pg;           /* Working page.      */
+
+	for (n = 0; (hand.pg < REGION_PAGES) && (n < SWAP_BATCH); hand.pg++)
+	{
+		i = hand.pg/(REGION_PGTABS*NR_PTES);
+		j = (hand.pg/NR_PTES)%REGION_PGTABS;
+		k = hand.pg%NR_PTES;
+
+		/* Skip invalid mini regions. */
+		if ((mreg = reg->mtab[i]) == NULL)
+		{
+			hand.pg = (i + 1)*REGION_PGTABS*NR_PTES - 1;
+			continue;
+		}
+
+		/* Skip invalid page tables. */
+		if (mreg->pgtab[j] == NULL)
+		{
+			hand.pg = (i*REGION_PGTABS + j + 1)*NR_PTES - 1;
+			continue;
+		}
+
+		pg = &mreg->pgtab[j][k];
+
+		/* Page not in memory. */
+		if (!pte_is_present(pg))
+			continue;
+
+		/* Recently used. */
+		if (pte_is_accessed(pg))
+		{
+			pte_accessed_set(pg, 0);
+			continue;
+		}
+
+		/* Shared page. */
+		if (frame_is_shared(pg->frame))
+			continue;
+
+		batch[n++].pg = pg;
+	}
+
+	return (n);
+}
+
+/**
+ * @brief Swaps out selected pages.
+ *
+ * @details Selected pages are unmapped first, so that any access to them
+ *          blocks on the memory region lock until they are written. Pages
+ *          that are assigned to contiguous swap slots are written at once.
+ *
+ * @param reg Memory region of the selected pages.
+ * @param n   Number of selected pages.
+ *
+ * @returns Zero upon successful completion, and non-zero otherwise.
+ *
+ * @note The memory region of the selected pages must be locked.
+ */
+PRIVATE int swap_write(struct region *reg, unsigned n)
+{
+	int slot;        /* Swap slot.        */
+	unsigned i, j;   /* Loop indexes.     */
+	size_t size;     /* Bytes to write.   */
+	ssize_t ret;     /* Bytes written.    */
+	struct pte *pg;  /* Working page.     */
+
+	/* Allocate swap slots. */
+	for (i = 0; i < n; i++)
+	{
+		if ((slot = swap_alloc()) < 0)
+			break;
+		batch[i].slot = slot;
+	}
+
+	/* Swap area is full. */
+	if ((n = i) == 0)
+		return (-1);
+
+	/* Unmap pages. */
+	for (i = 0; i < n; i++)
+	{
+		pg = batch[i].pg;
+		batch[i].old = *pg;
+
+		pte_present_set(pg, 0);
+		pte_cow_set(pg, 0);
+		pte_swap_set(pg, 1);
+		pg->frame = batch[i].slot;
+	}
+
+	tlb_flush();
+	cpus[curr_core].curr_thread->tlb_flush = 1;
+
+	/* Write runs of contiguous swap slots. */
+	for (i = 0; i < n; i = j)
+	{
+		for (j = i; j < n; j++)
+		{
+			if (batch[j].slot != batch[i].slot + (j - i))
+				break;
+
+			kmemcpy(&swapbuf[(j - i)*PAGE_SIZE],
+				UMEM_PAGE(batch[j].old.frame), PAGE_SIZE);
+		}
+
+		size = (j - i)*PAGE_SIZE;
+
+		ret = bdev_write(SWAP_DEV, swapbuf, size, SWAP_OFF(batch[i].slot));
+		if (ret != (ssize_t)size)
+			goto error;
+	}
+
+	/* Release page frames. */
+	for (i = 0; i < n; i++)
+		frame_free(batch[i].old.frame);
+
+	regrss_add(NULL, reg, -(int)n);
+
+	return (0);
+
+error:
+
+	/*
+	 * Compressed swap devices may run out of memory for a
+	 * while. They then write fewer bytes or report ENOSPC.
+	 */
+	if ((ret < 0) && (ret != -ENOSPC))
+	{
+		kprintf("mm: failed to write to swap area");
+		swap_enabled = 0;
+	}
+
+	/* Map pages back. */
+	for (i = 0; i < n; i++)
+	{
+		*batch[i].pg = batch[i].old;
+		swap_free(batch[i].slot);
+	}
+
+	tlb_flush();
+	cpus[curr_core].curr_thread->tlb_flush = 1;
+
+	return (-1);
+}
+
+/**
+ * @brief Swaps out a batch of pages.
+ *
+ * @details Runs the CLOCK page replacement algorithm over the table of memory
+ *          regions, for at most two rounds. Memory regions that are locked
+ *          are skipped, so that this may be called while allocating a page
+ *          frame on behalf of a locked memory region.
+ *
+ * @returns Zero if some page frame was released, and non-zero otherwise.
+ */
+PUBLIC int swap_reclaim(void)
+{
+	int ret;            /* Return value.   */
+	unsigned n;         /* Selected pages. */
+	struct region *reg; /* Working region. */
+
+	/* Swapping is not possible. */
+	if (!swap_enabled || (curr_proc == IDLE))
+		return (-1);
+
+	/* Wait for ongoing page out. */
+	if (swap_busy)
+	{
+		while (swap_busy)
+			sleep(&swap_chain, PRIO_REGION);
+		return (0);
+	}
+
+	swap_busy = 1;
+	ret = -1;
+
+	for (unsigned i = 0; i < 2*NR_REGIONS; i++)
+	{
+		reg = &regtab[hand.reg];
+
+		if (swappable(reg))
+		{
+			lockreg(reg);
+			n = swap_select(reg);
+
+			if (n > 0)
+			{
+				ret = swap_write(reg, n);
+				unlockreg(reg);
+				break;
+			}
+
+			unlockreg(reg);
+		}
+
+		hand.reg = (hand.reg + 1)%NR_REGIONS;
+		hand.pg = 0;
+	}
+
+	swap_busy = 0;
+	wakeup(&swap_chain);
+
+	return (ret);
+}
+
+/**
+ * @brief Wakes up the page-out daemon.
+ */
+PUBLIC void kswapd_wakeup(void)
+{
+	wakeup(&kswapd_chain);
+}
+
+/**
+ * @brief Page-out daemon.
+ *
+ * @details Swaps out pages whenever free page frames run low, until there
+ *          are enough of them again. Signals are ignored, except at system
+ *          shutdown.
+ */
+PUBLIC void kswapd(void)
+{
+	kstrncpy(curr_proc->name, "kswapd", NAME_MAX);
+
+	swap_on();
+
+	while (!shutting_down)
+	{
+		while (frame_nfree() < SWAP_HIWAT)
+		{
+			if (swap_reclaim())
+				break;
+		}
+
+		sleep(&kswapd_chain, PRIO_USER);
+		curr_proc->received = 0;
+	}
+
+	die(0);
+}
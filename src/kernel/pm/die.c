@@ -101,6 +101,7 @@ PUBLIC void die(int status)
 	/* Detach process memory regions. */
 	for (unsigned i = 0; i < NR_PREGIONS; i++)
 		detachreg(curr_proc, &curr_proc->pregs[i]);
+	detachmaps(curr_proc);
 
 	/* Force threads regions to detach if this wasn't done previously. */
 	t = curr_proc->threads;
@@ -110,6 +111,7 @@ PUBLIC void die(int status)
 		t->state = THRD_TERMINATED;
 		t = t->next;
 	}
+	tstack_flush(curr_proc);
 
 	/* Release root and pwd. */
 	inode_put(curr_proc->root);
@@ -123,7 +123,14 @@ PUBLIC void pm_init(void)
 	IDLE->pgdir = idle_pgdir;
 	for (int i = 0; i < NR_PREGIONS; i++)
 		IDLE->pregs[i].reg = NULL;
+	IDLE->mmaps = NULL;
+	IDLE->nmmaps = 0;
+	IDLE->rtab = NULL;
+	IDLE->nrtab = 0;
+	IDLE->tstacks = 0;
+	IDLE->ntscache = 0;
 	IDLE->threads->pregs.reg = NULL;
+	IDLE->threads->lastreg = NULL;
 	IDLE->size = 0;
 	for (int i = 0; i < OPEN_MAX; i++)
 		IDLE->ofiles[i] = NULL;
@@ -146,6 +153,15 @@ PUBLIC void pm_init(void)
 	IDLE->ktime = 0;
 	IDLE->cutime = 0;
 	IDLE->cktime = 0;
+	IDLE->minflt = 0;
+	IDLE->majflt = 0;
+	IDLE->cowflt = 0;
+	IDLE->rss = 0;
+	IDLE->maxrss = 0;
+	IDLE->cminflt = 0;
+	IDLE->cmajflt = 0;
+	IDLE->ccowflt = 0;
+	IDLE->cmaxrss = 0;
 	IDLE->state = PROC_RUNNING;
 	IDLE->nice = NZERO;
 	IDLE->alarm = 0;
@@ -22,7 +22,10 @@
 #include <nanvix/thread.h>
 #include <nanvix/pm.h>
 #include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <nanvix/region.h>
 #include <nanvix/smp.h>
+#include <sys/stat.h>
 
 /**
  * @brief Thread table.
@@ -63,6 +66,7 @@ PUBLIC void thread_init(void)
 			curr->irqlvl = INT_LVL_5;
 			curr->pmcs.enable_counters = 0;
 			curr->pregs.reg = NULL;
+			curr->lastreg = NULL;
 			
 			cpus[i].curr_thread = curr;
 
@@ -88,3 +92,130 @@ PUBLIC struct thread *get_free_thread()
     kprintf("thread table overflow");
     return (NULL);
 }
+
+/**
+ * @brief Allocates a stack for a new thread.
+ *
+ * @details Thread stacks live in fixed slots right below the user stack
+ *          address, one slot per page table, so no address has to be
+ *          searched for. The stack of an exited thread is reused when it
+ *          fits in @p size. The lowest page of a slot is never mapped, and
+ *          thus works as a guard page.
+ *
+ * @param thrd Target thread.
+ * @param size Maximum stack size (at most #THRD_STACK_MAX bytes).
+ *
+ * @returns Upon successful completion, the start address of the new stack
+ *          is returned. Upon failure, zero is returned instead.
+ */
+PUBLIC addr_t tstack_alloc(struct thread *thrd, size_t size)
+{
+	unsigned i;         /* Stack slot.      */
+	addr_t start;       /* Start address.   */
+	struct region *reg; /* Stack region.    */
+
+	/* Search for a free stack slot. */
+	for (i = 0; i < NR_TSTACKS; i++)
+	{
+		if (!(curr_proc->tstacks & (1 << i)))
+			break;
+	}
+
+	/* Too many threads. */
+	if (i == NR_TSTACKS)
+		return (0);
+
+	/* Stack slot is not clear. */
+	start = TSTACK_ADDR(i);
+	if (!addr_is_clear(curr_proc, start))
+		return (0);
+
+	/* Reuse stack of an exited thread. */
+	reg = NULL;
+	if (curr_proc->ntscache > 0)
+	{
+		reg = curr_proc->tscache[--curr_proc->ntscache];
+		reg->count--;
+		lockreg(reg);
+
+		/* Stack is too large. */
+		if (reg->size > size)
+		{
+			freereg(reg);
+			reg = NULL;
+		}
+	}
+
+	if (reg == NULL)
+	{
+		reg = allocreg(S_IRUSR | S_IWUSR, PAGE_SIZE, REGION_DOWNWARDS);
+		if (reg == NULL)
+			return (0);
+	}
+
+	reg->maxsize = size;
+
+	if (attachreg(curr_proc, &thrd->pregs, start, reg))
+	{
+		unlockreg(reg);
+		freereg(reg);
+		return (0);
+	}
+
+	unlockreg(reg);
+	curr_proc->tstacks |= 1 << i;
+
+	return (start);
+}
+
+/**
+ * @brief Releases the stack of a thread.
+ *
+ * @details The stack is detached from the process and kept for later
+ *          reuse, unless there is no room to cache it.
+ *
+ * @param proc Process that owns the thread.
+ * @param thrd Target thread.
+ */
+PUBLIC void tstack_free(struct process *proc, struct thread *thrd)
+{
+	struct region *reg; /* Stack region. */
+
+	/* Nothing to be done. */
+	if ((reg = thrd->pregs.reg) == NULL)
+		return;
+
+	proc->tstacks &= ~(1 << TSTACK_SLOT(thrd->pregs.start));
+
+	/* Cache is full. */
+	if (proc->ntscache == THRD_STACK_CACHE)
+	{
+		detachreg(proc, &thrd->pregs);
+		return;
+	}
+
+	/* The cache holds a reference to the region. */
+	reg->count++;
+	detachreg(proc, &thrd->pregs);
+	proc->tscache[proc->ntscache++] = reg;
+}
+
+/**
+ * @brief Releases the cached thread stacks of a process.
+ *
+ * @param proc Target process.
+ */
+PUBLIC void tstack_flush(struct process *proc)
+{
+	struct region *reg; /* Stack region. */
+
+	while (proc->ntscache > 0)
+	{
+		reg = proc->tscache[--proc->ntscache];
+		if (--reg->count == 0)
+		{
+			lockreg(reg);
+			freereg(reg);
+		}
+	}
+}
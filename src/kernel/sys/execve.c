@@ -25,8 +25,10 @@
 #include <nanvix/mm.h>
 #include <nanvix/pm.h>
 #include <nanvix/smp.h>
+#include <nanvix/syscall.h>
 #include <elf.h>
 #include <errno.h>
+#include <spawn.h>
 
 /*
  * Asserts if a file is a ELF executable.
@@ -44,7 +46,7 @@ PRIVATE int is_elf(struct elf32_fhdr *header)
 /*
  * Loads an ELF 32 executable.
  */
-PRIVATE addr_t load_elf32(struct inode *inode)
+PRIVATE addr_t load_elf32(struct process *proc, struct inode *inode)
 {
 	int i;                  /* Loop index.                    */
 	addr_t addr;            /* Region address.                */
@@ -109,7 +111,7 @@ PRIVATE addr_t load_elf32(struct inode *inode)
 		/* Text section. */
 		if (!(seg[i].p_flags ^ (PF_R | PF_X)))
 		{
-			preg = TEXT(curr_proc);
+			preg = TEXT(proc);
 
 			/* Failed to allocate region. */
 			if ((reg = xalloc(inode, seg[i].p_offset, seg[i].p_filesz)) == NULL)
@@ -119,7 +121,7 @@ PRIVATE addr_t load_elf32(struct inode *inode)
 		/* Data section. */
 		else
 		{
-			preg = DATA(curr_proc);
+			preg = DATA(proc);
 		
 			/* Failed to allocate region. */
 			if ((reg = allocreg(S_IRUSR | S_IWUSR, seg[i].p_memsz, 0)) == NULL)
@@ -129,7 +131,7 @@ PRIVATE addr_t load_elf32(struct inode *inode)
 		}
 		
 		/* Attach memory region. */
-		if (attachreg(curr_proc, preg, addr, reg))
+		if (attachreg(proc, preg, addr, reg))
 		{
 			freereg(reg);
 			brelse(header);
@@ -157,21 +159,22 @@ error0:
  */
 PRIVATE int count(const char **str)
 {
-	int s;          /* Working string. */
+	const char *s;  /* Working string. */
 	const char **r; /* Read pointer.   */
-	int c;          /* String couynt.  */
+	int c;          /* String count.   */
 	
 	/* Count the number of strings. */
-	for (c = 0, r = str; (s = fudword(r)) != 0; r++)
-	{				
+	for (c = 0, r = str; /* noop */; r++, c++)
+	{
 		/* Bad string vector. */
-		if (s == -1)
+		if (copy_from_user(&s, r, sizeof(const char *)))
 		{
 			curr_proc->errno = -EFAULT;
 			return (-1);
 		}
-			
-		c++;
+
+		if (s == NULL)
+			break;
 	}
 	
 	return (c);
@@ -180,48 +183,42 @@ PRIVATE int count(const char **str)
 /*
  * Copy strings of a vector of strings to somewhere.
  */
-PRIVATE int copy_strings(int count, const char **strings, char *where, int p, const int bypass)
+PRIVATE int copy_strings(int count, const char **strings, char *where, int p)
 {
-	int ch;          /* Working character.     */
 	const char *str; /* Working string.        */
-	int length;      /* Working string length. */
+	ssize_t length;  /* Working string length. */
 	
 	/* Copy strings. */
 	while (count-- > 0)
 	{
-		str = (bypass) ? *strings : (const char *)fudword(strings + count);
-		length = 1;
-		
-		/* Get working string length. */
-		while ((ch = ((bypass) ? *str : fubyte(str))) != '\0')
-		{			
-			/* Bad string. */
-			if (ch < 0)
-			{
-				curr_proc->errno = -EFAULT;
-				return (-1);
-			}
-			
-			length++;
-			str++;
+		/* Bad string vector. */
+		if (copy_from_user(&str, strings + count, sizeof(const char *)))
+		{
+			curr_proc->errno = -EFAULT;
+			return (-1);
 		}
-		
-		
-		/* Copy working string. */
-		while (length-- > 0)
+
+		/*
+		 * Copy working string to the bottom of the
+		 * free area, since its length is not known yet.
+		 */
+		if ((length = strncpy_from_user(where, str, p + 1)) < 0)
 		{
-			where[p] = (char) fubyte(str);
-		
-			p--;
-			str--;
-			
-			/* Strings too long. */
-			if (p < 0)
-			{
-				curr_proc->errno = -E2BIG;
-				return (-1);
-			}
+			curr_proc->errno = length;
+			return (-1);
 		}
+
+		/* Strings too long. */
+		if (length >= p)
+		{
+			curr_proc->errno = -E2BIG;
+			return (-1);
+		}
+
+		/* Move it to the top of the free area. */
+		for (ssize_t i = length; i >= 0; i--)
+			where[p - length + i] = where[i];
+		p -= length + 1;
 	}
 	
 	return (p);
@@ -300,9 +297,9 @@ PRIVATE addr_t buildargs
 		return (0);
 		
 	/* Copy argv and envp to stack. */
-	if ((p = copy_strings(envc, envp, stack, size - 1, 0)) < 0)
+	if ((p = copy_strings(envc, envp, stack, size - 1)) < 0)
 		return (0);
-	if ((p = copy_strings(argc, argv, stack, p, 0)) < 0)
+	if ((p = copy_strings(argc, argv, stack, p)) < 0)
 		return (0);
 	if ((p = create_tables(stack, size, p, argc, envc)) == 0)
 		return (0);
@@ -332,6 +329,36 @@ PRIVATE const char *get_binary_name(const char *pathname)
 	return (binname);
 }
 
+/*
+ * Gets the inode of an executable file.
+ */
+PRIVATE struct inode *getexec(const char *pathname)
+{
+	struct inode *inode; /* File inode. */
+
+	/* Get file's inode. */
+	if ((inode = inode_name(pathname)) == NULL)
+		return (NULL);
+
+	/* Not a regular file. */
+	if (!S_ISREG(inode->mode))
+	{
+		inode_put(inode);
+		curr_proc->errno = -EACCES;
+		return (NULL);
+	}
+
+	/* Not allowed. */
+	if (!permission(inode->mode, inode->uid, inode->gid, curr_proc, MAY_EXEC, 0))
+	{
+		inode_put(inode);
+		curr_proc->errno = -EACCES;
+		return (NULL);
+	}
+
+	return (inode);
+}
+
 /*
  * Executes a program.
  */
@@ -360,28 +387,12 @@ PUBLIC int sys_execve(const char *filename, const char **argv, const char **envp
 	}
 
 	/* Get file's inode. */
-	if ((inode = inode_name(pathname)) == NULL)
+	if ((inode = getexec(pathname)) == NULL)
 	{
 		putname(pathname);
 		return (curr_proc->errno);
 	}
 
-	/* Not a regular file. */
-	if (!S_ISREG(inode->mode))
-	{
-		putname(pathname);
-		inode_put(inode);
-		return (-EACCES);
-	}
-
-	/* Not allowed. */
-	if (!permission(inode->mode, inode->uid, inode->gid, curr_proc, MAY_EXEC, 0))
-	{
-		putname(pathname);
-		inode_put(inode);
-		return (-EACCES);
-	}
-
 	/* Close file descriptors. */
 	for (i = 0; i < OPEN_MAX; i++)
 	{
@@ -403,6 +414,7 @@ PUBLIC int sys_execve(const char *filename, const char **argv, const char **envp
 	/* Detach process memory regions. */
 	for (i = 0; i < NR_PREGIONS; i++)
 		detachreg(curr_proc, &curr_proc->pregs[i]);
+	detachmaps(curr_proc);
 
 	 /* Clear current threads. */
 	detachreg(curr_proc, &cpus[curr_core].curr_thread->pregs);
@@ -415,10 +427,11 @@ PUBLIC int sys_execve(const char *filename, const char **argv, const char **envp
 			clear_thread(t);
 		t = t->next;
 	}
+	tstack_flush(curr_proc);
 
 	
 	/* Load executable. */
-	if (!(entry = load_elf32(inode)))
+	if (!(entry = load_elf32(curr_proc, inode)))
 		goto die0;
 
 	/* Attach stack region. */
@@ -427,6 +440,7 @@ PUBLIC int sys_execve(const char *filename, const char **argv, const char **envp
 	if (attachreg(curr_proc, &cpus[curr_core].curr_thread->pregs, USTACK_ADDR - 1, reg))
 		goto die1;
 	unlockreg(reg);
+	curr_proc->tstacks = 1 << TSTACK_SLOT(USTACK_ADDR - 1);
 
 	/* Attach heap region. */
 	if ((reg = allocreg(S_IRUSR | S_IWUSR, PAGE_SIZE, REGION_UPWARDS)) == NULL)
@@ -454,3 +468,261 @@ die0:
 	die(((SIGSEGV & 0xff) << 16) | (1 << 9));
 	return (-1);
 }
+
+/*
+ * Carries out file actions of spawn().
+ */
+PRIVATE int spawn_actions(const struct spawn_action *actions, int nactions)
+{
+	int fd;                     /* File descriptor. */
+	struct spawn_action action; /* Working action.  */
+
+	for (int i = 0; i < nactions; i++)
+	{
+		if (copy_from_user(&action, &actions[i], sizeof(struct spawn_action)))
+			return (-EFAULT);
+
+		switch (action.type)
+		{
+			case SPAWN_OPEN:
+				if ((fd = sys_open(action.path, action.oflag, action.mode)) < 0)
+					return (fd);
+				if (fd != action.fd)
+				{
+					if ((fd = sys_dup2(fd, action.fd)) < 0)
+						return (fd);
+					do_close(fd);
+				}
+				break;
+
+			case SPAWN_CLOSE:
+				if ((fd = sys_close(action.fd)) < 0)
+					return (fd);
+				break;
+
+			case SPAWN_DUP2:
+				if ((fd = sys_dup2(action.fd, action.newfd)) < 0)
+					return (fd);
+				break;
+
+			default:
+				return (-EINVAL);
+		}
+	}
+
+	return (0);
+}
+
+/*
+ * Sets up the user context of a spawned process.
+ */
+PRIVATE void spawn_context(struct process *proc, addr_t entry, addr_t sp, const char *stack)
+{
+	struct intstack *s;
+
+	/*
+	 * The kernel stack of the new process was cloned,
+	 * so it will return from this very system call.
+	 */
+	s = (struct intstack *) proc->threads->kesp;
+
+#ifdef i386
+	((void) stack);
+	s->ebx = 0;
+	s->ecx = 0;
+	s->edx = 0;
+	s->esi = 0;
+	s->edi = 0;
+	s->ebp = sp;
+	s->useresp = sp;
+	s->eip = entry;
+#elif or1k
+	const dword_t *args;
+
+	args = (const dword_t *)(stack + (sp - (USTACK_ADDR - ARG_MAX)));
+
+	for (int i = 0; i < 32; i++)
+		s->gpr[i] = 0;
+	s->gpr[1] = sp;
+	s->gpr[2] = sp;
+	s->gpr[3] = args[1];
+	s->gpr[4] = args[2];
+	s->gpr[5] = args[3];
+	s->eear = 0;
+	s->epcr = entry;
+#endif
+}
+
+/*
+ * Spawns a process.
+ */
+PUBLIC pid_t sys_spawn(const struct spawn_args *args)
+{
+	int i;                         /* Loop index.          */
+	int err;                       /* Error code.          */
+	struct inode *inode;           /* File inode.          */
+	struct region *reg;            /* Process region.      */
+	struct process *proc;          /* New process.         */
+	addr_t entry;                  /* Program entry point. */
+	addr_t sp;                     /* User stack pointer.  */
+	char *pathname;                /* Path name.           */
+	char *stack;                   /* User stack.          */
+	unsigned close;                /* Close on exec flags. */
+	struct file *ofiles[OPEN_MAX]; /* Saved file table.    */
+	struct spawn_args a;           /* Spawn arguments.     */
+
+	/* Invalid arguments. */
+	if (copy_from_user(&a, args, sizeof(struct spawn_args)))
+		return (-EFAULT);
+
+	/* Unsupported flags. */
+	if (a.flags & ~(POSIX_SPAWN_RESETIDS | POSIX_SPAWN_SETSIGDEF))
+		return (-EINVAL);
+
+	/* Invalid file actions. */
+	if ((a.nactions < 0) || (a.nactions > SPAWN_ACTIONS_MAX))
+		return (-EINVAL);
+
+	/* Get path name. */
+	if ((pathname = getname(a.path)) == NULL)
+		return (curr_proc->errno);
+
+	/* Build arguments. */
+	if ((stack = getkpg(1)) == NULL)
+	{
+		err = -ENOMEM;
+		goto error0;
+	}
+	if (!(sp = buildargs(stack, ARG_MAX, a.argv, a.envp)))
+	{
+		err = curr_proc->errno;
+		goto error1;
+	}
+
+	/* Get file's inode. */
+	if ((inode = getexec(pathname)) == NULL)
+	{
+		err = curr_proc->errno;
+		goto error1;
+	}
+
+	if ((proc = allocproc()) == NULL)
+	{
+		err = curr_proc->errno;
+		goto error2;
+	}
+
+	/* Load executable. */
+	if (!(entry = load_elf32(proc, inode)))
+	{
+		err = curr_proc->errno;
+		goto error3;
+	}
+
+	err = -ENOMEM;
+
+	/* Attach stack region. */
+	if ((reg = allocreg(S_IRUSR | S_IWUSR, PAGE_SIZE, REGION_DOWNWARDS)) == NULL)
+		goto error3;
+	if (attachreg(proc, &proc->threads->pregs, USTACK_ADDR - 1, reg))
+	{
+		freereg(reg);
+		goto error3;
+	}
+	unlockreg(reg);
+	proc->tstacks = 1 << TSTACK_SLOT(USTACK_ADDR - 1);
+
+	/* Attach heap region. */
+	if ((reg = allocreg(S_IRUSR | S_IWUSR, PAGE_SIZE, REGION_UPWARDS)) == NULL)
+		goto error3;
+	if (attachreg(proc, HEAP(proc), UHEAP_ADDR, reg))
+	{
+		freereg(reg);
+		goto error3;
+	}
+	unlockreg(reg);
+
+	/* Copy arguments. */
+	if (writeupg(proc, USTACK_ADDR - ARG_MAX, stack, ARG_MAX))
+		goto error3;
+
+	/*
+	 * File actions are carried out on the file table of the
+	 * current process, which is restored once the new process
+	 * has inherited it. Hold a reference to saved files, so that
+	 * closing them does not release them.
+	 */
+	for (i = 0; i < OPEN_MAX; i++)
+	{
+		if ((ofiles[i] = curr_proc->ofiles[i]) != NULL)
+			ofiles[i]->count++;
+	}
+	close = curr_proc->close;
+
+	if ((err = spawn_actions(a.actions, a.nactions)) == 0)
+	{
+		copyproc(proc);
+
+		/* Close file descriptors. */
+		for (i = 0; i < OPEN_MAX; i++)
+		{
+			if ((proc->close & (1 << i)) && (proc->ofiles[i] != NULL))
+			{
+				proc->ofiles[i]->count--;
+				proc->ofiles[i] = NULL;
+			}
+		}
+		proc->close = 0;
+	}
+
+	/* Restore file table. */
+	for (i = 0; i < OPEN_MAX; i++)
+	{
+		do_close(i);
+		curr_proc->ofiles[i] = ofiles[i];
+	}
+	curr_proc->close = close;
+
+	/* Failed to carry out file actions. */
+	if (err)
+		goto error3;
+
+	/* Reset signal handlers. */
+	proc->restorer = NULL;
+	for (i = 0; i < NR_SIGNALS; i++)
+	{
+		if (proc->handlers[i] != SIG_IGN)
+			proc->handlers[i] = SIG_DFL;
+		if ((a.flags & POSIX_SPAWN_SETSIGDEF) && (a.sigdefault & (1 << i)))
+			proc->handlers[i] = SIG_DFL;
+	}
+
+	/* Reset effective IDs. */
+	if (a.flags & POSIX_SPAWN_RESETIDS)
+	{
+		proc->euid = proc->uid;
+		proc->egid = proc->gid;
+	}
+
+	/* Assign binary name to the process name. */
+	kstrncpy(proc->name, get_binary_name(pathname), NAME_MAX);
+
+	spawn_context(proc, entry, sp, stack);
+	startproc(proc);
+
+	inode_put(inode);
+	putkpg(stack);
+	putname(pathname);
+
+	return (proc->pid);
+
+error3:
+	freeproc(proc);
+error2:
+	inode_put(inode);
+error1:
+	putkpg(stack);
+error0:
+	putname(pathname);
+	return (err);
+}
@@ -58,10 +58,16 @@ found:
 EXTERN int sys_dup2(int oldfd, int newfd)
 {
 	/* Invalid file descriptor. */
-	if ((newfd < 0)||(newfd >= OPEN_MAX)||((curr_proc->ofiles[newfd]) == NULL))
+	if ((oldfd < 0)||(oldfd >= OPEN_MAX)||((curr_proc->ofiles[oldfd]) == NULL))
 		return (-EBADF);
+	if ((newfd < 0) || (newfd >= OPEN_MAX))
+		return (-EBADF);
+	
+	/* Nothing to be done. */
+	if (oldfd == newfd)
+		return (newfd);
 	
-	sys_close(newfd);
+	do_close(newfd);
 	return (do_dup(oldfd, newfd));
 }
 
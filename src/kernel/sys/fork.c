@@ -27,18 +27,20 @@
 #include <sys/types.h>
 #include <errno.h>
 
-/*
- * Creates a new process.
+/**
+ * @brief Allocates a process.
+ *
+ * @details Allocates a process entry, its first thread and its page
+ *          directory. No memory region is attached to the new process.
+ *
+ * @returns Upon successful completion, a pointer to the new process is
+ *          returned. Upon failure, a #NULL pointer is returned instead and
+ *          the error code is stored in curr_proc->errno.
  */
-PUBLIC pid_t sys_fork(void)
+PUBLIC struct process *allocproc(void)
 {
-	int i;                /* Loop index.     */
-	int err;              /* Error?          */
-	struct process *proc; /* Process.        */
-	struct thread *thrd;  /* New thread.     */
-	struct thread *t;     /* Tmp thread.     */
-	struct region *reg;   /* Memory region.  */
-	struct pregion *preg; /* Process region. */
+	struct process *proc; /* Process.    */
+	struct thread *thrd;  /* New thread. */
 
 	/*
 	 * Prevent non-privileged user from using the last 
@@ -46,7 +48,10 @@ PUBLIC pid_t sys_fork(void)
 	 * user can invoke kill() if something goes wrong.
 	 */
 	if ((nprocs + 1 >= PROC_MAX) && (!IS_SUPERUSER(curr_proc)))
-		return (-EAGAIN);
+	{
+		curr_proc->errno = -EAGAIN;
+		return (NULL);
+	}
 
 	/* Search for a free process. */
 	for (proc = FIRST_PROC; proc <= LAST_PROC; proc++)
@@ -58,23 +63,163 @@ PUBLIC pid_t sys_fork(void)
 
 	kprintf("process table overflow");
 
-	return (-EAGAIN);
+	curr_proc->errno = -EAGAIN;
+	return (NULL);
 
 found:
 	if ((thrd = get_free_thread()) == NULL)
-		return (-EAGAIN);
+	{
+		curr_proc->errno = -EAGAIN;
+		return (NULL);
+	}
 	
 	thrd->state = THRD_READY;
+	thrd->next = NULL;
 	proc->threads = thrd;
+	proc->size = 0;
+	proc->mmaps = NULL;
+	proc->nmmaps = 0;
+	proc->rtab = NULL;
+	proc->nrtab = 0;
+	proc->tstacks = 0;
+	proc->ntscache = 0;
+	proc->rss = 0;
+	proc->maxrss = 0;
 
 	/* Mark process as beeing created. */
 	proc->flags = 1 << PROC_NEW;
 
-	err = crtpgdir(proc);
-	
 	/* Failed to create process page directory. */
-	if (err)
-		goto error0;
+	if (crtpgdir(proc))
+	{
+		thrd->state = THRD_DEAD;
+		proc->flags = 0;
+		curr_proc->errno = -ENOMEM;
+		return (NULL);
+	}
+
+	return (proc);
+}
+
+/**
+ * @brief Releases a process that was not started.
+ *
+ * @param proc Target process.
+ */
+PUBLIC void freeproc(struct process *proc)
+{
+	/* Detach attached regions. */
+	for (int i = 0; i < NR_PREGIONS; i++)
+		detachreg(proc, &proc->pregs[i]);
+	detachmaps(proc);
+	detachreg(proc, &proc->threads->pregs);
+
+	dstrypgdir(proc);
+	proc->threads->state = THRD_DEAD;
+	proc->flags = 0;
+}
+
+/**
+ * @brief Makes a process inherit the attributes of the current process.
+ *
+ * @param proc Target process.
+ */
+PUBLIC void copyproc(struct process *proc)
+{
+	int i; /* Loop index. */
+
+	/* Initialize process. */
+	proc->threads->intlvl = 1;
+	proc->received = 0;
+	proc->restorer = curr_proc->restorer;
+	proc->threads->tid = next_tid++;
+	proc->threads->next = NULL;
+	proc->threads->retval = NULL;
+	proc->threads->flags = 0 << THRD_NEW;
+	proc->threads->next_thrd = NULL;
+	proc->threads->chain = NULL;
+	proc->threads->father = proc;
+	proc->threads->lastreg = NULL;
+
+	kmemcpy(&proc->threads->fss, &cpus[curr_core].curr_thread->fss, sizeof(struct fpu));
+
+	for (i = 0; i < NR_SIGNALS; i++)
+		proc->handlers[i] = curr_proc->handlers[i];
+	proc->threads->irqlvl = cpus[curr_core].curr_thread->irqlvl;
+	proc->threads->pmcs.enable_counters = 0;
+	proc->pwd = curr_proc->pwd;
+	proc->pwd->count++;
+	proc->root = curr_proc->root;
+	proc->root->count++;
+	for (i = 0; i < OPEN_MAX; i++)
+	{
+		proc->ofiles[i] = curr_proc->ofiles[i];
+		
+		/* Increment file reference count. */
+		if (proc->ofiles[i] != NULL)
+			proc->ofiles[i]->count++;
+	}
+	proc->close = curr_proc->close;
+	proc->umask = curr_proc->umask;
+	proc->tty = curr_proc->tty;
+	proc->status = 0;
+	proc->nchildren = 0;
+	proc->uid = curr_proc->uid;
+	proc->euid = curr_proc->euid;
+	proc->suid = curr_proc->suid;
+	proc->gid = curr_proc->gid;
+	proc->egid = curr_proc->egid;
+	proc->sgid = curr_proc->sgid;
+	proc->pid = next_pid++;
+	proc->pgrp = curr_proc->pgrp;
+	proc->father = curr_proc;
+	kstrncpy(proc->name, curr_proc->name, NAME_MAX);
+	proc->utime = 0;
+	proc->ktime = 0;
+	proc->cutime = 0;
+	proc->cktime = 0;
+	proc->minflt = 0;
+	proc->majflt = 0;
+	proc->cowflt = 0;
+	proc->cminflt = 0;
+	proc->cmajflt = 0;
+	proc->ccowflt = 0;
+	proc->cmaxrss = 0;
+	proc->threads->priority = cpus[curr_core].curr_thread->priority;
+	proc->nice = curr_proc->nice;
+	proc->alarm = 0;
+	proc->next = NULL;
+	proc->chain = NULL;
+}
+
+/**
+ * @brief Starts a process.
+ *
+ * @param proc Target process.
+ */
+PUBLIC void startproc(struct process *proc)
+{
+	sched(proc->threads);
+
+	curr_proc->nchildren++;
+	
+	nprocs++;
+}
+
+/*
+ * Creates a new process.
+ */
+PUBLIC pid_t sys_fork(void)
+{
+	int i;                /* Loop index.     */
+	int err;              /* Error?          */
+	struct process *proc; /* Process.        */
+	struct thread *t;     /* Tmp thread.     */
+	struct region *reg;   /* Memory region.  */
+	struct pregion *preg; /* Process region. */
+
+	if ((proc = allocproc()) == NULL)
+		return (curr_proc->errno);
 	
 	/*
 	 * Duplicate attached regions.
@@ -95,7 +240,7 @@ found:
 		
 		/* Failed to duplicate region. */
 		if (reg == NULL)
-			goto error1;
+			goto error;
 		
 		err = attachreg(proc, &proc->pregs[i], preg->start, reg);
 		
@@ -107,12 +252,16 @@ found:
 			 */
 			kpanic("failed to attach region");
 			freereg(reg);
-			goto error1;
+			goto error;
 		}
 			
 		unlockreg(reg);
 	}
 
+	/* Duplicate memory mappings. */
+	if (dupmaps(proc))
+		goto error;
+
 	/* Duplicate attached thread region.
 	 * There will be only one thread in
 	 * the son process according to POSIX */
@@ -128,9 +277,10 @@ found:
 
 	/* Failed to duplicate region. */
 	if (reg == NULL)
-		goto error1;
+		goto error;
 
 	err = attachreg(proc, &proc->threads->pregs, preg->start, reg);
+	proc->tstacks = 1 << TSTACK_SLOT(preg->start);
 
 	/* Failed to attach region. */
 	if (err)
@@ -140,66 +290,14 @@ found:
 		 */
 		kpanic("failed to attach thread region");
 		freereg(reg);
-		goto error1;
+		goto error;
 	}
 
 	unlockreg(reg);
 dup_done:
 	
-	/* Initialize process. */
-	proc->threads->intlvl = 1;
-	proc->received = 0;
-	proc->restorer = curr_proc->restorer;
-	proc->threads->tid = next_tid++;
-	proc->threads->next = NULL;
-	proc->threads->retval = NULL;
-	proc->threads->flags = 0 << THRD_NEW;
-	proc->threads->next_thrd = NULL;
-	proc->threads->chain = NULL;
-	proc->threads->father = proc;
-
-	kmemcpy(&proc->threads->fss, &cpus[curr_core].curr_thread->fss, sizeof(struct fpu));
+	copyproc(proc);
 
-	for (i = 0; i < NR_SIGNALS; i++)
-		proc->handlers[i] = curr_proc->handlers[i];
-	proc->threads->irqlvl = cpus[curr_core].curr_thread->irqlvl;
-	proc->threads->pmcs.enable_counters = 0;
-	proc->pwd = curr_proc->pwd;
-	proc->pwd->count++;
-	proc->root = curr_proc->root;
-	proc->root->count++;
-	for (i = 0; i < OPEN_MAX; i++)
-	{
-		proc->ofiles[i] = curr_proc->ofiles[i];
-		
-		/* Increment file reference count. */
-		if (proc->ofiles[i] != NULL)
-			proc->ofiles[i]->count++;
-	}
-	proc->close = curr_proc->close;
-	proc->umask = curr_proc->umask;
-	proc->tty = curr_proc->tty;
-	proc->status = 0;
-	proc->nchildren = 0;
-	proc->uid = curr_proc->uid;
-	proc->euid = curr_proc->euid;
-	proc->suid = curr_proc->suid;
-	proc->gid = curr_proc->gid;
-	proc->egid = curr_proc->egid;
-	proc->sgid = curr_proc->sgid;
-	proc->pid = next_pid++;
-	proc->pgrp = curr_proc->pgrp;
-	proc->father = curr_proc;
-	kstrncpy(proc->name, curr_proc->name, NAME_MAX);
-	proc->utime = 0;
-	proc->ktime = 0;
-	proc->cutime = 0;
-	proc->cktime = 0;
-	proc->threads->priority = cpus[curr_core].curr_thread->priority;
-	proc->nice = curr_proc->nice;
-	proc->alarm = 0;
-	proc->next = NULL;
-	proc->chain = NULL;
 	proc->size = curr_proc->size;
 	t = curr_proc->threads;
 	while (t != NULL)
@@ -210,30 +308,11 @@ dup_done:
 		t = t->next;
 	}
 
-
-
-	sched(proc->threads);
-
-	curr_proc->nchildren++;
-	
-	nprocs++;
+	startproc(proc);
 	
 	return (proc->pid);
 
-error1:
-	/* Detach attached regions. */
-	while (--i >= 0)
-	{
-		/* Region not attached. */
-		if (proc->pregs[i].reg == NULL)
-			continue;
-		
-		/* Detach. */
-		preg = &proc->pregs[i];
-		detachreg(proc, preg);
-	}
-error0:
-	dstrypgdir(proc);
-	proc->flags = 0;
+error:
+	freeproc(proc);
 	return (-ENOMEM);
 }
@@ -0,0 +1,93 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ * 
+ * This file is part of Nanvix.
+ * 
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/clock.h>
+#include <nanvix/const.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <nanvix/region.h>
+#include <sys/resource.h>
+#include <errno.h>
+
+/**
+ * @brief Converts clock ticks into a time value.
+ *
+ * @param tv    Store location for the time value.
+ * @param ticks Clock ticks.
+ */
+PRIVATE void ticks2tv(struct timeval *tv, unsigned ticks)
+{
+	tv->tv_sec = ticks/CLOCK_FREQ;
+	tv->tv_usec = (ticks%CLOCK_FREQ)*(1000000/CLOCK_FREQ);
+}
+
+/**
+ * @brief Gets information about resource utilization.
+ *
+ * @param who     Whose resource utilization is to be reported: either
+ *                the calling process (RUSAGE_SELF) or its terminated and
+ *                waited-for children (RUSAGE_CHILDREN).
+ * @param r_usage Store location for resource utilization information.
+ *
+ * @returns Upon successful completion, zero is returned. Upon failure, a
+ *          negative error code is returned instead.
+ */
+PUBLIC int sys_getrusage(int who, struct rusage *r_usage)
+{
+	unsigned rss;    /* Resident pages. */
+	unsigned shared; /* Shared pages.   */
+
+	/* Not a valid buffer. */
+	if (!chkmem(r_usage, sizeof(struct rusage), MAY_WRITE))
+		return (-EFAULT);
+
+	/* Calling process. */
+	if (who == RUSAGE_SELF)
+	{
+		rss = procrss(curr_proc, &shared);
+
+		ticks2tv(&r_usage->ru_utime, curr_proc->utime);
+		ticks2tv(&r_usage->ru_stime, curr_proc->ktime);
+		r_usage->ru_maxrss = curr_proc->maxrss*(PAGE_SIZE/1024);
+		r_usage->ru_minflt = curr_proc->minflt;
+		r_usage->ru_majflt = curr_proc->majflt;
+		r_usage->ru_rss = rss*(PAGE_SIZE/1024);
+		r_usage->ru_shrss = shared*(PAGE_SIZE/1024);
+		r_usage->ru_cowflt = curr_proc->cowflt;
+	}
+
+	/* Terminated children. */
+	else if (who == RUSAGE_CHILDREN)
+	{
+		ticks2tv(&r_usage->ru_utime, curr_proc->cutime);
+		ticks2tv(&r_usage->ru_stime, curr_proc->cktime);
+		r_usage->ru_maxrss = curr_proc->cmaxrss*(PAGE_SIZE/1024);
+		r_usage->ru_minflt = curr_proc->cminflt;
+		r_usage->ru_majflt = curr_proc->cmajflt;
+		r_usage->ru_rss = 0;
+		r_usage->ru_shrss = 0;
+		r_usage->ru_cowflt = curr_proc->ccowflt;
+	}
+
+	/* Invalid argument. */
+	else
+		return (-EINVAL);
+
+	return (0);
+}
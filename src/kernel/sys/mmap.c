@@ -0,0 +1,125 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *              2015-2016 Davidson Francis <davidsondfgl@gmail.com>
+ * 
+ * This file is part of Nanvix.
+ * 
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <nanvix/const.h>
+#include <nanvix/klib.h>
+#include <nanvix/fs.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <nanvix/region.h>
+#include <nanvix/syscall.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+
+/*
+ * Maps pages of memory.
+ *
+ * Mappings are placed on page table boundaries, so MAP_FIXED fails with
+ * EINVAL if addr is not aligned to one.
+ */
+PUBLIC void *sys_mmap(const struct mmap_args *args)
+{
+	int flags;             /* Region flags.         */
+	int shared;            /* Shared mapping?       */
+	size_t size;           /* Mapped file size.     */
+	mode_t mode;           /* Access permissions.   */
+	struct file *f;        /* Mapped file.          */
+	struct region *reg;    /* Memory region.        */
+	struct pregion *preg;  /* Process region.       */
+	struct mmap_args a;    /* Mapping arguments.    */
+	
+	/* Invalid arguments. */
+	if (!chkmem(args, sizeof(struct mmap_args), MAY_READ))
+		return ((void *)-EINVAL);
+	
+	kmemcpy(&a, args, sizeof(struct mmap_args));
+	
+	/* Invalid length or offset. */
+	if ((a.len == 0) || (a.len > UMMAP_SIZE) || (a.off < 0) || (a.off & ~PAGE_MASK))
+		return ((void *)-EINVAL);
+	
+	/* Either shared or private mappings. */
+	shared = a.flags & MAP_SHARED;
+	if (!shared == !(a.flags & MAP_PRIVATE))
+		return ((void *)-EINVAL);
+	
+	/* Fixed mappings must be properly aligned. */
+	if ((a.flags & MAP_FIXED) && ((addr_t)a.addr & ~PGTAB_MASK))
+		return ((void *)-EINVAL);
+	
+	a.len = ALIGN(a.len, PAGE_SIZE);
+	mode = protmode(a.prot);
+	f = NULL;
+	
+	/* File mapping. */
+	if (!(a.flags & MAP_ANONYMOUS))
+	{
+		/* Invalid file descriptor. */
+		if ((a.fd < 0) || (a.fd >= OPEN_MAX) || ((f = curr_proc->ofiles[a.fd]) == NULL))
+			return ((void *)-EBADF);
+		
+		/* File not open for reading. */
+		if (ACCMODE(f->oflag) == O_WRONLY)
+			return ((void *)-EACCES);
+		
+		/* File not open for writing. */
+		if (shared && (a.prot & PROT_WRITE) && (ACCMODE(f->oflag) != O_RDWR))
+			return ((void *)-EACCES);
+		
+		/* File cannot be mapped. */
+		if (!S_ISREG(f->inode->mode))
+			return ((void *)-ENODEV);
+	}
+	
+	flags = shared ? REGION_SHARED : 0;
+	
+	/*
+	 * Large anonymous mappings may be backed by large pages.
+	 * Fall back to regular pages if none is available.
+	 */
+	reg = NULL;
+	if ((a.flags & MAP_LARGE) && (f == NULL) && !(a.len & ~LPAGE_MASK))
+		reg = allocreg(mode, a.len, flags | REGION_LARGE);
+	
+	if ((reg == NULL) && ((reg = allocreg(mode, a.len, flags)) == NULL))
+		return ((void *)-ENOMEM);
+	
+	/* Load file. */
+	if (f != NULL)
+	{
+		/* Shared mappings of files not open for writing stay read-only. */
+		if (shared && (ACCMODE(f->oflag) != O_RDWR))
+			reg->flags |= REGION_NOWRITE;
+		
+		size = (a.off < f->inode->size) ? f->inode->size - a.off : 0;
+		loadreg(f->inode, reg, a.off, (size < a.len) ? size : a.len);
+	}
+	
+	if ((preg = mapreg(curr_proc, (addr_t)a.addr, reg, a.flags & MAP_FIXED)) == NULL)
+	{
+		freereg(reg);
+		return ((void *)-ENOMEM);
+	}
+	
+	unlockreg(reg);
+	
+	return ((void *)preg->start);
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *              2015-2016 Davidson Francis <davidsondfgl@gmail.com>
+ * 
+ * This file is part of Nanvix.
+ * 
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <nanvix/const.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <nanvix/region.h>
+#include <sys/mman.h>
+#include <errno.h>
+
+/*
+ * Sets protection of memory mappings.
+ *
+ * Only whole mappings are changed. If the range covers part of a
+ * mapping, no protection is changed and EINVAL is returned.
+ */
+PUBLIC int sys_mprotect(void *addr, size_t len, int prot)
+{
+	mode_t mode;          /* Access permissions. */
+	addr_t start;         /* Start address.      */
+	addr_t end;           /* End address.        */
+	struct pregion *preg; /* Process region.     */
+	
+	start = (addr_t)addr;
+	end = start + ALIGN(len, PAGE_SIZE);
+	
+	/* Invalid range. */
+	if ((len == 0) || (start & ~PAGE_MASK) || (end < start))
+		return (-EINVAL);
+	
+	/* Invalid protection. */
+	if (prot & ~(PROT_READ | PROT_WRITE | PROT_EXEC))
+		return (-EINVAL);
+	
+	mode = protmode(prot);
+	
+	/*
+	 * Protection can only be changed for
+	 * whole mappings in the given range.
+	 */
+	for (unsigned i = 0; i < curr_proc->nmmaps; i++)
+	{
+		preg = &curr_proc->mmaps[i];
+		
+		/* Process region not in use. */
+		if (preg->reg == NULL)
+			continue;
+		
+		if ((preg->start < end) && (start < preg->start + preg->reg->size))
+		{
+			if ((preg->start < start) || (preg->start + preg->reg->size > end))
+				return (-EINVAL);
+			
+			/* Mapped file not open for writing. */
+			if ((mode & MAY_WRITE) && (preg->reg->flags & REGION_NOWRITE))
+				return (-EACCES);
+			
+			/* Large pages are mapped apart in each process. */
+			if ((preg->reg->flags & REGION_LARGE) && (preg->reg->flags & REGION_SHARED))
+				return (-EINVAL);
+		}
+	}
+	
+	for (unsigned i = 0; i < curr_proc->nmmaps; i++)
+	{
+		preg = &curr_proc->mmaps[i];
+		
+		/* Process region not in use. */
+		if (preg->reg == NULL)
+			continue;
+		
+		if ((preg->start >= start) && (preg->start < end))
+		{
+			lockreg(preg->reg);
+			protreg(preg, mode);
+			unlockreg(preg->reg);
+		}
+	}
+	
+	return (0);
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *              2015-2016 Davidson Francis <davidsondfgl@gmail.com>
+ * 
+ * This file is part of Nanvix.
+ * 
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <nanvix/const.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <nanvix/region.h>
+#include <sys/mman.h>
+#include <errno.h>
+
+/*
+ * Synchronizes memory with physical storage.
+ */
+PUBLIC int sys_msync(void *addr, size_t len, int flags)
+{
+	int ret;              /* Return value.    */
+	int found;            /* Mapping found?   */
+	addr_t start;         /* Start address.   */
+	addr_t end;           /* End address.     */
+	addr_t lo, hi;        /* Range to sync.   */
+	struct pregion *preg; /* Process region.  */
+	
+	start = (addr_t)addr;
+	end = start + ALIGN(len, PAGE_SIZE);
+	
+	/* Invalid address. */
+	if ((start & ~PAGE_MASK) || (end < start))
+		return (-EINVAL);
+	
+	/* Invalid flags. */
+	if ((flags & ~(MS_ASYNC | MS_INVALIDATE | MS_SYNC)) ||
+		((flags & MS_ASYNC) && (flags & MS_SYNC)))
+		return (-EINVAL);
+	
+	/*
+	 * Shared mappings are coherent with the page
+	 * cache, so there is nothing to invalidate.
+	 */
+	
+	ret = 0;
+	found = 0;
+	for (unsigned i = 0; i < curr_proc->nmmaps; i++)
+	{
+		preg = &curr_proc->mmaps[i];
+		
+		/* Process region not in use. */
+		if (preg->reg == NULL)
+			continue;
+		
+		lo = (preg->start > start) ? preg->start : start;
+		hi = preg->start + preg->reg->size;
+		hi = (hi < end) ? hi : end;
+		
+		/* Mapping not in range. */
+		if (lo >= hi)
+			continue;
+		
+		found = 1;
+		lockreg(preg->reg);
+		if (syncreg(preg, lo, hi - lo) < 0)
+			ret = -EIO;
+		unlockreg(preg->reg);
+	}
+	
+	/* Range not mapped. */
+	if (!found && (len > 0))
+		return (-ENOMEM);
+	
+	return (ret);
+}
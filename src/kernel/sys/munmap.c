@@ -0,0 +1,75 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *              2015-2016 Davidson Francis <davidsondfgl@gmail.com>
+ * 
+ * This file is part of Nanvix.
+ * 
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <nanvix/const.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <nanvix/region.h>
+#include <errno.h>
+
+/*
+ * Unmaps pages of memory.
+ *
+ * Only whole mappings are unmapped. If the range covers part of a
+ * mapping, nothing is unmapped and EINVAL is returned.
+ */
+PUBLIC int sys_munmap(void *addr, size_t len)
+{
+	addr_t start;         /* Start address.   */
+	addr_t end;           /* End address.     */
+	struct pregion *preg; /* Process region.  */
+	
+	start = (addr_t)addr;
+	end = start + ALIGN(len, PAGE_SIZE);
+	
+	/* Invalid range. */
+	if ((len == 0) || (start & ~PAGE_MASK) || (end < start))
+		return (-EINVAL);
+	
+	/* Mappings cannot be partially unmapped. */
+	for (unsigned i = 0; i < curr_proc->nmmaps; i++)
+	{
+		preg = &curr_proc->mmaps[i];
+		
+		/* Process region not in use. */
+		if (preg->reg == NULL)
+			continue;
+		
+		if ((preg->start < end) && (start < preg->start + preg->reg->size))
+		{
+			if ((preg->start < start) || (preg->start + preg->reg->size > end))
+				return (-EINVAL);
+		}
+	}
+	
+	for (unsigned i = 0; i < curr_proc->nmmaps; i++)
+	{
+		preg = &curr_proc->mmaps[i];
+		
+		/* Process region not in use. */
+		if (preg->reg == NULL)
+			continue;
+		
+		if ((preg->start >= start) && (preg->start < end))
+			unmapreg(curr_proc, preg);
+	}
+	
+	return (0);
+}
@@ -18,7 +18,9 @@
  */
 
 #include <nanvix/klib.h>
+#include <nanvix/mm.h>
 #include <nanvix/pm.h>
+#include <nanvix/region.h>
 
 void prepareValue(int value, char* s, int padding)
 {
@@ -55,6 +57,11 @@ PUBLIC int sys_ps()
 	char nice    [26];
 	char utime   [26];
 	char ktime   [26];
+	char rss     [26];
+	char shr     [26];
+	char minflt  [26];
+	char majflt  [26];
+	char cow     [26];
 
 	const char *states[7];
 	states[0] = "DEAD";
@@ -107,6 +114,47 @@ PUBLIC int sys_ps()
 			uid, priority, nice, utime, ktime, states[(int)p->state] );
 	}
 
+	kprintf("\n--------------------------------- Memory Usage"
+			" ---------------------------------\n"
+		    "NAME               PID   RSS       SHARED     MINFLT"
+		    " MAJFLT  COW");
+
+	for (p = IDLE; p <= LAST_PROC; p++)
+	{
+		unsigned shared;
+
+		/* Skip invalid processes. */
+		if (!IS_VALID(p))
+			continue;
+
+		/* Name */
+		size = kstrlen(p->name);
+		kstrcpy(name, p->name);
+		len = 20 - size;
+
+		for(i=size; i<len+size-1; i++)
+			*(name+i) = ' ';
+
+		*(name+i) = '\0';
+
+		/* Pid */
+		prepareValue(p->pid, pid, 6);
+
+		/* Resident and shared pages. */
+		prepareValue(procrss(p, &shared), rss, 10);
+		prepareValue(shared, shr, 11);
+
+		/* Page faults. */
+		prepareValue(p->minflt, minflt, 7);
+		prepareValue(p->majflt, majflt, 8);
+
+		/* Pages copied on write. */
+		prepareValue(p->cowflt, cow, 1);
+
+		kprintf("%s%s%s%s%s%s%s", name, pid, rss, shr, minflt, majflt, cow);
+	}
+
 	kprintf("\nLast process: %s, pid: %d\n",last_proc->name, last_proc->pid);
+	kprintf("Pages saved by merging: %d\n", frame_nsaved());
 	return 0;
 }
@@ -49,12 +49,16 @@ PRIVATE int setup_stack(addr_t user_sp, void *arg,
 	}
 
 	/* Get kernel page for IPI kernel stack. */
-	ipikstack = getkpg(1);
-	if (ipikstack == NULL)
+	ipikstack = NULL;
+	if (smp_enabled)
 	{
-		kprintf("cannot allocate ipi kstack");
-		goto error1;
-	}	
+		ipikstack = getkpg(1);
+		if (ipikstack == NULL)
+		{
+			kprintf("cannot allocate ipi kstack");
+			goto error1;
+		}
+	}
 
 	/* Forge the new stack and update the thread structure. */
 	kern_sp = forge_stack(kstack, start_routine, user_sp, arg, start_thread);
@@ -70,63 +74,6 @@ error0:
 	return (-1);
 }
 
-/*
- * @brief Allocate and attach new stack region for the new thread.
- */
-PRIVATE addr_t alloc_attach_stack_reg(struct thread *thrd)
-{
-	int err;              /* Error?                 */
-	struct pregion *preg; /* Process region.        */
-	struct region *reg;   /* Memory region.         */
-	addr_t start;         /* New region start addr. */
-	addr_t offset;        /* Reg addr offfset.      */
-
-	/* Allocate a stack region for the thread. */
-	if ((reg = allocreg(S_IRUSR | S_IWUSR, PAGE_SIZE, REGION_DOWNWARDS)) == NULL)
-		kpanic("allocreg failed");
-
-	/* Failed to duplicate region. */
-	if (reg == NULL)
-	{
-		kprintf("failed to duplicate region");
-        goto error;
-	}
-
-
-	preg = &curr_proc->threads->pregs;
-
-	/* Thread region not in use. */
-	if (preg->reg == NULL)
-	{
-		kprintf("thread region not in use");
-		freereg(reg);
-		goto error;
-	}
-
-	/* Get a correct offset to attach new stack. */
-	offset = 0;
-	do {
-		offset += PGTAB_SIZE;
-		start = (preg->start - offset);
-	} while (!addr_is_clear(curr_proc, start));
-
-	/* Attach the region below previous stack. */
-	err = attachreg(curr_proc, &thrd->pregs, start, reg);
-
-	/* Failed to attach region. */
-	if (err)
-	{
-		kpanic("failed to attach thread region");
-		freereg(reg);
-		goto error;
-	}
-	unlockreg(reg);
-	return (start - DWORD_SIZE);
-
-error:
-	return (0);
-}
-
 /*
  * @brief Creates a new thread.
  */
@@ -137,6 +84,7 @@ PUBLIC int sys_pthread_create(pthread_t *pthread, _CONST pthread_attr_t *attr,
 	struct thread *thrd;             /* Thread.            */
 	struct thread *t;                /* Tmp thread.        */
 	addr_t user_sp;                  /* User stack addr.   */
+	size_t stacksize;                /* Stack size.        */
 
 
 	/* Check start routine address validity. */
@@ -148,6 +96,19 @@ PUBLIC int sys_pthread_create(pthread_t *pthread, _CONST pthread_attr_t *attr,
 		goto error;
 	}
 
+	/* Default stack size. */
+	stacksize = THRD_STACK_MAX;
+	if ((attr != NULL) && (attr->stacksize != 0))
+	{
+		/* Stack too large. */
+		if ((size_t)attr->stacksize > THRD_STACK_MAX)
+		{
+			kprintf("pthread_create : stack too large");
+			goto error;
+		}
+		stacksize = ALIGN(attr->stacksize, PAGE_SIZE);
+	}
+
 	/* Find and init a new thread structure. */
 	if ((thrd = get_free_thread()) == NULL)
 		goto error;
@@ -160,6 +121,7 @@ PUBLIC int sys_pthread_create(pthread_t *pthread, _CONST pthread_attr_t *attr,
 	thrd->flags = 1 << THRD_NEW;
 	thrd->retval = NULL;
 	thrd->father = curr_proc;
+	thrd->lastreg = NULL;
 	*pthread = thrd->tid;
 
 	/*
@@ -171,16 +133,21 @@ PUBLIC int sys_pthread_create(pthread_t *pthread, _CONST pthread_attr_t *attr,
 	else
 	    thrd->detachstate = PTHREAD_CREATE_JOINABLE;
 
+	/* Allocate the new stack. */
+	if ((user_sp = tstack_alloc(thrd, stacksize)) == 0)
+	{
+		thrd->state = THRD_DEAD;
+		goto error;
+	}
+	user_sp -= DWORD_SIZE;
+
 	/* Attach new thread in the process list. */
 	t = curr_proc->threads;
 	while(t->next != NULL)
 		t = t->next;
 	t->next = thrd;
 
-	/* Allocate and setup the new stack. */
-	if ((user_sp = alloc_attach_stack_reg(thrd)) == 0)
-		goto error;
-
+	/* Setup the new stack. */
 	if (setup_stack(user_sp, arg, thrd, start_routine, start_thread) == -1)
 		goto error;
 
@@ -65,9 +65,10 @@ removed:
 	 * Clear memory.
 	 * TODO : should also be able to run cleanup handler.
 	 */
-	detachreg(proc, &thrd->pregs);
+	tstack_free(proc, thrd);
 	putkpg(thrd->kstack);
-	putkpg(thrd->ipikstack);
+	if (thrd->ipikstack != NULL)
+		putkpg(thrd->ipikstack);
 
 	return (0);
 }
@@ -0,0 +1,103 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/const.h>
+#include <nanvix/fs.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <nanvix/syscall.h>
+#include <sys/stat.h>
+#include <sys/syslimits.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <limits.h>
+
+/*
+ * Reads from a file into multiple buffers.
+ */
+PUBLIC ssize_t sys_readv(int fd, const struct iovec *iov, int iovcnt)
+{
+	size_t n;                  /* Bytes to read.       */
+	ssize_t ret;               /* Return value.        */
+	ssize_t count;             /* Bytes actually read. */
+	struct file *f;            /* File.                */
+	struct inode *i;           /* Inode.               */
+	struct iovec kiov[IOV_MAX]; /* I/O vector.          */
+	
+	/* Invalid file descriptor. */
+	if ((fd < 0) || (fd >= OPEN_MAX) || ((f = curr_proc->ofiles[fd]) == NULL))
+		return (-EBADF);
+	
+	/* File not opened for reading. */
+	if (ACCMODE(f->oflag) == O_WRONLY)
+		return (-EBADF);
+	
+	/* Invalid I/O vector. */
+	if ((iovcnt <= 0) || (iovcnt > IOV_MAX))
+		return (-EINVAL);
+	if (!chkmem(iov, iovcnt*sizeof(struct iovec), MAY_READ))
+		return (-EINVAL);
+	
+	kmemcpy(kiov, iov, iovcnt*sizeof(struct iovec));
+	
+	/* Invalid buffers. */
+	n = 0;
+	for (int j = 0; j < iovcnt; j++)
+	{
+		if (!chkmem(kiov[j].iov_base, kiov[j].iov_len, MAY_WRITE))
+			return (-EINVAL);
+		
+		/* Overflow. */
+		if ((n += kiov[j].iov_len) > SSIZE_MAX)
+			return (-EINVAL);
+	}
+	
+	i = f->inode;
+	
+	/* Regular file. */
+	if (S_ISREG(i->mode))
+	{
+		if ((count = file_readv(i, kiov, iovcnt, f->pos)) < 0)
+			return (curr_proc->errno);
+		
+		f->pos += count;
+		
+		return (count);
+	}
+	
+	/* Other files are read one buffer at a time. */
+	count = 0;
+	for (int j = 0; j < iovcnt; j++)
+	{
+		ret = sys_read(fd, kiov[j].iov_base, kiov[j].iov_len);
+		
+		/* Failed to read. */
+		if (ret < 0)
+			return ((count > 0) ? count : ret);
+		
+		count += ret;
+		
+		/* Short read. */
+		if ((size_t)ret < kiov[j].iov_len)
+			break;
+	}
+	
+	return (count);
+}
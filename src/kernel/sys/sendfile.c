@@ -0,0 +1,67 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/const.h>
+#include <nanvix/fs.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <errno.h>
+
+/*
+ * Transfers data between files.
+ */
+PUBLIC ssize_t sys_sendfile(int out_fd, int in_fd, off_t *offset, size_t count)
+{
+	off_t pos;        /* Source file offset. */
+	ssize_t ret;      /* Return value.       */
+	struct file *in;  /* Source file.        */
+	struct file *out; /* Target file.        */
+	
+	/* Invalid file descriptors. */
+	if ((in_fd < 0) || (in_fd >= OPEN_MAX) || ((in = curr_proc->ofiles[in_fd]) == NULL))
+		return (-EBADF);
+	if ((out_fd < 0) || (out_fd >= OPEN_MAX) || ((out = curr_proc->ofiles[out_fd]) == NULL))
+		return (-EBADF);
+	
+	/* Files not opened for reading/writing. */
+	if ((ACCMODE(in->oflag) == O_WRONLY) || (ACCMODE(out->oflag) == O_RDONLY))
+		return (-EBADF);
+	
+	/* Source file cannot be mapped in memory. */
+	if (!S_ISREG(in->inode->mode) && !S_ISBLK(in->inode->mode))
+		return (-EINVAL);
+	
+	/* Use file offset. */
+	if (offset == NULL)
+		return (file_splice(in, &in->pos, out, &out->pos, count));
+	
+	/* Invalid offset. */
+	if (!chkmem(offset, sizeof(off_t), MAY_WRITE))
+		return (-EINVAL);
+	if ((pos = *offset) < 0)
+		return (-EINVAL);
+	
+	/* Use given offset. */
+	if ((ret = file_splice(in, &pos, out, &out->pos, count)) >= 0)
+		*offset = pos;
+	
+	return (ret);
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *              2015-2016 Davidson Francis <davidsondfgl@gmail.com>
+ * 
+ * This file is part of Nanvix.
+ * 
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <nanvix/const.h>
+#include <nanvix/config.h>
+#include <nanvix/region.h>
+#include <nanvix/shm.h>
+
+/**
+ * @brief Shared memory segments table.
+ */
+PUBLIC struct shm shmtab[NR_SHMS];
+
+/**
+ * @brief Gets a shared memory segment.
+ *
+ * @param shmid Shared memory segment identifier.
+ *
+ * @returns Upon successful completion, a pointer to the shared memory segment
+ *          is returned. If @p shmid does not identify a valid segment, a
+ *          #NULL pointer is returned instead.
+ */
+PUBLIC struct shm *shm_get(int shmid)
+{
+	/* Invalid identifier. */
+	if ((shmid < 0) || (shmid >= NR_SHMS))
+		return (NULL);
+
+	/* Segment not in use. */
+	if (shmtab[shmid].reg == NULL)
+		return (NULL);
+
+	return (&shmtab[shmid]);
+}
+
+/**
+ * @brief Searches for the shared memory segment of a memory region.
+ *
+ * @param reg Target memory region.
+ *
+ * @returns If the memory region belongs to a shared memory segment that was
+ *          not removed yet, a pointer to that segment is returned. Otherwise,
+ *          a #NULL pointer is returned instead.
+ */
+PUBLIC struct shm *shm_lookup(struct region *reg)
+{
+	for (struct shm *shm = &shmtab[0]; shm < &shmtab[NR_SHMS]; shm++)
+	{
+		if (shm->reg == reg)
+			return (shm);
+	}
+
+	return (NULL);
+}
+
+/**
+ * @brief Removes a shared memory segment.
+ *
+ * @details Releases the reference of the segment to its memory region. The
+ *          memory region is freed once all processes have detached from it.
+ *
+ * @param shm Target shared memory segment.
+ */
+PUBLIC void shm_remove(struct shm *shm)
+{
+	struct region *reg;
+
+	reg = shm->reg;
+	shm->reg = NULL;
+
+	if (--reg->count == 0)
+		freereg(reg);
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *              2015-2016 Davidson Francis <davidsondfgl@gmail.com>
+ * 
+ * This file is part of Nanvix.
+ * 
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <nanvix/clock.h>
+#include <nanvix/const.h>
+#include <nanvix/fs.h>
+#include <nanvix/hal.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <nanvix/region.h>
+#include <nanvix/shm.h>
+#include <sys/shm.h>
+#include <errno.h>
+
+/*
+ * Attaches a shared memory segment.
+ */
+PUBLIC void *sys_shmat(int shmid, const void *shmaddr, int shmflg)
+{
+	addr_t addr;          /* Attach address.   */
+	mode_t perm;          /* Granted access.   */
+	struct shm *shm;      /* Segment.          */
+	struct pregion *preg; /* Process region.   */
+
+	/* Invalid segment. */
+	if ((shm = shm_get(shmid)) == NULL)
+		return ((void *)-EINVAL);
+
+	perm = accessreg(curr_proc, shm->reg);
+
+	/* Read permission denied. */
+	if (!(perm & MAY_READ))
+		return ((void *)-EACCES);
+
+	/*
+	 * Pages are mapped with the access permissions of
+	 * the segment, so attaching to a writable segment
+	 * requires write permission even with SHM_RDONLY.
+	 */
+	if ((shm->reg->mode & MAY_WRITE) && !(perm & MAY_WRITE))
+		return ((void *)-EACCES);
+
+	addr = (addr_t)shmaddr;
+	if (shmflg & SHM_RND)
+		addr &= PGTAB_MASK;
+
+	lockreg(shm->reg);
+	preg = mapreg(curr_proc, addr, shm->reg, (shmaddr != NULL));
+	unlockreg(shm->reg);
+
+	/* Failed to attach. */
+	if (preg == NULL)
+		return ((void *)((shmaddr != NULL) ? -EINVAL : -ENOMEM));
+
+	shm->lpid = curr_proc->pid;
+	shm->atime = CURRENT_TIME;
+
+	return ((void *)preg->start);
+}
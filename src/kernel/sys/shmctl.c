@@ -0,0 +1,107 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *              2015-2016 Davidson Francis <davidsondfgl@gmail.com>
+ * 
+ * This file is part of Nanvix.
+ * 
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <nanvix/clock.h>
+#include <nanvix/const.h>
+#include <nanvix/fs.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <nanvix/region.h>
+#include <nanvix/shm.h>
+#include <sys/shm.h>
+#include <errno.h>
+
+/**
+ * @brief Asserts if the current process owns a shared memory segment.
+ */
+#define IS_OWNER(shm)                             \
+	(IS_SUPERUSER(curr_proc)                   || \
+	 (curr_proc->euid == (shm)->reg->uid)      || \
+	 (curr_proc->euid == (shm)->reg->cuid))
+
+/*
+ * Shared memory control operations.
+ */
+PUBLIC int sys_shmctl(int shmid, int cmd, struct shmid_ds *buf)
+{
+	struct shm *shm; /* Segment. */
+
+	/* Invalid segment. */
+	if ((shm = shm_get(shmid)) == NULL)
+		return (-EINVAL);
+
+	switch (cmd)
+	{
+		/* Get segment information. */
+		case IPC_STAT:
+			/* Invalid buffer. */
+			if (!chkmem(buf, sizeof(struct shmid_ds), MAY_WRITE))
+				return (-EINVAL);
+
+			/* Permission denied. */
+			if (!(accessreg(curr_proc, shm->reg) & MAY_READ))
+				return (-EACCES);
+
+			buf->shm_perm.uid = shm->reg->uid;
+			buf->shm_perm.gid = shm->reg->gid;
+			buf->shm_perm.cuid = shm->reg->cuid;
+			buf->shm_perm.cgid = shm->reg->cgid;
+			buf->shm_perm.mode = shm->reg->mode;
+			buf->shm_segsz = shm->size;
+			buf->shm_lpid = shm->lpid;
+			buf->shm_cpid = shm->cpid;
+			buf->shm_nattch = shm_nattch(shm);
+			buf->shm_atime = shm->atime;
+			buf->shm_dtime = shm->dtime;
+			buf->shm_ctime = shm->ctime;
+			break;
+
+		/* Set segment information. */
+		case IPC_SET:
+			/* Invalid buffer. */
+			if (!chkmem(buf, sizeof(struct shmid_ds), MAY_READ))
+				return (-EINVAL);
+
+			/* Permission denied. */
+			if (!IS_OWNER(shm))
+				return (-EPERM);
+
+			lockreg(shm->reg);
+			editreg(shm->reg, buf->shm_perm.uid, buf->shm_perm.gid,
+				buf->shm_perm.mode & (MAY_READ | MAY_WRITE));
+			unlockreg(shm->reg);
+			shm->ctime = CURRENT_TIME;
+			break;
+
+		/* Remove segment. */
+		case IPC_RMID:
+			/* Permission denied. */
+			if (!IS_OWNER(shm))
+				return (-EPERM);
+
+			shm_remove(shm);
+			break;
+
+		/* Invalid command. */
+		default:
+			return (-EINVAL);
+	}
+
+	return (0);
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *              2015-2016 Davidson Francis <davidsondfgl@gmail.com>
+ * 
+ * This file is part of Nanvix.
+ * 
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <nanvix/clock.h>
+#include <nanvix/const.h>
+#include <nanvix/pm.h>
+#include <nanvix/region.h>
+#include <nanvix/shm.h>
+#include <errno.h>
+
+/*
+ * Detaches a shared memory segment.
+ */
+PUBLIC int sys_shmdt(const void *shmaddr)
+{
+	struct shm *shm;      /* Segment.         */
+	struct pregion *preg; /* Process region.  */
+
+	for (unsigned i = 0; i < curr_proc->nmmaps; i++)
+	{
+		preg = &curr_proc->mmaps[i];
+
+		/* Process region not in use. */
+		if (preg->reg == NULL)
+			continue;
+
+		/* Not the segment we are looking for. */
+		if ((preg->start != (addr_t)shmaddr) || !(preg->reg->flags & REGION_SHM))
+			continue;
+
+		/* Segment may have been removed. */
+		if ((shm = shm_lookup(preg->reg)) != NULL)
+		{
+			shm->lpid = curr_proc->pid;
+			shm->dtime = CURRENT_TIME;
+		}
+
+		unmapreg(curr_proc, preg);
+
+		return (0);
+	}
+
+	return (-EINVAL);
+}
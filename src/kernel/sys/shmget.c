@@ -0,0 +1,111 @@
+/*
+ * Copyright(C) 2011-2016 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *              2015-2016 Davidson Francis <davidsondfgl@gmail.com>
+ * 
+ * This file is part of Nanvix.
+ * 
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <nanvix/clock.h>
+#include <nanvix/const.h>
+#include <nanvix/config.h>
+#include <nanvix/fs.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <nanvix/region.h>
+#include <nanvix/shm.h>
+#include <sys/shm.h>
+#include <errno.h>
+
+/*
+ * Gets a shared memory segment.
+ */
+PUBLIC int sys_shmget(key_t key, size_t size, int shmflg)
+{
+	mode_t mode;        /* Access permissions. */
+	struct shm *shm;    /* Working segment.    */
+	struct region *reg; /* Memory region.      */
+
+	/* Look for existing segment. */
+	if (key != IPC_PRIVATE)
+	{
+		for (shm = &shmtab[0]; shm < &shmtab[NR_SHMS]; shm++)
+		{
+			if ((shm->reg == NULL) || (shm->key != key))
+				continue;
+
+			/* Segment exists. */
+			if ((shmflg & IPC_CREAT) && (shmflg & IPC_EXCL))
+				return (-EEXIST);
+
+			/* Segment is too small. */
+			if (size > shm->size)
+				return (-EINVAL);
+
+			mode = accessreg(curr_proc, shm->reg);
+
+			/* Permission denied. */
+			if (((shmflg & MAY_READ) && !(mode & MAY_READ)) ||
+				((shmflg & MAY_WRITE) && !(mode & MAY_WRITE)))
+				return (-EACCES);
+
+			return (shm - shmtab);
+		}
+
+		/* Segment does not exist. */
+		if (!(shmflg & IPC_CREAT))
+			return (-ENOENT);
+	}
+
+	/* Invalid size. */
+	if ((size == 0) || (size > PROC_SIZE_MAX))
+		return (-EINVAL);
+
+	/* Search for a free segment. */
+	for (shm = &shmtab[0]; shm < &shmtab[NR_SHMS]; shm++)
+	{
+		if (shm->reg == NULL)
+			goto found;
+	}
+
+	return (-ENOSPC);
+
+found:
+
+	/*
+	 * Execute permissions are meaningless
+	 * and would mistake the region for text.
+	 */
+	mode = shmflg & (MAY_READ | MAY_WRITE);
+
+	reg = allocreg(mode, ALIGN(size, PAGE_SIZE), REGION_SHARED | REGION_SHM);
+	if (reg == NULL)
+		return (-ENOMEM);
+
+	/* Segment reference. */
+	reg->count++;
+	unlockreg(reg);
+
+	shm->key = key;
+	shm->reg = reg;
+	shm->size = size;
+	shm->cpid = curr_proc->pid;
+	shm->lpid = 0;
+	shm->atime = 0;
+	shm->dtime = 0;
+	shm->ctime = CURRENT_TIME;
+
+	return (shm - shmtab);
+}
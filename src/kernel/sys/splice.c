@@ -0,0 +1,113 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/const.h>
+#include <nanvix/fs.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <nanvix/syscall.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <errno.h>
+
+/**
+ * @brief Gets a file offset for splice().
+ *
+ * @param f   Target file.
+ * @param off User offset, if any.
+ * @param pos Location where the offset shall be stored.
+ *
+ * @returns Zero upon successful completion, and a negative error code
+ *          otherwise.
+ */
+PRIVATE int splice_pos(struct file *f, off_t *off, off_t *pos)
+{
+	/* Use file offset. */
+	if (off == NULL)
+	{
+		*pos = f->pos;
+		return (0);
+	}
+	
+	/* Not seekable. */
+	if (S_ISFIFO(f->inode->mode) || S_ISCHR(f->inode->mode))
+		return (-ESPIPE);
+	
+	/* Invalid offset. */
+	if (!chkmem(off, sizeof(off_t), MAY_WRITE))
+		return (-EINVAL);
+	if ((*pos = *off) < 0)
+		return (-EINVAL);
+	
+	return (0);
+}
+
+/*
+ * Moves data between files.
+ */
+PUBLIC ssize_t sys_splice(const struct splice_args *args)
+{
+	int ret;                /* Return value. */
+	ssize_t count;          /* Bytes moved.  */
+	off_t inpos, outpos;    /* File offsets. */
+	struct file *in, *out;  /* Files.        */
+	struct splice_args a;   /* Arguments.    */
+	
+	/* Invalid arguments. */
+	if (!chkmem(args, sizeof(struct splice_args), MAY_READ))
+		return (-EINVAL);
+	
+	kmemcpy(&a, args, sizeof(struct splice_args));
+	
+	/* Invalid file descriptors. */
+	if ((a.fd_in < 0) || (a.fd_in >= OPEN_MAX) || ((in = curr_proc->ofiles[a.fd_in]) == NULL))
+		return (-EBADF);
+	if ((a.fd_out < 0) || (a.fd_out >= OPEN_MAX) || ((out = curr_proc->ofiles[a.fd_out]) == NULL))
+		return (-EBADF);
+	
+	/* Files not opened for reading/writing. */
+	if ((ACCMODE(in->oflag) == O_WRONLY) || (ACCMODE(out->oflag) == O_RDONLY))
+		return (-EBADF);
+	
+	/* Invalid flags. */
+	if (a.flags & ~(SPLICE_F_MOVE | SPLICE_F_MORE))
+		return (-EINVAL);
+	
+	if ((ret = splice_pos(in, a.off_in, &inpos)) < 0)
+		return (ret);
+	if ((ret = splice_pos(out, a.off_out, &outpos)) < 0)
+		return (ret);
+	
+	/* Failed to move data. */
+	if ((count = file_splice(in, &inpos, out, &outpos, a.len)) < 0)
+		return (count);
+	
+	/* Update offsets. */
+	if (a.off_in != NULL)
+		*a.off_in = inpos;
+	else
+		in->pos = inpos;
+	if (a.off_out != NULL)
+		*a.off_out = outpos;
+	else
+		out->pos = outpos;
+	
+	return (count);
+}
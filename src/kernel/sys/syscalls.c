@@ -89,5 +89,21 @@ PUBLIC void (*syscalls_table[NR_SYSCALLS])(void)  = {
 	(void (*)(void))&sys_pthread_exit,
 	(void (*)(void))&sys_pthread_join,
 	(void (*)(void))&sys_pthread_self,
-	(void (*)(void))&sys_pthread_detach
+	(void (*)(void))&sys_pthread_detach,
+	(void (*)(void))&sys_mmap,
+	(void (*)(void))&sys_munmap,
+	(void (*)(void))&sys_mprotect,
+	(void (*)(void))&sys_msync,
+	(void (*)(void))&sys_shmget,
+	(void (*)(void))&sys_shmat,
+	(void (*)(void))&sys_shmdt,
+	(void (*)(void))&sys_shmctl,
+	(void (*)(void))&sys_spawn,
+	(void (*)(void))&sys_getrusage,
+	(void (*)(void))&sys_pread,
+	(void (*)(void))&sys_pwrite,
+	(void (*)(void))&sys_readv,
+	(void (*)(void))&sys_writev,
+	(void (*)(void))&sys_sendfile,
+	(void (*)(void))&sys_splice
 };
@@ -85,6 +85,11 @@ repeat:
 				pid = p->pid;
 				curr_proc->cutime += p->utime;
 				curr_proc->cktime += p->ktime;
+				curr_proc->cminflt += p->minflt;
+				curr_proc->cmajflt += p->majflt;
+				curr_proc->ccowflt += p->cowflt;
+				if (p->maxrss > curr_proc->cmaxrss)
+					curr_proc->cmaxrss = p->maxrss;
 
 				/* Bury child process. */
 				bury(p);
@@ -0,0 +1,61 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna   <pedrohenriquepenna@gmail.com>
+ *              2016-2018 Davidson Francis <davidsondfgl@gmail.com>
+ * 
+ * This file is part of Nanvix.
+ * 
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/syscall.h>
+#include <sys/resource.h>
+#include <errno.h>
+#include <reent.h>
+
+/**
+ * @brief Gets information about resource utilization.
+ * 
+ * @param who     RUSAGE_SELF or RUSAGE_CHILDREN.
+ * @param r_usage Resource utilization information.
+ * 
+ * @returns Upon successful completion, zero is returned. Upon failure, -1
+ *          is returned and errno set to indicate the error.
+ */
+int getrusage(int who, struct rusage *r_usage)
+{
+	register int ret
+		__asm__("r11") = NR_getrusage;
+	register unsigned r3
+		__asm__("r3") = (unsigned) who;
+	register unsigned r4
+		__asm__("r4") = (unsigned) r_usage;
+	
+	__asm__ volatile (
+		"l.sys 1"
+		: "=r" (ret)
+		: "r" (ret),
+		  "r" (r3),
+		  "r" (r4)
+	);
+	
+	/* Error. */
+	if (ret < 0)
+	{
+		errno = -ret;
+		_REENT->_errno = -ret;
+		return (-1);
+	}
+	
+	return (ret);
+}
@@ -17,10 +17,12 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <nanvix/thread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <limits.h>
 #include <pthread.h>
 
 /*
@@ -48,6 +50,7 @@ void __start_thread(void *(*__start_routine)(void *), void *arg)
 int pthread_attr_init(pthread_attr_t *attr)
 {
 	attr->detachstate = PTHREAD_CREATE_JOINABLE;
+	attr->stacksize = 0;
 	attr->is_initialized = 1;
 	return (0);
 }
@@ -78,3 +81,36 @@ int pthread_attr_setdetachstate(pthread_attr_t *attr, int detachstate)
 	attr->detachstate = detachstate;
 	return (0);
 }
+
+/*
+ * @brief Sets the stack size attribute.
+ *
+ * @details Sets the stack size attribute of the thread attributes object
+ * referred to by attr to the value specified in stacksize.
+ *
+ * @returns On success, these functions return 0; on error, they return a
+ * nonzero error number.
+ */
+int pthread_attr_setstacksize(pthread_attr_t *attr, size_t stacksize)
+{
+	if (stacksize < PTHREAD_STACK_MIN)
+		return (EINVAL);
+	attr->stacksize = stacksize;
+	return (0);
+}
+
+/*
+ * @brief Gets the stack size attribute.
+ *
+ * @details Returns the stack size attribute of the thread attributes object
+ * referred to by attr in the buffer pointed to by stacksize. If no stack
+ * size was set, the default one is returned.
+ *
+ * @returns On success, these functions return 0; on error, they return a
+ * nonzero error number.
+ */
+int pthread_attr_getstacksize(_CONST pthread_attr_t *attr, size_t *stacksize)
+{
+	*stacksize = (attr->stacksize != 0) ? attr->stacksize : THRD_STACK_MAX;
+	return (0);
+}
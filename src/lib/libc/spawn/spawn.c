@@ -0,0 +1,375 @@
+/*
+ * Copyright(C) 2011-2017 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ * 
+ * This file is part of Nanvix.
+ * 
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/syscall.h>
+#include <sys/types.h>
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Forward definitions. */
+extern pid_t _spawn(const struct spawn_args *);
+
+/*
+ * Number of file actions that are allocated at once.
+ */
+#define SPAWN_ACTIONS_CHUNK 4
+
+/*
+ * Spawn attributes.
+ */
+struct __posix_spawnattr
+{
+	short flags;         /* Spawn flags.      */
+	sigset_t sigdefault; /* Signals to reset. */
+};
+
+/*
+ * Spawn file actions.
+ */
+struct __posix_spawn_file_actions
+{
+	int n;                          /* Number of actions.       */
+	int size;                       /* Size of the action list. */
+	struct spawn_action *actions;   /* List of actions.         */
+};
+
+/*
+ * @brief Appends a file action.
+ *
+ * @returns A pointer to the new file action, or NULL if there is not
+ * enough memory.
+ */
+static struct spawn_action *spawn_addaction(posix_spawn_file_actions_t *fa)
+{
+	struct spawn_action *actions;
+	struct __posix_spawn_file_actions *p = *fa;
+
+	/* Too many actions. */
+	if (p->n == SPAWN_ACTIONS_MAX)
+		return (NULL);
+
+	/* Grow list of actions. */
+	if (p->n == p->size)
+	{
+		actions = realloc(p->actions,
+			(p->size + SPAWN_ACTIONS_CHUNK)*sizeof(struct spawn_action));
+		if (actions == NULL)
+			return (NULL);
+		p->actions = actions;
+		p->size += SPAWN_ACTIONS_CHUNK;
+	}
+
+	return (&p->actions[p->n++]);
+}
+
+/*
+ * @brief Initializes a file actions object.
+ */
+int posix_spawn_file_actions_init(posix_spawn_file_actions_t *fa)
+{
+	struct __posix_spawn_file_actions *p;
+
+	if ((p = malloc(sizeof(struct __posix_spawn_file_actions))) == NULL)
+		return (ENOMEM);
+
+	p->n = 0;
+	p->size = 0;
+	p->actions = NULL;
+	*fa = p;
+
+	return (0);
+}
+
+/*
+ * @brief Destroys a file actions object.
+ */
+int posix_spawn_file_actions_destroy(posix_spawn_file_actions_t *fa)
+{
+	struct __posix_spawn_file_actions *p = *fa;
+
+	for (int i = 0; i < p->n; i++)
+	{
+		if (p->actions[i].type == SPAWN_OPEN)
+			free((char *)p->actions[i].path);
+	}
+
+	free(p->actions);
+	free(p);
+
+	return (0);
+}
+
+/*
+ * @brief Adds an open action to a file actions object.
+ */
+int posix_spawn_file_actions_addopen(posix_spawn_file_actions_t *fa,
+	int fd, const char *path, int oflag, mode_t mode)
+{
+	char *name;
+	struct spawn_action *action;
+
+	/* Invalid file descriptor. */
+	if ((fd < 0) || (fd >= OPEN_MAX))
+		return (EBADF);
+
+	if ((name = strdup(path)) == NULL)
+		return (ENOMEM);
+
+	if ((action = spawn_addaction(fa)) == NULL)
+	{
+		free(name);
+		return (ENOMEM);
+	}
+
+	action->type = SPAWN_OPEN;
+	action->fd = fd;
+	action->path = name;
+	action->oflag = oflag;
+	action->mode = mode;
+
+	return (0);
+}
+
+/*
+ * @brief Adds a dup2 action to a file actions object.
+ */
+int posix_spawn_file_actions_adddup2(posix_spawn_file_actions_t *fa,
+	int fd, int newfd)
+{
+	struct spawn_action *action;
+
+	/* Invalid file descriptor. */
+	if ((fd < 0) || (fd >= OPEN_MAX) || (newfd < 0) || (newfd >= OPEN_MAX))
+		return (EBADF);
+
+	if ((action = spawn_addaction(fa)) == NULL)
+		return (ENOMEM);
+
+	action->type = SPAWN_DUP2;
+	action->fd = fd;
+	action->newfd = newfd;
+
+	return (0);
+}
+
+/*
+ * @brief Adds a close action to a file actions object.
+ */
+int posix_spawn_file_actions_addclose(posix_spawn_file_actions_t *fa, int fd)
+{
+	struct spawn_action *action;
+
+	/* Invalid file descriptor. */
+	if ((fd < 0) || (fd >= OPEN_MAX))
+		return (EBADF);
+
+	if ((action = spawn_addaction(fa)) == NULL)
+		return (ENOMEM);
+
+	action->type = SPAWN_CLOSE;
+	action->fd = fd;
+
+	return (0);
+}
+
+/*
+ * @brief Initializes a spawn attributes object.
+ */
+int posix_spawnattr_init(posix_spawnattr_t *attr)
+{
+	struct __posix_spawnattr *p;
+
+	if ((p = malloc(sizeof(struct __posix_spawnattr))) == NULL)
+		return (ENOMEM);
+
+	p->flags = 0;
+	(void) sigemptyset(&p->sigdefault);
+	*attr = p;
+
+	return (0);
+}
+
+/*
+ * @brief Destroys a spawn attributes object.
+ */
+int posix_spawnattr_destroy(posix_spawnattr_t *attr)
+{
+	free(*attr);
+	return (0);
+}
+
+/*
+ * @brief Gets the spawn flags attribute.
+ */
+int posix_spawnattr_getflags(const posix_spawnattr_t *attr, short *flags)
+{
+	*flags = (*attr)->flags;
+	return (0);
+}
+
+/*
+ * @brief Sets the spawn flags attribute.
+ *
+ * @details Process groups, signal masks and scheduling parameters are
+ * not supported, so the corresponding flags are rejected.
+ */
+int posix_spawnattr_setflags(posix_spawnattr_t *attr, short flags)
+{
+	if (flags & ~(POSIX_SPAWN_RESETIDS | POSIX_SPAWN_SETSIGDEF))
+		return (EINVAL);
+
+	(*attr)->flags = flags;
+	return (0);
+}
+
+/*
+ * @brief Gets the default signals attribute.
+ */
+int posix_spawnattr_getsigdefault(const posix_spawnattr_t *attr,
+	sigset_t *sigdefault)
+{
+	*sigdefault = (*attr)->sigdefault;
+	return (0);
+}
+
+/*
+ * @brief Sets the default signals attribute.
+ */
+int posix_spawnattr_setsigdefault(posix_spawnattr_t *attr,
+	const sigset_t *sigdefault)
+{
+	(*attr)->sigdefault = *sigdefault;
+	return (0);
+}
+
+/*
+ * @brief Spawns a process.
+ *
+ * @details Creates a child process that executes the program @p path,
+ * without duplicating the address space of the calling process. File
+ * actions and spawn attributes are carried out by the kernel.
+ *
+ * @returns On success, zero is returned and the child process ID is
+ * stored in @p pid. On error, an error number is returned instead.
+ */
+int posix_spawn(pid_t *pid, const char *path,
+	const posix_spawn_file_actions_t *fa, const posix_spawnattr_t *attr,
+	char *const argv[], char *const envp[])
+{
+	pid_t ret;
+	struct spawn_args args;
+
+	args.path = path;
+	args.argv = (const char **)argv;
+	args.envp = (const char **)((envp != NULL) ? envp : environ);
+	args.actions = NULL;
+	args.nactions = 0;
+	args.flags = 0;
+	args.sigdefault = 0;
+
+	if ((fa != NULL) && (*fa != NULL))
+	{
+		args.actions = (*fa)->actions;
+		args.nactions = (*fa)->n;
+	}
+
+	if ((attr != NULL) && (*attr != NULL))
+	{
+		args.flags = (*attr)->flags;
+		args.sigdefault = (*attr)->sigdefault;
+	}
+
+	if ((ret = _spawn(&args)) < 0)
+		return (errno);
+
+	if (pid != NULL)
+		*pid = ret;
+
+	return (0);
+}
+
+/*
+ * @brief Spawns a process, searching for the executable in PATH.
+ */
+int posix_spawnp(pid_t *pid, const char *file,
+	const posix_spawn_file_actions_t *fa, const posix_spawnattr_t *attr,
+	char *const argv[], char *const envp[])
+{
+	int err;    /* Error number.        */
+	int denied; /* Access denied?       */
+	char *name; /* Working path name.   */
+	int length; /* File name length.    */
+	char *path; /* Working path.        */
+	char *p;    /* End of working path. */
+
+	/* Use given path. */
+	if (strchr(file, '/') != NULL)
+		return (posix_spawn(pid, file, fa, attr, argv, envp));
+
+	/* No directory to search. */
+	if ((path = getenv("PATH")) == NULL)
+		return (ENOENT);
+
+	denied = 0;
+	length = strlen(file) + 1;
+
+	if ((name = malloc(length + strlen(path) + 1)) == NULL)
+		return (ENOMEM);
+
+	/* Search for executable. */
+	err = ENOENT;
+	while (*path != '\0')
+	{
+		/* Get end of path. */
+		if ((p = strchr(path, ':')) == NULL)
+			p = strchr(path, '\0');
+
+		/* Build path name.  */
+		memcpy(name, path, p - path);
+		name[p - path] = '/';
+		memcpy(&name[(p - path) + 1], file, length);
+
+		err = posix_spawn(pid, name, fa, attr, argv, envp);
+
+		/* Failed to spawn. */
+		if (err == EACCES)
+			denied = 1;
+		else if (err != ENOENT)
+			break;
+
+		if (*p == '\0')
+			break;
+		path = p + 1;
+	}
+
+	/*
+	 * At least one failure was due to
+	 * permissions.
+	 */
+	if ((err == ENOENT) && (denied))
+		err = EACCES;
+
+	free(name);
+	return (err);
+}
@@ -64,12 +64,16 @@
 #include <errno.h>
 #include <stddef.h>
 #include <stdlib.h>
+#include <spawn.h>
 #include <unistd.h>
+#include <sys/wait.h>
 #include <_syslist.h>
 #include <reent.h>
 
 #if defined (unix) || defined (__CYGWIN__)
 static int _EXFUN(do_system, (struct _reent *ptr _AND _CONST char *s));
+#else
+static int _EXFUN(do_spawn, (_CONST char *s));
 #endif
 
 int
@@ -99,9 +103,8 @@ _DEFUN(_system_r, (ptr, s),
   return do_system (ptr, s);
 #else
   if (s == NULL)
-    return 0;
-  errno = ENOSYS;
-  return -1;
+    return 1;
+  return do_spawn (s);
 #endif
 
 #endif
@@ -204,3 +207,36 @@ static int do_system(struct _reent *ptr, const char *s)
     }
 }
 #endif
+
+#if !defined (unix) && !defined (__CYGWIN__)
+
+/*
+ * Runs a command with the shell. The shell is spawned right away,
+ * so the address space of the caller is not duplicated.
+ */
+static int do_spawn(const char *s)
+{
+  char *argv[4];
+  int err, status;
+  pid_t pid, rc;
+
+  argv[0] = "tsh";
+  argv[1] = "-c";
+  argv[2] = (char *) s;
+  argv[3] = NULL;
+
+  if ((err = posix_spawn (&pid, "/bin/tsh", NULL, NULL, argv, environ)) != 0)
+    {
+      errno = err;
+      return -1;
+    }
+
+  while ((rc = wait (&status)) != pid)
+    {
+      if (rc == -1)
+        return -1;
+    }
+
+  return (status >> 8) & 0xff;
+}
+#endif
@@ -23,16 +23,26 @@
 #include <sys/times.h>
 #include <sys/wait.h>
 #include <sys/sem.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/shm.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/sendfile.h>
+#include <sys/mount.h>
 #include <stdio.h>
 #include <signal.h>
+#include <spawn.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <ustat.h>
 #include <string.h>
 #include <fcntl.h>
 #include <limits.h>
 #include <semaphore.h>
 #include <errno.h>
 #include <pthread.h>
+#include <i386/pmc.h>
 
 /* Test flags. */
 #define VERBOSE	 (1 << 10)
@@ -195,6 +205,232 @@ static int stack_grow_test(void)
 	return (0);
 }
 
+/**
+ * @brief Resource usage test module.
+ *
+ * @details Touches the pages of a private mapping and checks the page fault
+ *          and resident set counters. Then a child process writes to the
+ *          same pages, which are copied on write. Finally, the pages of a
+ *          new mapping are touched and released, and the peak resident set
+ *          size must account for them.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int rusage_test(void)
+{
+	const size_t npages = 16;       /* Number of pages.   */
+	const size_t pgsize = 4096;     /* Page size.         */
+	struct rusage r0, r1;           /* Resource usage.    */
+	char *p;                        /* Mapping.           */
+	pid_t pid;                      /* Child process ID.  */
+	int status;                     /* Child exit status. */
+
+	p = mmap(NULL, npages*pgsize, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (p == MAP_FAILED)
+		return (-1);
+
+	if (getrusage(RUSAGE_SELF, &r0) < 0)
+		return (-1);
+
+	for (size_t i = 0; i < npages; i++)
+		p[i*pgsize] = 1;
+
+	if (getrusage(RUSAGE_SELF, &r1) < 0)
+		return (-1);
+
+	/* Demand zero pages. */
+	if (r1.ru_minflt - r0.ru_minflt < (long) npages)
+		return (-1);
+	if (r1.ru_rss - r0.ru_rss < (long)(npages*pgsize/1024))
+		return (-1);
+	if (r1.ru_maxrss < r1.ru_rss)
+		return (-1);
+
+	/* Child breaks copy on write. */
+	if ((pid = fork()) < 0)
+		return (-1);
+	if (pid == 0)
+	{
+		for (size_t i = 0; i < npages; i++)
+			p[i*pgsize] = 2;
+		_exit(EXIT_SUCCESS);
+	}
+	wait(&status);
+
+	if (getrusage(RUSAGE_CHILDREN, &r1) < 0)
+		return (-1);
+	if (r1.ru_cowflt < (long) npages)
+		return (-1);
+
+	/* Bad argument. */
+	if ((getrusage(1, &r1) != -1) || (errno != EINVAL))
+		return (-1);
+
+	munmap(p, npages*pgsize);
+
+	/* Peak is kept after pages are released. */
+	p = mmap(NULL, npages*pgsize, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (p == MAP_FAILED)
+		return (-1);
+	if (getrusage(RUSAGE_SELF, &r0) < 0)
+		return (-1);
+	for (size_t i = 0; i < npages; i++)
+		p[i*pgsize] = 3;
+	munmap(p, npages*pgsize);
+	if (getrusage(RUSAGE_SELF, &r1) < 0)
+		return (-1);
+	if (r1.ru_maxrss < r0.ru_rss + (long)(npages*pgsize/1024))
+		return (-1);
+
+	return (0);
+}
+
+/**
+ * @brief Asserts if a page is filled with zeros.
+ *
+ * @param p Target page.
+ *
+ * @returns Non-zero if the page is filled with zeros, and zero otherwise.
+ */
+static int page_is_zero(const char *p)
+{
+	for (size_t i = 0; i < 4096; i++)
+	{
+		if (p[i] != 0)
+			return (0);
+	}
+
+	return (1);
+}
+
+/**
+ * @brief Shared zero page test module.
+ *
+ * @details Reads fresh pages of a private mapping, which are backed by the
+ *          shared zero page, and then writes to them, both in this process
+ *          and in a child process. Writes must never land in the zero page,
+ *          so pages that were not written must still read as zeros.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int zero_page_test(void)
+{
+	const size_t npages = 3;    /* Number of pages.   */
+	const size_t pgsize = 4096; /* Page size.         */
+	char *p;                    /* Mapping.           */
+	pid_t pid;                  /* Child process ID.  */
+	int status;                 /* Child exit status. */
+
+	p = mmap(NULL, npages*pgsize, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (p == MAP_FAILED)
+		return (-1);
+
+	/* Fresh pages read as zeros. */
+	if (!page_is_zero(&p[0]) || !page_is_zero(&p[pgsize]))
+		goto error;
+
+	/* Writing a page leaves the other ones untouched. */
+	memset(&p[0], 1, pgsize);
+	if ((p[0] != 1) || (p[pgsize - 1] != 1))
+		goto error;
+	if (!page_is_zero(&p[pgsize]) || !page_is_zero(&p[2*pgsize]))
+		goto error;
+
+	/* Child writes are not seen by the parent. */
+	if ((pid = fork()) < 0)
+		goto error;
+	if (pid == 0)
+	{
+		memset(&p[0], 2, npages*pgsize);
+		_exit((p[pgsize] == 2) ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+	wait(&status);
+
+	if ((!WIFEXITED(status)) || (WEXITSTATUS(status) != EXIT_SUCCESS))
+		goto error;
+	if ((p[0] != 1) || (p[pgsize - 1] != 1))
+		goto error;
+	if (!page_is_zero(&p[pgsize]) || !page_is_zero(&p[2*pgsize]))
+		goto error;
+
+	return (munmap(p, npages*pgsize));
+
+error:
+	munmap(p, npages*pgsize);
+	return (-1);
+}
+
+/**
+ * @brief Page coloring benchmark module.
+ *
+ * @details Walks through a buffer with a stride of one page, so that every
+ *          access in a round lands at the same page offset. These lines
+ *          compete for the same sets of a physically indexed cache unless
+ *          the underlying page frames have distinct colors. Last level cache
+ *          misses and cycles are sampled with the performance counters, and
+ *          comparing kernels built with and without PAGE_COLORING shows how
+ *          many conflict misses page coloring saves.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int color_test(void)
+{
+	const size_t npages = 64;   /* Number of pages.       */
+	const size_t pgsize = 4096; /* Page size.             */
+	const size_t line = 64;     /* Cache line size.       */
+	const int npasses = 64;     /* Walks through buffer.  */
+	struct pmc pmc0, pmc1;      /* Performance counters.  */
+	volatile char *p;           /* Buffer.                */
+	unsigned sum;               /* Dummy sum.             */
+
+	p = mmap(NULL, npages*pgsize, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (p == MAP_FAILED)
+		return (-1);
+
+	/* Fault in pages. */
+	for (size_t i = 0; i < npages*pgsize; i += line)
+		p[i] = 1;
+
+	pmc0.enable_counters = IA32_PMC0 | IA32_PMC1;
+	pmc0.event_C1 = LLC_MISSES;
+	pmc0.event_C2 = UNHALTED_CORE_CYCLES;
+	if ((acct(&pmc0, ACCT_WR) < 0) || (acct(&pmc0, ACCT_RD) < 0))
+		goto error;
+
+	sum = 0;
+	for (int k = 0; k < npasses; k++)
+	{
+		for (size_t j = 0; j < pgsize; j += line)
+		{
+			for (size_t i = 0; i < npages; i++)
+				sum += p[i*pgsize + j];
+		}
+	}
+
+	if (acct(&pmc1, ACCT_RD) < 0)
+		goto error;
+
+	if (sum != npasses*npages*(pgsize/line))
+		goto error;
+
+	/* Print performance statistics. */
+	if (flags & VERBOSE)
+	{
+		printf("  LLC misses: %lu\n", (unsigned long)(pmc1.C1 - pmc0.C1));
+		printf("  Cycles:     %lu\n", (unsigned long)(pmc1.C2 - pmc0.C2));
+	}
+
+	return (munmap((void *)p, npages*pgsize));
+
+error:
+	munmap((void *)p, npages*pgsize);
+	return (-1);
+}
+
 /*============================================================================*
  *									io_test									  *
  *============================================================================*/
@@ -244,152 +480,861 @@ static int io_test(void)
 }
 
 /*============================================================================*
- *								  sched_test								  *
+ *                             File System Test                               *
  *============================================================================*/
 
 /**
- * @brief Scheduling test 0.
- * 
- * @details Spawns two processes and tests wait() system call.
- * 
- * @return Zero if passed on test, and non-zero otherwise.
+ * @brief Directory entry cache test.
+ *
+ * @details Looks up names that are created, linked and removed, so that
+ *          stale positive or negative entries in the directory entry cache
+ *          would show up.
+ *
+ * @returns Zero if passed, non-zero otherwise.
  */
-static int sched_test0(void)
+static int dcache_test(void)
 {
-	pid_t pid;
-	
-	pid = fork();
-	
-	/* Failed to fork(). */
-	if (pid < 0)
-		return (-1);
-	
-	/* Child process. */
-	else if (pid == 0)
+	int fd;
+	struct stat st0, st1;
+	const char *filename = "/home/dcache.test";
+	const char *linkname = "/home/dcache.link";
+
+	unlink(filename);
+	unlink(linkname);
+
+	/* Missing file, twice. */
+	for (int i = 0; i < 2; i++)
 	{
-		work_cpu();
-		_exit(EXIT_SUCCESS);
+		if ((stat(filename, &st0) != -1) || (errno != ENOENT))
+			return (-1);
 	}
-	
-	wait(NULL);
-	
-	return (0);
+
+	/* Created file is found. */
+	if ((fd = open(filename, O_RDWR | O_CREAT, 0666)) < 0)
+		return (-1);
+	if ((fstat(fd, &st0) < 0) || (stat(filename, &st1) < 0))
+		goto error;
+	if (st0.st_ino != st1.st_ino)
+		goto error;
+
+	/* Linked file is found. */
+	if (link(filename, linkname) < 0)
+		goto error;
+	if ((stat(linkname, &st1) < 0) || (st0.st_ino != st1.st_ino))
+		goto error;
+
+	/* Removed file is gone, but its link is not. */
+	if (unlink(filename) < 0)
+		goto error;
+	if ((stat(filename, &st1) != -1) || (errno != ENOENT))
+		goto error;
+	if ((stat(linkname, &st1) < 0) || (st0.st_ino != st1.st_ino))
+		goto error;
+
+	close(fd);
+
+	return (unlink(linkname));
+
+error:
+	close(fd);
+	unlink(filename);
+	unlink(linkname);
+	return (-1);
 }
 
+/* Number of files in indexed directory test. */
+#define NR_INDEX_FILES 256
+
 /**
- * @brief Scheduling test 1.
- * 
- * @details Forces the priority inversion problem, to check how well the system
- *			performs on dynamic priorities.
- * 
- * @returns Zero if passed on test, and non-zero otherwise.
+ * @brief Indexed directory test.
+ *
+ * @details Fills a directory that is indexed by the disk image builder, so
+ *          that its leaf blocks are split, and then looks files up.
+ *
+ * @returns Zero if passed, non-zero otherwise.
  */
-static int sched_test1(void)
+static int diridx_test(void)
 {
-	pid_t pid;
-		
-	pid = fork();
-	
-	/* Failed to fork(). */
-	if (pid < 0)
-		return (-1);
-	
-	/* Parent process. */
-	else if (pid > 0)
+	int fd;
+	int ret;
+	struct stat st;
+	char filename[32];
+
+	ret = -1;
+
+	/* Create files. */
+	for (int i = 0; i < NR_INDEX_FILES; i++)
 	{
-		nice(-2*NZERO);
-		work_cpu();
+		sprintf(filename, "/home/index/f%d", i);
+		if ((fd = open(filename, O_WRONLY | O_CREAT | O_EXCL, 0666)) < 0)
+			goto out;
+		close(fd);
 	}
-	
-	/* Child process. */
-	else
+
+	/* Duplicated name. */
+	if ((open("/home/index/f0", O_WRONLY | O_CREAT | O_EXCL, 0666) != -1) ||
+		(errno != EEXIST))
+		goto out;
+
+	/* Files are found. */
+	for (int i = 0; i < NR_INDEX_FILES; i++)
 	{
-		nice(2*NZERO);
-		work_io();
-		_exit(EXIT_SUCCESS);
+		sprintf(filename, "/home/index/f%d", i);
+		if (stat(filename, &st) < 0)
+			goto out;
 	}
-		
-	wait(NULL);
-	
-	return (0);
+
+	/* Missing file. */
+	if ((stat("/home/index/f", &st) != -1) || (errno != ENOENT))
+		goto out;
+
+	ret = 0;
+
+out:
+	for (int i = 0; i < NR_INDEX_FILES; i++)
+	{
+		sprintf(filename, "/home/index/f%d", i);
+		unlink(filename);
+	}
+
+	return (ret);
 }
 
+/* Block size used in overwrite test. */
+#define OVERWRITE_BLOCK_SIZE 1024
+
+/* Number of blocks in overwrite test. */
+#define NR_OVERWRITE_BLOCKS 8
+
 /**
- * @brief Scheduling test 1.
- * 
- * @details Spawns several processes and stresses the scheduler.
- * 
- * @returns Zero if passed on test, and non-zero otherwise.
+ * @brief Block overwrite test.
+ *
+ * @details Overwrites whole blocks of a file, as well as a range that
+ *          straddles block boundaries, and then reads the file back.
+ *
+ * @returns Zero if passed, non-zero otherwise.
  */
-static int sched_test2(void)
+static int overwrite_test(void)
 {
-	pid_t pid[4];
+	int fd;
+	int ret;
+	size_t off;
+	static char buf[NR_OVERWRITE_BLOCKS*OVERWRITE_BLOCK_SIZE];
+	const char *filename = "/home/overwrite.test";
 
-	for (int i = 0; i < 4; i++)
+	ret = -1;
+
+	if ((fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0666)) < 0)
+		return (-1);
+
+	/* Fill file. */
+	memset(buf, 'a', sizeof(buf));
+	if (write(fd, buf, sizeof(buf)) != sizeof(buf))
+		goto out;
+
+	/* Overwrite whole blocks. */
+	off = 2*OVERWRITE_BLOCK_SIZE;
+	memset(&buf[off], 'b', 3*OVERWRITE_BLOCK_SIZE);
+	if (lseek(fd, off, SEEK_SET) < 0)
+		goto out;
+	if (write(fd, &buf[off], 3*OVERWRITE_BLOCK_SIZE) != 3*OVERWRITE_BLOCK_SIZE)
+		goto out;
+
+	/* Overwrite across block boundaries. */
+	off = OVERWRITE_BLOCK_SIZE/2;
+	memset(&buf[off], 'c', 2*OVERWRITE_BLOCK_SIZE);
+	if (lseek(fd, off, SEEK_SET) < 0)
+		goto out;
+	if (write(fd, &buf[off], 2*OVERWRITE_BLOCK_SIZE) != 2*OVERWRITE_BLOCK_SIZE)
+		goto out;
+
+	/* Read file back. */
+	if (lseek(fd, 0, SEEK_SET) < 0)
+		goto out;
+	for (int i = 0; i < NR_OVERWRITE_BLOCKS; i++)
 	{
-		pid[i] = fork();
-		
-		/* Failed to fork(). */
-		if (pid[i] < 0)
-			return (-1);
-	
-		/* Child process. */
-		else if (pid[i] == 0)
-		{
-			if (i & 1)
-			{
-				nice(2*NZERO);
-				work_cpu();
-				_exit(EXIT_SUCCESS);
-			}
-			
-			else
-			{	
-				nice(-2*NZERO);
-				pause();
-				_exit(EXIT_SUCCESS);
-			}
-		}
+		char blk[OVERWRITE_BLOCK_SIZE];
+
+		if (read(fd, blk, sizeof(blk)) != sizeof(blk))
+			goto out;
+		if (memcmp(blk, &buf[i*OVERWRITE_BLOCK_SIZE], sizeof(blk)))
+			goto out;
 	}
 
-	for (int i = 0; i < 4; i++)
+	ret = 0;
+
+out:
+	close(fd);
+	unlink(filename);
+
+	return (ret);
+}
+
+/**
+ * @brief Vectored and positioned I/O test.
+ *
+ * @details Writes a file from multiple buffers, reads records back at given
+ *          offsets, and then reads the file into multiple buffers.
+ *
+ * @returns Zero if passed, non-zero otherwise.
+ */
+static int iovec_test(void)
+{
+	int fd;
+	int ret;
+	struct iovec iov[3];
+	char a[100], b[2000], c[50];
+	char rec[64];
+	const char *filename = "/home/iovec.test";
+
+	ret = -1;
+
+	if ((fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0666)) < 0)
+		return (-1);
+
+	memset(a, 'a', sizeof(a));
+	memset(b, 'b', sizeof(b));
+	memset(c, 'c', sizeof(c));
+
+	/* Gather write. */
+	iov[0].iov_base = a; iov[0].iov_len = sizeof(a);
+	iov[1].iov_base = b; iov[1].iov_len = sizeof(b);
+	iov[2].iov_base = c; iov[2].iov_len = sizeof(c);
+	if (writev(fd, iov, 3) != sizeof(a) + sizeof(b) + sizeof(c))
+		goto out;
+
+	/* Positioned read and write do not move the file offset. */
+	if (pread(fd, rec, sizeof(rec), sizeof(a) - 32) != sizeof(rec))
+		goto out;
+	if (memcmp(rec, a, 32) || memcmp(&rec[32], b, 32))
+		goto out;
+	if (pwrite(fd, c, 10, sizeof(a)) != 10)
+		goto out;
+	if (lseek(fd, 0, SEEK_CUR) != sizeof(a) + sizeof(b) + sizeof(c))
+		goto out;
+	memset(b, 'c', 10);
+
+	/* Scatter read. */
+	if (lseek(fd, 0, SEEK_SET) < 0)
+		goto out;
+	memset(a, 0, sizeof(a));
+	memset(c, 0, sizeof(c));
+	iov[0].iov_base = c; iov[0].iov_len = sizeof(c);
+	iov[1].iov_base = a; iov[1].iov_len = sizeof(a);
+	if (readv(fd, iov, 2) != sizeof(c) + sizeof(a))
+		goto out;
+	for (size_t j = 0; j < sizeof(c); j++)
 	{
-		if (i & 1)
-			wait(NULL);
-		
-		else
-		{	
-			kill(pid[i], SIGCONT);
-			wait(NULL);
-		}
+		if (c[j] != 'a')
+			goto out;
 	}
-	
-	return (0);
+	for (size_t j = 0; j < sizeof(a); j++)
+	{
+		if (a[j] != ((j < sizeof(a) - sizeof(c)) ? 'a' : b[j - (sizeof(a) - sizeof(c))]))
+			goto out;
+	}
+
+	/* End of file. */
+	if (pread(fd, rec, sizeof(rec), sizeof(a) + sizeof(b) + sizeof(c)) != 0)
+		goto out;
+
+	ret = 0;
+
+out:
+	close(fd);
+	unlink(filename);
+
+	return (ret);
 }
 
 /**
- * @brief Scheduling test 3.
- * 
- * @details Spawns several processes and stresses the scheduler.
- * 
- * @returns Zero if passed on test, and non-zero otherwise.
+ * @brief File splicing test.
+ *
+ * @details Copies a file with sendfile(), and then moves it through a pipe
+ *          with splice() and checks that the data survives both trips.
+ *
+ * @returns Zero if passed, non-zero otherwise.
  */
-static int sched_test3(void)
+static int splice_test(void)
 {
-	pid_t child;
-	pid_t father;
-	
-	father = getpid();
-	
-	fork();
-	fork();
-	fork();
-	fork();
-		
-	/* Wait for children. */
-	while ((child = wait(NULL)) >= 0)
-		/* noop. */;
-	
+	int ret;
+	int fd[2];
+	int pipefd[2];
+	off_t off;
+	char buf[3000];
+	char rec[sizeof(buf)];
+	const char *filename[2] = { "/home/splice0.test", "/home/splice1.test" };
+
+	ret = -1;
+
+	for (size_t j = 0; j < sizeof(buf); j++)
+		buf[j] = (char)j;
+
+	if ((fd[0] = open(filename[0], O_RDWR | O_CREAT | O_TRUNC, 0666)) < 0)
+		return (-1);
+	if ((fd[1] = open(filename[1], O_RDWR | O_CREAT | O_TRUNC, 0666)) < 0)
+	{
+		close(fd[0]);
+		unlink(filename[0]);
+		return (-1);
+	}
+	if (pipe(pipefd) < 0)
+		goto out0;
+
+	if (write(fd[0], buf, sizeof(buf)) != sizeof(buf))
+		goto out1;
+
+	/* Copy from a given offset. */
+	off = 100;
+	if (sendfile(fd[1], fd[0], &off, sizeof(buf)) != sizeof(buf) - 100)
+		goto out1;
+	if (off != sizeof(buf))
+		goto out1;
+	if (pread(fd[1], rec, sizeof(rec), 0) != sizeof(buf) - 100)
+		goto out1;
+	if (memcmp(rec, &buf[100], sizeof(buf) - 100))
+		goto out1;
+
+	/* Round trip through a pipe. */
+	off = 0;
+	if (splice(fd[0], &off, pipefd[1], NULL, 1000, 0) != 1000)
+		goto out1;
+	if (splice(pipefd[0], NULL, fd[1], NULL, 1000, 0) != 1000)
+		goto out1;
+	if (pread(fd[1], rec, 1000, sizeof(buf) - 100) != 1000)
+		goto out1;
+	if (memcmp(rec, buf, 1000))
+		goto out1;
+
+	/* Offsets are meaningless on pipes. */
+	if ((splice(pipefd[0], &off, fd[1], NULL, 1, 0) >= 0) || (errno != ESPIPE))
+		goto out1;
+
+	ret = 0;
+
+out1:
+	close(pipefd[0]);
+	close(pipefd[1]);
+out0:
+	close(fd[0]);
+	close(fd[1]);
+	unlink(filename[0]);
+	unlink(filename[1]);
+
+	return (ret);
+}
+
+/**
+ * @brief Large file test.
+ *
+ * @details Writes a file that spans the double indirect zone, stamping each
+ *          block with its number, and then reads it back.
+ *
+ * @returns Zero if passed, non-zero otherwise.
+ */
+static int largefile_test(void)
+{
+	int fd;
+	int ret;
+	int buf[OVERWRITE_BLOCK_SIZE/sizeof(int)];
+	const int nblocks = 600;
+	const char *filename = "/home/large.test";
+
+	ret = -1;
+
+	if ((fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0666)) < 0)
+		return (-1);
+
+	/* Write file. */
+	for (int i = 0; i < nblocks; i++)
+	{
+		for (size_t j = 0; j < sizeof(buf)/sizeof(int); j++)
+			buf[j] = i;
+		if (write(fd, buf, sizeof(buf)) != sizeof(buf))
+			goto out;
+	}
+
+	/* Read file. */
+	if (lseek(fd, 0, SEEK_SET) < 0)
+		goto out;
+	for (int i = 0; i < nblocks; i++)
+	{
+		if (read(fd, buf, sizeof(buf)) != sizeof(buf))
+			goto out;
+		if ((buf[0] != i) || (buf[sizeof(buf)/sizeof(int) - 1] != i))
+			goto out;
+	}
+
+	ret = 0;
+
+out:
+	close(fd);
+	unlink(filename);
+
+	return (ret);
+}
+
+/**
+ * @brief Gets the number of free blocks in the file system of a file.
+ *
+ * @param fd Target file.
+ *
+ * @returns The number of free blocks, or -1 upon failure.
+ */
+static long free_blocks(int fd)
+{
+	struct stat st;
+	struct ustat u;
+
+	if (fstat(fd, &st) < 0)
+		return (-1);
+	if (ustat(st.st_dev, &u) < 0)
+		return (-1);
+
+	return (u.f_tfree);
+}
+
+/**
+ * @brief Block preallocation test.
+ *
+ * @details Interleaves writes to two files, so that both of them hold runs of
+ *          preallocated blocks, and then checks that unused blocks are given
+ *          back when the file system is synchronized, and when the files are
+ *          closed and truncated.
+ *
+ * @returns Zero if passed, non-zero otherwise.
+ */
+static int prealloc_test(void)
+{
+	int fd[2];
+	int tfd;
+	int ret;
+	long nfree;
+	char buf[OVERWRITE_BLOCK_SIZE];
+	const long nblocks = 5;
+	const char *filenames[2] = {"/home/prealloc0.test", "/home/prealloc1.test"};
+
+	ret = -1;
+
+	memset(buf, 'p', sizeof(buf));
+
+	if ((fd[0] = open(filenames[0], O_RDWR | O_CREAT | O_TRUNC, 0666)) < 0)
+		return (-1);
+	if ((fd[1] = open(filenames[1], O_RDWR | O_CREAT | O_TRUNC, 0666)) < 0)
+		goto out1;
+
+	if ((nfree = free_blocks(fd[0])) < 0)
+		goto out0;
+
+	/* Files grow in parallel. */
+	for (long i = 0; i < nblocks; i++)
+	{
+		for (int j = 0; j < 2; j++)
+		{
+			if (write(fd[j], buf, sizeof(buf)) != sizeof(buf))
+				goto out0;
+		}
+	}
+	if (free_blocks(fd[0]) > nfree - 2*nblocks)
+		goto out0;
+
+	/* Unused blocks are given back on sync. */
+	sync();
+	if (free_blocks(fd[0]) != nfree - 2*nblocks)
+		goto out0;
+
+	/* Unused blocks are given back on close. */
+	close(fd[0]);
+	close(fd[1]);
+	if ((fd[0] = open(filenames[0], O_RDWR)) < 0)
+		goto out1;
+	if ((fd[1] = open(filenames[1], O_RDWR | O_TRUNC)) < 0)
+		goto out1;
+	if (free_blocks(fd[0]) != nfree - nblocks)
+		goto out0;
+
+	/* Unused blocks are given back on truncate. */
+	if (lseek(fd[0], 0, SEEK_END) < 0)
+		goto out0;
+	if (write(fd[0], buf, sizeof(buf)) != sizeof(buf))
+		goto out0;
+	if ((tfd = open(filenames[0], O_RDWR | O_TRUNC)) < 0)
+		goto out0;
+	close(tfd);
+	if (free_blocks(fd[0]) != nfree)
+		goto out0;
+
+	ret = 0;
+
+out0:
+	close(fd[1]);
+out1:
+	close(fd[0]);
+	unlink(filenames[0]);
+	unlink(filenames[1]);
+
+	return (ret);
+}
+
+/**
+ * @brief tmpfs test.
+ *
+ * @details Mounts a tmpfs, writes a file that spans a few pages and a hole,
+ *          reads it back and then unmounts the file system.
+ *
+ * @returns Zero if passed, non-zero otherwise.
+ */
+static int tmpfs_test(void)
+{
+	int fd;
+	int ret;
+	struct stat st0, st1;
+	char buf[10000];
+	const char *filename = "/tmp/tmpfs.test";
+
+	if (stat("/", &st0) < 0)
+		return (-1);
+	if (mount("tmpfs", "/tmp") != 0)
+		return (-1);
+
+	ret = -1;
+
+	if ((fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0666)) < 0)
+		goto out1;
+
+	/* File must not be on the root file system. */
+	if ((fstat(fd, &st1) < 0) || (st1.st_dev == st0.st_dev))
+		goto out0;
+
+	/* Write file, leaving a hole in the beginning. */
+	for (size_t i = 0; i < sizeof(buf); i++)
+		buf[i] = (char)i;
+	if (pwrite(fd, buf, sizeof(buf), sizeof(buf)) != sizeof(buf))
+		goto out0;
+
+	/* Read file. */
+	if (pread(fd, buf, sizeof(buf), 0) != sizeof(buf))
+		goto out0;
+	for (size_t i = 0; i < sizeof(buf); i++)
+	{
+		if (buf[i] != 0)
+			goto out0;
+	}
+	if (pread(fd, buf, sizeof(buf), sizeof(buf)) != sizeof(buf))
+		goto out0;
+	for (size_t i = 0; i < sizeof(buf); i++)
+	{
+		if (buf[i] != (char)i)
+			goto out0;
+	}
+
+	ret = 0;
+
+out0:
+	close(fd);
+	unlink(filename);
+out1:
+	if (unmount("/tmp") != 0)
+		ret = -1;
+
+	return (ret);
+}
+
+/**
+ * @brief Loads the ext2 disk image into the spare RAM disk.
+ *
+ * @details The image is copied only if the RAM disk does not hold an ext2
+ *          file system yet, so that blocks cached by an earlier run stay
+ *          valid.
+ *
+ * @returns Zero if the RAM disk holds the ext2 disk, non-zero otherwise.
+ */
+static int ext2_load(void)
+{
+	int fd[2];
+	int ret;
+	ssize_t n;
+	unsigned char magic[2];
+	static char buf[4096];
+
+	if ((fd[1] = open("/dev/ramdisk1", O_RDWR)) < 0)
+		return (-1);
+
+	ret = 0;
+
+	/* Already loaded. */
+	if ((pread(fd[1], magic, sizeof(magic), 1024 + 56) == sizeof(magic))
+		&& (magic[0] == 0x53) && (magic[1] == 0xef))
+		goto out1;
+
+	ret = -1;
+
+	if ((fd[0] = open("/etc/ext2.img", O_RDONLY)) < 0)
+		goto out1;
+
+	while ((n = read(fd[0], buf, sizeof(buf))) > 0)
+	{
+		if (write(fd[1], buf, n) != n)
+			goto out0;
+	}
+	if (n == 0)
+		ret = 0;
+
+out0:
+	close(fd[0]);
+out1:
+	close(fd[1]);
+
+	return (ret);
+}
+
+/**
+ * @brief ext2 test.
+ *
+ * @details Mounts the ext2 disk, writes a file that reaches past the single
+ *          indirect block and has a hole, reads it back, and then truncates
+ *          and removes it. Free block and inode counts must be back to their
+ *          starting values afterwards.
+ *
+ * @returns Zero if passed, non-zero otherwise.
+ */
+static int ext2_test(void)
+{
+	int fd;
+	int ret;
+	dev_t dev;
+	struct stat st, st0;
+	struct ustat u0, u1;
+	static char buf[10000];
+	const off_t far = 5*1024*1024;
+	const char *filename = "/mnt/ext2.test";
+
+	if ((ext2_load() != 0) || (stat("/", &st0) < 0))
+		return (-1);
+	if (mount("/dev/ramdisk1", "/mnt") != 0)
+		return (-1);
+
+	ret = -1;
+
+	if ((fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0666)) < 0)
+		goto out1;
+
+	/* File must not be on the root file system. */
+	if ((fstat(fd, &st) < 0) || (st.st_dev == st0.st_dev))
+		goto out0;
+	dev = st.st_dev;
+	if (ustat(dev, &u0) < 0)
+		goto out0;
+
+	/* Write file, leaving a hole in the middle. */
+	for (size_t i = 0; i < sizeof(buf); i++)
+		buf[i] = (char)i;
+	if (pwrite(fd, buf, sizeof(buf), 0) != sizeof(buf))
+		goto out0;
+	if (pwrite(fd, buf, sizeof(buf), far) != sizeof(buf))
+		goto out0;
+
+	/* Read file. */
+	if (pread(fd, buf, sizeof(buf), far - sizeof(buf)) != sizeof(buf))
+		goto out0;
+	for (size_t i = 0; i < sizeof(buf); i++)
+	{
+		if (buf[i] != 0)
+			goto out0;
+	}
+	for (off_t off = 0; off <= far; off += far)
+	{
+		if (pread(fd, buf, sizeof(buf), off) != sizeof(buf))
+			goto out0;
+		for (size_t i = 0; i < sizeof(buf); i++)
+		{
+			if (buf[i] != (char)i)
+				goto out0;
+		}
+	}
+	if ((fstat(fd, &st) < 0) || (st.st_size != far + (off_t)sizeof(buf)))
+		goto out0;
+
+	/* Truncate file. */
+	close(fd);
+	if ((fd = open(filename, O_RDWR | O_TRUNC)) < 0)
+		goto out1;
+	if ((fstat(fd, &st) < 0) || (st.st_size != 0))
+		goto out0;
+	if ((ustat(dev, &u1) < 0) || (u1.f_tfree != u0.f_tfree))
+		goto out0;
+
+	/* Remove file. */
+	if (write(fd, buf, sizeof(buf)) != sizeof(buf))
+		goto out0;
+	close(fd);
+	if (unlink(filename) < 0)
+		goto out1;
+	if (ustat(dev, &u1) < 0)
+		goto out1;
+	if ((u1.f_tfree != u0.f_tfree) || (u1.f_tinode != u0.f_tinode + 1))
+		goto out1;
+
+	ret = 0;
+	goto out1;
+
+out0:
+	close(fd);
+	unlink(filename);
+out1:
+	if (unmount("/mnt") != 0)
+		ret = -1;
+
+	return (ret);
+}
+
+/*============================================================================*
+ *								  sched_test								  *
+ *============================================================================*/
+
+/**
+ * @brief Scheduling test 0.
+ * 
+ * @details Spawns two processes and tests wait() system call.
+ * 
+ * @return Zero if passed on test, and non-zero otherwise.
+ */
+static int sched_test0(void)
+{
+	pid_t pid;
+	
+	pid = fork();
+	
+	/* Failed to fork(). */
+	if (pid < 0)
+		return (-1);
+	
+	/* Child process. */
+	else if (pid == 0)
+	{
+		work_cpu();
+		_exit(EXIT_SUCCESS);
+	}
+	
+	wait(NULL);
+	
+	return (0);
+}
+
+/**
+ * @brief Scheduling test 1.
+ * 
+ * @details Forces the priority inversion problem, to check how well the system
+ *			performs on dynamic priorities.
+ * 
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int sched_test1(void)
+{
+	pid_t pid;
+		
+	pid = fork();
+	
+	/* Failed to fork(). */
+	if (pid < 0)
+		return (-1);
+	
+	/* Parent process. */
+	else if (pid > 0)
+	{
+		nice(-2*NZERO);
+		work_cpu();
+	}
+	
+	/* Child process. */
+	else
+	{
+		nice(2*NZERO);
+		work_io();
+		_exit(EXIT_SUCCESS);
+	}
+		
+	wait(NULL);
+	
+	return (0);
+}
+
+/**
+ * @brief Scheduling test 1.
+ * 
+ * @details Spawns several processes and stresses the scheduler.
+ * 
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int sched_test2(void)
+{
+	pid_t pid[4];
+
+	for (int i = 0; i < 4; i++)
+	{
+		pid[i] = fork();
+		
+		/* Failed to fork(). */
+		if (pid[i] < 0)
+			return (-1);
+	
+		/* Child process. */
+		else if (pid[i] == 0)
+		{
+			if (i & 1)
+			{
+				nice(2*NZERO);
+				work_cpu();
+				_exit(EXIT_SUCCESS);
+			}
+			
+			else
+			{	
+				nice(-2*NZERO);
+				pause();
+				_exit(EXIT_SUCCESS);
+			}
+		}
+	}
+
+	for (int i = 0; i < 4; i++)
+	{
+		if (i & 1)
+			wait(NULL);
+		
+		else
+		{	
+			kill(pid[i], SIGCONT);
+			wait(NULL);
+		}
+	}
+	
+	return (0);
+}
+
+/**
+ * @brief Scheduling test 3.
+ * 
+ * @details Spawns several processes and stresses the scheduler.
+ * 
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int sched_test3(void)
+{
+	pid_t child;
+	pid_t father;
+	
+	father = getpid();
+	
+	fork();
+	fork();
+	fork();
+	fork();
+		
+	/* Wait for children. */
+	while ((child = wait(NULL)) >= 0)
+		/* noop. */;
+	
 	/* Die. */
 	if (getpid() != father)
 		_exit(EXIT_SUCCESS);
@@ -398,301 +1343,800 @@ static int sched_test3(void)
 }
 
 /**
- * @brief Scheduling test 4.
+ * @brief Scheduling test 4.
+ * 
+ * @details Spawns several processes and stresses the scheduler.
+ * 
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int sched_test4(void)
+{
+	pid_t root = getpid();
+	
+	for (int i = 0; i < 16; i++)
+	{
+		pid_t pid = fork();
+
+		/* Failed to fork. */
+		if (pid < 0)
+			return -1;
+		
+		/* Parent process. */
+		else if (pid > 0)
+		{
+			fork();
+			nice(-i * NZERO);
+			break;
+		}
+	}
+
+	wait(NULL);
+	
+	work_cpu();
+	if (getpid() != root)
+		_exit(EXIT_SUCCESS);
+	
+	return (0);
+}
+
+/*============================================================================*
+ *							   Semaphores Test								  *
+ *============================================================================*/
+
+/**
+ * @brief Produces stuff.
+ *
+ * @param sem  Accounts for empty slots on a shared buffer.
+ * @param fill Accounts for used slots on a shared buffer.
+ */
+static void consumer(sem_t *sem, sem_t *empty, int n)
+{
+	for (int j = 0; j < n; j++)
+	{
+		sem_wait(empty);
+		work_cpu();
+		sem_post(sem);
+	}
+}
+
+/**
+ * @brief Consumes stuff.
+ *
+ * @param sem  Accounts for empty slots on a shared buffer.
+ * @param fill Accounts for used slots on a shared buffer.
+ */
+static void producer(sem_t *sem, sem_t *empty, int n)
+{
+	for (int j = 0; j < n; j++)
+	{
+		sem_wait(sem);
+		work_cpu();
+		sem_post(empty);
+	}
+}
+
+/*	
+ * @brief Producer consumer test.
+ */
+static int sem_producer_consumer_test(void)
+{
+	int n;				 /* Number of items.	   */
+	mode_t mode;		 /* Semaphore access mode. */
+	sem_t *empty, *full; /* Semaphores.			   */
+
+	/* Named semaphores. */
+	const char *sem1 = "/home/mysem/sem1";
+	const char *sem2 = "/home/mysem/sem2";
+
+	n = 10;
+	mode = 0644;
+
+	full = sem_open(sem2, O_CREAT, mode, 0);
+	empty = sem_open(sem1, O_CREAT, mode, n);
+
+	if ((empty == NULL) || (full == NULL))
+	{	
+		printf("cannot create semaphores\n");
+		exit(EXIT_FAILURE);	
+	}
+
+	/* Child. */
+	if (fork() == 0)
+	{
+		full = sem_open(sem2, O_RDWR);
+		empty = sem_open(sem1, O_RDWR);
+
+		if ((empty == NULL) || (full == NULL))
+		{	
+			printf("cannot open semaphores\n");
+			exit(EXIT_FAILURE);	
+		}
+
+		producer(empty, full, n);
+
+		sem_close(full);
+		sem_close(empty);
+
+		exit (EXIT_SUCCESS);
+	}
+
+	/* Father. */
+	else
+	{
+		consumer(empty, full, n);
+
+		sem_close(full);
+		sem_close(empty);
+		
+		sem_unlink(sem2);
+		sem_unlink(sem1);
+	}
+
+	return (0);
+}
+
+static int sem_test_open_close(void) 
+{ 
+	/* Child. */
+	if (fork() == 0)
+	{ 
+		/* We don't unlink semc2 */ 
+		sem_t *semc1, *semc3;
+		semc1 = sem_open("/home/mysem/sem1",O_CREAT,0777,0);
+		semc3 = sem_open("/home/mysem/sem3",O_CREAT,0777,0); 
+
+		sem_wait(semc1);
+		work_cpu();
+		sem_post(semc3);
+
+		sem_unlink("/home/mysem/sem1");
+		sem_wait(semc1);
+
+		sem_close(semc3);
+		sem_close(semc1);
+		sem_unlink("/home/mysem/sem3");
+
+		/* Operations on invalid semaphores */
+		sem_wait(semc1);
+		sem_wait(semc3);
+		sem_post(semc1);
+		sem_post(semc3);
+
+		exit (EXIT_SUCCESS);
+	} 
+	else
+	{ 
+		/* father */ 
+		sem_t *semf1, *semf2, *semf3, *semf4; 
+		semf1 = sem_open("/home/mysem/sem1",O_CREAT,0777,0);
+		/* Opening the same semaphore : the same address should be returned */ 
+		semf2 = sem_open("/home/mysem/sem1",O_CREAT,0777,0);
+		semf3 = sem_open("/home/mysem/sem3",O_CREAT,0777,0); 
+		semf4 = sem_open("/home/mysem/sem4",O_CREAT,0777,0); 
+
+		sem_post(semf1);
+		work_cpu();
+		sem_wait(semf3);
+		sem_unlink("/home/mysem/sem1");
+
+		work_cpu();
+		sem_post(semf1);
+		sem_close(semf3);
+
+		/* sem4 multiple closed */
+		sem_close(semf4);
+		sem_close(semf4); /* no effect */ 
+		sem_close(semf4); /* no effect */
+		
+		sem_unlink("/home/mysem/sem4"); /* this will delete sem4 because ref count == 0 */
+		
+		/* opening a new semaphore called sem4 */
+		semf4 = sem_open("/home/mysem/sem4",O_CREAT,0777,0); 
+
+		/* Unlinking before closing */
+		sem_unlink("/home/mysem/sem4"); /* this will delete sem4 because ref count == 0 */
+
+		sem_close(semf4);
+
+		semf4 = sem_open("/home/mysem/sem4",O_CREAT,0777,0); /* This will use another kernel slot : sem4 has been unlinked */
+
+		sem_close(semf1);
+		sem_close(semf2);
+		sem_close(semf3);
+		
+		sem_unlink("/home/mysem/sem2");
+		sem_unlink("/home/mysem/sem4");
+	} 
+ 
+	return (0); 
+} 
+
+/*============================================================================*
+ *								  FPU test									  *
+ *============================================================================*/
+
+/**
+ * @brief FPU testing module.
  * 
- * @details Spawns several processes and stresses the scheduler.
+ * @details Performs a floating point operation, while trying to
+ mess up the stack from another process.
  * 
  * @returns Zero if passed on test, and non-zero otherwise.
  */
-static int sched_test4(void)
+int fpu_test(void)
 {
-	pid_t root = getpid();
+#ifdef i386
+	pid_t pid;	   /* Child process ID.		*/
+	float a = 6.7; /* First dummy operand.	*/
+	float b = 1.2; /* Second dummy operand. */
+	float result;  /* Result.				*/
 	
-	for (int i = 0; i < 16; i++)
-	{
-		pid_t pid = fork();
-
-		/* Failed to fork. */
-		if (pid < 0)
-			return -1;
-		
-		/* Parent process. */
-		else if (pid > 0)
-		{
-			fork();
-			nice(-i * NZERO);
-			break;
-		}
-	}
+	/* Perform a/b */
+	__asm__ volatile(
+		"flds %1;"
+		"flds %0;"
+		"fdivrp %%st,%%st(1);"
+		: /* noop. */
+		: "m" (b), "m" (a)
+	);
 
-	wait(NULL);
+	pid = fork();
 	
-	work_cpu();
-	if (getpid() != root)
+	/* Failed to fork(). */
+	if (pid < 0)
+		return (-1);
+	
+	/*
+	 * Child process tries
+	 * to mess up the stack.
+	 */
+	else if (pid == 0)
+	{
+		work_fpu();
 		_exit(EXIT_SUCCESS);
+	}
 	
+	wait(NULL);
+
+	/* But it's only in your context,
+	 * so nothing changed for father process.
+	 */
+	__asm__ volatile(
+		"fstps %0;"
+		: "=m" (result)
+	);
+
+	/* 0x40b2aaaa = 6.7/1.2 = 5.5833.. */
+	return (result == 0x40b2aaaa);
+#elif or1k
+	((void)work_fpu);
+	return (1);
+#endif
+}
+
+/*============================================================================*
+ *							 Memory Violation								  *
+ *============================================================================*/
+
+/*	
+ * @brief Forces a memory violation.
+ */
+static int test_mem0(void)
+{
+	/* Child. */
+	if (fork() == 0)
+	{
+		int *i;
+		i = NULL;
+		printf("%d \n",*i);
+	}
+	/* Parent. */
+	else
+	{
+		/* noop */;
+		exit(EXIT_SUCCESS);
+	}
+
 	return (0);
 }
 
+/* Size of bad buffers mapping. */
+#define BADBUF_SIZE 4096
+
+/**
+ * @brief Passes bad user buffers to system calls.
+ *
+ * @returns Zero if passed, non-zero otherwise.
+ */
+static int test_mem1(void)
+{
+	char *p;
+	struct stat st;
+
+	/* Null path name. */
+	if ((stat(NULL, &st) != -1) || (errno != EFAULT))
+		return (-1);
+
+	p = mmap(NULL, BADBUF_SIZE, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (p == MAP_FAILED)
+		return (-1);
+
+	/* Path name that runs off the end of the mapping. */
+	memset(p, 'a', BADBUF_SIZE);
+	if ((stat(p, &st) != -1) || (errno != EFAULT))
+		goto error;
+
+	/* Path name that ends right at the end of the mapping. */
+	p[BADBUF_SIZE - 2] = '/';
+	p[BADBUF_SIZE - 1] = '\0';
+	if (stat(&p[BADBUF_SIZE - 2], &st) != 0)
+		goto error;
+
+	return (munmap(p, BADBUF_SIZE));
+
+error:
+	munmap(p, BADBUF_SIZE);
+	return (-1);
+}
+
 /*============================================================================*
- *							   Semaphores Test								  *
+ *                           Memory Mapping Test                              *
  *============================================================================*/
 
+/* Size of memory mappings. */
+#define MMAP_SIZE (64*1024)
+
 /**
- * @brief Produces stuff.
+ * @brief Private anonymous mapping test.
  *
- * @param sem  Accounts for empty slots on a shared buffer.
- * @param fill Accounts for used slots on a shared buffer.
+ * @returns Zero if passed, non-zero otherwise.
  */
-static void consumer(sem_t *sem, sem_t *empty, int n)
+static int mmap_test0(void)
 {
-	for (int j = 0; j < n; j++)
+	char *p, *q;
+	int status;
+
+	p = mmap(NULL, MMAP_SIZE, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (p == MAP_FAILED)
+		return (-1);
+
+	/* Pages are zero filled. */
+	for (size_t i = 0; i < MMAP_SIZE; i++)
 	{
-		sem_wait(empty);
-		work_cpu();
-		sem_post(sem);
+		if (p[i] != 0)
+			return (-1);
+	}
+
+	memset(p, 1, MMAP_SIZE);
+
+	/* Changes made by the child are private. */
+	if (fork() == 0)
+	{
+		p[0] = 2;
+		_exit((p[1] == 1) ? EXIT_SUCCESS : EXIT_FAILURE);
 	}
+
+	wait(&status);
+
+	if ((!WIFEXITED(status)) || (WEXITSTATUS(status) != EXIT_SUCCESS))
+		return (-1);
+	if (p[0] != 1)
+		return (-1);
+
+	/* Fixed mappings must be aligned. */
+	q = mmap(p + 4096, 4096, PROT_READ,
+		MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+	if ((q != MAP_FAILED) || (errno != EINVAL))
+		return (-1);
+
+	/* Mappings cannot be partially unmapped. */
+	if ((munmap(p, 4096) != -1) || (errno != EINVAL))
+		return (-1);
+
+	return (munmap(p, MMAP_SIZE));
 }
 
 /**
- * @brief Consumes stuff.
+ * @brief Shared anonymous mapping test.
  *
- * @param sem  Accounts for empty slots on a shared buffer.
- * @param fill Accounts for used slots on a shared buffer.
+ * @returns Zero if passed, non-zero otherwise.
  */
-static void producer(sem_t *sem, sem_t *empty, int n)
+static int mmap_test1(void)
 {
-	for (int j = 0; j < n; j++)
+	int *p;
+
+	p = mmap(NULL, MMAP_SIZE, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (p == MAP_FAILED)
+		return (-1);
+
+	/* Child writes, parent reads. */
+	if (fork() == 0)
 	{
-		sem_wait(sem);
-		work_cpu();
-		sem_post(empty);
+		p[0] = 1;
+		p[MMAP_SIZE/sizeof(int) - 1] = 2;
+		_exit(EXIT_SUCCESS);
 	}
+
+	wait(NULL);
+
+	if ((p[0] != 1) || (p[MMAP_SIZE/sizeof(int) - 1] != 2))
+		return (-1);
+
+	return (munmap(p, MMAP_SIZE));
 }
 
-/*	
- * @brief Producer consumer test.
+/* Size of large memory mappings. */
+#define MMAP_LARGE_SIZE (4*1024*1024)
+
+/**
+ * @brief Large page mapping test.
+ *
+ * @details Large pages are only a hint, so the mapping must behave as a
+ *          regular private anonymous mapping.
+ *
+ * @returns Zero if passed, non-zero otherwise.
  */
-static int sem_producer_consumer_test(void)
+static int mmap_test3(void)
 {
-	int n;				 /* Number of items.	   */
-	mode_t mode;		 /* Semaphore access mode. */
-	sem_t *empty, *full; /* Semaphores.			   */
+	int *p;
+	int status;
+	const size_t n = MMAP_LARGE_SIZE/sizeof(int);
 
-	/* Named semaphores. */
-	const char *sem1 = "/home/mysem/sem1";
-	const char *sem2 = "/home/mysem/sem2";
+	p = mmap(NULL, MMAP_LARGE_SIZE, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS | MAP_LARGE, -1, 0);
+	if (p == MAP_FAILED)
+		return (-1);
 
-	n = 10;
-	mode = 0644;
+	/* Touch every page. */
+	for (size_t i = 0; i < n; i += 1024)
+	{
+		if (p[i] != 0)
+			goto error;
+		p[i] = i;
+	}
 
-	full = sem_open(sem2, O_CREAT, mode, 0);
-	empty = sem_open(sem1, O_CREAT, mode, n);
+	/* Changes made by the child are private. */
+	if (fork() == 0)
+	{
+		p[0] = -1;
+		_exit((p[n - 1024] == (int)(n - 1024)) ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
 
-	if ((empty == NULL) || (full == NULL))
-	{	
-		printf("cannot create semaphores\n");
-		exit(EXIT_FAILURE);	
+	wait(&status);
+
+	if ((!WIFEXITED(status)) || (WEXITSTATUS(status) != EXIT_SUCCESS))
+		goto error;
+	if (p[0] != 0)
+		goto error;
+
+	return (munmap(p, MMAP_LARGE_SIZE));
+
+error:
+	munmap(p, MMAP_LARGE_SIZE);
+	return (-1);
+}
+
+/**
+ * @brief Shared file mapping test.
+ *
+ * @returns Zero if passed, non-zero otherwise.
+ */
+static int mmap_test2(void)
+{
+	int fd;
+	char *p;
+	pid_t pid;
+	int status;
+	char buf[16];
+	const char *filename = "/home/mmap.test";
+
+	if ((fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0666)) < 0)
+		return (-1);
+
+	memset(buf, 'a', sizeof(buf));
+	if (write(fd, buf, sizeof(buf)) != sizeof(buf))
+		goto error0;
+
+	p = mmap(NULL, sizeof(buf), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (p == MAP_FAILED)
+		goto error0;
+
+	/* File contents are mapped. */
+	if (p[0] != 'a')
+		goto error1;
+
+	/* Changes are written back. */
+	p[0] = 'b';
+	if (msync(p, sizeof(buf), MS_SYNC) < 0)
+		goto error1;
+	if (lseek(fd, 0, SEEK_SET) < 0)
+		goto error1;
+	if ((read(fd, buf, sizeof(buf)) != sizeof(buf)) || (buf[0] != 'b'))
+		goto error1;
+
+	/* Mapping cannot be written anymore. */
+	if (mprotect(p, sizeof(buf), PROT_READ) < 0)
+		goto error1;
+	if ((pid = fork()) < 0)
+		goto error1;
+	if (pid == 0)
+	{
+		p[0] = 'c';
+		_exit(EXIT_SUCCESS);
+	}
+	wait(&status);
+	if ((!WIFSIGNALED(status)) || (WTERMSIG(status) != SIGSEGV))
+		goto error1;
+	if (p[0] != 'b')
+		goto error1;
+
+	munmap(p, sizeof(buf));
+	close(fd);
+	unlink(filename);
+
+	return (0);
+
+error1:
+	munmap(p, sizeof(buf));
+error0:
+	close(fd);
+	unlink(filename);
+	return (-1);
+}
+
+/**
+ * @brief Dummy signal handler.
+ *
+ * @param sig Received signal.
+ */
+static void mmap_alarm(int sig)
+{
+	((void) sig);
+}
+
+/**
+ * @brief Merged pages test.
+ *
+ * @details Two processes fill private mappings with the same contents and
+ *          give the kernel some time to merge them. Pages must still be
+ *          private afterwards.
+ *
+ * @returns Zero if passed, non-zero otherwise.
+ */
+static int mmap_test4(void)
+{
+	char *p;
+	pid_t pid;
+	int status;
+
+	signal(SIGALRM, mmap_alarm);
+
+	if ((pid = fork()) < 0)
+		return (-1);
+
+	p = mmap(NULL, MMAP_SIZE, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (p == MAP_FAILED)
+	{
+		if (pid == 0)
+			_exit(EXIT_FAILURE);
+		wait(NULL);
+		return (-1);
+	}
+
+	memset(p, 'k', MMAP_SIZE);
+
+	/* Wait for pages to be merged. */
+	alarm(2);
+	pause();
+
+	/* Child changes its pages. */
+	if (pid == 0)
+	{
+		memset(p, 'c', MMAP_SIZE);
+		_exit((p[MMAP_SIZE - 1] == 'c') ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	wait(&status);
+
+	if ((!WIFEXITED(status)) || (WEXITSTATUS(status) != EXIT_SUCCESS))
+		goto error;
+
+	for (size_t i = 0; i < MMAP_SIZE; i++)
+	{
+		if (p[i] != 'k')
+			goto error;
 	}
 
-	/* Child. */
+	return (munmap(p, MMAP_SIZE));
+
+error:
+	munmap(p, MMAP_SIZE);
+	return (-1);
+}
+
+/**
+ * @brief Shared memory segment test.
+ *
+ * @returns Zero if passed, non-zero otherwise.
+ */
+static int shm_test0(void)
+{
+	int shmid;
+	int *p;
+	struct shmid_ds ds;
+
+	if ((shmid = shmget(IPC_PRIVATE, MMAP_SIZE, IPC_CREAT | 0600)) < 0)
+		return (-1);
+
+	/* Child attaches and writes. */
 	if (fork() == 0)
 	{
-		full = sem_open(sem2, O_RDWR);
-		empty = sem_open(sem1, O_RDWR);
+		if ((p = shmat(shmid, NULL, 0)) == (void *) -1)
+			_exit(EXIT_FAILURE);
+		p[0] = 1;
+		p[MMAP_SIZE/sizeof(int) - 1] = 2;
+		_exit((shmdt(p) == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
 
-		if ((empty == NULL) || (full == NULL))
-		{	
-			printf("cannot open semaphores\n");
-			exit(EXIT_FAILURE);	
-		}
+	wait(NULL);
 
-		producer(empty, full, n);
+	if ((p = shmat(shmid, NULL, 0)) == (void *) -1)
+		goto error0;
 
-		sem_close(full);
-		sem_close(empty);
+	if ((p[0] != 1) || (p[MMAP_SIZE/sizeof(int) - 1] != 2))
+		goto error1;
 
-		exit (EXIT_SUCCESS);
-	}
+	if ((shmctl(shmid, IPC_STAT, &ds) < 0) || (ds.shm_nattch != 1))
+		goto error1;
 
-	/* Father. */
-	else
-	{
-		consumer(empty, full, n);
+	/* Segment survives removal until detached. */
+	if (shmctl(shmid, IPC_RMID, NULL) < 0)
+		goto error1;
+	if (p[0] != 1)
+		goto error1;
 
-		sem_close(full);
-		sem_close(empty);
-		
-		sem_unlink(sem2);
-		sem_unlink(sem1);
-	}
+	return (shmdt(p));
 
-	return (0);
+error1:
+	shmdt(p);
+error0:
+	shmctl(shmid, IPC_RMID, NULL);
+	return (-1);
 }
 
-static int sem_test_open_close(void) 
-{ 
-	/* Child. */
-	if (fork() == 0)
-	{ 
-		/* We don't unlink semc2 */ 
-		sem_t *semc1, *semc3;
-		semc1 = sem_open("/home/mysem/sem1",O_CREAT,0777,0);
-		semc3 = sem_open("/home/mysem/sem3",O_CREAT,0777,0); 
+/*============================================================================*
+ *                           Swapping Test                                    *
+ *============================================================================*/
 
-		sem_wait(semc1);
-		work_cpu();
-		sem_post(semc3);
+/* Number of processes in swapping test. */
+#define SWAP_NPROCS 6
 
-		sem_unlink("/home/mysem/sem1");
-		sem_wait(semc1);
+/* Memory used by each process in swapping test. */
+#define SWAP_MEM_SIZE (6*1024*1024)
 
-		sem_close(semc3);
-		sem_close(semc1);
-		sem_unlink("/home/mysem/sem3");
+/**
+ * @brief Swapping test.
+ *
+ * @details Spawns processes that altogether use more memory than there is
+ *          in the system. Each of them fills its memory with a pattern,
+ *          waits for the others to do the same, and then checks it.
+ *
+ * @returns Zero if passed, non-zero otherwise.
+ */
+static int swap_test0(void)
+{
+	char c;
+	int *p;
+	int fd[2];
+	int status;
+	int ret = 0;
+	const size_t n = SWAP_MEM_SIZE/sizeof(int);
+
+	if (pipe(fd) < 0)
+		return (-1);
 
-		/* Operations on invalid semaphores */
-		sem_wait(semc1);
-		sem_wait(semc3);
-		sem_post(semc1);
-		sem_post(semc3);
+	for (int i = 0; i < SWAP_NPROCS; i++)
+	{
+		if (fork() == 0)
+		{
+			close(fd[1]);
 
-		exit (EXIT_SUCCESS);
-	} 
-	else
-	{ 
-		/* father */ 
-		sem_t *semf1, *semf2, *semf3, *semf4; 
-		semf1 = sem_open("/home/mysem/sem1",O_CREAT,0777,0);
-		/* Opening the same semaphore : the same address should be returned */ 
-		semf2 = sem_open("/home/mysem/sem1",O_CREAT,0777,0);
-		semf3 = sem_open("/home/mysem/sem3",O_CREAT,0777,0); 
-		semf4 = sem_open("/home/mysem/sem4",O_CREAT,0777,0); 
+			p = mmap(NULL, SWAP_MEM_SIZE, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (p == MAP_FAILED)
+				_exit(EXIT_FAILURE);
 
-		sem_post(semf1);
-		work_cpu();
-		sem_wait(semf3);
-		sem_unlink("/home/mysem/sem1");
+			for (size_t j = 0; j < n; j += 1024)
+				p[j] = i*n + j;
 
-		work_cpu();
-		sem_post(semf1);
-		sem_close(semf3);
+			/* Wait for the other processes. */
+			read(fd[0], &c, 1);
 
-		/* sem4 multiple closed */
-		sem_close(semf4);
-		sem_close(semf4); /* no effect */ 
-		sem_close(semf4); /* no effect */
-		
-		sem_unlink("/home/mysem/sem4"); /* this will delete sem4 because ref count == 0 */
-		
-		/* opening a new semaphore called sem4 */
-		semf4 = sem_open("/home/mysem/sem4",O_CREAT,0777,0); 
+			for (size_t j = 0; j < n; j += 1024)
+			{
+				if (p[j] != (int)(i*n + j))
+					_exit(EXIT_FAILURE);
+			}
 
-		/* Unlinking before closing */
-		sem_unlink("/home/mysem/sem4"); /* this will delete sem4 because ref count == 0 */
+			_exit(EXIT_SUCCESS);
+		}
+	}
 
-		sem_close(semf4);
+	close(fd[0]);
+	close(fd[1]);
 
-		semf4 = sem_open("/home/mysem/sem4",O_CREAT,0777,0); /* This will use another kernel slot : sem4 has been unlinked */
+	for (int i = 0; i < SWAP_NPROCS; i++)
+	{
+		if (wait(&status) < 0)
+			return (-1);
+		if ((!WIFEXITED(status)) || (WEXITSTATUS(status) != EXIT_SUCCESS))
+			ret = -1;
+	}
 
-		sem_close(semf1);
-		sem_close(semf2);
-		sem_close(semf3);
-		
-		sem_unlink("/home/mysem/sem2");
-		sem_unlink("/home/mysem/sem4");
-	} 
- 
-	return (0); 
-} 
+	return (ret);
+}
 
 /*============================================================================*
- *								  FPU test									  *
+ *                           Spawn Test                                       *
  *============================================================================*/
 
 /**
- * @brief FPU testing module.
- * 
- * @details Performs a floating point operation, while trying to
- mess up the stack from another process.
- * 
- * @returns Zero if passed on test, and non-zero otherwise.
+ * @brief Process spawning test.
+ *
+ * @details Spawns echo with its standard output redirected to a file,
+ *          and checks what was written there.
+ *
+ * @returns Zero if passed, non-zero otherwise.
  */
-int fpu_test(void)
+static int spawn_test0(void)
 {
-#ifdef i386
-	pid_t pid;	   /* Child process ID.		*/
-	float a = 6.7; /* First dummy operand.	*/
-	float b = 1.2; /* Second dummy operand. */
-	float result;  /* Result.				*/
-	
-	/* Perform a/b */
-	__asm__ volatile(
-		"flds %1;"
-		"flds %0;"
-		"fdivrp %%st,%%st(1);"
-		: /* noop. */
-		: "m" (b), "m" (a)
-	);
+	pid_t pid;
+	int fd, status;
+	char buf[8];
+	posix_spawn_file_actions_t fa;
+	const char *filename = "spawn.test";
+	char *argv[] = { "echo", "spawn", NULL };
 
-	pid = fork();
-	
-	/* Failed to fork(). */
-	if (pid < 0)
+	if (posix_spawn_file_actions_init(&fa) != 0)
 		return (-1);
-	
-	/*
-	 * Child process tries
-	 * to mess up the stack.
-	 */
-	else if (pid == 0)
-	{
-		work_fpu();
-		_exit(EXIT_SUCCESS);
-	}
-	
-	wait(NULL);
 
-	/* But it's only in your context,
-	 * so nothing changed for father process.
-	 */
-	__asm__ volatile(
-		"fstps %0;"
-		: "=m" (result)
-	);
+	if (posix_spawn_file_actions_addopen(&fa, 1, filename,
+		O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR) != 0)
+		goto error0;
 
-	/* 0x40b2aaaa = 6.7/1.2 = 5.5833.. */
-	return (result == 0x40b2aaaa);
-#elif or1k
-	((void)work_fpu);
-	return (1);
-#endif
-}
+	if (posix_spawnp(&pid, "echo", &fa, NULL, argv, environ) != 0)
+		goto error0;
 
-/*============================================================================*
- *							 Memory Violation								  *
- *============================================================================*/
+	while (wait(&status) != pid)
+		/* noop */;
 
-/*	
- * @brief Forces a memory violation.
- */
-static int test_mem0(void)
-{
-	/* Child. */
-	if (fork() == 0)
-	{
-		int *i;
-		i = NULL;
-		printf("%d \n",*i);
-	}
-	/* Parent. */
-	else
+	if (!WIFEXITED(status) || (WEXITSTATUS(status) != EXIT_SUCCESS))
+		goto error0;
+
+	posix_spawn_file_actions_destroy(&fa);
+
+	/* Check output. */
+	if ((fd = open(filename, O_RDONLY)) < 0)
+		goto error1;
+	if ((read(fd, buf, 6) != 6) || (strncmp(buf, "spawn\n", 6)))
 	{
-		/* noop */;
-		exit(EXIT_SUCCESS);
+		close(fd);
+		goto error1;
 	}
 
+	close(fd);
+	unlink(filename);
 	return (0);
+
+error0:
+	posix_spawn_file_actions_destroy(&fa);
+error1:
+	unlink(filename);
+	return (-1);
 }
 
 /*============================================================================*
@@ -1003,6 +2447,88 @@ static int thread_test0(void)
 }
 
 
+/*
+ * @brief Recursively fills the stack.
+ */
+static int thread_stack_fill(int depth)
+{
+	volatile char buf[512];
+
+	for (unsigned i = 0; i < sizeof(buf); i++)
+		buf[i] = (char) depth;
+
+	if (depth > 0)
+	{
+		if (thread_stack_fill(depth - 1))
+			return (-1);
+	}
+
+	for (unsigned i = 0; i < sizeof(buf); i++)
+	{
+		if (buf[i] != (char) depth)
+			return (-1);
+	}
+
+	return (0);
+}
+
+/*
+ * @brief Thread routine that uses its stack.
+ */
+static void *thread_stack_routine_test(void *arg)
+{
+	return ((thread_stack_fill(32)) ? NULL : arg);
+}
+
+/*
+ * @brief Thread test stack size attribute and stack reuse.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int thread_test4(void)
+{
+	int res;
+	void *ret;
+	size_t size;
+	pthread_attr_t attr;
+	pthread_t thread;
+
+	pthread_attr_init(&attr);
+
+	/* Stack too small. */
+	if (pthread_attr_setstacksize(&attr, PTHREAD_STACK_MIN - 1) == 0)
+		return (-1);
+
+	if ((res = pthread_attr_setstacksize(&attr, 32*1024)) != 0)
+		return (res);
+	pthread_attr_getstacksize(&attr, &size);
+	if (size != 32*1024)
+		return (-1);
+
+	/* Stacks of exited threads get reused. */
+	for (int i = 0; i < 64; i++)
+	{
+		if ((res = pthread_create(&thread, &attr,
+								  thread_stack_routine_test, &attr)) != 0)
+			return (res);
+
+		if ((res = pthread_join(thread, &ret)) != 0)
+			return (res);
+
+		if (ret != &attr)
+			return (-1);
+	}
+
+	/* Stack too large. */
+	pthread_attr_setstacksize(&attr, 64*1024*1024);
+	if (pthread_create(&thread, &attr, thread_stack_routine_test, &attr) == 0)
+		return (-1);
+
+	pthread_attr_destroy(&attr);
+
+	return (0);
+}
+
 /*============================================================================*
  *                                   main                                     *
  *============================================================================*/
@@ -1019,12 +2545,18 @@ static void usage(void)
 	printf("Options:\n");
 	printf("  fpu	  Floating Point Unit Test\n");
 	printf("  io	  I/O Test\n");
+	printf("  fs	  File System Tests\n");
 	printf("  ipc	  Interprocess Communication Test\n");
 	printf("  paging  Paging System Test\n");
+	printf("  color	  Page Coloring Benchmark\n");
 	printf("  stack	  Stack growth Test\n");
 	printf("  sched	  Scheduling Test\n");
 	printf("  sem	  Semaphore Tests\n");
 	printf("  mem	  Memory Violation Tests\n");
+	printf("  mmap	  Memory Mapping Tests\n");
+	printf("  shm	  Shared Memory Tests\n");
+	printf("  swap	  Swapping Tests\n");
+	printf("  spawn	  Process Spawning Tests\n");
 	printf("  thread  Thread Tests\n");
 
 	exit(EXIT_SUCCESS);
@@ -1049,12 +2581,50 @@ int main(int argc, char **argv)
 				   (!io_test()) ? "PASSED" : "FAILED");
 		}
 		
+		/* File system tests. */
+		else if (!strcmp(argv[i], "fs"))
+		{
+			printf("File System Tests\n");
+			printf("  name cache [%s]\n",
+				   (!dcache_test()) ? "PASSED" : "FAILED");
+			printf("  indexed directory [%s]\n",
+				   (!diridx_test()) ? "PASSED" : "FAILED");
+			printf("  block overwrite [%s]\n",
+				   (!overwrite_test()) ? "PASSED" : "FAILED");
+			printf("  vectored I/O [%s]\n",
+				   (!iovec_test()) ? "PASSED" : "FAILED");
+			printf("  file splicing [%s]\n",
+				   (!splice_test()) ? "PASSED" : "FAILED");
+			printf("  large file [%s]\n",
+				   (!largefile_test()) ? "PASSED" : "FAILED");
+			printf("  block preallocation [%s]\n",
+				   (!prealloc_test()) ? "PASSED" : "FAILED");
+			printf("  tmpfs [%s]\n",
+				   (!tmpfs_test()) ? "PASSED" : "FAILED");
+			printf("  ext2 [%s]\n",
+				   (!ext2_test()) ? "PASSED" : "FAILED");
+		}
+
 		/* Paging system test. */
 		else if (!strcmp(argv[i], "paging"))
 		{
 			printf("Demand Zero Test\n");
 			printf("  Result:			  [%s]\n",
 				   (!demand_zero_test()) ? "PASSED" : "FAILED");
+			printf("Resource Usage Test\n");
+			printf("  Result:			  [%s]\n",
+				   (!rusage_test()) ? "PASSED" : "FAILED");
+			printf("Zero Page Test\n");
+			printf("  Result:			  [%s]\n",
+				   (!zero_page_test()) ? "PASSED" : "FAILED");
+		}
+
+		/* Page coloring benchmark. */
+		else if (!strcmp(argv[i], "color"))
+		{
+			printf("Page Coloring Benchmark\n");
+			printf("  Result:			  [%s]\n",
+				   (!color_test()) ? "PASSED" : "FAILED");
 		}
 
 		/* Stack growth test. */
@@ -1101,10 +2671,52 @@ int main(int argc, char **argv)
 		else if (!strcmp(argv[i], "mem"))
 		{
 			printf("Memory Violation Tests\n");
+			printf("  bad user buffers	[%s]\n",
+				   (!test_mem1()) ? "PASSED" : "FAILED");
 			printf("  null pointer		[%s]\n",
 				   (!test_mem0()) ? "PASSED" : "FAILED");
 		}
 
+		/* Memory mapping tests. */
+		else if (!strcmp(argv[i], "mmap"))
+		{
+			printf("Memory Mapping Tests\n");
+			printf("  private anonymous [%s]\n",
+				   (!mmap_test0()) ? "PASSED" : "FAILED");
+			printf("  shared anonymous	[%s]\n",
+				   (!mmap_test1()) ? "PASSED" : "FAILED");
+			printf("  shared file		[%s]\n",
+				   (!mmap_test2()) ? "PASSED" : "FAILED");
+			printf("  large pages		[%s]\n",
+				   (!mmap_test3()) ? "PASSED" : "FAILED");
+			printf("  merged pages		[%s]\n",
+				   (!mmap_test4()) ? "PASSED" : "FAILED");
+		}
+
+		/* Shared memory tests. */
+		else if (!strcmp(argv[i], "shm"))
+		{
+			printf("Shared Memory Tests\n");
+			printf("  shared segment [%s]\n",
+				   (!shm_test0()) ? "PASSED" : "FAILED");
+		}
+
+		/* Swapping tests. */
+		else if (!strcmp(argv[i], "swap"))
+		{
+			printf("Swapping Tests\n");
+			printf("  overcommit [%s]\n",
+				   (!swap_test0()) ? "PASSED" : "FAILED");
+		}
+
+		/* Process spawning tests. */
+		else if (!strcmp(argv[i], "spawn"))
+		{
+			printf("Process Spawning Tests\n");
+			printf("  file actions [%s]\n",
+				   (!spawn_test0()) ? "PASSED" : "FAILED");
+		}
+
 		/* Thread tests. */
 		else if (!strcmp(argv[i], "thread"))
 		{
@@ -1117,6 +2729,8 @@ int main(int argc, char **argv)
 				(!thread_test2()) ? "PASSED" : "FAILED");
 			printf("  multithreaded process fork [%s]\n",
 				(!thread_test3()) ? "PASSED" : "FAILED");
+			printf("  thread stack size [%s]\n",
+				(!thread_test4()) ? "PASSED" : "FAILED");
 		}
 
 		/* Wrong usage. */
@@ -17,10 +17,12 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
  
+#include <sys/sendfile.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -39,11 +41,8 @@ static int nfiles = 0;         /* Number of files to concatenate. */
  */
 static void cat(char *filename)
 {
-	int fd;           /* File descriptor.        */
-	int off;          /* Buffer offset.          */
-	char buf[BUFSIZ]; /* Buffer.                 */
-	ssize_t n, nread; /* Bytes actually read.    */
-	ssize_t nwritten; /* Bytes actually written. */
+	int fd;    /* File descriptor.      */
+	ssize_t n; /* Bytes actually moved. */
 	
 	fd = open(filename, O_RDONLY);
 	
@@ -54,29 +53,18 @@ static void cat(char *filename)
 		return;
 	}
 	
+	fflush(stdout);
+	
 	/* Concatenate file. */
-	do
-	{	
-		/* Error while reading. */
-		if ((nread = read(fd, buf, BUFSIZ)) < 0)
-			fprintf(stderr, "cat: cannot read %s\n", filename);
-		
-		n = nread;
-		
-		off = 0;
-		do
-		{
-			nwritten = write(fileno(stdout), &buf[off], nread);
-			
-			/* Failed to write. */
-			if (nwritten < 0)
-			{
-				fprintf(stderr, "cat: write error\n");
-				exit(errno);
-			}
-			off += nwritten;
-		} while ((nread -= nwritten) > 0);
-	} while (n == BUFSIZ);	
+	while ((n = splice(fd, NULL, fileno(stdout), NULL, SSIZE_MAX, 0)) > 0)
+		/* noop */ ;
+	
+	/* Failed to concatenate. */
+	if (n < 0)
+	{
+		fprintf(stderr, "cat: cannot concatenate %s\n", filename);
+		exit(errno);
+	}
 	
 	close(fd);
 }
@@ -17,9 +17,11 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <sys/sendfile.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -38,23 +40,15 @@ static const char *dest = NULL; /* Destination file. */
  */
 static void do_cp(int src, int dest)
 {
-	ssize_t count;    /* Bytes read/written.  */
-	char buf[BUFSIZ]; /* Buffer.              */
+	ssize_t count; /* Bytes moved. */
 	
 	/* Copy source file into destination file. */
-	while ((count = read(src, buf, BUFSIZ)) > 0) {
-		count = write(dest, buf, count);
-		
-		/* Write error. */
-		if (count < 0) {
-			fprintf(stderr, "cp: write error\n");
-			exit(EXIT_FAILURE);
-		}
-	}
+	while ((count = sendfile(dest, src, NULL, SSIZE_MAX)) > 0)
+		/* noop */ ;
 	
-	/* Error while reading. */
+	/* Copy error. */
 	if (count < 0) {
-		fprintf(stderr, "cp: read error\n");
+		fprintf(stderr, "cp: copy error\n");
 		exit(EXIT_FAILURE);
 	}
 }
@@ -27,6 +27,7 @@
 #include <limits.h>
 #include <stdlib.h>
 #include <signal.h>
+#include <spawn.h>
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
@@ -50,6 +51,9 @@ int shret = EXIT_SUCCESS;
 /* Input file. */
 FILE *input = NULL;
 
+/* Command string. */
+static char *command = NULL;
+
 /* TTY modes */
 struct termios canonical;
 struct termios raw;
@@ -156,12 +160,84 @@ static void closeredir(int *redir)
 		close(redir[1]);
 }
 
+/*
+ * Spawns a command.
+ */
+static int spawncmd(pid_t *pid, const char **args, int *redir, int flags)
+{
+	int i;                         /* Loop index.        */
+	int err;                       /* Error number.      */
+	sigset_t sigdefault;           /* Signals to reset.  */
+	posix_spawnattr_t attr;        /* Spawn attributes.  */
+	posix_spawn_file_actions_t fa; /* File actions.      */
+	void (*sigint)(int) = SIG_DFL;  /* SIGINT handler.    */
+	void (*sigquit)(int) = SIG_DFL; /* SIGQUIT handler.   */
+	
+	if ((err = posix_spawn_file_actions_init(&fa)) != 0)
+		return (err);
+	if ((err = posix_spawnattr_init(&attr)) != 0)
+		goto error0;
+	
+	/* Reset signals. */
+	(void) sigemptyset(&sigdefault);
+	(void) sigaddset(&sigdefault, SIGTERM);
+	(void) sigaddset(&sigdefault, SIGTSTP);
+	if (!(flags & CMD_ASYNC))
+	{
+		(void) sigaddset(&sigdefault, SIGINT);
+		(void) sigaddset(&sigdefault, SIGQUIT);
+	}
+	posix_spawnattr_setsigdefault(&attr, &sigdefault);
+	posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGDEF);
+	
+	/* Asynchronous jobs do not read from the terminal. */
+	if ((flags & CMD_ASYNC) && (redir[0] == -1))
+	{
+		err = posix_spawn_file_actions_addopen(&fa, 0, "/dev/null", O_RDONLY, 0);
+		if (err != 0)
+			goto error1;
+	}
+	
+	/* Redirections. */
+	for (i = 0; i < 2; i++)
+	{
+		if (redir[i] != -1)
+		{
+			if ((err = posix_spawn_file_actions_adddup2(&fa, redir[i], i)) != 0)
+				goto error1;
+			if ((err = posix_spawn_file_actions_addclose(&fa, redir[i])) != 0)
+				goto error1;
+		}
+	}
+	
+	/* Asynchronous jobs inherit ignored SIGINT and SIGQUIT. */
+	if (flags & CMD_ASYNC)
+	{
+		sigint = signal(SIGINT, SIG_IGN);
+		sigquit = signal(SIGQUIT, SIG_IGN);
+	}
+	
+	err = posix_spawnp(pid, args[0], &fa, &attr, (char * const *)args, environ);
+	
+	if (flags & CMD_ASYNC)
+	{
+		signal(SIGINT, sigint);
+		signal(SIGQUIT, sigquit);
+	}
+
+error1:
+	posix_spawnattr_destroy(&attr);
+error0:
+	posix_spawn_file_actions_destroy(&fa);
+	return (err);
+}
+
 /*
  * Runs a command.
  */
 static void runcmd(const char **args, int argc, int *redir, int flags)
 {
-	int i;         /* Loop index.       */
+	int err;       /* Error number.     */
 	int status;    /* Exit status.      */
 	pid_t pid;     /* Child process ID. */
 	builtin_t cmd; /* Built-in command. */
@@ -175,92 +251,47 @@ static void runcmd(const char **args, int argc, int *redir, int flags)
 		return;
 	}
 	
-	pid = fork();
-	
-	/* Failed to fork. */
-	if (pid < 0)
+	if ((err = spawncmd(&pid, args, redir, flags)) != 0)
 	{
-		fprintf(stderr, "%s: failed to fork child\n", TSH_NAME);
-		shret = errno;
+		fprintf(stderr, "%s: failed to execute\n", args[0]);
+		shret = err;
 		goto error;
 	}
 	
-	/* Parent process. */
-	if (pid > 0)
-	{
-		closeredir(redir);
-		
-		/* Piping... */
-		if (flags & CMD_PIPE)
-			return;
-		
-		/* Asynchronous execution. */
-		if (flags & CMD_ASYNC)
-		{
-			printf("[%d]+\n", pid);
-			return;
-		}
-
-		/* Wait child. */
-		while (wait(&status) != pid)
-			/* noop */;
-		
-		/* Abnormal termination. */
-		if (status != EXIT_SUCCESS)
-		{
-			/* Signal. */
-			if (WIFSIGNALED(status))
-				sigmsg(shret = WTERMSIG(status));
-			
-			/* Voluntary. */
-			else if (WIFEXITED(status))
-				shret = WEXITSTATUS(status);
-			
-			/* Stopped. */
-			else if  (WIFSTOPPED(status))
-				printf("[%d]+\tStopped\n", pid);
-		}
-		
+	closeredir(redir);
+	
+	/* Piping... */
+	if (flags & CMD_PIPE)
 		return;
-	}
 	
-	/*
-	 * Child process.
-	 */
-
-	/* Reset signals. */
-	signal(SIGINT, SIG_DFL);
-	signal(SIGQUIT, SIG_DFL);
-	signal(SIGTERM, SIG_DFL);
-	signal(SIGTSTP, SIG_DFL);
+	/* Asynchronous execution. */
 	if (flags & CMD_ASYNC)
 	{
-		signal(SIGINT, SIG_IGN);
-		signal(SIGQUIT, SIG_IGN);
-		if (redir[0] == -1)
-		{
-			close(0);
-			open("/dev/null", O_RDONLY);
-		}
+		printf("[%d]+\n", pid);
+		return;
 	}
+
+	/* Wait child. */
+	while (wait(&status) != pid)
+		/* noop */;
 	
-	/* Redirections. */
-	for (i = 0; i < 2; i++)
+	/* Abnormal termination. */
+	if (status != EXIT_SUCCESS)
 	{
-		if (redir[i] != -1)
-		{
-			if (dup2(redir[i], i) == -1)
-			{
-				fprintf(stderr, "%s: failed to redirect\n", args[0]);
-				exit(EXIT_FAILURE);
-			}
-			close(redir[i]);
-		}
-	}
+		/* Signal. */
+		if (WIFSIGNALED(status))
+			sigmsg(shret = WTERMSIG(status));
 		
-	execvp(args[0], (char * const *)args);
-	fprintf(stderr, "%s: failed to execute\n", args[0]);
-	exit(EXIT_FAILURE);
+		/* Voluntary. */
+		else if (WIFEXITED(status))
+			shret = WEXITSTATUS(status);
+		
+		/* Stopped. */
+		else if  (WIFSTOPPED(status))
+			printf("[%d]+\tStopped\n", pid);
+	}
+	
+	return;
 
 error:
 	sherror();
@@ -691,6 +722,7 @@ static void usage(void)
 	printf("Usage: %s [options]\n", TSH_NAME);
 	printf("Options:\n");
 	printf("  <command file> Command file to read from\n");
+	printf("  -c <command>   Executes command and exits\n");
 	printf("  --help         Displays this information and exits\n");
 	printf("  --version      Prints program version and exits\n");
 	
@@ -725,11 +757,23 @@ static void readargs(int argc, char **argv)
 		else if (!strcmp(arg, "--help"))
 			usage();
 		
+		/* Execute command. */
+		else if (!strcmp(arg, "-c"))
+		{
+			if (++i == argc)
+				usage();
+			command = argv[i];
+		}
+		
 		/* Set input. */
 		else
 			infile = arg;
 	}
 	
+	/* Command string. */
+	if (command != NULL)
+		return;
+	
 	/* Read from standard input. */
 	if (input == NULL)
 	{
@@ -787,6 +831,15 @@ int main(int argc, char **argv)
 
 #endif /* OPEN_MAX */
 
+	/* Execute command string. */
+	if (command != NULL)
+	{
+		strncpy(line, command, LINELEN - 1);
+		line[LINELEN - 1] = '\0';
+		pline(line);
+		return (shret);
+	}
+
 	/* Configure tty to work in raw mode. */
 	configure_tty();
 
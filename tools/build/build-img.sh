@@ -88,7 +88,10 @@ function format {
 	$QEMU_VIRT bin/mkdir.minix $1 /home/rep1 $ROOTUID $ROOTGID
 	$QEMU_VIRT bin/mkdir.minix $1 /home/rep2 $ROOTUID $ROOTGID
 	$QEMU_VIRT bin/mkdir.minix $1 /dev $ROOTUID $ROOTGID
+	$QEMU_VIRT bin/mkdir.minix $1 /tmp $ROOTUID $ROOTGID
+	$QEMU_VIRT bin/mkdir.minix $1 /mnt $ROOTUID $ROOTGID
 	$QEMU_VIRT bin/mkdir.minix $1 /home/mysem/ $ROOTUID $ROOTGID
+	$QEMU_VIRT bin/mkdir.minix -i $1 /home/index $ROOTUID $ROOTGID
 	$QEMU_VIRT bin/mknod.minix $1 /dev/null 666 c 0 0 $ROOTUID $ROOTGID
 	$QEMU_VIRT bin/mknod.minix $1 /dev/tty 666 c 0 1 $ROOTUID $ROOTGID
 	$QEMU_VIRT bin/mknod.minix $1 /dev/klog 666 c 0 2 $ROOTUID $ROOTGID
@@ -96,6 +99,15 @@ function format {
 	$QEMU_VIRT bin/mknod.minix $1 /dev/ramdisk1 666 b 1 0 $ROOTUID $ROOTGID
 }
 
+#
+# Formats an ext2 disk, with 1 KB blocks.
+#   $1 Disk image name.
+#   $2 Number of inodes.
+#
+function format_ext2 {
+	mke2fs -q -F -t ext2 -b 1024 -m 0 -N $2 -L nanvix $1
+}
+
 #
 # Copy files to a disk image.
 #   $1 Target disk image.
@@ -106,6 +118,7 @@ function copy_files
 	chmod 600 tools/img/inittab
 	
 	$QEMU_VIRT bin/cp.minix $1 tools/img/inittab /etc/inittab $ROOTUID $ROOTGID
+	$QEMU_VIRT bin/cp.minix $1 ext2.img /etc/ext2.img $ROOTUID $ROOTGID
 	
 	passwords $1
 	
@@ -175,6 +188,10 @@ else
 		fi;
 	done
 
+	# Build ext2 disk image (as large as the spare RAM disk).
+	dd if=/dev/zero of=ext2.img bs=1024 count=64
+	format_ext2 ext2.img 16
+
 	# Build HDD image.
 	dd if=/dev/zero of=hdd.img bs=1024 count=65536
 	format hdd.img 1024 32768
@@ -421,6 +421,180 @@ static block_t minix_block_map(struct d_inode *ip, off_t off, bool create)
 	return (BLOCK_NULL);
 }
 
+/**
+ * @brief Number of directory entries in a block.
+ */
+#define DIRENTS_PER_BLOCK (BLOCK_SIZE/sizeof(struct d_dirent))
+
+/**
+ * @brief Splits a full leaf block of an indexed directory.
+ * 
+ * @param ip   Target directory.
+ * @param idx  Directory index.
+ * @param i    Index entry of the leaf block.
+ * @param blk  Leaf block.
+ * @param leaf Contents of the leaf block.
+ * 
+ * @returns True if the leaf block was split, and false otherwise.
+ * 
+ * @note The Minix file system must be mounted.
+ */
+static bool diridx_split
+(struct d_inode *ip, struct d_diridx *idx, unsigned i, block_t blk, struct d_dirent *leaf)
+{
+	uint32_t split;                             /* Split hash.           */
+	uint16_t logic;                             /* Logical block number. */
+	block_t newblk;                             /* New leaf block.       */
+	struct d_dirent newleaf[DIRENTS_PER_BLOCK]; /* New leaf contents.    */
+	unsigned n;                                 /* Entries moved.        */
+	
+	/* Cannot split. */
+	if ((idx->h_count == DIRIDX_MAX) || minix_diridx_split(leaf, &split))
+		return (false);
+	
+	logic = ip->i_size/BLOCK_SIZE;
+	newblk = minix_block_map(ip, ip->i_size, true);
+	ip->i_size += BLOCK_SIZE;
+	
+	/* Move entries. */
+	memset(newleaf, 0, BLOCK_SIZE);
+	n = 0;
+	for (unsigned j = 0; j < DIRENTS_PER_BLOCK; j++)
+	{
+		if (minix_name_hash(leaf[j].d_name) >= split)
+		{
+			newleaf[n++] = leaf[j];
+			memset(&leaf[j], 0, sizeof(struct d_dirent));
+		}
+	}
+	
+	slseek(fd, blk*BLOCK_SIZE, SEEK_SET);
+	swrite(fd, leaf, BLOCK_SIZE);
+	slseek(fd, newblk*BLOCK_SIZE, SEEK_SET);
+	swrite(fd, newleaf, BLOCK_SIZE);
+	
+	minix_diridx_insert(idx, i + 1, split, logic);
+	
+	return (true);
+}
+
+/**
+ * @brief Searches for a directory entry in an indexed directory.
+ * 
+ * @param ip       Directory where the directory entry shall be searched. 
+ * @param filename Name of the directory entry that shall be searched.
+ * @param create   Create directory entry?
+ * @param off      Location where the file offset of the entry shall be stored.
+ * 
+ * @returns True if the search was carried out, and false if the directory
+ *          shall be searched linearly instead. In the former case, the file
+ *          offset where the directory entry is located, or -1 if the file
+ *          does not exist, is stored in the location pointed to by @p off.
+ * 
+ * @note The Minix file system must be mounted.
+ */
+static bool dirent_search_indexed
+(struct d_inode *ip, const char *filename, bool create, off_t *off)
+{
+	unsigned i;                              /* Index entry.       */
+	uint16_t logic;                          /* Leaf block.        */
+	block_t blk;                             /* Working block.     */
+	uint32_t hash;                           /* Hash of file name. */
+	int entry;                               /* Free entry.        */
+	struct d_diridx idx;                     /* Directory index.   */
+	struct d_dirent leaf[DIRENTS_PER_BLOCK]; /* Leaf block.        */
+	
+	/* Too small to be indexed. */
+	if ((ip->i_size < 2*BLOCK_SIZE) || (ip->i_zones[0] == BLOCK_NULL))
+		return (false);
+	
+	slseek(fd, ip->i_zones[0]*BLOCK_SIZE, SEEK_SET);
+	sread(fd, &idx, BLOCK_SIZE);
+	if (!minix_diridx_valid(&idx))
+		return (false);
+	
+	/* "." and ".." live in the first block. */
+	if (!strcmp(filename, ".") || !strcmp(filename, ".."))
+	{
+		if (create)
+			error("duplicate entry");
+		
+		*off = ip->i_zones[0]*BLOCK_SIZE;
+		if (filename[1] != '\0')
+			*off += sizeof(struct d_dirent);
+		
+		return (true);
+	}
+	
+	hash = minix_name_hash(filename);
+	
+again:
+	
+	i = minix_diridx_search(&idx, hash);
+	logic = minix_diridx_entry(&idx, i)->blk;
+	
+	/* Broken index. */
+	if ((logic == 0) || (logic*BLOCK_SIZE >= ip->i_size))
+		error("broken directory index");
+	
+	blk = minix_block_map(ip, logic*BLOCK_SIZE, false);
+	slseek(fd, blk*BLOCK_SIZE, SEEK_SET);
+	sread(fd, leaf, BLOCK_SIZE);
+	
+	entry = -1;
+	for (unsigned j = 0; j < DIRENTS_PER_BLOCK; j++)
+	{
+		/* Remember free entry. */
+		if (leaf[j].d_ino == INODE_NULL)
+		{
+			if (entry < 0)
+				entry = j;
+			continue;
+		}
+		
+		/* Found. */
+		if (!strncmp(leaf[j].d_name, filename, MINIX_NAME_MAX))
+		{
+			/* Duplicate entry. */
+			if (create)
+				error("duplicate entry");
+			
+			*off = blk*BLOCK_SIZE + j*sizeof(struct d_dirent);
+			return (true);
+		}
+	}
+	
+	/* No entry found. */
+	if (!create)
+	{
+		*off = -1;
+		return (true);
+	}
+	
+	/* Free entry found. */
+	if (entry >= 0)
+	{
+		*off = blk*BLOCK_SIZE + entry*sizeof(struct d_dirent);
+		return (true);
+	}
+	
+	/* Split leaf block. */
+	if (diridx_split(ip, &idx, i, blk, leaf))
+	{
+		slseek(fd, ip->i_zones[0]*BLOCK_SIZE, SEEK_SET);
+		swrite(fd, &idx, BLOCK_SIZE);
+		goto again;
+	}
+	
+	/* Drop index. */
+	memset((char *)&idx + 2*sizeof(struct d_dirent), 0,
+		BLOCK_SIZE - 2*sizeof(struct d_dirent));
+	slseek(fd, ip->i_zones[0]*BLOCK_SIZE, SEEK_SET);
+	swrite(fd, &idx, BLOCK_SIZE);
+	
+	return (false);
+}
+
 /**
  * @brief Searches for a directory entry.
  * 
@@ -444,6 +618,10 @@ static off_t dirent_search(struct d_inode *ip, const char *filename,bool create)
 	int nentries;      /* Number of directory entries. */
 	struct d_dirent d; /* Working directory entry.     */
 	
+	/* Indexed directory. */
+	if (dirent_search_indexed(ip, filename, create, &off))
+		return (off);
+	
 	nentries = ip->i_size/sizeof(struct d_dirent);
 	
 	/* Search for directory entry. */
@@ -678,6 +856,55 @@ uint16_t minix_mkdir
 	return (num);
 }
 
+/**
+ * @brief Indexes a directory.
+ * 
+ * @details Turns the empty directory @p num into an indexed directory, so that
+ *          entries are looked up and added through a hash index. Names are
+ *          then spread across leaf blocks that are split as they fill up.
+ * 
+ * @param num Inode number of the target directory.
+ * 
+ * @note @p num must refer to an empty directory.
+ * @note The Minix file system must be mounted.
+ */
+void minix_dir_index(uint16_t num)
+{
+	block_t blk;                             /* Leaf block.       */
+	struct d_inode *ip;                      /* Directory.        */
+	struct d_diridx idx;                     /* Directory index.  */
+	struct d_dirent leaf[DIRENTS_PER_BLOCK]; /* Empty leaf block. */
+	
+	ip = minix_inode_read(num);
+	
+	/* Not an empty directory. */
+	if (!S_ISDIR(ip->i_mode))
+		error("not a directory");
+	if (ip->i_size != 2*sizeof(struct d_dirent))
+		error("directory not empty");
+	
+	/* Build index. */
+	slseek(fd, ip->i_zones[0]*BLOCK_SIZE, SEEK_SET);
+	sread(fd, &idx, BLOCK_SIZE);
+	memset((char *)&idx + 2*sizeof(struct d_dirent), 0,
+		BLOCK_SIZE - 2*sizeof(struct d_dirent));
+	idx.h_magic = DIRIDX_MAGIC;
+	idx.h_count = 0;
+	minix_diridx_insert(&idx, 0, 0, 1);
+	
+	/* First leaf block. */
+	blk = minix_block_map(ip, BLOCK_SIZE, true);
+	ip->i_size = 2*BLOCK_SIZE;
+	memset(leaf, 0, BLOCK_SIZE);
+	slseek(fd, blk*BLOCK_SIZE, SEEK_SET);
+	swrite(fd, leaf, BLOCK_SIZE);
+	
+	slseek(fd, ip->i_zones[0]*BLOCK_SIZE, SEEK_SET);
+	swrite(fd, &idx, BLOCK_SIZE);
+	
+	minix_inode_write(num, ip);
+}
+
 /**
  * @brief Creates a special file.
  * 
@@ -18,8 +18,10 @@
  */
 
 #include <fcntl.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #include "minix.h"
@@ -32,7 +34,8 @@
  */
 static void usage(void)
 {
-	printf("usage: mkdir.minix <input file> <directory> <uid> <gid>\n");
+	printf("usage: mkdir.minix [-i] <input file> <directory> <uid> <gid>\n");
+	printf("  -i  index the new directory\n");
 	exit(EXIT_SUCCESS);
 }
 
@@ -45,6 +48,15 @@ int main(int argc, char **argv)
 	uint16_t num1, num2;               /* Working inode numbers.           */
 	struct d_inode *ip;                /* Working inode.                   */
 	char filename[MINIX_NAME_MAX + 1]; /* Working file name.               */
+	bool indexed;                      /* Index new directory?             */
+	
+	/* Index new directory. */
+	indexed = ((argc > 1) && (!strcmp(argv[1], "-i")));
+	if (indexed)
+	{
+		argc--;
+		argv++;
+	}
 	
 	/* Wrong usage. */
 	if (argc != 5)
@@ -63,7 +75,12 @@ int main(int argc, char **argv)
 		
 		/* Create directory. */
 		if (num2 == INODE_NULL)
+		{
 			num2 = minix_mkdir(ip, num1, filename, atoi(argv[3]), atoi(argv[4]));
+			
+			if ((indexed) && (*dirname == '\0'))
+				minix_dir_index(num2);
+		}
 		
 		minix_inode_write(num1, ip);
 		ip = minix_inode_read(num1 = num2);